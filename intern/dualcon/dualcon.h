@@ -96,7 +96,9 @@ void *dualcon(const DualConInput *input_mesh,
               float threshold,
               float hermite_num,
               float scale,
-              int depth);
+              int depth,
+              /* number of threads used for scan conversion */
+              int num_threads);
 
 #ifdef __cplusplus
 }
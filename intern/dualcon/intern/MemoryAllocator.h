@@ -63,7 +63,7 @@ virtual int getBytes( ) = 0;
 /**
  * Dynamic memory allocator - allows allocation/deallocation
  *
- * Note: there are 4 bytes overhead for each allocated yet unused object.
+ * Note: there are 8 bytes overhead for each de-allocated yet unused object.
  */
 template < int N >
 class MemoryAllocator : public VirtualMemoryAllocator
@@ -76,7 +76,7 @@ int HEAP_UNIT, HEAP_MASK;
 /// Data array
 UCHAR **data;
 
-/// Allocation stack
+/// Allocation stack, only holds de-allocated objects
 UCHAR ***stack;
 
 /// Number of data blocks
@@ -91,22 +91,20 @@ int stacksize;
 /// Number of available objects on stack
 int available;
 
+/// Number of objects in the last data block which were never allocated
+int fresh;
+
 /**
  * Allocate a memory block
  */
 void allocateDataBlock( )
 {
-	// Allocate a data block
+	// Allocate a data block, objects are handed out in order so pages
+	// are only touched once they are used
 	datablocknum += 1;
 	data = ( UCHAR ** )realloc(data, sizeof (UCHAR *) * datablocknum);
 	data[datablocknum - 1] = ( UCHAR * )malloc(HEAP_UNIT * N);
-
-	// Update allocation stack
-	for (int i = 0; i < HEAP_UNIT; i++)
-	{
-		stack[0][i] = (data[datablocknum - 1] + i * N);
-	}
-	available = HEAP_UNIT;
+	fresh = HEAP_UNIT;
 }
 
 /**
@@ -131,20 +129,16 @@ MemoryAllocator( )
 	HEAP_UNIT = 1 << HEAP_BASE;
 	HEAP_MASK = (1 << HEAP_BASE) - 1;
 
-	data = ( UCHAR ** )malloc(sizeof(UCHAR *) );
-	data[0] = ( UCHAR * )malloc(HEAP_UNIT * N);
-	datablocknum = 1;
+	data = NULL;
+	datablocknum = 0;
+	fresh = 0;
 
-	stack = ( UCHAR *** )malloc(sizeof (UCHAR * *) );
-	stack[0] = ( UCHAR ** )malloc(HEAP_UNIT * sizeof (UCHAR *) );
-	stackblocknum = 1;
-	stacksize = HEAP_UNIT;
-	available = HEAP_UNIT;
+	stack = NULL;
+	stackblocknum = 0;
+	stacksize = 0;
+	available = 0;
 
-	for (int i = 0; i < HEAP_UNIT; i++)
-	{
-		stack[0][i] = (data[0] + i * N);
-	}
+	allocateDataBlock( );
 }
 
 /**
@@ -170,14 +164,20 @@ void destroy( )
  */
 void *allocate( )
 {
-	if (available == 0)
+	if (available > 0)
+	{
+		// Re-use a de-allocated object
+		available--;
+		return (void *)stack[available >> HEAP_BASE][available & HEAP_MASK];
+	}
+
+	if (fresh == 0)
 	{
 		allocateDataBlock( );
 	}
 
-	// printf("Allocating %d\n", header[ allocated ]) ;
-	available--;
-	return (void *)stack[available >> HEAP_BASE][available & HEAP_MASK];
+	fresh--;
+	return (void *)(data[datablocknum - 1] + (HEAP_UNIT - 1 - fresh) * N);
 }
 
 /**
@@ -209,7 +209,7 @@ void printInfo( )
  */
 int getAllocated( )
 {
-	return HEAP_UNIT * datablocknum - available;
+	return HEAP_UNIT * datablocknum - available - fresh;
 };
 
 int getAll( )
@@ -41,6 +41,10 @@ ModelReader(){
 virtual Triangle *getNextTriangle( ) = 0;
 virtual int getNextTriangle(int t[3]) = 0;
 
+/// Get triangle by index, false when it can't be used. Doesn't change the
+/// reading location and can be called from multiple threads.
+virtual bool getTriangle(int index, Triangle *trian) = 0;
+
 /// Get bounding box
 virtual float getBoundingBox(float origin[3]) = 0;
 
@@ -90,30 +90,35 @@ void reset()
 	maxsize *= 1 / scale;
 }
 
-Triangle *getNextTriangle()
+bool getTriangle(int index, Triangle *t)
 {
-	if (curtri == input_mesh->tottri)
-		return NULL;
-
-	Triangle *t = new Triangle();
-
-	unsigned int *tr = GET_TRI(input_mesh, curtri);
+	unsigned int *tr = GET_TRI(input_mesh, index);
 	veccopy(t->vt[0], GET_CO(input_mesh, GET_LOOP(input_mesh, tr[0])));
 	veccopy(t->vt[1], GET_CO(input_mesh, GET_LOOP(input_mesh, tr[1])));
 	veccopy(t->vt[2], GET_CO(input_mesh, GET_LOOP(input_mesh, tr[2])));
 
-	curtri++;
-
 	/* remove triangle if it contains invalid coords */
 	for (int i = 0; i < 3; i++) {
 		const float *co = t->vt[i];
 		if (isnan(co[0]) || isnan(co[1]) || isnan(co[2])) {
-			delete t;
-			return getNextTriangle();
+			return false;
 		}
 	}
 
-	return t;
+	return true;
+}
+
+Triangle *getNextTriangle()
+{
+	Triangle *t = new Triangle();
+
+	while (curtri < input_mesh->tottri) {
+		if (getTriangle(curtri++, t))
+			return t;
+	}
+
+	delete t;
+	return NULL;
 }
 
 int getNextTriangle(int t[3])
@@ -177,11 +182,12 @@ void *dualcon(const DualConInput *input_mesh,
               float threshold,
               float hermite_num,
               float scale,
-              int depth)
+              int depth,
+              int num_threads)
 {
 	DualConInputReader r(input_mesh, scale);
 	Octree o(&r, alloc_output, add_vert, add_quad,
-	         flags, mode, depth, threshold, hermite_num);
+	         flags, mode, depth, threshold, hermite_num, num_threads);
 	o.scanConvert();
 	return o.getOutputMesh();
 }
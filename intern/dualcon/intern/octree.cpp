@@ -26,7 +26,10 @@
 
 #include "octree.h"
 #include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
 #include <limits>
+#include <thread>
 #include <time.h>
 
 /**
@@ -51,8 +54,9 @@ Octree::Octree(ModelReader *mr,
                DualConAddVert add_vert_func,
                DualConAddQuad add_quad_func,
                DualConFlags flags, DualConMode dualcon_mode, int depth,
-               float threshold, float sharpness)
-	: use_flood_fill(flags & DUALCON_FLOOD_FILL),
+               float threshold, float sharpness, int threads)
+	: num_threads(threads),
+	use_flood_fill(flags & DUALCON_FLOOD_FILL),
 	/* note on `use_manifold':
 
 	   After playing around with this option, the only case I could
@@ -104,6 +108,40 @@ Octree::Octree(ModelReader *mr,
 
 }
 
+Octree::Octree(const Octree *parent)
+	: root(NULL),
+	reader(parent->reader),
+	cubes(NULL),
+	dimen(parent->dimen),
+	mindimen(parent->mindimen),
+	minshift(parent->minshift),
+	maxDepth(parent->maxDepth),
+	range(parent->range),
+	nodeCount(0),
+	nodeSpace(0),
+	ringList(NULL),
+	maxTrianglePerCell(0),
+	num_threads(1),
+	use_flood_fill(parent->use_flood_fill),
+	thresh(parent->thresh),
+	use_manifold(parent->use_manifold),
+	hermite_num(parent->hermite_num),
+	mode(parent->mode),
+	alloc_output(NULL),
+	add_vert(NULL),
+	add_quad(NULL),
+	output_mesh(NULL)
+{
+	origin[0] = parent->origin[0];
+	origin[1] = parent->origin[1];
+	origin[2] = parent->origin[2];
+	/* the static node tables are built by the parent already, and are read
+	 * by other fragments, only copy the per-octree edge tables */
+	memcpy(numEdgeTable, parent->numEdgeTable, sizeof(numEdgeTable));
+	memcpy(edgeCountTable, parent->edgeCountTable, sizeof(edgeCountTable));
+	initMemory();
+}
+
 Octree::~Octree()
 {
 	delete cubes;
@@ -225,13 +263,36 @@ void Octree::initMemory()
 void Octree::freeMemory()
 {
 	for (int i = 0; i < 9; i++) {
-		alloc[i]->destroy();
-		delete alloc[i];
+		if (alloc[i] != NULL) {
+			alloc[i]->destroy();
+			delete alloc[i];
+		}
+	}
+
+	for (int i = 0; i < 4; i++) {
+		if (leafalloc[i] != NULL) {
+			leafalloc[i]->destroy();
+			delete leafalloc[i];
+		}
+	}
+
+	for (size_t i = 0; i < fragment_alloc.size(); i++) {
+		fragment_alloc[i]->destroy();
+		delete fragment_alloc[i];
+	}
+	fragment_alloc.clear();
+}
+
+void Octree::adoptFragmentMemory(Octree *fragment)
+{
+	for (int i = 0; i < 9; i++) {
+		fragment_alloc.push_back(fragment->alloc[i]);
+		fragment->alloc[i] = NULL;
 	}
 
 	for (int i = 0; i < 4; i++) {
-		leafalloc[i]->destroy();
-		delete leafalloc[i];
+		fragment_alloc.push_back(fragment->leafalloc[i]);
+		fragment->leafalloc[i] = NULL;
 	}
 }
 
@@ -264,6 +325,13 @@ void Octree::resetMinimalEdges()
 
 void Octree::addAllTriangles()
 {
+	/* Subtrees are only scan converted separately when they are below
+	 * the levels which are used for splitting the work. */
+	if (num_threads > 1 && maxDepth > FRAGMENT_LEVELS) {
+		addAllTrianglesThreaded();
+		return;
+	}
+
 	Triangle *trian;
 	int count = 0;
 
@@ -321,35 +389,214 @@ void Octree::addAllTriangles()
 	putchar(13);
 }
 
-/* Prepare a triangle for insertion into the octree; call the other
-   addTriangle() to (recursively) build the octree */
-void Octree::addTriangle(Triangle *trian, int triind)
+/* Project the triangle's coordinates into the grid */
+void Octree::projectTriangle(Triangle *trian, int64_t trig[3][3])
 {
 	int i, j;
 
-	/* Project the triangle's coordinates into the grid */
 	for (i = 0; i < 3; i++) {
 		for (j = 0; j < 3; j++)
 			trian->vt[i][j] = dimen * (trian->vt[i][j] - origin[j]) / range;
 	}
 
-	/* Generate projections */
-	int64_t cube[2][3] = {{0, 0, 0}, {dimen, dimen, dimen}};
-	int64_t trig[3][3];
 	for (i = 0; i < 3; i++) {
 		for (j = 0; j < 3; j++)
 			trig[i][j] = (int64_t)(trian->vt[i][j]);
 	}
+}
 
-	/* Add triangle to the octree */
+/* Generate projections of a grid-space triangle against the root cube */
+CubeTriangleIsect *Octree::createRootProjection(int64_t trig[3][3], int triind)
+{
+	int64_t cube[2][3] = {{0, 0, 0}, {dimen, dimen, dimen}};
 	int64_t errorvec = (int64_t)(0);
-	CubeTriangleIsect *proj = new CubeTriangleIsect(cube, trig, errorvec, triind);
+	return new CubeTriangleIsect(cube, trig, errorvec, triind);
+}
+
+/* Prepare a triangle for insertion into the octree; call the other
+   addTriangle() to (recursively) build the octree */
+void Octree::addTriangle(Triangle *trian, int triind)
+{
+	int64_t trig[3][3];
+	projectTriangle(trian, trig);
+
+	/* Add triangle to the octree */
+	CubeTriangleIsect *proj = createRootProjection(trig, triind);
 	root = (Node *)addTriangle(&root->internal, proj, maxDepth);
 
 	delete proj->inherit;
 	delete proj;
 }
 
+/* Projections of the triangle against the given child of the cube, NULL
+   when the triangle does not intersect that child. Same tests as done by
+   addTriangle(), where the child shift is accumulated incrementally. */
+static CubeTriangleIsect *child_projection(CubeTriangleIsect *p,
+                                           unsigned char boxmask,
+                                           int child)
+{
+	if (!(boxmask & (1 << child)))
+		return NULL;
+
+	CubeTriangleIsect *subp = new CubeTriangleIsect(p);
+	int off[3] = {(child >> 2) & 1, (child >> 1) & 1, child & 1};
+	subp->shift(off);
+	if (!subp->isIntersecting()) {
+		delete subp;
+		return NULL;
+	}
+	return subp;
+}
+
+/* Projections of the triangle against the fragment cell, NULL when the
+   triangle does not intersect the cell */
+static CubeTriangleIsect *fragment_projection(CubeTriangleIsect *proj,
+                                              int fragment)
+{
+	CubeTriangleIsect *p = proj;
+	for (int level = FRAGMENT_LEVELS - 1; level >= 0 && p != NULL; level--) {
+		const int child = (fragment >> (3 * level)) & 7;
+		CubeTriangleIsect *subp = child_projection(p, p->getBoxMask(), child);
+		if (p != proj)
+			delete p;
+		p = subp;
+	}
+	return p;
+}
+
+/* Run func(thread) on num_threads threads and wait for them to finish */
+template<typename Func>
+static void run_threads(int num_threads, const Func &func)
+{
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; t++)
+		threads.push_back(std::thread(func, t));
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+}
+
+/* Can the grid-space triangle intersect the cell, given by the child
+   indices of the levels below the root? Conservative bounding box test,
+   done before the exact projection test. */
+static bool cell_overlap(int64_t trig[3][3], int cell, int levels, int64_t size)
+{
+	for (int axis = 0; axis < 3; axis++) {
+		int64_t lo = 0;
+		for (int level = levels - 1; level >= 0; level--) {
+			const int child = (cell >> (3 * level)) & 7;
+			lo = lo * 2 + ((child >> (2 - axis)) & 1);
+		}
+		lo *= size;
+
+		const int64_t tmin = std::min(trig[0][axis], std::min(trig[1][axis], trig[2][axis]));
+		const int64_t tmax = std::max(trig[0][axis], std::max(trig[1][axis], trig[2][axis]));
+		if (tmax < lo - 1 || tmin > lo + size + 1)
+			return false;
+	}
+	return true;
+}
+
+void Octree::addAllTrianglesThreaded()
+{
+	/* Each fragment cell is scan converted by a single thread, which reads
+	   the triangles by index straight from the input mesh. Only a mask of
+	   the root children a triangle may intersect is stored, one byte per
+	   triangle, so fragments skip most triangles without reading them.
+	   Triangles are added in increasing index order like the serial
+	   version does, so the octree is the same. */
+	const int num_triangles = reader->getNumTriangles();
+	const int64_t size = dimen >> FRAGMENT_LEVELS;
+	InternalNode *fragment_nodes[NUM_FRAGMENTS] = {NULL};
+	std::vector<unsigned char> masks(num_triangles, 0);
+
+	run_threads(num_threads, [&](int t) {
+		const int start = (int)((int64_t)num_triangles * t / num_threads);
+		const int end = (int)((int64_t)num_triangles * (t + 1) / num_threads);
+		Triangle trian;
+		for (int triind = start; triind < end; triind++) {
+			if (!reader->getTriangle(triind, &trian))
+				continue;
+			int64_t trig[3][3];
+			projectTriangle(&trian, trig);
+			for (int child = 0; child < 8; child++) {
+				if (cell_overlap(trig, child, 1, dimen >> 1))
+					masks[triind] |= (unsigned char)(1 << child);
+			}
+		}
+	});
+
+	/* Fragments are all created before the threads start, constructing one
+	   must not race with scan conversion */
+	std::vector<Octree *> fragments(num_threads);
+	for (int t = 0; t < num_threads; t++)
+		fragments[t] = new Octree(this);
+
+	std::atomic<int> next_fragment(0);
+	run_threads(num_threads, [&](int t) {
+		Octree *octree = fragments[t];
+		Triangle trian;
+		int fragment;
+		while ((fragment = next_fragment++) < NUM_FRAGMENTS) {
+			const unsigned char bit = (unsigned char)(1 << (fragment >> (3 * (FRAGMENT_LEVELS - 1))));
+			InternalNode *node = NULL;
+			for (int triind = 0; triind < num_triangles; triind++) {
+				if (!(masks[triind] & bit))
+					continue;
+				reader->getTriangle(triind, &trian);
+				int64_t trig[3][3];
+				projectTriangle(&trian, trig);
+				if (!cell_overlap(trig, fragment, FRAGMENT_LEVELS, size))
+					continue;
+
+				CubeTriangleIsect *proj = createRootProjection(trig, triind);
+				CubeTriangleIsect *p = fragment_projection(proj, fragment);
+				if (p != NULL) {
+					/* the cell node is only created when a triangle intersects
+					   it, same as addTriangle() does */
+					if (node == NULL)
+						node = octree->createInternal(0);
+					node = octree->addTriangle(node, p, maxDepth - FRAGMENT_LEVELS);
+					delete p;
+				}
+				delete proj->inherit;
+				delete proj;
+			}
+			fragment_nodes[fragment] = node;
+		}
+	});
+
+	/* Merge fragments: link subtrees, creating the nodes above them like
+	   addTriangle() would have done, and take over the fragment memory */
+	for (int fragment = 0; fragment < NUM_FRAGMENTS; fragment++) {
+		if (fragment_nodes[fragment] == NULL)
+			continue;
+		InternalNode *node = &root->internal;
+		InternalNode *parent = NULL;
+		int parent_count = 0;
+		for (int level = FRAGMENT_LEVELS - 1; level >= 0; level--) {
+			const int child = (fragment >> (3 * level)) & 7;
+			const int count = node->get_child_count(child);
+			if (level == 0 || !node->has_child(child)) {
+				InternalNode *child_node = (level == 0) ? fragment_nodes[fragment] : createInternal(0);
+				node = addInternalChild(node, child, count, child_node);
+				if (parent != NULL)
+					parent->set_child(parent_count, (Node *)node);
+				else
+					root = (Node *)node;
+			}
+			if (level > 0) {
+				parent = node;
+				parent_count = count;
+				node = &node->get_child(count)->internal;
+			}
+		}
+	}
+	for (int t = 0; t < num_threads; t++) {
+		adoptFragmentMemory(fragments[t]);
+		delete fragments[t];
+	}
+}
+
 #if 0
 static void print_depth(int height, int maxDepth)
 {
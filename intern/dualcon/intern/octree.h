@@ -27,6 +27,7 @@
 #include <cstring>
 #include <stdio.h>
 #include <math.h>
+#include <vector>
 #include "GeoCommon.h"
 #include "Projections.h"
 #include "ModelReader.h"
@@ -55,6 +56,11 @@
 
 #define EDGE_FLOATS 4
 
+/* Number of octree levels above the subtrees which are scan converted
+ * independently from each other on multiple threads */
+#define FRAGMENT_LEVELS 2
+#define NUM_FRAGMENTS (1 << (3 * FRAGMENT_LEVELS))
+
 union Node;
 struct LeafNode;
 
@@ -235,6 +241,10 @@ class Octree
 	VirtualMemoryAllocator *alloc[9];
 	VirtualMemoryAllocator *leafalloc[4];
 
+	/// Memory allocators taken over from scan conversion fragments, they
+	/// own nodes of the subtrees which were built on other threads
+	std::vector<VirtualMemoryAllocator *> fragment_alloc;
+
 	/// Root node
 	Node *root;
 
@@ -267,6 +277,9 @@ class Octree
 	int maxTrianglePerCell;
 	int outType;     // 0 for OFF, 1 for PLY, 2 for VOL
 
+	/// Number of threads used for scan conversion
+	int num_threads;
+
 	// For flood filling
 	int use_flood_fill;
 	float thresh;
@@ -286,7 +299,7 @@ class Octree
 		   DualConAddVert add_vert_func,
 		   DualConAddQuad add_quad_func,
 		   DualConFlags flags, DualConMode mode, int depth,
-		   float threshold, float hermite_num);
+		   float threshold, float hermite_num, int num_threads);
 
 	/**
 	 * Destructor
@@ -303,6 +316,13 @@ class Octree
 	}
 
  private:
+	/**
+	 * Construct a scan conversion fragment: it shares grid parameters with
+	 * the parent octree, but allocates nodes from its own memory, so that
+	 * subtrees can be scan converted on multiple threads
+	 */
+	explicit Octree(const Octree *parent);
+
 	/* Helper functions */
 
 	/**
@@ -310,6 +330,12 @@ class Octree
 	 */
 	void initMemory();
 
+	/**
+	 * Take over memory of the fragment, nodes allocated by the fragment
+	 * stay valid until this octree is destroyed
+	 */
+	void adoptFragmentMemory(Octree *fragment);
+
 	/**
 	 * Release memory
 	 */
@@ -339,6 +365,14 @@ class Octree
 	void addTriangle(Triangle *trian, int triind);
 	InternalNode *addTriangle(InternalNode *node, CubeTriangleIsect *p, int height);
 
+	/**
+	 * Same as addAllTriangles(), but scan converts independent subtrees
+	 * on multiple threads. Gives the same octree as the serial version.
+	 */
+	void addAllTrianglesThreaded();
+	void projectTriangle(Triangle *trian, int64_t trig[3][3]);
+	CubeTriangleIsect *createRootProjection(int64_t trig[3][3], int triind);
+
 	/**
 	 * Method to update minimizer in a cell: update edge intersections instead
 	 */
@@ -30,6 +30,10 @@
 #include <opensubdiv/far/patchTable.h>
 #include <opensubdiv/far/patchTableFactory.h>
 #include <opensubdiv/osd/cpuEvaluator.h>
+#if defined(OPENSUBDIV_HAS_OPENMP) && defined(_OPENMP)
+#  include <opensubdiv/osd/ompEvaluator.h>
+#  define OPENSUBDIV_HAS_THREADED_STENCILS
+#endif
 #include <opensubdiv/osd/cpuPatchTable.h>
 #include <opensubdiv/osd/cpuVertexBuffer.h>
 #include <opensubdiv/osd/mesh.h>
@@ -44,6 +48,9 @@
 
 using OpenSubdiv::Osd::BufferDescriptor;
 using OpenSubdiv::Osd::CpuEvaluator;
+#ifdef OPENSUBDIV_HAS_THREADED_STENCILS
+using OpenSubdiv::Osd::OmpEvaluator;
+#endif
 using OpenSubdiv::Osd::CpuPatchTable;
 using OpenSubdiv::Osd::CpuVertexBuffer;
 using OpenSubdiv::Osd::PatchCoord;
@@ -148,6 +155,44 @@ class StackAllocatedBuffer {
   float data_[element_size * num_vertices];
 };
 
+// Evaluator which is used to apply stencils on refine().
+//
+// Stencils are evaluated for all the refined vertices at once, so it is worth
+// to spread this work across all the cores. Patches are evaluated one point
+// at a time, threading there will only add an overhead, so they stay on the
+// evaluator which the output was created for.
+template <typename EVALUATOR, typename DEVICE_CONTEXT>
+struct StencilEvaluator {
+  typedef EVALUATOR Type;
+
+  static const Type* get(
+      OpenSubdiv::Osd::EvaluatorCacheT<EVALUATOR>* evaluator_cache,
+      const BufferDescriptor& src_desc,
+      const BufferDescriptor& dst_desc,
+      DEVICE_CONTEXT* device_context) {
+    return OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(evaluator_cache,
+                                                    src_desc,
+                                                    dst_desc,
+                                                    device_context);
+  }
+};
+
+#ifdef OPENSUBDIV_HAS_THREADED_STENCILS
+template <typename DEVICE_CONTEXT>
+struct StencilEvaluator<CpuEvaluator, DEVICE_CONTEXT> {
+  typedef OmpEvaluator Type;
+
+  // NOTE: OpenMP evaluator only has static methods, no instance is needed.
+  static const Type* get(
+      OpenSubdiv::Osd::EvaluatorCacheT<CpuEvaluator>* /*evaluator_cache*/,
+      const BufferDescriptor& /*src_desc*/,
+      const BufferDescriptor& /*dst_desc*/,
+      DEVICE_CONTEXT* /*device_context*/) {
+    return NULL;
+  }
+};
+#endif
+
 template <typename EVAL_VERTEX_BUFFER,
           typename STENCIL_TABLE,
           typename PATCH_TABLE,
@@ -198,16 +243,19 @@ class FaceVaryingVolatileEval {
     BufferDescriptor dst_face_varying_desc = src_face_varying_desc_;
     dst_face_varying_desc.offset += num_coarse_face_varying_vertices_ *
                                     src_face_varying_desc_.stride;
-    const EVALUATOR* eval_instance = OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(
+    typedef StencilEvaluator<EVALUATOR, DEVICE_CONTEXT> Stencils;
+    const typename Stencils::Type* eval_instance = Stencils::get(
         evaluator_cache_,
         src_face_varying_desc_,
         dst_face_varying_desc,
         device_context_);
-    EVALUATOR::EvalStencils(src_face_varying_data_, src_face_varying_desc_,
-                            src_face_varying_data_, dst_face_varying_desc,
-                            face_varying_stencils_,
-                            eval_instance,
-                            device_context_);
+    Stencils::Type::EvalStencils(src_face_varying_data_,
+                                 src_face_varying_desc_,
+                                 src_face_varying_data_,
+                                 dst_face_varying_desc,
+                                 face_varying_stencils_,
+                                 eval_instance,
+                                 device_context_);
   }
 
   void evalPatch(const PatchCoord& patch_coord, float face_varying[2]) {
@@ -359,32 +407,29 @@ class VolatileEvalOutput {
 
   void refine() {
     // Evaluate vertex positions.
+    typedef StencilEvaluator<EVALUATOR, DEVICE_CONTEXT> Stencils;
     BufferDescriptor dst_desc = src_desc_;
     dst_desc.offset += num_coarse_vertices_ * src_desc_.stride;
-    const EVALUATOR* eval_instance =
-        OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(evaluator_cache_,
-                                                 src_desc_,
-                                                 dst_desc,
-                                                 device_context_);
-    EVALUATOR::EvalStencils(src_data_, src_desc_,
-                            src_data_, dst_desc,
-                            vertex_stencils_,
-                            eval_instance,
-                            device_context_);
+    const typename Stencils::Type* eval_instance =
+        Stencils::get(evaluator_cache_, src_desc_, dst_desc, device_context_);
+    Stencils::Type::EvalStencils(src_data_, src_desc_,
+                                 src_data_, dst_desc,
+                                 vertex_stencils_,
+                                 eval_instance,
+                                 device_context_);
     // Evaluate varying data.
     if (hasVaryingData()) {
       BufferDescriptor dst_varying_desc = src_varying_desc_;
       dst_varying_desc.offset +=
           num_coarse_vertices_ * src_varying_desc_.stride;
-      eval_instance = OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(
-          evaluator_cache_,
-          src_varying_desc_,
-          dst_varying_desc,
-          device_context_);
-      EVALUATOR::EvalStencils(src_varying_data_, src_varying_desc_,
-                              src_varying_data_, dst_varying_desc,
-                              varying_stencils_,
-                              eval_instance, device_context_);
+      eval_instance = Stencils::get(evaluator_cache_,
+                                    src_varying_desc_,
+                                    dst_varying_desc,
+                                    device_context_);
+      Stencils::Type::EvalStencils(src_varying_data_, src_varying_desc_,
+                                   src_varying_data_, dst_varying_desc,
+                                   varying_stencils_,
+                                   eval_instance, device_context_);
     }
     // Evaluate face-varying data.
     if (hasFaceVaryingData()) {
@@ -398,10 +398,48 @@ bool checkEdgeSharpnessMatch(
   return true;
 }
 
+// Face-varying topology (UV islands) is stored in the refiner as well, so
+// changes there also require topology refiner to be re-created.
+bool checkUVLayersMatch(
+    const OpenSubdiv::Far::TopologyRefiner* topology_refiner,
+    const OpenSubdiv_Converter* converter) {
+  using OpenSubdiv::Far::ConstIndexArray;
+  using OpenSubdiv::Far::TopologyLevel;
+  const TopologyLevel& base_level = topology_refiner->GetLevel(0);
+  const int num_layers = converter->getNumUVLayers(converter);
+  if (num_layers != base_level.GetNumFVarChannels()) {
+    return false;
+  }
+  const int num_faces = base_level.GetNumFaces();
+  for (int layer_index = 0; layer_index < num_layers; ++layer_index) {
+    converter->precalcUVLayer(converter, layer_index);
+    bool is_matching = (converter->getNumUVCoordinates(converter) ==
+                        base_level.GetNumFVarValues(layer_index));
+    for (int face_index = 0; face_index < num_faces && is_matching;
+         ++face_index) {
+      const ConstIndexArray& face_uvs =
+          base_level.GetFaceFVarValues(face_index, layer_index);
+      for (int corner = 0; corner < face_uvs.size(); ++corner) {
+        if (face_uvs[corner] !=
+            converter->getFaceCornerUVIndex(converter, face_index, corner)) {
+          is_matching = false;
+          break;
+        }
+      }
+    }
+    converter->finishUVLayer(converter);
+    if (!is_matching) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool checkTopologyAttributesMatch(
     const OpenSubdiv::Far::TopologyRefiner* topology_refiner,
     const OpenSubdiv_Converter* converter) {
-  return checkEdgeSharpnessMatch(topology_refiner, converter);
+  return checkEdgeSharpnessMatch(topology_refiner, converter) &&
+         checkUVLayersMatch(topology_refiner, converter);
 }
 
 }  // namespace
@@ -114,6 +114,9 @@ openvdb::GridBase *OpenVDB_export_vector_grid(
 	MergeScalarGrids op(&(grid[0]->tree()), &(grid[1]->tree()), &(grid[2]->tree()));
 	tools::foreach(vecgrid->beginValueOn(), op, true, false);
 
+	/* Lossless, see OpenVDB_export_grid. */
+	vecgrid->tree().prune();
+
 	vecgrid->setTransform(transform);
 
 	/* Avoid clipping against an empty grid. */
@@ -149,18 +152,33 @@ void OpenVDB_import_grid_vector(
 	}
 
 	Vec3SGrid::Ptr vgrid = gridPtrCast<Vec3SGrid>(reader->getGrid(name));
-	Vec3SGrid::ConstAccessor acc = vgrid->getConstAccessor();
-	math::Coord xyz;
-	int &x = xyz[0], &y = xyz[1], &z = xyz[2];
-
-	size_t index = 0;
-	for (z = 0; z < res[2]; ++z) {
-		for (y = 0; y < res[1]; ++y) {
-			for (x = 0; x < res[0]; ++x, ++index) {
-				math::Vec3s value = acc.getValue(xyz);
-				(*data_x)[index] = value.x();
-				(*data_y)[index] = value.y();
-				(*data_z)[index] = value.z();
+
+	/* See OpenVDB_import_grid, only the active voxels and tiles are visited. */
+	const math::CoordBBox bbox(Coord(0), Coord(res[0] - 1, res[1] - 1, res[2] - 1));
+	const size_t num_voxels = size_t(res[0]) * size_t(res[1]) * size_t(res[2]);
+	const math::Vec3s background = vgrid->background();
+
+	std::fill(*data_x, *data_x + num_voxels, background.x());
+	std::fill(*data_y, *data_y + num_voxels, background.y());
+	std::fill(*data_z, *data_z + num_voxels, background.z());
+
+	for (Vec3SGrid::ValueOnCIter iter = vgrid->cbeginValueOn(); iter; ++iter) {
+		math::CoordBBox box;
+		iter.getBoundingBox(box);
+		box.intersect(bbox);
+
+		if (box.empty()) {
+			continue;
+		}
+
+		const math::Vec3s value = iter.getValue();
+
+		for (int z = box.min().z(); z <= box.max().z(); ++z) {
+			for (int y = box.min().y(); y <= box.max().y(); ++y) {
+				const size_t row = (size_t(z) * res[1] + y) * res[0];
+				std::fill(*data_x + row + box.min().x(), *data_x + row + box.max().x() + 1, value.x());
+				std::fill(*data_y + row + box.min().x(), *data_y + row + box.max().x() + 1, value.y());
+				std::fill(*data_z + row + box.min().x(), *data_z + row + box.max().x() + 1, value.z());
 			}
 		}
 	}
@@ -34,6 +34,7 @@
 #include <openvdb/tools/Clip.h>
 #include <openvdb/tools/Dense.h>
 
+#include <algorithm>
 #include <cstdio>
 
 namespace internal {
@@ -65,6 +66,10 @@ GridType *OpenVDB_export_grid(
 	tools::Dense<const T, openvdb::tools::LayoutXYZ> dense_grid(bbox, data);
 	tools::copyFromDense(dense_grid, grid->tree(), static_cast<T>(clipping));
 
+	/* Collapse uniform leaves (e.g. fully lit shadow or solid obstacles) into
+	 * tiles, only exactly equal values are merged so this is lossless. */
+	grid->tree().prune();
+
 	grid->setTransform(transform);
 
 	/* Avoid clipping against an empty grid. */
@@ -103,16 +108,29 @@ void OpenVDB_import_grid(
 	}
 
 	typename GridType::Ptr grid = gridPtrCast<GridType>(reader->getGrid(temp_name));
-	typename GridType::ConstAccessor acc = grid->getConstAccessor();
 
-	math::Coord xyz;
-	int &x = xyz[0], &y = xyz[1], &z = xyz[2];
+	/* Only visit the active voxels and tiles instead of looking up every voxel
+	 * of the domain, empty space is filled with the background value. */
+	const math::CoordBBox bbox(Coord(0), Coord(res[0] - 1, res[1] - 1, res[2] - 1));
+	const size_t num_voxels = size_t(res[0]) * size_t(res[1]) * size_t(res[2]);
+
+	std::fill(*data, *data + num_voxels, static_cast<T>(grid->background()));
+
+	for (typename GridType::ValueOnCIter iter = grid->cbeginValueOn(); iter; ++iter) {
+		math::CoordBBox box;
+		iter.getBoundingBox(box);
+		box.intersect(bbox);
+
+		if (box.empty()) {
+			continue;
+		}
+
+		const T value = static_cast<T>(iter.getValue());
 
-	size_t index = 0;
-	for (z = 0; z < res[2]; ++z) {
-		for (y = 0; y < res[1]; ++y) {
-			for (x = 0; x < res[0]; ++x, ++index) {
-				(*data)[index] = acc.getValue(xyz);
+		for (int z = box.min().z(); z <= box.max().z(); ++z) {
+			for (int y = box.min().y(); y <= box.max().y(); ++y) {
+				T *row = *data + (size_t(z) * res[1] + y) * res[0];
+				std::fill(row + box.min().x(), row + box.max().x() + 1, value);
 			}
 		}
 	}
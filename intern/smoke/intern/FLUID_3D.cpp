@@ -383,10 +383,7 @@ void FLUID_3D::step(float dt, float gravity[3])
 
 #if PARALLEL==1
 	}	// end of parallel
-	#pragma omp barrier
-
-	#pragma omp single
-	{
+	}
 #endif
 	/*
 	* addForce() changed Temp values to preserve thread safety
@@ -398,35 +395,18 @@ void FLUID_3D::step(float dt, float gravity[3])
 	SWAP_POINTERS(_xVelocity, _xVelocityTemp);
 	SWAP_POINTERS(_yVelocity, _yVelocityTemp);
 	SWAP_POINTERS(_zVelocity, _zVelocityTemp);
-#if PARALLEL==1
-	}	// end of single
 
-	#pragma omp barrier
+	/*
+	* The pressure and heat solvers are parallelized over slices
+	* internally, so run them one after the other with all threads
+	* instead of both at once on one thread each.
+	*/
+	project();
 
-	#pragma omp for
-	for (int i=0; i<2; i++)
-	{
-		if (i==0)
-		{
-#endif
-			project();
-#if PARALLEL==1
-		}
-		else if (i==1)
-		{
-#endif
-			if (_heat) {
-				diffuseHeat();
-			}
-#if PARALLEL==1
-		}
+	if (_heat) {
+		diffuseHeat();
 	}
 
-	#pragma omp barrier
-
-	#pragma omp single
-	{
-#endif
 	/*
 	* For thread safety use "Old" to read
 	* "current" values but still allow changing values.
@@ -447,11 +427,8 @@ void FLUID_3D::step(float dt, float gravity[3])
 	advectMacCormackBegin(0, _zRes);
 
 #if PARALLEL==1
-	}	// end of single
-
-	#pragma omp barrier
-
-
+	#pragma omp parallel
+	{
 	#pragma omp for schedule(static,1)
 	for (int i=0; i<stepParts; i++)
 	{
@@ -507,10 +484,9 @@ void FLUID_3D::step(float dt, float gravity[3])
 	_totalTime += _dt;
 	_totalSteps++;
 
-	for (int i = 0; i < _totalCells; i++)
-	{
-		_xForce[i] = _yForce[i] = _zForce[i] = 0.0f;
-	}
+	memset(_xForce, 0, sizeof(float) * _totalCells);
+	memset(_yForce, 0, sizeof(float) * _totalCells);
+	memset(_zForce, 0, sizeof(float) * _totalCells);
 
 }
 
@@ -925,9 +901,6 @@ void FLUID_3D::addForce(int zBegin, int zEnd)
 //////////////////////////////////////////////////////////////////////
 void FLUID_3D::project()
 {
-	int x, y, z;
-	size_t index;
-
 	float *_pressure = new float[_totalCells];
 	float *_divergence   = new float[_totalCells];
 
@@ -948,10 +921,14 @@ void FLUID_3D::project()
 	else setZeroZ(_zVelocity, _res, 0, _zRes);
 
 	// calculate divergence
-	index = _slabSize + _xRes + 1;
-	for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-		for (y = 1; y < _yRes - 1; y++, index += 2)
-			for (x = 1; x < _xRes - 1; x++, index++)
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int z = 1; z < _zRes - 1; z++)
+	{
+		size_t index = (size_t)z * _slabSize + _xRes + 1;
+		for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
 			{
 
 				if(_obstacles[index])
@@ -990,6 +967,7 @@ void FLUID_3D::project()
 				// Pressure is zero anyway since now a local array is used
 				_pressure[index] = 0.0f;
 			}
+	}
 
 	copyBorderAll(_pressure, 0, _zRes);
 
@@ -1004,10 +982,14 @@ void FLUID_3D::project()
 	// project out solution
 	// New idea for code from NVIDIA graphic gems 3 - DG
 	float invDx = 1.0f / _dx;
-	index = _slabSize + _xRes + 1;
-	for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-		for (y = 1; y < _yRes - 1; y++, index += 2)
-			for (x = 1; x < _xRes - 1; x++, index++)
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int z = 1; z < _zRes - 1; z++)
+	{
+		size_t index = (size_t)z * _slabSize + _xRes + 1;
+		for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
 			{
 				float vMask[3] = {1.0f, 1.0f, 1.0f}, vObst[3] = {0, 0, 0};
 				// float vR = 0.0f, vL = 0.0f, vT = 0.0f, vB = 0.0f, vD = 0.0f, vU = 0.0f;  // UNUSED
@@ -1045,6 +1027,7 @@ void FLUID_3D::project()
 					_zVelocity[index] = _zVelocityOb[index];
 				}
 			}
+	}
 
 	// DG: was enabled in original code but now we do this later
 	// setObstacleVelocity(0, _zRes);
@@ -1127,7 +1110,10 @@ void FLUID_3D::diffuseHeat()
 	solveHeat(_heat, _heatOld, _obstacles);
 
 	// zero out inside obstacles
-	for (int x = 0; x < _totalCells; x++)
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int x = 0; x < (int)_totalCells; x++)
 		if (_obstacles[x])
 			_heat[x] = 0.0f;
 }
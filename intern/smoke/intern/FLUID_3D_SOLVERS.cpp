@@ -31,16 +31,35 @@
 #include <cstring>
 #define SOLVER_ACCURACY 1e-06
 
+//////////////////////////////////////////////////////////////////////
+// Slices are solved in parallel. Dot products are summed per z slice
+// and the slices are added up in order afterwards, so the result does
+// not depend on the number of threads.
+//////////////////////////////////////////////////////////////////////
+static float sumSlices(const float *slices, int zRes)
+{
+	float sum = 0.0f;
+	for (int z = 1; z < zRes - 1; z++)
+		sum += slices[z];
+	return sum;
+}
+
+static float maxSlices(const float *slices, int zRes)
+{
+	float max = 0.0f;
+	for (int z = 1; z < zRes - 1; z++)
+		max = (slices[z] > max) ? slices[z] : max;
+	return max;
+}
+
 //////////////////////////////////////////////////////////////////////
 // solve the heat equation with CG
 //////////////////////////////////////////////////////////////////////
 void FLUID_3D::solveHeat(float* field, float* b, unsigned char* skip)
 {
-	int x, y, z;
-	const int twoxr = 2 * _xRes;
-	size_t index;
 	const float heatConst = _dt * _heatDiffusion / (_dx * _dx);
 	float *_q, *_residual, *_direction, *_Acenter;
+	float *_sliceSum, *_sliceMax;
 
 	// i = 0
 	int i = 0;
@@ -49,127 +68,161 @@ void FLUID_3D::solveHeat(float* field, float* b, unsigned char* skip)
 	_direction    = new float[_totalCells]; // set 0
 	_q            = new float[_totalCells]; // set 0
 	_Acenter       = new float[_totalCells]; // set 0
+	_sliceSum     = new float[_zRes];
+	_sliceMax     = new float[_zRes];
 
-  	memset(_residual, 0, sizeof(float)*_totalCells);
+	memset(_residual, 0, sizeof(float)*_totalCells);
 	memset(_q, 0, sizeof(float)*_totalCells);
 	memset(_direction, 0, sizeof(float)*_totalCells);
 	memset(_Acenter, 0, sizeof(float)*_totalCells);
 
-	float deltaNew = 0.0f;
-
-  // r = b - Ax
-  index = _slabSize + _xRes + 1;
-  for (z = 1; z < _zRes - 1; z++, index += twoxr)
-    for (y = 1; y < _yRes - 1; y++, index += 2)
-      for (x = 1; x < _xRes - 1; x++, index++)
-      {
-        // if the cell is a variable
-        _Acenter[index] = 1.0f;
-        if (!skip[index])
-        {
-          // set the matrix to the Poisson stencil in order
-          if (!skip[index + 1]) _Acenter[index] += heatConst;
-          if (!skip[index - 1]) _Acenter[index] += heatConst;
-          if (!skip[index + _xRes]) _Acenter[index] += heatConst;
-          if (!skip[index - _xRes]) _Acenter[index] += heatConst;
-          if (!skip[index + _slabSize]) _Acenter[index] += heatConst;
-          if (!skip[index - _slabSize]) _Acenter[index] += heatConst;
-
-		  _residual[index] = b[index] - (_Acenter[index] * field[index] + 
-          field[index - 1] * (skip[index - 1] ? 0.0f : -heatConst) +
-          field[index + 1] * (skip[index + 1] ? 0.0f : -heatConst) +
-          field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -heatConst) +
-          field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -heatConst) +
-          field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -heatConst) +
-          field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -heatConst));
-        }
-		else
+	// r = b - Ax
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int z = 1; z < _zRes - 1; z++)
+	{
+		size_t index = (size_t)z * _slabSize + _xRes + 1;
+		float sum = 0.0f;
+
+		for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
+			{
+				// if the cell is a variable
+				_Acenter[index] = 1.0f;
+				if (!skip[index])
+				{
+					// set the matrix to the Poisson stencil in order
+					if (!skip[index + 1]) _Acenter[index] += heatConst;
+					if (!skip[index - 1]) _Acenter[index] += heatConst;
+					if (!skip[index + _xRes]) _Acenter[index] += heatConst;
+					if (!skip[index - _xRes]) _Acenter[index] += heatConst;
+					if (!skip[index + _slabSize]) _Acenter[index] += heatConst;
+					if (!skip[index - _slabSize]) _Acenter[index] += heatConst;
+
+					_residual[index] = b[index] - (_Acenter[index] * field[index] +
+					field[index - 1] * (skip[index - 1] ? 0.0f : -heatConst) +
+					field[index + 1] * (skip[index + 1] ? 0.0f : -heatConst) +
+					field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -heatConst) +
+					field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -heatConst) +
+					field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -heatConst) +
+					field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -heatConst));
+				}
+				else
+				{
+					_residual[index] = 0.0f;
+				}
+
+				_direction[index] = _residual[index];
+				sum += _residual[index] * _residual[index];
+			}
+
+		_sliceSum[z] = sum;
+	}
+
+	float deltaNew = sumSlices(_sliceSum, _zRes);
+
+	// While deltaNew > (eps^2) * delta0
+	const float eps  = SOLVER_ACCURACY;
+	float maxR = 2.0f * eps;
+	while ((i < _iterations) && (maxR > eps))
+	{
+		// q = Ad
+#if PARALLEL==1
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int z = 1; z < _zRes - 1; z++)
 		{
-        _residual[index] = 0.0f;
+			size_t index = (size_t)z * _slabSize + _xRes + 1;
+			float sum = 0.0f;
+
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+				{
+					// if the cell is a variable
+					if (!skip[index])
+					{
+						_q[index] = (_Acenter[index] * _direction[index] +
+						_direction[index - 1] * (skip[index - 1] ? 0.0f : -heatConst) +
+						_direction[index + 1] * (skip[index + 1] ? 0.0f : -heatConst) +
+						_direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -heatConst) +
+						_direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -heatConst) +
+						_direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -heatConst) +
+						_direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -heatConst));
+					}
+					else
+					{
+						_q[index] = 0.0f;
+					}
+					sum += _direction[index] * _q[index];
+				}
+
+			_sliceSum[z] = sum;
 		}
 
-		_direction[index] = _residual[index];
-		deltaNew += _residual[index] * _residual[index];
-      }
-
-
-  // While deltaNew > (eps^2) * delta0
-  const float eps  = SOLVER_ACCURACY;
-  float maxR = 2.0f * eps;
-  while ((i < _iterations) && (maxR > eps))
-  {
-    // q = Ad
-	float alpha = 0.0f;
-
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += twoxr)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-        {
-          // if the cell is a variable
-          if (!skip[index])
-          {
-
-			_q[index] = (_Acenter[index] * _direction[index] + 
-            _direction[index - 1] * (skip[index - 1] ? 0.0f : -heatConst) +
-            _direction[index + 1] * (skip[index + 1] ? 0.0f : -heatConst) +
-            _direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -heatConst) +
-            _direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -heatConst) +
-            _direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -heatConst) +
-            _direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -heatConst));
-          }
-		  else
-		  {
-          _q[index] = 0.0f;
-		  }
-		  alpha += _direction[index] * _q[index];
-        }
-
-    if (fabs(alpha) > 0.0f)
-      alpha = deltaNew / alpha;
-	
-	float deltaOld = deltaNew;
-	deltaNew = 0.0f;
-
-	maxR = 0.0f;
-
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += twoxr)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
+		float alpha = sumSlices(_sliceSum, _zRes);
+
+		if (fabs(alpha) > 0.0f)
+			alpha = deltaNew / alpha;
+
+		float deltaOld = deltaNew;
+
+#if PARALLEL==1
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int z = 1; z < _zRes - 1; z++)
 		{
-          field[index] += alpha * _direction[index];
+			size_t index = (size_t)z * _slabSize + _xRes + 1;
+			float sum = 0.0f, max = 0.0f;
+
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+				{
+					field[index] += alpha * _direction[index];
+
+					_residual[index] -= alpha * _q[index];
+					max = (_residual[index] > max) ? _residual[index] : max;
 
-		  _residual[index] -= alpha * _q[index];
-          maxR = (_residual[index] > maxR) ? _residual[index] : maxR;
+					sum += _residual[index] * _residual[index];
+				}
 
-		  deltaNew += _residual[index] * _residual[index];
+			_sliceSum[z] = sum;
+			_sliceMax[z] = max;
 		}
 
-    float beta = deltaNew / deltaOld;
+		deltaNew = sumSlices(_sliceSum, _zRes);
+		maxR = maxSlices(_sliceMax, _zRes);
 
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += twoxr)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-         _direction[index] = _residual[index] + beta * _direction[index];
+		float beta = deltaNew / deltaOld;
 
-	
-    i++;
-  }
-  // cout << i << " iterations converged to " << maxR << endl;
+#if PARALLEL==1
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int z = 1; z < _zRes - 1; z++)
+		{
+			size_t index = (size_t)z * _slabSize + _xRes + 1;
+
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+					_direction[index] = _residual[index] + beta * _direction[index];
+		}
+
+		i++;
+	}
+	// cout << i << " iterations converged to " << maxR << endl;
 
 	if (_residual) delete[] _residual;
 	if (_direction) delete[] _direction;
 	if (_q)       delete[] _q;
 	if (_Acenter)  delete[] _Acenter;
+	delete[] _sliceSum;
+	delete[] _sliceMax;
 }
 
 void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 {
-	int x, y, z;
-	size_t index;
 	float *_q, *_Precond, *_h, *_residual, *_direction;
+	float *_sliceSum, *_sliceMax;
 
 	// i = 0
 	int i = 0;
@@ -179,6 +232,8 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 	_q            = new float[_totalCells]; // set 0
 	_h			  = new float[_totalCells]; // set 0
 	_Precond	  = new float[_totalCells]; // set 0
+	_sliceSum     = new float[_zRes];
+	_sliceMax     = new float[_zRes];
 
 	memset(_residual, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_q, 0, sizeof(float)*_xRes*_yRes*_zRes);
@@ -186,143 +241,173 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 	memset(_h, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_Precond, 0, sizeof(float)*_xRes*_yRes*_zRes);
 
-	float deltaNew = 0.0f;
-
 	// r = b - Ax
-	index = _slabSize + _xRes + 1;
-	for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-		for (y = 1; y < _yRes - 1; y++, index += 2)
-		  for (x = 1; x < _xRes - 1; x++, index++)
-		  {
-			// if the cell is a variable
-			float Acenter = 0.0f;
-			if (!skip[index])
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int z = 1; z < _zRes - 1; z++)
+	{
+		size_t index = (size_t)z * _slabSize + _xRes + 1;
+		float sum = 0.0f;
+
+		for (int y = 1; y < _yRes - 1; y++, index += 2)
+			for (int x = 1; x < _xRes - 1; x++, index++)
 			{
-			  // set the matrix to the Poisson stencil in order
-			  if (!skip[index + 1]) Acenter += 1.0f;
-			  if (!skip[index - 1]) Acenter += 1.0f;
-			  if (!skip[index + _xRes]) Acenter += 1.0f;
-			  if (!skip[index - _xRes]) Acenter += 1.0f;
-			  if (!skip[index + _slabSize]) Acenter += 1.0f;
-			  if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			  _residual[index] = b[index] - (Acenter * field[index] +  
-			  field[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
-			  field[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
-			  field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f)+
-			  field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
-			  field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f)+
-			  field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f) );
-			}
-			else
-			{
-			_residual[index] = 0.0f;
+				// if the cell is a variable
+				float Acenter = 0.0f;
+				if (!skip[index])
+				{
+					// set the matrix to the Poisson stencil in order
+					if (!skip[index + 1]) Acenter += 1.0f;
+					if (!skip[index - 1]) Acenter += 1.0f;
+					if (!skip[index + _xRes]) Acenter += 1.0f;
+					if (!skip[index - _xRes]) Acenter += 1.0f;
+					if (!skip[index + _slabSize]) Acenter += 1.0f;
+					if (!skip[index - _slabSize]) Acenter += 1.0f;
+
+					_residual[index] = b[index] - (Acenter * field[index] +
+					field[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
+					field[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
+					field[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f)+
+					field[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
+					field[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f)+
+					field[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f) );
+				}
+				else
+				{
+					_residual[index] = 0.0f;
+				}
+
+				// P^-1
+				if(Acenter < 1.0f)
+					_Precond[index] = 0.0;
+				else
+					_Precond[index] = 1.0f / Acenter;
+
+				// p = P^-1 * r
+				_direction[index] = _residual[index] * _Precond[index];
+
+				sum += _residual[index] * _direction[index];
 			}
 
-			// P^-1
-			if(Acenter < 1.0f)
-				_Precond[index] = 0.0;
-			else
-				_Precond[index] = 1.0f / Acenter;
-
-			// p = P^-1 * r
-			_direction[index] = _residual[index] * _Precond[index];
-
-			deltaNew += _residual[index] * _direction[index];
-		  }
-
-
-  // While deltaNew > (eps^2) * delta0
-  const float eps  = SOLVER_ACCURACY;
-  //while ((i < _iterations) && (deltaNew > eps*delta0))
-  float maxR = 2.0f * eps;
-  // while (i < _iterations)
-  while ((i < _iterations) && (maxR > 0.001f * eps))
-  {
-
-	float alpha = 0.0f;
-
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-        {
-          // if the cell is a variable
-          float Acenter = 0.0f;
-          if (!skip[index])
-          {
-            // set the matrix to the Poisson stencil in order
-            if (!skip[index + 1]) Acenter += 1.0f;
-            if (!skip[index - 1]) Acenter += 1.0f;
-            if (!skip[index + _xRes]) Acenter += 1.0f;
-            if (!skip[index - _xRes]) Acenter += 1.0f;
-            if (!skip[index + _slabSize]) Acenter += 1.0f;
-            if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			_q[index] = Acenter * _direction[index] +  
-            _direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
-            _direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
-            _direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
-            _direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
-            _direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f) +
-            _direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f);
-          }
-		  else
-		  {
-          _q[index] = 0.0f;
-		  }
-
-		  alpha += _direction[index] * _q[index];
-        }
-
-
-    if (fabs(alpha) > 0.0f)
-      alpha = deltaNew / alpha;
-
-	float deltaOld = deltaNew;
-	deltaNew = 0.0f;
-
-	maxR = 0.0;
-
-	float tmp;
-
-    // x = x + alpha * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
+		_sliceSum[z] = sum;
+	}
+
+	float deltaNew = sumSlices(_sliceSum, _zRes);
+
+	// While deltaNew > (eps^2) * delta0
+	const float eps  = SOLVER_ACCURACY;
+	//while ((i < _iterations) && (deltaNew > eps*delta0))
+	float maxR = 2.0f * eps;
+	// while (i < _iterations)
+	while ((i < _iterations) && (maxR > 0.001f * eps))
+	{
+		// q = Ad
+#if PARALLEL==1
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int z = 1; z < _zRes - 1; z++)
 		{
-          field[index] += alpha * _direction[index];
+			size_t index = (size_t)z * _slabSize + _xRes + 1;
+			float sum = 0.0f;
+
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+				{
+					// if the cell is a variable
+					float Acenter = 0.0f;
+					if (!skip[index])
+					{
+						// set the matrix to the Poisson stencil in order
+						if (!skip[index + 1]) Acenter += 1.0f;
+						if (!skip[index - 1]) Acenter += 1.0f;
+						if (!skip[index + _xRes]) Acenter += 1.0f;
+						if (!skip[index - _xRes]) Acenter += 1.0f;
+						if (!skip[index + _slabSize]) Acenter += 1.0f;
+						if (!skip[index - _slabSize]) Acenter += 1.0f;
+
+						_q[index] = Acenter * _direction[index] +
+						_direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
+						_direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
+						_direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
+						_direction[index + _xRes] * (skip[index + _xRes] ? 0.0f : -1.0f)+
+						_direction[index - _slabSize] * (skip[index - _slabSize] ? 0.0f : -1.0f) +
+						_direction[index + _slabSize] * (skip[index + _slabSize] ? 0.0f : -1.0f);
+					}
+					else
+					{
+						_q[index] = 0.0f;
+					}
+
+					sum += _direction[index] * _q[index];
+				}
+
+			_sliceSum[z] = sum;
+		}
 
-		  _residual[index] -= alpha * _q[index];
+		float alpha = sumSlices(_sliceSum, _zRes);
 
-		  _h[index] = _Precond[index] * _residual[index];
+		if (fabs(alpha) > 0.0f)
+			alpha = deltaNew / alpha;
 
-		  tmp = _residual[index] * _h[index];
-		  deltaNew += tmp;
-		  maxR = (tmp > maxR) ? tmp : maxR;
+		float deltaOld = deltaNew;
 
+		// x = x + alpha * d
+#if PARALLEL==1
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int z = 1; z < _zRes - 1; z++)
+		{
+			size_t index = (size_t)z * _slabSize + _xRes + 1;
+			float sum = 0.0f, max = 0.0f;
+
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+				{
+					field[index] += alpha * _direction[index];
+
+					_residual[index] -= alpha * _q[index];
+
+					_h[index] = _Precond[index] * _residual[index];
+
+					float tmp = _residual[index] * _h[index];
+					sum += tmp;
+					max = (tmp > max) ? tmp : max;
+				}
+
+			_sliceSum[z] = sum;
+			_sliceMax[z] = max;
 		}
 
+		deltaNew = sumSlices(_sliceSum, _zRes);
+		maxR = maxSlices(_sliceMax, _zRes);
+
+		// beta = deltaNew / deltaOld
+		float beta = deltaNew / deltaOld;
 
-    // beta = deltaNew / deltaOld
-    float beta = deltaNew / deltaOld;
+		// d = h + beta * d
+#if PARALLEL==1
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int z = 1; z < _zRes - 1; z++)
+		{
+			size_t index = (size_t)z * _slabSize + _xRes + 1;
 
-    // d = h + beta * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
-          _direction[index] = _h[index] + beta * _direction[index];
+			for (int y = 1; y < _yRes - 1; y++, index += 2)
+				for (int x = 1; x < _xRes - 1; x++, index++)
+					_direction[index] = _h[index] + beta * _direction[index];
+		}
 
-    // i = i + 1
-    i++;
-  }
-  // cout << i << " iterations converged to " << sqrt(maxR) << endl;
+		// i = i + 1
+		i++;
+	}
+	// cout << i << " iterations converged to " << sqrt(maxR) << endl;
 
 	if (_h) delete[] _h;
 	if (_Precond) delete[] _Precond;
 	if (_residual) delete[] _residual;
 	if (_direction) delete[] _direction;
 	if (_q)       delete[] _q;
+	delete[] _sliceSum;
+	delete[] _sliceMax;
 }
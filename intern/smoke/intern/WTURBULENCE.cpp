@@ -886,13 +886,17 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
     const int id  = omp_get_thread_num(); /*, num = omp_get_num_threads(); */
 #endif
 
-  // vector noise main loop
+  // vector noise main loop, in tiles of one row of coarse cells so
+  // there is enough work to balance over many threads even for
+  // coarse grids with few slices
+  const int totalTiles = _zResSm * _yResSm;
 #if PARALLEL==1
-#pragma omp for schedule(static,1)
+#pragma omp for schedule(dynamic,1)
 #endif
-  for (int zSmall = 0; zSmall < _zResSm; zSmall++)
+  for (int tile = 0; tile < totalTiles; tile++)
   {
-  for (int ySmall = 0; ySmall < _yResSm; ySmall++) 
+  const int zSmall = tile / _yResSm;
+  const int ySmall = tile % _yResSm;
   for (int xSmall = 0; xSmall < _xResSm; xSmall++)
   {
     const int indexSmall = xSmall + ySmall * _xResSm + zSmall * _slabSizeSm;
@@ -272,6 +272,9 @@ class PHYSICS_PT_cloth_object_collision(PhysicButtonsPanel, Panel):
         col = flow.column()
         col.prop(cloth, "impulse_clamp")
 
+        col = flow.column()
+        col.prop(cloth, "use_continuous_collision")
+
         col = flow.column()
         col.prop(cloth, "collection")
 
@@ -512,6 +512,7 @@ class NODE_PT_quality(bpy.types.Panel):
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
         col.prop(tree, "chunk_size")
+        col.prop(tree, "cache_size")
 
         col = layout.column()
         col.prop(tree, "use_opencl")
@@ -449,9 +449,9 @@ class USERPREF_PT_system_general(Panel):
         column.separator()
 
         column.label(text="Sequencer/Clip Editor:")
-        # currently disabled in the code
-        # column.prop(system, "prefetch_frames")
+        column.prop(system, "prefetch_frames")
         column.prop(system, "memory_cache_limit")
+        column.prop(system, "sequencer_disk_cache_limit", text="Disk Cache Limit")
 
         column.separator()
 
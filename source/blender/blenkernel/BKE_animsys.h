@@ -220,6 +220,8 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph, struct ID *id, int dri
 
 void BKE_animsys_update_driver_array(struct ID *id);
 
+void BKE_animsys_bindings_invalidate(void);
+
 /* ************************************* */
 
 #endif /* __BKE_ANIMSYS_H__*/
@@ -275,6 +275,13 @@ void BKE_pose_constraints_evaluate(
         struct Object *object,
         int pchan_index);
 
+void BKE_pose_eval_bone_batch(
+        struct Depsgraph *depsgraph,
+        struct Scene *scene,
+        struct Object *object,
+        const int *pchan_indices,
+        int num_pchans);
+
 void BKE_pose_bone_done(
         struct Depsgraph *depsgraph,
         struct Object *object,
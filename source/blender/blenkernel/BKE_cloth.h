@@ -189,6 +189,7 @@ typedef enum {
 typedef enum {
 	CLOTH_COLLSETTINGS_FLAG_ENABLED = ( 1 << 1 ), /* enables cloth - object collisions */
 	CLOTH_COLLSETTINGS_FLAG_SELF = ( 1 << 2 ), /* enables selfcollisions */
+	CLOTH_COLLSETTINGS_FLAG_CONTINUOUS = ( 1 << 3 ), /* detect collisions over the motion during a step */
 } CLOTH_COLLISIONSETTINGS_FLAGS;
 
 /* Spring types as defined in the paper.*/
@@ -213,6 +214,7 @@ typedef enum {
 ////////////////////////////////////////////////
 
 struct CollPair;
+struct ClothCollisionCache;
 
 typedef struct ColliderContacts {
 	struct Object *ob;
@@ -223,7 +225,10 @@ typedef struct ColliderContacts {
 } ColliderContacts;
 
 // needed for implicit.c
-int cloth_bvh_collision(struct Depsgraph *depsgraph, struct Object *ob, struct ClothModifierData *clmd, float step, float dt);
+struct ClothCollisionCache *cloth_collision_cache_create(struct Depsgraph *depsgraph, struct Object *ob, struct ClothModifierData *clmd);
+void cloth_collision_cache_free(struct ClothCollisionCache *cache);
+int cloth_bvh_collision(struct Depsgraph *depsgraph, struct Object *ob, struct ClothModifierData *clmd,
+                        struct ClothCollisionCache *cache, float step, float dt);
 
 void cloth_find_point_contacts(struct Depsgraph *depsgraph, struct Object *ob, struct ClothModifierData *clmd, float step, float dt,
                                ColliderContacts **r_collider_contacts, int *r_totcolliders);
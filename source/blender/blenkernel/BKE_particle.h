@@ -43,6 +43,7 @@
 
 struct ParticleSystemModifierData;
 struct ParticleSystem;
+struct SPHGrid;
 struct ParticleKey;
 struct ParticleSettings;
 
@@ -95,6 +96,8 @@ typedef struct ParticleSimulationData {
 
 typedef struct SPHData {
 	ParticleSystem *psys[10];
+	/* neighbour search grids of psys, shared by duplicate systems */
+	struct SPHGrid *grid[10];
 	ParticleData *pa;
 	float mass;
 	struct EdgeHash *eh;
@@ -367,7 +370,7 @@ void psys_apply_child_modifiers(struct ParticleThreadContext *ctx, struct ListBa
                                 struct ChildParticle *cpa, struct ParticleTexture *ptex, const float orco[3], float hairmat[4][4],
                                 struct ParticleCacheKey *keys, struct ParticleCacheKey *parent_keys, const float parent_orco[3]);
 
-void psys_sph_init(struct ParticleSimulationData *sim, struct SPHData *sphdata);
+void psys_sph_init(struct ParticleSimulationData *sim, struct SPHData *sphdata, float cfra);
 void psys_sph_finalise(struct SPHData *sphdata);
 void psys_sph_density(struct BVHTree *tree, struct SPHData *data, float co[3], float vars[2]);
 
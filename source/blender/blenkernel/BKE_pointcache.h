@@ -113,6 +113,10 @@ typedef struct PTCacheData {
 typedef struct PTCacheFile {
 	FILE *fp;
 
+	/* whole file contents when read through ptcache_file_open_mem, fp is NULL then */
+	unsigned char *mem;
+	size_t mem_size, mem_ofs;
+
 	int frame, old_format;
 	unsigned int totpoint, type;
 	unsigned int data_types, flag;
@@ -326,6 +330,9 @@ int  BKE_ptcache_mem_pointers_seek(int point_index, struct PTCacheMem *pm);
 /* Main cache reading call. */
 int     BKE_ptcache_read(PTCacheID *pid, float cfra, bool no_extrapolate_old);
 
+/* Stop loading disk cache frames in the background and free the loaded ones. */
+void    BKE_ptcache_read_ahead_free(void);
+
 /* Main cache writing call. */
 int     BKE_ptcache_write(PTCacheID *pid, unsigned int cfra);
 
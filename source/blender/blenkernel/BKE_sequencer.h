@@ -104,6 +104,8 @@ typedef struct SeqRenderData {
 	float motion_blur_shutter;
 	bool skip_cache;
 	bool is_proxy_render;
+	/* rendered ahead of playback on a prefetch thread */
+	bool is_prefetch_render;
 	int view_id;
 
 	/* special case for OpenGL render */
@@ -194,6 +196,9 @@ struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, flo
 struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
 void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
+void BKE_sequencer_prefetch_stop(void);
+void BKE_sequencer_prefetch_wait(void);
+void BKE_sequencer_prefetch_free(void);
 
 /* **********************************************************************
  * sequencer.c
@@ -250,6 +255,7 @@ bool BKE_sequencer_input_have_to_preprocess(const SeqRenderData *context, struct
 
 void BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Depsgraph *depsgraph, struct Scene *scene, struct Sequence *seq, struct GSet *file_list, ListBase *queue);
 void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context, short *stop, short *do_update, float *progress);
+void BKE_sequencer_proxy_rebuild_queue(ListBase *queue, short *stop, short *do_update, float *progress);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
 
 void BKE_sequencer_proxy_set(struct Sequence *seq, bool value);
@@ -263,9 +269,19 @@ typedef enum {
 	SEQ_STRIPELEM_IBUF,
 	SEQ_STRIPELEM_IBUF_COMP,
 	SEQ_STRIPELEM_IBUF_STARTSTILL,
-	SEQ_STRIPELEM_IBUF_ENDSTILL
+	SEQ_STRIPELEM_IBUF_ENDSTILL,
+	/* strip input before preprocessing (transform, color balance, modifiers...) */
+	SEQ_STRIPELEM_IBUF_RAW
 } eSeqStripElemIBuf;
 
+typedef struct SeqCacheStats {
+	int hits_memory;
+	int hits_disk;
+	int misses;
+	int disk_items;
+	size_t disk_size;
+} SeqCacheStats;
+
 void BKE_sequencer_cache_destruct(void);
 void BKE_sequencer_cache_cleanup(void);
 
@@ -275,17 +291,23 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, struct Seque
 /* passed ImBuf is properly refed, so ownership is *not*
  * transferred to the cache.
  * you can pass the same ImBuf multiple times to the cache without problems.
+ * cost is the time in seconds it took to render the image, images which are
+ * cheap to render again are freed first when the cache is full.
  */
 
-void BKE_sequencer_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type, struct ImBuf *nval);
+void BKE_sequencer_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type,
+                             struct ImBuf *nval, float cost);
 
+/* free everything but SEQ_STRIPELEM_IBUF_RAW images of the sequence */
 void BKE_sequencer_cache_cleanup_sequence(struct Sequence *seq);
 
-struct ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type);
-void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type, struct ImBuf *ibuf);
+/* free SEQ_STRIPELEM_IBUF_RAW images */
 void BKE_sequencer_preprocessed_cache_cleanup(void);
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(struct Sequence *seq);
 
+void BKE_sequencer_cache_stats_get(SeqCacheStats *r_stats);
+void BKE_sequencer_cache_stats_reset(void);
+
 /* **********************************************************************
  * seqeffects.c
  *
@@ -79,6 +79,7 @@ typedef enum eSubdivStatsValue {
 	SUBDIV_STATS_EVALUATOR_REFINE,
 	SUBDIV_STATS_SUBDIV_TO_CCG,
 	SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS,
+	SUBDIV_STATS_TOPOLOGY_COMPARE,
 
 	NUM_SUBDIV_STATS_VALUES,
 } eSubdivStatsValue;
@@ -103,6 +104,10 @@ typedef struct SubdivStats {
 			double subdiv_to_ccg_time;
 			/* Time spent on CCG elements evaluation/initialization. */
 			double subdiv_to_ccg_elements_time;
+			/* Time spent on comparing topology of the existing refiner with
+			 * the new input when trying to re-use the descriptor.
+			 */
+			double topology_compare_time;
 		};
 		double values_[NUM_SUBDIV_STATS_VALUES];
 	};
@@ -186,6 +191,11 @@ void BKE_subdiv_stats_end(SubdivStats *stats, eSubdivStatsValue value);
 
 void BKE_subdiv_stats_print(const SubdivStats *stats);
 
+/* ================================ SETTINGS ================================ */
+
+bool BKE_subdiv_settings_equal(const SubdivSettings *settings_a,
+                               const SubdivSettings *settings_b);
+
 /* ============================== CONSTRUCTION ============================== */
 
 Subdiv *BKE_subdiv_new_from_converter(const SubdivSettings *settings,
@@ -194,6 +204,22 @@ Subdiv *BKE_subdiv_new_from_converter(const SubdivSettings *settings,
 Subdiv *BKE_subdiv_new_from_mesh(const SubdivSettings *settings,
                                  struct Mesh *mesh);
 
+/* Similar to above, but will not re-create descriptor if it was created for
+ * the same settings and topology.
+ * If settings or topology did change, the existing descriptor is freed and a
+ * new one is created.
+ *
+ * NOTE: It is allowed to pass NULL as an existing subdivision surface
+ * descriptor. This will create new descriptor without any extra checks.
+ */
+Subdiv *BKE_subdiv_update_from_converter(
+        Subdiv *subdiv,
+        const SubdivSettings *settings,
+        struct OpenSubdiv_Converter *converter);
+Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
+                                    const SubdivSettings *settings,
+                                    struct Mesh *mesh);
+
 void BKE_subdiv_free(Subdiv *subdiv);
 
 /* ============================ DISPLACEMENT API ============================ */
@@ -44,6 +44,7 @@
 #include "BLI_dynstr.h"
 #include "BLI_listbase.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -254,6 +255,9 @@ void BKE_animdata_free(ID *id, const bool do_id_user)
 			/* free driver array cache */
 			MEM_SAFE_FREE(adt->driver_array);
 
+			/* free pre-resolved action bindings */
+			MEM_SAFE_FREE(adt->binding_cache);
+
 			/* free overrides */
 			/* TODO... */
 
@@ -300,6 +304,7 @@ AnimData *BKE_animdata_copy(Main *bmain, AnimData *adt, const int flag)
 	/* duplicate drivers (F-Curves) */
 	copy_fcurves(&dadt->drivers, &adt->drivers);
 	dadt->driver_array = NULL;
+	dadt->binding_cache = NULL;
 
 	/* don't copy overrides */
 	BLI_listbase_clear(&dadt->overrides);
@@ -1695,32 +1700,214 @@ static void animsys_write_orig_anim_rna(
 	}
 }
 
+/* Pre-resolved RNA bindings -------------------------- */
+
+/* Resolving the RNA path of every F-Curve on every frame is a large part of the cost of playing
+ * back animation. The evaluated copy of an ID keeps the resolved properties of its active action
+ * in AnimData.binding_cache, so the paths are only parsed again after data got reallocated.
+ *
+ * Bindings stay valid as long as the evaluated ID and its action are not copied again and no pose
+ * channels are rebuilt. All of those bump the global generation, see BKE_animsys_bindings_invalidate.
+ * Drivers are not bound: they are evaluated from several threads at once for the same ID.
+ *
+ * Properties of the original ID are not bound. They can be freed without any depsgraph update
+ * (ID properties replaced or removed from Python), so values are written back to the original
+ * ID resolving the path every time, see animsys_write_orig_anim_rna. */
+
+enum {
+	ANIM_BINDING_UNRESOLVED = 0,
+	ANIM_BINDING_RESOLVED   = 1,
+	ANIM_BINDING_INVALID    = 2,
+};
+
+typedef struct AnimBinding {
+	FCurve *fcu;                    /* F-Curve the binding belongs to */
+	PathResolvedRNA anim_rna;       /* property on the evaluated ID */
+	int state;
+	int pad;
+} AnimBinding;
+
+typedef struct AnimBindingCache {
+	bAction *action;          /* action the bindings were resolved for */
+	unsigned int generation;  /* value of animsys_binding_generation at the time of resolving */
+	int tot_bindings;         /* one binding per F-Curve of the action, in list order */
+	AnimBinding bindings[];
+} AnimBindingCache;
+
+static unsigned int animsys_binding_generation = 1;
+
+/* Forget all pre-resolved bindings, for when RNA data they may point to has been reallocated. */
+void BKE_animsys_bindings_invalidate(void)
+{
+	atomic_add_and_fetch_u(&animsys_binding_generation, 1);
+}
+
+/* Get bindings for the curves of the active action, (re)creating the cache when needed. */
+static AnimBindingCache *animsys_bindings_ensure(AnimData *adt, bAction *act)
+{
+	const unsigned int generation = atomic_add_and_fetch_u(&animsys_binding_generation, 0);
+	AnimBindingCache *cache = adt->binding_cache;
+
+	if (cache && (cache->action == act) && (cache->generation == generation)) {
+		return cache;
+	}
+
+	const int tot_bindings = BLI_listbase_count(&act->curves);
+	if (cache == NULL || cache->tot_bindings != tot_bindings) {
+		MEM_SAFE_FREE(adt->binding_cache);
+		cache = adt->binding_cache = MEM_mallocN(
+		        sizeof(AnimBindingCache) + sizeof(AnimBinding) * tot_bindings, "AnimBindingCache");
+		cache->tot_bindings = tot_bindings;
+	}
+	cache->action = act;
+	cache->generation = generation;
+	memset(cache->bindings, 0, sizeof(AnimBinding) * tot_bindings);
+
+	AnimBinding *binding = cache->bindings;
+	for (FCurve *fcu = act->curves.first; fcu; fcu = fcu->next, binding++) {
+		binding->fcu = fcu;
+	}
+
+	return cache;
+}
+
+/* Binding of the index-th F-Curve of the list. When the list doesn't match the cache anymore
+ * (curves added or removed without invalidating the bindings) the property is resolved without
+ * binding, and the cache is rebuilt on the next evaluation. */
+static AnimBinding *animsys_binding_get(AnimBindingCache *cache, int index, FCurve *fcu)
+{
+	if (cache == NULL) {
+		return NULL;
+	}
+	if (index < cache->tot_bindings && cache->bindings[index].fcu == fcu) {
+		return &cache->bindings[index];
+	}
+	cache->action = NULL;
+	return NULL;
+}
+
+/* Resolve the property of an F-Curve, using the binding when there is one. */
+static bool animsys_binding_resolve(
+        PointerRNA *ptr, FCurve *fcu, AnimBinding *binding, PathResolvedRNA *r_anim_rna)
+{
+	if (binding == NULL) {
+		return animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, r_anim_rna);
+	}
+	if (binding->state == ANIM_BINDING_UNRESOLVED) {
+		binding->state = animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &binding->anim_rna) ?
+		                 ANIM_BINDING_RESOLVED : ANIM_BINDING_INVALID;
+	}
+	if (binding->state == ANIM_BINDING_INVALID) {
+		return false;
+	}
+	*r_anim_rna = binding->anim_rna;
+	return true;
+}
+
+/* Lists with at least this many F-Curves are evaluated in a batch, see animsys_evaluate_fcurves. */
+#define ANIMSYS_FCURVES_BATCH_MIN 256
+
+typedef struct AnimsysFCurveEval {
+	FCurve *fcu;
+	PathResolvedRNA anim_rna;
+	float value;
+} AnimsysFCurveEval;
+
+typedef struct AnimsysFCurveBatchData {
+	AnimsysFCurveEval *evals;
+	float ctime;
+} AnimsysFCurveBatchData;
+
+static void animsys_evaluate_fcurve_batch_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	AnimsysFCurveBatchData *data = userdata;
+	AnimsysFCurveEval *eval = &data->evals[i];
+
+	eval->value = calculate_fcurve(&eval->anim_rna, eval->fcu, data->ctime);
+}
+
+static bool animsys_fcurve_is_evaluated(FCurve *fcu)
+{
+	/* Check if this F-Curve doesn't belong to a muted group. */
+	if ((fcu->grp != NULL) && (fcu->grp->flag & AGRP_MUTED)) {
+		return false;
+	}
+	/* Check if this curve should be skipped. */
+	if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED))) {
+		return false;
+	}
+	return true;
+}
+
 /* Evaluate all the F-Curves in the given list
  * This performs a set of standard checks. If extra checks are required, separate code should be used
+ * \param bindings: optional pre-resolved properties of the F-Curves in the list.
  */
-static void animsys_evaluate_fcurves(
-        Depsgraph *depsgraph, PointerRNA *ptr, ListBase *list, float ctime)
+static void animsys_evaluate_fcurves_ex(
+        Depsgraph *depsgraph, PointerRNA *ptr, ListBase *list, AnimBindingCache *bindings, float ctime)
 {
 	const bool is_active_depsgraph = DEG_is_active(depsgraph);
-	/* Calculate then execute each curve. */
-	for (FCurve *fcu = list->first; fcu; fcu = fcu->next) {
-		/* Check if this F-Curve doesn't belong to a muted group. */
-		if ((fcu->grp != NULL) && (fcu->grp->flag & AGRP_MUTED)) {
-			continue;
+	const int tot_fcurves = BLI_listbase_count_at_most(list, ANIMSYS_FCURVES_BATCH_MIN);
+	int index = 0;
+
+	if (tot_fcurves < ANIMSYS_FCURVES_BATCH_MIN) {
+		/* Calculate then execute each curve. */
+		for (FCurve *fcu = list->first; fcu; fcu = fcu->next, index++) {
+			if (!animsys_fcurve_is_evaluated(fcu)) {
+				continue;
+			}
+			PathResolvedRNA anim_rna;
+			if (animsys_binding_resolve(ptr, fcu, animsys_binding_get(bindings, index, fcu), &anim_rna)) {
+				const float curval = calculate_fcurve(&anim_rna, fcu, ctime);
+				animsys_write_rna_setting(&anim_rna, curval);
+				if (is_active_depsgraph) {
+					animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
+				}
+			}
 		}
-		/* Check if this curve should be skipped. */
-		if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED))) {
+		return;
+	}
+
+	/* Large actions (crowds, big rigs) are done in three passes: resolve all paths, calculate all
+	 * curves on multiple threads, then write the values in the original order. */
+	AnimsysFCurveEval *evals = MEM_mallocN(sizeof(*evals) * BLI_listbase_count(list), __func__);
+	int tot_evals = 0;
+
+	for (FCurve *fcu = list->first; fcu; fcu = fcu->next, index++) {
+		if (!animsys_fcurve_is_evaluated(fcu)) {
 			continue;
 		}
-		PathResolvedRNA anim_rna;
-		if (animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
-			const float curval = calculate_fcurve(&anim_rna, fcu, ctime);
-			animsys_write_rna_setting(&anim_rna, curval);
-			if (is_active_depsgraph) {
-				animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
-			}
+		AnimsysFCurveEval *eval = &evals[tot_evals];
+		if (animsys_binding_resolve(ptr, fcu, animsys_binding_get(bindings, index, fcu), &eval->anim_rna)) {
+			eval->fcu = fcu;
+			tot_evals++;
 		}
 	}
+
+	AnimsysFCurveBatchData data = {evals, ctime};
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 64;
+	BLI_task_parallel_range(0, tot_evals, &data, animsys_evaluate_fcurve_batch_cb, &settings);
+
+	for (int i = 0; i < tot_evals; i++) {
+		AnimsysFCurveEval *eval = &evals[i];
+		animsys_write_rna_setting(&eval->anim_rna, eval->value);
+		if (is_active_depsgraph) {
+			animsys_write_orig_anim_rna(ptr, eval->fcu->rna_path, eval->fcu->array_index, eval->value);
+		}
+	}
+
+	MEM_freeN(evals);
+}
+
+static void animsys_evaluate_fcurves(
+        Depsgraph *depsgraph, PointerRNA *ptr, ListBase *list, float ctime)
+{
+	animsys_evaluate_fcurves_ex(depsgraph, ptr, list, NULL, ctime);
 }
 
 /* ***************************************** */
@@ -1845,6 +2032,18 @@ void animsys_evaluate_action(Depsgraph *depsgraph, PointerRNA *ptr, bAction *act
 	animsys_evaluate_action_ex(depsgraph, ptr, act, ctime);
 }
 
+/* Evaluate the active action of an evaluated (copy-on-write) ID using its pre-resolved bindings */
+static void animsys_evaluate_action_bound(
+        Depsgraph *depsgraph, PointerRNA *ptr, AnimData *adt, float ctime)
+{
+	bAction *act = adt->action;
+
+	action_idcode_patch_check(ptr->id.data, act);
+
+	AnimBindingCache *bindings = animsys_bindings_ensure(adt, act);
+	animsys_evaluate_fcurves_ex(depsgraph, ptr, &act->curves, bindings, ctime);
+}
+
 /* ***************************************** */
 /* NLA System - Evaluation */
 
@@ -2865,9 +3064,16 @@ void BKE_animsys_evaluate_animdata(Depsgraph *depsgraph, Scene *scene, ID *id, A
 			 */
 			animsys_calculate_nla(depsgraph, &id_ptr, adt, ctime);
 		}
-		/* evaluate Active Action only */
-		else if (adt->action)
-			animsys_evaluate_action_ex(depsgraph, &id_ptr, adt->action, ctime);
+		/* evaluate Active Action only
+		 * - evaluated copies are only animated by their own depsgraph, so they can keep the
+		 *   resolved properties around between frames
+		 */
+		else if (adt->action) {
+			if (id->tag & LIB_TAG_COPIED_ON_WRITE)
+				animsys_evaluate_action_bound(depsgraph, &id_ptr, adt, ctime);
+			else
+				animsys_evaluate_action_ex(depsgraph, &id_ptr, adt->action, ctime);
+		}
 
 		/* reset tag */
 		adt->recalc &= ~ADT_RECALC_ANIM;
@@ -702,17 +702,35 @@ void BKE_pose_constraints_evaluate(struct Depsgraph *depsgraph,
 	}
 }
 
-void BKE_pose_bone_done(struct Depsgraph *depsgraph,
-                        struct Object *object,
-                        int pchan_index)
+/* Evaluate a bone which has no constraints and is not part of any IK chain,
+ * parent is expected to be evaluated already. */
+static void pose_eval_bone_simple(struct Depsgraph *depsgraph,
+                                  Scene *scene,
+                                  Object *object,
+                                  const bArmature *armature,
+                                  bPoseChannel *pchan,
+                                  float ctime)
 {
-	const bArmature *armature = (bArmature *)object->data;
-	if (armature->edbo != NULL) {
-		return;
+	BLI_assert(pchan->constraints.first == NULL);
+	BLI_assert((pchan->flag & (POSE_IKTREE | POSE_IKSPLINE)) == 0);
+	if (armature->flag & ARM_RESTPOS) {
+		Bone *bone = pchan->bone;
+		if (bone) {
+			copy_m4_m4(pchan->pose_mat, bone->arm_mat);
+			copy_v3_v3(pchan->pose_head, bone->arm_head);
+			copy_v3_v3(pchan->pose_tail, bone->arm_tail);
+		}
 	}
-	bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_index);
+	else if ((pchan->flag & POSE_DONE) == 0) {
+		BKE_pose_where_is_bone(depsgraph, scene, object, pchan, ctime, 1);
+	}
+}
+
+static void pose_bone_done_ex(struct Depsgraph *depsgraph,
+                              const bArmature *armature,
+                              bPoseChannel *pchan)
+{
 	float imat[4][4];
-	DEG_debug_print_eval(depsgraph, __func__, pchan->name, pchan);
 	if (pchan->bone) {
 		invert_m4_m4(imat, pchan->bone->arm_mat);
 		mul_m4_m4m4(pchan->chan_mat, pchan->pose_mat, imat);
@@ -730,6 +748,46 @@ void BKE_pose_bone_done(struct Depsgraph *depsgraph,
 	}
 }
 
+void BKE_pose_bone_done(struct Depsgraph *depsgraph,
+                        struct Object *object,
+                        int pchan_index)
+{
+	const bArmature *armature = (bArmature *)object->data;
+	if (armature->edbo != NULL) {
+		return;
+	}
+	bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_index);
+	DEG_debug_print_eval(depsgraph, __func__, pchan->name, pchan);
+	pose_bone_done_ex(depsgraph, armature, pchan);
+}
+
+/* Evaluate a batch of unconstrained bones under a common root, which replaces
+ * the per-bone pose and done operations of all of them.
+ *
+ * Indices are ordered so that parents come before their children. */
+void BKE_pose_eval_bone_batch(struct Depsgraph *depsgraph,
+                              Scene *scene,
+                              Object *object,
+                              const int *pchan_indices,
+                              int num_pchans)
+{
+	const bArmature *armature = (bArmature *)object->data;
+	if (armature->edbo != NULL) {
+		return;
+	}
+	bPoseChannel *rootchan = pose_pchan_get_indexed(object, pchan_indices[0]);
+	DEG_debug_print_eval_subdata(
+	        depsgraph, __func__, object->id.name, object,
+	        "rootchan", rootchan->name, rootchan);
+	BLI_assert(object->type == OB_ARMATURE);
+	const float ctime = BKE_scene_frame_get(scene); /* not accurate... */
+	for (int i = 0; i < num_pchans; i++) {
+		bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_indices[i]);
+		pose_eval_bone_simple(depsgraph, scene, object, armature, pchan, ctime);
+		pose_bone_done_ex(depsgraph, armature, pchan);
+	}
+}
+
 void BKE_pose_eval_bbone_segments(struct Depsgraph *depsgraph,
                                   struct Object *object,
                                   int pchan_index)
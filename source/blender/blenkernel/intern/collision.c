@@ -72,6 +72,7 @@ typedef struct ColDetectData {
 	CollPair *collisions;
 	bool culling;
 	bool use_normal;
+	bool continuous;
 	bool collided;
 } ColDetectData;
 
@@ -86,10 +87,10 @@ typedef struct SelfColDetectData {
 Collision modifier code start
 ***********************************/
 
-/* step is limited from 0 (frame start position) to 1 (frame end position) */
-void collision_move_object(CollisionModifierData *collmd, float step, float prevstep)
+/* When swept, the positions at prevstep are stored in current_xnew and the bounding volumes
+ * enclose the whole motion from prevstep to step, for continuous collision detection. */
+static void collision_move_object_ex(CollisionModifierData *collmd, float step, float prevstep, bool swept)
 {
-	float oldx[3];
 	unsigned int i = 0;
 
 	/* the collider doesn't move this frame */
@@ -98,18 +99,37 @@ void collision_move_object(CollisionModifierData *collmd, float step, float prev
 			zero_v3(collmd->current_v[i].co);
 		}
 
+		if (swept) {
+			memcpy(collmd->current_xnew, collmd->current_x, sizeof(MVert) * collmd->mvert_num);
+		}
+
 		return;
 	}
 
 	for (i = 0; i < collmd->mvert_num; i++) {
+		float *oldx = collmd->current_xnew[i].co;
+
 		interp_v3_v3v3(oldx, collmd->x[i].co, collmd->xnew[i].co, prevstep);
 		interp_v3_v3v3(collmd->current_x[i].co, collmd->x[i].co, collmd->xnew[i].co, step);
 		sub_v3_v3v3(collmd->current_v[i].co, collmd->current_x[i].co, oldx);
 	}
 
-	bvhtree_update_from_mvert(
-	        collmd->bvhtree, collmd->current_x, NULL,
-	        collmd->tri, collmd->tri_num, false);
+	if (swept) {
+		bvhtree_update_from_mvert(
+		        collmd->bvhtree, collmd->current_xnew, collmd->current_x,
+		        collmd->tri, collmd->tri_num, true);
+	}
+	else {
+		bvhtree_update_from_mvert(
+		        collmd->bvhtree, collmd->current_x, NULL,
+		        collmd->tri, collmd->tri_num, false);
+	}
+}
+
+/* step is limited from 0 (frame start position) to 1 (frame end position) */
+void collision_move_object(CollisionModifierData *collmd, float step, float prevstep)
+{
+	collision_move_object_ex(collmd, step, prevstep, false);
 }
 
 BVHTree *bvhtree_build_from_mvert(
@@ -799,6 +819,68 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd, CollPair
 #  pragma GCC diagnostic pop
 #endif
 
+/* Find a cloth vertex that passed through the collider triangle during the step.
+ * Positions move linearly from a to a_new and from b to b_new, the plane crossing is searched
+ * with the signed distances at both ends. Returns the penetration depth at the end of the step,
+ * or -1 when no vertex passed through. */
+static float compute_collision_swept_point(const float a[3][3], const float a_new[3][3],
+                                           const float b[3][3], const float b_new[3][3],
+                                           bool culling, float r_a[3], float r_b[3], float r_normal[3])
+{
+	float normal[3], normal_new[3];
+	float depth = -1.0f;
+
+	if (normal_tri_v3(normal, b[0], b[1], b[2]) < FLT_EPSILON ||
+	    normal_tri_v3(normal_new, b_new[0], b_new[1], b_new[2]) < FLT_EPSILON)
+	{
+		return -1.0f;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		float tmp[3], co[3], tri[3][3];
+		float d, d_new;
+
+		sub_v3_v3v3(tmp, a[i], b[0]);
+		d = dot_v3v3(normal, tmp);
+		sub_v3_v3v3(tmp, a_new[i], b_new[0]);
+		d_new = dot_v3v3(normal_new, tmp);
+
+		/* Only a change of side counts, contacts that stay on one side are found statically. */
+		if ((d > 0.0f) == (d_new > 0.0f) || (culling && d < 0.0f)) {
+			continue;
+		}
+
+		/* Check that the crossing point lies inside the triangle at that time. */
+		const float t = d / (d - d_new);
+
+		interp_v3_v3v3(co, a[i], a_new[i], t);
+		for (int j = 0; j < 3; j++) {
+			interp_v3_v3v3(tri[j], b[j], b_new[j], t);
+		}
+
+		if (!isect_point_tri_v3(co, tri[0], tri[1], tri[2], tmp)) {
+			continue;
+		}
+
+		if (fabsf(d_new) > depth) {
+			depth = fabsf(d_new);
+
+			copy_v3_v3(r_a, a_new[i]);
+			closest_on_tri_to_point_v3(r_b, a_new[i], b_new[0], b_new[1], b_new[2]);
+
+			/* Push back to the side the vertex came from. */
+			if (d > 0.0f) {
+				copy_v3_v3(r_normal, normal_new);
+			}
+			else {
+				negate_v3_v3(r_normal, normal_new);
+			}
+		}
+	}
+
+	return depth;
+}
+
 static void cloth_collision(
         void *__restrict userdata,
         const int index,
@@ -843,10 +925,44 @@ static void cloth_collision(
 		collpair[index].flag = 0;
 
 		data->collided = true;
+		return;
 	}
-	else {
-		collpair[index].flag = COLLISION_INACTIVE;
+
+	if (data->continuous) {
+		const MVert *b_old = collmd->current_xnew, *b_new = collmd->current_x;
+		float a[3][3], a_new[3][3], b[3][3], b_new_co[3][3];
+
+		for (int i = 0; i < 3; i++) {
+			copy_v3_v3(a[i], verts1[tri_a->tri[i]].txold);
+			copy_v3_v3(a_new[i], verts1[tri_a->tri[i]].tx);
+			copy_v3_v3(b[i], b_old[tri_b->tri[i]].co);
+			copy_v3_v3(b_new_co[i], b_new[tri_b->tri[i]].co);
+		}
+
+		if (compute_collision_swept_point(a, a_new, b, b_new_co, data->culling, pa, pb, vect) >= 0.0f) {
+			collpair[index].ap1 = tri_a->tri[0];
+			collpair[index].ap2 = tri_a->tri[1];
+			collpair[index].ap3 = tri_a->tri[2];
+
+			collpair[index].bp1 = tri_b->tri[0];
+			collpair[index].bp2 = tri_b->tri[1];
+			collpair[index].bp3 = tri_b->tri[2];
+
+			copy_v3_v3(collpair[index].pa, pa);
+			copy_v3_v3(collpair[index].pb, pb);
+			copy_v3_v3(collpair[index].vector, vect);
+			copy_v3_v3(collpair[index].normal, vect);
+
+			/* Treated like intersecting triangles. */
+			collpair[index].distance = 0.0f;
+			collpair[index].flag = 0;
+
+			data->collided = true;
+			return;
+		}
 	}
+
+	collpair[index].flag = COLLISION_INACTIVE;
 }
 
 static void cloth_selfcollision(
@@ -1058,18 +1174,102 @@ void BKE_collider_cache_free(ListBase **colliders)
 	}
 }
 
-static bool cloth_bvh_objcollisions_nearcheck(ClothModifierData * clmd, CollisionModifierData *collmd,
-                                              CollPair **collisions, int numresult,
-                                              BVHTreeOverlap *overlap, bool culling, bool use_normal)
+/* Collision state of one cloth simulation step, kept over all its substeps. */
+typedef struct ClothCollisionCache {
+	Object **collobjs;
+	CollisionModifierData **collmds;
+	unsigned int numcollobj;
+
+	/* Per collider, results of the broadphase of the current substep. */
+	BVHTreeOverlap **overlap;
+	uint *overlap_num;
+
+	/* Per collider, contact buffers that are only reallocated when they grow. */
+	CollPair **collisions;
+	uint *collisions_len;
+
+	BVHTree *cloth_bvh;
+	bool continuous;
+} ClothCollisionCache;
+
+ClothCollisionCache *cloth_collision_cache_create(Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd)
 {
-	*collisions = (CollPair *)MEM_mallocN(sizeof(CollPair) * numresult, "collision array");
+	ClothCollisionCache *cache = MEM_callocN(sizeof(*cache), "ClothCollisionCache");
 
+	if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) {
+		cache->collobjs = BKE_collision_objects_create(depsgraph, ob, clmd->coll_parms->group, &cache->numcollobj, eModifierType_Collision);
+	}
+
+	if (cache->collobjs) {
+		cache->collmds = MEM_mallocN(sizeof(*cache->collmds) * cache->numcollobj, "ClothCollisionCache collmds");
+		cache->overlap = MEM_callocN(sizeof(*cache->overlap) * cache->numcollobj, "ClothCollisionCache overlap");
+		cache->overlap_num = MEM_callocN(sizeof(*cache->overlap_num) * cache->numcollobj, "ClothCollisionCache overlap_num");
+		cache->collisions = MEM_callocN(sizeof(*cache->collisions) * cache->numcollobj, "ClothCollisionCache collisions");
+		cache->collisions_len = MEM_callocN(sizeof(*cache->collisions_len) * cache->numcollobj, "ClothCollisionCache collisions_len");
+
+		for (uint i = 0; i < cache->numcollobj; i++) {
+			cache->collmds[i] = (CollisionModifierData *)modifiers_findByType(cache->collobjs[i], eModifierType_Collision);
+		}
+	}
+
+	return cache;
+}
+
+static void cloth_collision_cache_clear_overlap(ClothCollisionCache *cache)
+{
+	for (uint i = 0; i < cache->numcollobj; i++) {
+		MEM_SAFE_FREE(cache->overlap[i]);
+		cache->overlap_num[i] = 0;
+	}
+}
+
+void cloth_collision_cache_free(ClothCollisionCache *cache)
+{
+	if (cache->collobjs) {
+		cloth_collision_cache_clear_overlap(cache);
+
+		for (uint i = 0; i < cache->numcollobj; i++) {
+			MEM_SAFE_FREE(cache->collisions[i]);
+		}
+
+		MEM_freeN(cache->collmds);
+		MEM_freeN(cache->overlap);
+		MEM_freeN(cache->overlap_num);
+		MEM_freeN(cache->collisions);
+		MEM_freeN(cache->collisions_len);
+
+		BKE_collision_objects_free(cache->collobjs);
+	}
+
+	MEM_freeN(cache);
+}
+
+static void cloth_collision_broadphase(
+        void *__restrict userdata,
+        const int index,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ClothCollisionCache *cache = userdata;
+	CollisionModifierData *collmd = cache->collmds[index];
+
+	if (!collmd->bvhtree) {
+		return;
+	}
+
+	cache->overlap[index] = BLI_bvhtree_overlap(cache->cloth_bvh, collmd->bvhtree, &cache->overlap_num[index], NULL, NULL);
+}
+
+static bool cloth_bvh_objcollisions_nearcheck(ClothModifierData * clmd, CollisionModifierData *collmd,
+                                              CollPair *collisions, int numresult,
+                                              BVHTreeOverlap *overlap, bool culling, bool use_normal, bool continuous)
+{
 	ColDetectData data = {.clmd = clmd,
 	                      .collmd = collmd,
 	                      .overlap = overlap,
-	                      .collisions = *collisions,
+	                      .collisions = collisions,
 	                      .culling = culling,
 	                      .use_normal = use_normal,
+	                      .continuous = continuous,
 	                      .collided = false};
 
 	ParallelRangeSettings settings;
@@ -1181,7 +1381,8 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData * clmd, CollPair *
 	return ret;
 }
 
-int cloth_bvh_collision(Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd, float step, float dt)
+int cloth_bvh_collision(Depsgraph *UNUSED(depsgraph), Object *UNUSED(ob), ClothModifierData *clmd, ClothCollisionCache *cache,
+                        float step, float dt)
 {
 	Cloth *cloth = clmd->clothObject;
 	BVHTree *cloth_bvh = cloth->bvhtree;
@@ -1189,12 +1390,13 @@ int cloth_bvh_collision(Depsgraph *depsgraph, Object *ob, ClothModifierData *clm
 	int rounds = 0;
 	ClothVertex *verts = NULL;
 	int ret = 0, ret2 = 0;
-	Object **collobjs = NULL;
-	unsigned int numcollobj = 0;
-	uint *coll_counts_obj = NULL;
-	BVHTreeOverlap **overlap_obj = NULL;
+	Object **collobjs = cache->collobjs;
+	unsigned int numcollobj = cache->numcollobj;
+	uint *coll_counts_obj = cache->overlap_num;
+	BVHTreeOverlap **overlap_obj = cache->overlap;
 	uint coll_count_self = 0;
 	BVHTreeOverlap *overlap_self = NULL;
+	const bool continuous = (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_CONTINUOUS) != 0;
 
 	if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_COLLOBJ) || cloth_bvh==NULL)
 		return 0;
@@ -1202,27 +1404,35 @@ int cloth_bvh_collision(Depsgraph *depsgraph, Object *ob, ClothModifierData *clm
 	verts = cloth->verts;
 	mvert_num = cloth->mvert_num;
 
-	if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) {
-		bvhtree_update_from_cloth(clmd, false, false);
+	if ((clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) && collobjs) {
+		/* In continuous mode bounding volumes enclose the motion during the substep. */
+		bvhtree_update_from_cloth(clmd, continuous, false);
 
-		collobjs = BKE_collision_objects_create(depsgraph, ob, clmd->coll_parms->group, &numcollobj, eModifierType_Collision);
+		for (i = 0; i < numcollobj; i++) {
+			CollisionModifierData *collmd = cache->collmds[i];
 
-		if (collobjs) {
-			coll_counts_obj = MEM_callocN(sizeof(uint) * numcollobj, "CollCounts");
-			overlap_obj = MEM_callocN(sizeof(*overlap_obj) * numcollobj, "BVHOverlap");
+			if (!collmd->bvhtree) {
+				continue;
+			}
 
-			for (i = 0; i < numcollobj; i++) {
-				Object *collob = collobjs[i];
-				CollisionModifierData *collmd = (CollisionModifierData *)modifiers_findByType(collob, eModifierType_Collision);
+			/* Move object to position (step) in time. */
+			collision_move_object_ex(collmd, step + dt, step, continuous);
+		}
 
-				if (!collmd->bvhtree) {
-					continue;
-				}
+		/* The cloth tree is shared by all colliders, query them in parallel. */
+		cache->cloth_bvh = cloth_bvh;
 
-				/* Move object to position (step) in time. */
-				collision_move_object(collmd, step + dt, step);
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = (numcollobj > 1);
+		BLI_task_parallel_range(0, numcollobj, cache, cloth_collision_broadphase, &settings);
 
-				overlap_obj[i] = BLI_bvhtree_overlap(cloth_bvh, collmd->bvhtree, &coll_counts_obj[i], NULL, NULL);
+		/* Grow the contact buffers, they are refilled every round. */
+		for (i = 0; i < numcollobj; i++) {
+			if (coll_counts_obj[i] > cache->collisions_len[i]) {
+				MEM_SAFE_FREE(cache->collisions[i]);
+				cache->collisions[i] = MEM_mallocN(sizeof(CollPair) * coll_counts_obj[i], "collision array");
+				cache->collisions_len[i] = coll_counts_obj[i];
 			}
 		}
 	}
@@ -1238,36 +1448,28 @@ int cloth_bvh_collision(Depsgraph *depsgraph, Object *ob, ClothModifierData *clm
 
 		/* Object collisions. */
 		if ((clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) && collobjs) {
-			CollPair **collisions;
 			bool collided = false;
 
-			collisions = MEM_callocN(sizeof(CollPair *) * numcollobj, "CollPair");
-
 			for (i = 0; i < numcollobj; i++) {
 				Object *collob = collobjs[i];
-				CollisionModifierData *collmd = (CollisionModifierData *)modifiers_findByType(collob, eModifierType_Collision);
+				CollisionModifierData *collmd = cache->collmds[i];
 
 				if (!collmd->bvhtree) {
 					continue;
 				}
 
 				if (coll_counts_obj[i] && overlap_obj[i]) {
-					collided = cloth_bvh_objcollisions_nearcheck(clmd, collmd, &collisions[i], coll_counts_obj[i], overlap_obj[i],
+					collided = cloth_bvh_objcollisions_nearcheck(clmd, collmd, cache->collisions[i], coll_counts_obj[i], overlap_obj[i],
 					                                             (collob->pd->flag & PFIELD_CLOTH_USE_CULLING),
-					                                             (collob->pd->flag & PFIELD_CLOTH_USE_NORMAL)) || collided;
+					                                             (collob->pd->flag & PFIELD_CLOTH_USE_NORMAL),
+					                                             continuous) || collided;
 				}
 			}
 
 			if (collided) {
-				ret += cloth_bvh_objcollisions_resolve(clmd, collobjs, collisions, coll_counts_obj, numcollobj, dt);
+				ret += cloth_bvh_objcollisions_resolve(clmd, collobjs, cache->collisions, coll_counts_obj, numcollobj, dt);
 				ret2 += ret;
 			}
-
-			for (i = 0; i < numcollobj; i++) {
-				MEM_SAFE_FREE(collisions[i]);
-			}
-
-			MEM_freeN(collisions);
 		}
 
 		/* Self collisions. */
@@ -1309,20 +1511,10 @@ int cloth_bvh_collision(Depsgraph *depsgraph, Object *ob, ClothModifierData *clm
 	}
 	while (ret2 && (clmd->coll_parms->loop_count > rounds));
 
-	if (overlap_obj) {
-		for (i = 0; i < numcollobj; i++) {
-			MEM_SAFE_FREE(overlap_obj[i]);
-		}
-
-		MEM_freeN(overlap_obj);
-	}
-
-	MEM_SAFE_FREE(coll_counts_obj);
+	cloth_collision_cache_clear_overlap(cache);
 
 	MEM_SAFE_FREE(overlap_self);
 
-	BKE_collision_objects_free(collobjs);
-
 	return MIN2(ret, 1);
 }
 
@@ -2304,6 +2304,60 @@ static void berekeny(float f1, float f2, float f3, float f4, float *o, int b)
 
 /* -------------------------- */
 
+/* Check whether keyframe index 'a' is what binarysearch_bezt_index_ex() returns for 'evaltime',
+ * which holds when keyframes are sorted (as they are outside of transform). */
+static bool fcurve_eval_segment_valid(const BezTriple *bezts, const int totvert, const int a,
+                                      const float evaltime, const float threshold, bool *r_exact)
+{
+	if ((a < 0) || (a >= totvert)) {
+		return false;
+	}
+
+	if (IS_EQT(evaltime, bezts[a].vec[1][0], threshold)) {
+		/* on top of keyframe 'a', only valid when no neighbor is close enough to match as well */
+		if ((a > 0 && IS_EQT(evaltime, bezts[a - 1].vec[1][0], threshold)) ||
+		    (a < totvert - 1 && IS_EQT(evaltime, bezts[a + 1].vec[1][0], threshold)))
+		{
+			return false;
+		}
+		*r_exact = true;
+		return true;
+	}
+
+	/* in between keyframes 'a - 1' and 'a' */
+	if ((a > 0) &&
+	    (bezts[a - 1].vec[1][0] < evaltime) && (evaltime < bezts[a].vec[1][0]) &&
+	    !IS_EQT(evaltime, bezts[a - 1].vec[1][0], threshold))
+	{
+		*r_exact = false;
+		return true;
+	}
+
+	return false;
+}
+
+/* Find the keyframe segment for 'evaltime', like binarysearch_bezt_index_ex().
+ * During playback the segment is usually the same as, or the one after, the previous evaluation,
+ * so those are checked before doing the binary search. */
+static int fcurve_eval_segment_find(FCurve *fcu, BezTriple *bezts, float evaltime, float threshold, bool *r_exact)
+{
+	const int hint = fcu->eval_segment;
+	int a;
+
+	if (fcurve_eval_segment_valid(bezts, fcu->totvert, hint, evaltime, threshold, r_exact)) {
+		return hint;
+	}
+	if (fcurve_eval_segment_valid(bezts, fcu->totvert, hint + 1, evaltime, threshold, r_exact)) {
+		a = hint + 1;
+	}
+	else {
+		a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, threshold, r_exact);
+	}
+
+	fcu->eval_segment = a;
+	return a;
+}
+
 /* Calculate F-Curve value for 'evaltime' using BezTriple keyframes */
 static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
 {
@@ -2436,7 +2490,7 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
 		 *    - 0.00001 is too fine     -> Weird errors, like selecting the wrong keyframe range (see T39207), occur.
 		 *                                 This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd
 		 */
-		a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+		a = fcurve_eval_segment_find(fcu, bezts, evaltime, 0.0001, &exact);
 		if (G.debug & G_DEBUG) printf("eval fcurve '%s' - %f => %u/%u, %d\n", fcu->rna_path, evaltime, a, fcu->totvert, exact);
 
 		if (exact) {
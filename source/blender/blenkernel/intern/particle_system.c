@@ -68,6 +68,8 @@
 #include "BLI_threads.h"
 #include "BLI_linklist.h"
 
+#include "atomic_ops.h"
+
 #include "BKE_animsys.h"
 #include "BKE_boids.h"
 #include "BKE_collision.h"
@@ -107,8 +109,6 @@
 
 #endif // WITH_MOD_FLUID
 
-static ThreadRWMutex psys_bvhtree_rwlock = BLI_RWLOCK_INITIALIZER;
-
 /************************************************/
 /*			Reacting to system events			*/
 /************************************************/
@@ -1240,43 +1240,6 @@ void psys_get_pointcache_start_end(Scene *scene, ParticleSystem *psys, int *sfra
 /************************************************/
 /*			Effectors							*/
 /************************************************/
-static void psys_update_particle_bvhtree(ParticleSystem *psys, float cfra)
-{
-	if (psys) {
-		PARTICLE_P;
-		int totpart = 0;
-		bool need_rebuild;
-
-		BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
-		need_rebuild = !psys->bvhtree || psys->bvhtree_frame != cfra;
-		BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
-
-		if (need_rebuild) {
-			LOOP_SHOWN_PARTICLES {
-				totpart++;
-			}
-
-			BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_WRITE);
-
-			BLI_bvhtree_free(psys->bvhtree);
-			psys->bvhtree = BLI_bvhtree_new(totpart, 0.0, 4, 6);
-
-			LOOP_SHOWN_PARTICLES {
-				if (pa->alive == PARS_ALIVE) {
-					if (pa->state.time == cfra)
-						BLI_bvhtree_insert(psys->bvhtree, p, pa->prev_state.co, 1);
-					else
-						BLI_bvhtree_insert(psys->bvhtree, p, pa->state.co, 1);
-				}
-			}
-			BLI_bvhtree_balance(psys->bvhtree);
-
-			psys->bvhtree_frame = cfra;
-
-			BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
-		}
-	}
-}
 void psys_update_particle_tree(ParticleSystem *psys, float cfra)
 {
 	if (psys) {
@@ -1555,6 +1518,218 @@ static EdgeHash *sph_springhash_build(ParticleSystem *psys)
 	return springhash;
 }
 
+/* Uniform grid for the neighbour queries. Cells are hashed into a table of buckets and
+ * the particles are sorted by bucket with a counting sort, so the particles of a bucket
+ * are contiguous. Their positions are stored in the same order as separate x, y and z
+ * arrays, so the distance tests don't have to touch the particle data. */
+typedef struct SPHGrid {
+	float inv_cell_size;
+	unsigned int bucket_mask;
+	/* particles of bucket b are [bucket_start[b], bucket_start[b + 1]) */
+	unsigned int *bucket_start;
+
+	/* per particle, in bucket order */
+	int tot;
+	int *index;
+	int (*cell)[3];
+	float *co[3];
+} SPHGrid;
+
+typedef struct SPHGridBuildData {
+	SPHGrid *grid;
+	ParticleSystem *psys;
+	float cfra;
+
+	unsigned int *bucket;  /* per particle, SPH_GRID_NO_BUCKET if not in the grid */
+	unsigned int *fill;    /* per bucket, counts and then write positions */
+} SPHGridBuildData;
+
+#define SPH_GRID_NO_BUCKET UINT_MAX
+#define SPH_GRID_MIN_ITER_PER_THREAD 1024
+
+BLI_INLINE void sph_grid_cell(const SPHGrid *grid, const float co[3], int r_cell[3])
+{
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		/* clamped so far away particles can't overflow, they share a cell then */
+		const float f = floorf(co[i] * grid->inv_cell_size);
+		r_cell[i] = (int)CLAMPIS(f, -1e9f, 1e9f);
+	}
+}
+
+BLI_INLINE unsigned int sph_grid_bucket(const SPHGrid *grid, const int cell[3])
+{
+	return (((unsigned int)cell[0] * 73856093u) ^
+	        ((unsigned int)cell[1] * 19349663u) ^
+	        ((unsigned int)cell[2] * 83492791u)) & grid->bucket_mask;
+}
+
+/* Position at the start of the step, already advanced systems have it in prev_state. */
+BLI_INLINE const float *sph_grid_particle_co(const ParticleData *pa, float cfra)
+{
+	return (pa->state.time == cfra) ? pa->prev_state.co : pa->state.co;
+}
+
+static void sph_grid_count_cb(
+        void *__restrict userdata,
+        const int p,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	SPHGridBuildData *data = userdata;
+	const ParticleData *pa = data->psys->particles + p;
+	int cell[3];
+
+	if ((pa->flag & (PARS_UNEXIST | PARS_NO_DISP)) || pa->alive != PARS_ALIVE) {
+		data->bucket[p] = SPH_GRID_NO_BUCKET;
+		return;
+	}
+
+	sph_grid_cell(data->grid, sph_grid_particle_co(pa, data->cfra), cell);
+	data->bucket[p] = sph_grid_bucket(data->grid, cell);
+	atomic_add_and_fetch_uint32(&data->fill[data->bucket[p]], 1);
+}
+
+static void sph_grid_scatter_cb(
+        void *__restrict userdata,
+        const int p,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	SPHGridBuildData *data = userdata;
+	const unsigned int b = data->bucket[p];
+
+	if (b != SPH_GRID_NO_BUCKET) {
+		data->grid->index[atomic_fetch_and_add_uint32(&data->fill[b], 1)] = p;
+	}
+}
+
+static void sph_grid_bucket_cb(
+        void *__restrict userdata,
+        const int b,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	SPHGridBuildData *data = userdata;
+	SPHGrid *grid = data->grid;
+	const int start = (int)grid->bucket_start[b], end = (int)grid->bucket_start[b + 1];
+	int i, j;
+
+	/* the scatter order depends on the threads, sort by index to keep the results
+	 * (and the neighbour order) deterministic, buckets only hold a few particles */
+	for (i = start + 1; i < end; i++) {
+		const int p = grid->index[i];
+
+		for (j = i; j > start && grid->index[j - 1] > p; j--) {
+			grid->index[j] = grid->index[j - 1];
+		}
+		grid->index[j] = p;
+	}
+
+	for (i = start; i < end; i++) {
+		const float *co = sph_grid_particle_co(data->psys->particles + grid->index[i], data->cfra);
+
+		sph_grid_cell(grid, co, grid->cell[i]);
+		grid->co[0][i] = co[0];
+		grid->co[1][i] = co[1];
+		grid->co[2][i] = co[2];
+	}
+}
+
+static SPHGrid *sph_grid_build(ParticleSystem *psys, float cell_size, float cfra)
+{
+	SPHGrid *grid = MEM_callocN(sizeof(SPHGrid), "SPHGrid");
+	SPHGridBuildData data = {.grid = grid, .psys = psys, .cfra = cfra};
+	ParallelRangeSettings settings;
+	const unsigned int tot_buckets = power_of_2_max_u(max_ii(2 * psys->totpart, 64));
+	unsigned int b, tot = 0;
+
+	grid->inv_cell_size = 1.0f / max_ff(cell_size, FLT_EPSILON);
+	grid->bucket_mask = tot_buckets - 1;
+	grid->bucket_start = MEM_mallocN(sizeof(*grid->bucket_start) * (tot_buckets + 1), "SPHGrid buckets");
+
+	data.bucket = MEM_mallocN(sizeof(*data.bucket) * max_ii(psys->totpart, 1), "SPHGrid particle buckets");
+	data.fill = MEM_callocN(sizeof(*data.fill) * tot_buckets, "SPHGrid bucket fill");
+
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = SPH_GRID_MIN_ITER_PER_THREAD;
+
+	BLI_task_parallel_range(0, psys->totpart, &data, sph_grid_count_cb, &settings);
+
+	for (b = 0; b < tot_buckets; b++) {
+		const unsigned int count = data.fill[b];
+
+		grid->bucket_start[b] = data.fill[b] = tot;
+		tot += count;
+	}
+	grid->bucket_start[tot_buckets] = tot;
+
+	grid->tot = (int)tot;
+	grid->index = MEM_mallocN(sizeof(*grid->index) * max_ii(grid->tot, 1), "SPHGrid index");
+	grid->cell = MEM_mallocN(sizeof(*grid->cell) * max_ii(grid->tot, 1), "SPHGrid cell");
+	for (b = 0; b < 3; b++) {
+		grid->co[b] = MEM_mallocN(sizeof(float) * max_ii(grid->tot, 1), "SPHGrid co");
+	}
+
+	BLI_task_parallel_range(0, psys->totpart, &data, sph_grid_scatter_cb, &settings);
+	BLI_task_parallel_range(0, (int)tot_buckets, &data, sph_grid_bucket_cb, &settings);
+
+	MEM_freeN(data.bucket);
+	MEM_freeN(data.fill);
+
+	return grid;
+}
+
+static void sph_grid_free(SPHGrid *grid)
+{
+	MEM_freeN(grid->bucket_start);
+	MEM_freeN(grid->index);
+	MEM_freeN(grid->cell);
+	MEM_freeN(grid->co[0]);
+	MEM_freeN(grid->co[1]);
+	MEM_freeN(grid->co[2]);
+	MEM_freeN(grid);
+}
+
+/* Same as BLI_bvhtree_range_query on a tree of the particles. */
+static void sph_grid_range_query(const SPHGrid *grid, const float co[3], float radius,
+                                 BVHTree_RangeQuery callback, void *userdata)
+{
+	const float radius_sq = radius * radius;
+	float co_min[3], co_max[3];
+	int cell_min[3], cell_max[3], cell[3];
+	unsigned int i;
+
+	for (i = 0; i < 3; i++) {
+		co_min[i] = co[i] - radius;
+		co_max[i] = co[i] + radius;
+	}
+	sph_grid_cell(grid, co_min, cell_min);
+	sph_grid_cell(grid, co_max, cell_max);
+
+	for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+		for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+			for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+				const unsigned int b = sph_grid_bucket(grid, cell);
+				const unsigned int end = grid->bucket_start[b + 1];
+
+				for (i = grid->bucket_start[b]; i < end; i++) {
+					float dist_sq;
+
+					/* other cells hashed to the same bucket */
+					if (grid->cell[i][0] != cell[0] || grid->cell[i][1] != cell[1] || grid->cell[i][2] != cell[2])
+						continue;
+
+					dist_sq = (pow2f(grid->co[0][i] - co[0]) +
+					           pow2f(grid->co[1][i] - co[1]) +
+					           pow2f(grid->co[2][i] - co[2]));
+
+					if (dist_sq < radius_sq)
+						callback(userdata, grid->index[i], co, dist_sq);
+				}
+			}
+		}
+	}
+}
+
 #define SPH_NEIGHBORS 512
 typedef struct SPHNeighbor {
 	ParticleSystem *psys;
@@ -1576,8 +1751,9 @@ typedef struct SPHRangeData {
 	int use_size;
 } SPHRangeData;
 
-static void sph_evaluate_func(BVHTree *tree, ParticleSystem **psys, float co[3], SPHRangeData *pfr, float interaction_radius, BVHTree_RangeQuery callback)
+static void sph_evaluate_func(BVHTree *tree, SPHData *sphdata, float co[3], SPHRangeData *pfr, float interaction_radius, BVHTree_RangeQuery callback)
 {
+	ParticleSystem **psys = sphdata->psys;
 	int i;
 
 	pfr->tot_neighbors = 0;
@@ -1592,11 +1768,7 @@ static void sph_evaluate_func(BVHTree *tree, ParticleSystem **psys, float co[3],
 			break;
 		}
 		else {
-			BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
-
-			BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
-
-			BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
+			sph_grid_range_query(sphdata->grid[i], co, interaction_radius, callback, pfr);
 		}
 	}
 }
@@ -1709,7 +1881,7 @@ static void sph_force_cb(void *sphdata_v, ParticleKey *state, float *force, floa
 	pfr.pa = pa;
 	pfr.mass = sphdata->mass;
 
-	sph_evaluate_func( NULL, psys, state->co, &pfr, interaction_radius, sph_density_accum_cb);
+	sph_evaluate_func(NULL, sphdata, state->co, &pfr, interaction_radius, sph_density_accum_cb);
 
 	density = data[0];
 	near_density = data[1];
@@ -1880,7 +2052,7 @@ static void sphclassical_force_cb(void *sphdata_v, ParticleKey *state, float *fo
 	pfr.h = h;
 	pfr.pa = pa;
 
-	sph_evaluate_func(NULL, psys, state->co, &pfr, interaction_radius, sphclassical_neighbour_accum_cb);
+	sph_evaluate_func(NULL, sphdata, state->co, &pfr, interaction_radius, sphclassical_neighbour_accum_cb);
 	pressure =  stiffness * (pow7f(pa->sphdensity / rest_density) - 1.0f);
 
 	/* multiply by mass so that we return a force, not accel */
@@ -1958,20 +2130,41 @@ static void sphclassical_calc_dens(ParticleData *pa, float UNUSED(dfra), SPHData
 	pfr.pa = pa;
 	pfr.mass = sphdata->mass;
 
-	sph_evaluate_func( NULL, psys, pa->state.co, &pfr, interaction_radius, sphclassical_density_accum_cb);
+	sph_evaluate_func(NULL, sphdata, pa->state.co, &pfr, interaction_radius, sphclassical_density_accum_cb);
 	pa->sphdensity = min_ff(max_ff(data[0], fluid->rest_density * 0.9f), fluid->rest_density * 1.1f);
 }
 
-void psys_sph_init(ParticleSimulationData *sim, SPHData *sphdata)
+void psys_sph_init(ParticleSimulationData *sim, SPHData *sphdata, float cfra)
 {
 	ParticleTarget *pt;
-	int i;
+	SPHFluidSettings *fluid = sim->psys->part->fluid;
+	float interaction_radius = fluid->radius * (fluid->flag & SPH_FAC_RADIUS ? 4.0f * sim->psys->part->size : 1.0f);
+	int i, j;
 
 	// Add other coupled particle systems.
 	sphdata->psys[0] = sim->psys;
 	for (i=1, pt=sim->psys->targets.first; i<10; i++, pt=(pt?pt->next:NULL))
 		sphdata->psys[i] = pt ? psys_get_target_system(sim->ob, pt) : NULL;
 
+	/* Neighbour grids, with cells the size of the interaction radius so a query
+	 * visits at most 3x3x3 cells. Systems that are targeted twice share a grid. */
+	for (i = 0; i < 10; i++) {
+		sphdata->grid[i] = NULL;
+
+		if (sphdata->psys[i] == NULL)
+			continue;
+
+		for (j = 0; j < i; j++) {
+			if (sphdata->psys[j] == sphdata->psys[i]) {
+				sphdata->grid[i] = sphdata->grid[j];
+				break;
+			}
+		}
+
+		if (sphdata->grid[i] == NULL)
+			sphdata->grid[i] = sph_grid_build(sphdata->psys[i], interaction_radius, cfra);
+	}
+
 	if (psys_uses_gravity(sim))
 		sphdata->gravity = sim->scene->physics_settings.gravity;
 	else
@@ -1999,10 +2192,25 @@ void psys_sph_init(ParticleSimulationData *sim, SPHData *sphdata)
 
 void psys_sph_finalise(SPHData *sphdata)
 {
+	int i, j;
+
 	if (sphdata->eh) {
 		BLI_edgehash_free(sphdata->eh, NULL);
 		sphdata->eh = NULL;
 	}
+
+	for (i = 0; i < 10; i++) {
+		if (sphdata->grid[i] == NULL)
+			continue;
+
+		for (j = i + 1; j < 10; j++) {
+			if (sphdata->grid[j] == sphdata->grid[i])
+				sphdata->grid[j] = NULL;
+		}
+
+		sph_grid_free(sphdata->grid[i]);
+		sphdata->grid[i] = NULL;
+	}
 }
 /* Sample the density field at a point in space. */
 void psys_sph_density(BVHTree *tree, SPHData *sphdata, float co[3], float vars[2])
@@ -2019,7 +2227,7 @@ void psys_sph_density(BVHTree *tree, SPHData *sphdata, float co[3], float vars[2
 	pfr.h = interaction_radius * sphdata->hfac;
 	pfr.mass = sphdata->mass;
 
-	sph_evaluate_func(tree, psys, co, &pfr, interaction_radius, sphdata->density_cb);
+	sph_evaluate_func(tree, sphdata, co, &pfr, interaction_radius, sphdata->density_cb);
 
 	vars[0] = pfr.data[0];
 	vars[1] = pfr.data[1];
@@ -3508,6 +3716,7 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 	ParticleSystem *psys = sim->psys;
 	ParticleSettings *part=psys->part;
 	BoidBrainData bbd;
+	SPHData sphdata;
 	ParticleTexture ptex;
 	PARTICLE_P;
 	float timestep;
@@ -3567,13 +3776,9 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 		}
 		case PART_PHYS_FLUID:
 		{
-			ParticleTarget *pt = psys->targets.first;
-			psys_update_particle_bvhtree(psys, cfra);
-
-			for (; pt; pt=pt->next) {  /* Updating others systems particle tree for fluid-fluid interaction */
-				if (pt->ob)
-					psys_update_particle_bvhtree(BLI_findlink(&pt->ob->particlesystem, pt->psys-1), cfra);
-			}
+			/* builds the neighbour grids of this and the target systems, before the
+			 * particles are initialized so they hold the positions at the start of the step */
+			psys_sph_init(sim, &sphdata, cfra);
 			break;
 		}
 	}
@@ -3655,9 +3860,6 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 		}
 		case PART_PHYS_FLUID:
 		{
-			SPHData sphdata;
-			psys_sph_init(sim, &sphdata);
-
 			DynamicStepSolverTaskData task_data = {
 			    .sim = sim, .cfra = cfra, .timestep = timestep, .dtime = dtime,
 			};
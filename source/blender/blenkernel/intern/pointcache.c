@@ -51,6 +51,7 @@
 #include "BLI_threads.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -145,6 +146,7 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
 static int ptcache_file_compressed_write(PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode);
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size);
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size);
+static void ptcache_read_ahead_drop_file(const char *filename);
 
 /* Common functions */
 static int ptcache_basic_header_read(PTCacheFile *pf)
@@ -152,10 +154,10 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
 	int error=0;
 
 	/* Custom functions should read these basic elements too! */
-	if (!error && !fread(&pf->totpoint, sizeof(unsigned int), 1, pf->fp))
+	if (!error && !ptcache_file_read(pf, &pf->totpoint, 1, sizeof(unsigned int)))
 		error = 1;
 
-	if (!error && !fread(&pf->data_types, sizeof(unsigned int), 1, pf->fp))
+	if (!error && !ptcache_file_read(pf, &pf->data_types, 1, sizeof(unsigned int)))
 		error = 1;
 
 	return !error;
@@ -577,7 +579,162 @@ static void ptcache_smoke_error(void *smoke_v, const char *message)
 	modifier_setError(&smd->modifier, "%s", message);
 }
 
-#define SMOKE_CACHE_VERSION "1.04"
+#define SMOKE_CACHE_VERSION "1.05"
+/* dense grids, read only */
+#define SMOKE_CACHE_VERSION_DENSE "1.04"
+
+/* Grids are stored as tiles of SMOKE_CACHE_TILE_SIZE^3 voxels, tiles without
+ * any non-zero byte are skipped. Each grid is written as a compressed tile
+ * mask followed by the compressed voxels of the occupied tiles. */
+#define SMOKE_CACHE_TILE_SIZE 8
+
+static int ptcache_smoke_tiles_res(const int res[3], int r_tiles_res[3])
+{
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		r_tiles_res[i] = (res[i] + SMOKE_CACHE_TILE_SIZE - 1) / SMOKE_CACHE_TILE_SIZE;
+	}
+
+	return r_tiles_res[0] * r_tiles_res[1] * r_tiles_res[2];
+}
+
+static void ptcache_smoke_tile_bounds(const int res[3], const int tile[3], int r_min[3], int r_max[3])
+{
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		r_min[i] = tile[i] * SMOKE_CACHE_TILE_SIZE;
+		r_max[i] = min_ii(r_min[i] + SMOKE_CACHE_TILE_SIZE, res[i]);
+	}
+}
+
+static bool ptcache_smoke_tile_is_empty(const unsigned char *data, size_t elem_size, const int res[3],
+                                        const int min[3], const int max[3])
+{
+	const size_t row_len = (size_t)(max[0] - min[0]) * elem_size;
+	int y, z;
+
+	for (z = min[2]; z < max[2]; z++) {
+		for (y = min[1]; y < max[1]; y++) {
+			const unsigned char *row = data + (((size_t)z * res[1] + y) * res[0] + min[0]) * elem_size;
+			size_t i;
+
+			for (i = 0; i < row_len; i++) {
+				if (row[i]) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+/* pack: scratch buffer the size of the grid, out: compression buffer for it */
+static void ptcache_smoke_sparse_write(PTCacheFile *pf, const void *data, size_t elem_size, const int res[3],
+                                       unsigned char *pack, unsigned char *out, int mode)
+{
+	int tiles_res[3], tile[3], min[3], max[3];
+	const int tot_tiles = ptcache_smoke_tiles_res(res, tiles_res);
+	unsigned char *mask = MEM_callocN(sizeof(unsigned char) * tot_tiles, "smoke cache tile mask");
+	unsigned int pack_len = 0;
+	int t = 0, y, z;
+
+	for (tile[2] = 0; tile[2] < tiles_res[2]; tile[2]++) {
+		for (tile[1] = 0; tile[1] < tiles_res[1]; tile[1]++) {
+			for (tile[0] = 0; tile[0] < tiles_res[0]; tile[0]++, t++) {
+				size_t row_len;
+
+				ptcache_smoke_tile_bounds(res, tile, min, max);
+				if (ptcache_smoke_tile_is_empty(data, elem_size, res, min, max)) {
+					continue;
+				}
+
+				mask[t] = 1;
+				row_len = (size_t)(max[0] - min[0]) * elem_size;
+
+				for (z = min[2]; z < max[2]; z++) {
+					for (y = min[1]; y < max[1]; y++) {
+						const unsigned char *row = (const unsigned char *)data +
+						                           (((size_t)z * res[1] + y) * res[0] + min[0]) * elem_size;
+						memcpy(pack + pack_len, row, row_len);
+						pack_len += (unsigned int)row_len;
+					}
+				}
+			}
+		}
+	}
+
+	ptcache_file_compressed_write(pf, mask, (unsigned int)tot_tiles, out, mode);
+	ptcache_file_write(pf, &pack_len, 1, sizeof(unsigned int));
+	if (pack_len) {
+		ptcache_file_compressed_write(pf, pack, pack_len, out, mode);
+	}
+
+	MEM_freeN(mask);
+}
+
+/* pack: scratch buffer the size of the grid */
+static int ptcache_smoke_sparse_read(PTCacheFile *pf, void *data, size_t elem_size, const int res[3],
+                                     unsigned char *pack)
+{
+	int tiles_res[3], tile[3], min[3], max[3];
+	const int tot_tiles = ptcache_smoke_tiles_res(res, tiles_res);
+	const size_t data_len = (size_t)res[0] * res[1] * res[2] * elem_size;
+	unsigned char *mask = MEM_callocN(sizeof(unsigned char) * tot_tiles, "smoke cache tile mask");
+	unsigned int pack_len = 0, pack_ofs = 0;
+	int t = 0, y, z;
+
+	memset(data, 0, data_len);
+
+	if (ptcache_file_compressed_read(pf, mask, (unsigned int)tot_tiles) != 0 ||
+	    !ptcache_file_read(pf, &pack_len, 1, sizeof(unsigned int)) ||
+	    pack_len > data_len)
+	{
+		MEM_freeN(mask);
+		return 0;
+	}
+	if (pack_len && ptcache_file_compressed_read(pf, pack, pack_len) != 0) {
+		MEM_freeN(mask);
+		return 0;
+	}
+
+	for (tile[2] = 0; tile[2] < tiles_res[2]; tile[2]++) {
+		for (tile[1] = 0; tile[1] < tiles_res[1]; tile[1]++) {
+			for (tile[0] = 0; tile[0] < tiles_res[0]; tile[0]++, t++) {
+				size_t row_len;
+
+				if (!mask[t]) {
+					continue;
+				}
+
+				ptcache_smoke_tile_bounds(res, tile, min, max);
+				row_len = (size_t)(max[0] - min[0]) * elem_size;
+
+				for (z = min[2]; z < max[2]; z++) {
+					for (y = min[1]; y < max[1]; y++) {
+						unsigned char *row = (unsigned char *)data +
+						                     (((size_t)z * res[1] + y) * res[0] + min[0]) * elem_size;
+
+						/* mask and voxels disagree, corrupt cache */
+						if (pack_ofs + row_len > pack_len) {
+							MEM_freeN(mask);
+							return 0;
+						}
+
+						memcpy(row, pack + pack_ofs, row_len);
+						pack_ofs += (unsigned int)row_len;
+					}
+				}
+			}
+		}
+	}
+
+	MEM_freeN(mask);
+
+	return 1;
+}
 
 static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 {
@@ -599,32 +756,33 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		unsigned char *obstacles;
 		unsigned int in_len = sizeof(float)*(unsigned int)res;
 		unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4, "pointcache_lzo_buffer");
+		unsigned char *pack = (unsigned char *)MEM_mallocN(in_len, "pointcache_smoke_tiles");
 		//int mode = res >= 1000000 ? 2 : 1;
 		int mode=1;		// light
 		if (sds->cache_comp == SM_CACHE_HEAVY) mode=2;	// heavy
 
 		smoke_export(sds->fluid, &dt, &dx, &dens, &react, &flame, &fuel, &heat, &heatold, &vx, &vy, &vz, &r, &g, &b, &obstacles);
 
-		ptcache_file_compressed_write(pf, (unsigned char *)sds->shadow, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len, out, mode);
+		ptcache_smoke_sparse_write(pf, sds->shadow, sizeof(float), sds->res, pack, out, mode);
+		ptcache_smoke_sparse_write(pf, dens, sizeof(float), sds->res, pack, out, mode);
 		if (fluid_fields & SM_ACTIVE_HEAT) {
-			ptcache_file_compressed_write(pf, (unsigned char *)heat, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)heatold, in_len, out, mode);
+			ptcache_smoke_sparse_write(pf, heat, sizeof(float), sds->res, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, heatold, sizeof(float), sds->res, pack, out, mode);
 		}
 		if (fluid_fields & SM_ACTIVE_FIRE) {
-			ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)react, in_len, out, mode);
+			ptcache_smoke_sparse_write(pf, flame, sizeof(float), sds->res, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, fuel, sizeof(float), sds->res, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, react, sizeof(float), sds->res, pack, out, mode);
 		}
 		if (fluid_fields & SM_ACTIVE_COLORS) {
-			ptcache_file_compressed_write(pf, (unsigned char *)r, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)g, in_len, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)b, in_len, out, mode);
-		}
-		ptcache_file_compressed_write(pf, (unsigned char *)vx, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)vy, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)vz, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)obstacles, (unsigned int)res, out, mode);
+			ptcache_smoke_sparse_write(pf, r, sizeof(float), sds->res, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, g, sizeof(float), sds->res, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, b, sizeof(float), sds->res, pack, out, mode);
+		}
+		ptcache_smoke_sparse_write(pf, vx, sizeof(float), sds->res, pack, out, mode);
+		ptcache_smoke_sparse_write(pf, vy, sizeof(float), sds->res, pack, out, mode);
+		ptcache_smoke_sparse_write(pf, vz, sizeof(float), sds->res, pack, out, mode);
+		ptcache_smoke_sparse_write(pf, obstacles, sizeof(unsigned char), sds->res, pack, out, mode);
 		ptcache_file_write(pf, &dt, 1, sizeof(float));
 		ptcache_file_write(pf, &dx, 1, sizeof(float));
 		ptcache_file_write(pf, &sds->p0, 3, sizeof(float));
@@ -639,6 +797,7 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		ptcache_file_write(pf, &sds->active_color, 3, sizeof(float));
 
 		MEM_freeN(out);
+		MEM_freeN(pack);
 
 		ret = 1;
 	}
@@ -650,7 +809,7 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		float *dens, *react, *fuel, *flame, *tcu, *tcv, *tcw, *r, *g, *b;
 		unsigned int in_len = sizeof(float)*(unsigned int)res;
 		unsigned int in_len_big;
-		unsigned char *out;
+		unsigned char *out, *pack;
 		int mode;
 
 		smoke_turbulence_get_res(sds->wt, res_big_array);
@@ -664,24 +823,26 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 		smoke_turbulence_export(sds->wt, &dens, &react, &flame, &fuel, &r, &g, &b, &tcu, &tcv, &tcw);
 
 		out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len_big), "pointcache_lzo_buffer");
-		ptcache_file_compressed_write(pf, (unsigned char *)dens, in_len_big, out, mode);
+		pack = (unsigned char *)MEM_mallocN(in_len_big, "pointcache_smoke_tiles");
+		ptcache_smoke_sparse_write(pf, dens, sizeof(float), res_big_array, pack, out, mode);
 		if (fluid_fields & SM_ACTIVE_FIRE) {
-			ptcache_file_compressed_write(pf, (unsigned char *)flame, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)fuel, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)react, in_len_big, out, mode);
+			ptcache_smoke_sparse_write(pf, flame, sizeof(float), res_big_array, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, fuel, sizeof(float), res_big_array, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, react, sizeof(float), res_big_array, pack, out, mode);
 		}
 		if (fluid_fields & SM_ACTIVE_COLORS) {
-			ptcache_file_compressed_write(pf, (unsigned char *)r, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)g, in_len_big, out, mode);
-			ptcache_file_compressed_write(pf, (unsigned char *)b, in_len_big, out, mode);
+			ptcache_smoke_sparse_write(pf, r, sizeof(float), res_big_array, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, g, sizeof(float), res_big_array, pack, out, mode);
+			ptcache_smoke_sparse_write(pf, b, sizeof(float), res_big_array, pack, out, mode);
 		}
 		MEM_freeN(out);
 
 		out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len), "pointcache_lzo_buffer");
-		ptcache_file_compressed_write(pf, (unsigned char *)tcu, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)tcv, in_len, out, mode);
-		ptcache_file_compressed_write(pf, (unsigned char *)tcw, in_len, out, mode);
+		ptcache_smoke_sparse_write(pf, tcu, sizeof(float), sds->res, pack, out, mode);
+		ptcache_smoke_sparse_write(pf, tcv, sizeof(float), sds->res, pack, out, mode);
+		ptcache_smoke_sparse_write(pf, tcw, sizeof(float), sds->res, pack, out, mode);
 		MEM_freeN(out);
+		MEM_freeN(pack);
 
 		ret = 1;
 	}
@@ -689,6 +850,19 @@ static int  ptcache_smoke_write(PTCacheFile *pf, void *smoke_v)
 	return ret;
 }
 
+/* pack: scratch buffer the size of the grid, only used for sparse caches
+ * \return false when the grid couldn't be read, the rest of the file can't be used then. */
+static bool ptcache_smoke_grid_read(PTCacheFile *pf, void *data, size_t elem_size, const int res[3],
+                                    unsigned char *pack, bool sparse)
+{
+	if (sparse) {
+		return ptcache_smoke_sparse_read(pf, data, elem_size, res, pack) != 0;
+	}
+	else {
+		return ptcache_file_compressed_read(pf, data, (unsigned int)((size_t)res[0] * res[1] * res[2] * elem_size)) == 0;
+	}
+}
+
 /* read old smoke cache from 2.64 */
 static int ptcache_smoke_read_old(PTCacheFile *pf, void *smoke_v)
 {
@@ -775,11 +949,18 @@ static int ptcache_smoke_read(PTCacheFile *pf, void *smoke_v)
 	int cache_fields = 0;
 	int active_fields = 0;
 	int reallocate = 0;
+	bool sparse;
+	bool ok = true;
 
 	/* version header */
 	ptcache_file_read(pf, version, 4, sizeof(char));
-	if (!STREQLEN(version, SMOKE_CACHE_VERSION, 4))
-	{
+	if (STREQLEN(version, SMOKE_CACHE_VERSION, 4)) {
+		sparse = true;
+	}
+	else if (STREQLEN(version, SMOKE_CACHE_VERSION_DENSE, 4)) {
+		sparse = false;
+	}
+	else {
 		/* reset file pointer */
 		fseek(pf->fp, -4, SEEK_CUR);
 		return ptcache_smoke_read_old(pf, smoke_v);
@@ -823,29 +1004,38 @@ static int ptcache_smoke_read(PTCacheFile *pf, void *smoke_v)
 		float dt, dx, *dens, *react, *fuel, *flame, *heat, *heatold, *vx, *vy, *vz, *r, *g, *b;
 		unsigned char *obstacles;
 		unsigned int out_len = (unsigned int)res * sizeof(float);
+		unsigned char *pack = sparse ? (unsigned char *)MEM_mallocN(out_len, "pointcache_smoke_tiles") : NULL;
 
 		smoke_export(sds->fluid, &dt, &dx, &dens, &react, &flame, &fuel, &heat, &heatold, &vx, &vy, &vz, &r, &g, &b, &obstacles);
 
-		ptcache_file_compressed_read(pf, (unsigned char *)sds->shadow, out_len);
-		ptcache_file_compressed_read(pf, (unsigned char *)dens, out_len);
+		ok = ok && ptcache_smoke_grid_read(pf, sds->shadow, sizeof(float), sds->res, pack, sparse);
+		ok = ok && ptcache_smoke_grid_read(pf, dens, sizeof(float), sds->res, pack, sparse);
 		if (cache_fields & SM_ACTIVE_HEAT) {
-			ptcache_file_compressed_read(pf, (unsigned char *)heat, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)heatold, out_len);
+			ok = ok && ptcache_smoke_grid_read(pf, heat, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, heatold, sizeof(float), sds->res, pack, sparse);
 		}
 		if (cache_fields & SM_ACTIVE_FIRE) {
-			ptcache_file_compressed_read(pf, (unsigned char *)flame, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)fuel, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)react, out_len);
+			ok = ok && ptcache_smoke_grid_read(pf, flame, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, fuel, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, react, sizeof(float), sds->res, pack, sparse);
 		}
 		if (cache_fields & SM_ACTIVE_COLORS) {
-			ptcache_file_compressed_read(pf, (unsigned char *)r, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)g, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)b, out_len);
-		}
-		ptcache_file_compressed_read(pf, (unsigned char *)vx, out_len);
-		ptcache_file_compressed_read(pf, (unsigned char *)vy, out_len);
-		ptcache_file_compressed_read(pf, (unsigned char *)vz, out_len);
-		ptcache_file_compressed_read(pf, (unsigned char *)obstacles, (unsigned int)res);
+			ok = ok && ptcache_smoke_grid_read(pf, r, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, g, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, b, sizeof(float), sds->res, pack, sparse);
+		}
+		ok = ok && ptcache_smoke_grid_read(pf, vx, sizeof(float), sds->res, pack, sparse);
+		ok = ok && ptcache_smoke_grid_read(pf, vy, sizeof(float), sds->res, pack, sparse);
+		ok = ok && ptcache_smoke_grid_read(pf, vz, sizeof(float), sds->res, pack, sparse);
+		ok = ok && ptcache_smoke_grid_read(pf, obstacles, sizeof(unsigned char), sds->res, pack, sparse);
+
+		if (!ok) {
+			if (pack) {
+				MEM_freeN(pack);
+			}
+			return 0;
+		}
+
 		ptcache_file_read(pf, &dt, 1, sizeof(float));
 		ptcache_file_read(pf, &dx, 1, sizeof(float));
 		ptcache_file_read(pf, &sds->p0, 3, sizeof(float));
@@ -858,39 +1048,47 @@ static int ptcache_smoke_read(PTCacheFile *pf, void *smoke_v)
 		ptcache_file_read(pf, &sds->res_min, 3, sizeof(int));
 		ptcache_file_read(pf, &sds->res_max, 3, sizeof(int));
 		ptcache_file_read(pf, &sds->active_color, 3, sizeof(float));
+
+		if (pack) {
+			MEM_freeN(pack);
+		}
 	}
 
 	if (pf->data_types & (1<<BPHYS_DATA_SMOKE_HIGH) && sds->wt) {
-			int res = sds->res[0]*sds->res[1]*sds->res[2];
 			int res_big, res_big_array[3];
 			float *dens, *react, *fuel, *flame, *tcu, *tcv, *tcw, *r, *g, *b;
-			unsigned int out_len = sizeof(float)*(unsigned int)res;
 			unsigned int out_len_big;
+			unsigned char *pack;
 
 			smoke_turbulence_get_res(sds->wt, res_big_array);
 			res_big = res_big_array[0]*res_big_array[1]*res_big_array[2];
 			out_len_big = sizeof(float) * (unsigned int)res_big;
+			pack = sparse ? (unsigned char *)MEM_mallocN(out_len_big, "pointcache_smoke_tiles") : NULL;
 
 			smoke_turbulence_export(sds->wt, &dens, &react, &flame, &fuel, &r, &g, &b, &tcu, &tcv, &tcw);
 
-			ptcache_file_compressed_read(pf, (unsigned char *)dens, out_len_big);
+			ok = ok && ptcache_smoke_grid_read(pf, dens, sizeof(float), res_big_array, pack, sparse);
 			if (cache_fields & SM_ACTIVE_FIRE) {
-				ptcache_file_compressed_read(pf, (unsigned char *)flame, out_len_big);
-				ptcache_file_compressed_read(pf, (unsigned char *)fuel, out_len_big);
-				ptcache_file_compressed_read(pf, (unsigned char *)react, out_len_big);
+				ok = ok && ptcache_smoke_grid_read(pf, flame, sizeof(float), res_big_array, pack, sparse);
+				ok = ok && ptcache_smoke_grid_read(pf, fuel, sizeof(float), res_big_array, pack, sparse);
+				ok = ok && ptcache_smoke_grid_read(pf, react, sizeof(float), res_big_array, pack, sparse);
 			}
 			if (cache_fields & SM_ACTIVE_COLORS) {
-				ptcache_file_compressed_read(pf, (unsigned char *)r, out_len_big);
-				ptcache_file_compressed_read(pf, (unsigned char *)g, out_len_big);
-				ptcache_file_compressed_read(pf, (unsigned char *)b, out_len_big);
+				ok = ok && ptcache_smoke_grid_read(pf, r, sizeof(float), res_big_array, pack, sparse);
+				ok = ok && ptcache_smoke_grid_read(pf, g, sizeof(float), res_big_array, pack, sparse);
+				ok = ok && ptcache_smoke_grid_read(pf, b, sizeof(float), res_big_array, pack, sparse);
 			}
 
-			ptcache_file_compressed_read(pf, (unsigned char *)tcu, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)tcv, out_len);
-			ptcache_file_compressed_read(pf, (unsigned char *)tcw, out_len);
+			ok = ok && ptcache_smoke_grid_read(pf, tcu, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, tcv, sizeof(float), sds->res, pack, sparse);
+			ok = ok && ptcache_smoke_grid_read(pf, tcw, sizeof(float), sds->res, pack, sparse);
+
+			if (pack) {
+				MEM_freeN(pack);
+			}
 		}
 
-	return 1;
+	return ok;
 }
 
 #ifdef WITH_OPENVDB
@@ -1994,10 +2192,12 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 		fp = BLI_fopen(filename, "rb");
 	}
 	else if (mode==PTCACHE_FILE_WRITE) {
+		ptcache_read_ahead_drop_file(filename);
 		BLI_make_existing_file(filename); /* will create the dir if needs be, same as //textures is created */
 		fp = BLI_fopen(filename, "wb");
 	}
 	else if (mode==PTCACHE_FILE_UPDATE) {
+		ptcache_read_ahead_drop_file(filename);
 		BLI_make_existing_file(filename);
 		fp = BLI_fopen(filename, "rb+");
 	}
@@ -2005,17 +2205,60 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 	if (!fp)
 		return NULL;
 
-	pf= MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
+	pf= MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
 	pf->fp= fp;
 	pf->old_format = 0;
 	pf->frame = cfra;
 
 	return pf;
 }
+/* Read only access to the whole file, read into memory at once.
+ * Only for the reading code using ptcache_file_read, not for read_stream callbacks
+ * which access pf->fp directly. Doesn't touch the PTCacheID, so this can be used
+ * from the read-ahead threads. The file isn't memory mapped, cache files are
+ * truncated in place when they're rewritten, which would fault a mapping that is
+ * still being read. */
+static PTCacheFile *ptcache_file_open_mem(const char *filename, int cfra)
+{
+	PTCacheFile *pf;
+	FILE *fp = BLI_fopen(filename, "rb");
+	unsigned char *mem;
+	size_t size;
+
+	if (!fp)
+		return NULL;
+
+	size = BLI_file_descriptor_size(fileno(fp));
+	if (size == (size_t)-1) {
+		fclose(fp);
+		return NULL;
+	}
+
+	mem = MEM_mallocN(max_zz(size, 1), "PTCacheFile mem");
+	if (fread(mem, 1, size, fp) != size) {
+		MEM_freeN(mem);
+		fclose(fp);
+		return NULL;
+	}
+
+	fclose(fp);
+
+	pf = MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
+	pf->mem = mem;
+	pf->mem_size = size;
+	pf->frame = cfra;
+
+	return pf;
+}
 static void ptcache_file_close(PTCacheFile *pf)
 {
 	if (pf) {
-		fclose(pf->fp);
+		if (pf->mem) {
+			MEM_freeN(pf->mem);
+		}
+		else {
+			fclose(pf->fp);
+		}
 		MEM_freeN(pf);
 	}
 }
@@ -2040,8 +2283,17 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
 			/* do nothing */
 		}
 		else {
-			in = (unsigned char *)MEM_callocN(sizeof(unsigned char)*in_len, "pointcache_compressed_buffer");
-			ptcache_file_read(pf, in, in_len, sizeof(unsigned char));
+			/* decompress straight from the file contents if they are in memory */
+			const bool in_is_mem = (pf->mem && in_len <= pf->mem_size - pf->mem_ofs);
+
+			if (in_is_mem) {
+				in = pf->mem + pf->mem_ofs;
+				pf->mem_ofs += in_len;
+			}
+			else {
+				in = (unsigned char *)MEM_callocN(sizeof(unsigned char)*in_len, "pointcache_compressed_buffer");
+				ptcache_file_read(pf, in, in_len, sizeof(unsigned char));
+			}
 #ifdef WITH_LZO
 			if (compressed == 1)
 				r = lzo1x_decompress_safe(in, (lzo_uint)in_len, result, (lzo_uint *)&out_len, NULL);
@@ -2056,7 +2308,8 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
 				r = LzmaUncompress(result, &leno, in, &leni, props, sizeOfIt);
 			}
 #endif
-			MEM_freeN(in);
+			if (!in_is_mem)
+				MEM_freeN(in);
 		}
 	}
 	else {
@@ -2123,6 +2376,17 @@ static int ptcache_file_compressed_write(PTCacheFile *pf, unsigned char *in, uns
 }
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
+	if (pf->mem) {
+		const size_t len = (size_t)tot * size;
+
+		if (len > pf->mem_size - pf->mem_ofs)
+			return 0;
+
+		memcpy(f, pf->mem + pf->mem_ofs, len);
+		pf->mem_ofs += len;
+		return 1;
+	}
+
 	return (fread(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
@@ -2159,21 +2423,25 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
 	pf->data_types = 0;
 
-	if (fread(bphysics, sizeof(char), 8, pf->fp) != 8)
+	if (!ptcache_file_read(pf, bphysics, 8, sizeof(char)))
 		error = 1;
 
 	if (!error && !STREQLEN(bphysics, "BPHYSICS", 8))
 		error = 1;
 
-	if (!error && !fread(&typeflag, sizeof(unsigned int), 1, pf->fp))
+	if (!error && !ptcache_file_read(pf, &typeflag, 1, sizeof(unsigned int)))
 		error = 1;
 
 	pf->type = (typeflag & PTCACHE_TYPEFLAG_TYPEMASK);
 	pf->flag = (typeflag & PTCACHE_TYPEFLAG_FLAGMASK);
 
 	/* if there was an error set file as it was */
-	if (error)
-		fseek(pf->fp, 0, SEEK_SET);
+	if (error) {
+		if (pf->mem)
+			pf->mem_ofs = 0;
+		else
+			fseek(pf->fp, 0, SEEK_SET);
+	}
 
 	return !error;
 }
@@ -2390,9 +2658,12 @@ static void ptcache_find_frames_around(PTCacheID *pid, unsigned int frame, int *
 	}
 }
 
-static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
+/* Reads a cache frame file into a new PTCacheMem. Only uses its arguments, so this
+ * can run on the read-ahead threads. */
+static PTCacheMem *ptcache_file_to_mem(const char *filename, int cfra, unsigned int type,
+                                       int (*read_header)(PTCacheFile *pf))
 {
-	PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
+	PTCacheFile *pf = ptcache_file_open_mem(filename, cfra);
 	PTCacheMem *pm = NULL;
 	unsigned int i, error = 0;
 
@@ -2402,7 +2673,7 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 	if (!ptcache_file_header_begin_read(pf))
 		error = 1;
 
-	if (!error && (pf->type != pid->type || !pid->read_header(pf)))
+	if (!error && (pf->type != type || !read_header(pf)))
 		error = 1;
 
 	if (!error) {
@@ -2471,6 +2742,285 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 
 	return pm;
 }
+
+/* Full path of a frame file for reading, false if disk caches can't be used. */
+static bool ptcache_read_filename(PTCacheID *pid, char *filename, int cfra)
+{
+	/* save blend file before using disk pointcache */
+	if (!G.relbase_valid && (pid->cache->flag & PTCACHE_EXTERNAL) == 0)
+		return false;
+
+	ptcache_filename(pid, filename, cfra, 1, 1);
+
+	return true;
+}
+
+static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
+{
+	char filename[MAX_PTCACHE_FILE];
+
+	if (!ptcache_read_filename(pid, filename, cfra))
+		return NULL;
+
+	return ptcache_file_to_mem(filename, cfra, pid->type, pid->read_header);
+}
+
+/* Read-ahead of disk cache frames.
+ *
+ * When a frame is read from a disk cache, the next frames are loaded into PTCacheMem
+ * by background tasks, so that playback only has to copy them into the simulation data.
+ * Frames are identified by their file name. Writing a cache file drops the frame loaded
+ * from it, the generation is increased whenever cache files are cleared or renamed,
+ * which drops everything loaded until then. */
+
+#define PTCACHE_READ_AHEAD_FRAMES 4
+
+typedef struct PTCacheReadAheadElem {
+	struct PTCacheReadAheadElem *next, *prev;
+
+	/* only used to group the frames of one cache, never dereferenced,
+	 * frames are dropped when the cache is freed so the pointer can't be reused */
+	const PointCache *cache;
+	char filename[MAX_PTCACHE_FILE];
+	int frame;
+	unsigned int type;
+	int (*read_header)(PTCacheFile *pf);
+	int generation;
+
+	/* the task frees skipped elements, the reading side frees done ones */
+	bool skip, is_running, is_done;
+	PTCacheMem *pm;
+} PTCacheReadAheadElem;
+
+static ListBase read_ahead_queue = {NULL, NULL};
+static TaskPool *read_ahead_pool = NULL;
+static int read_ahead_generation = 0;
+static ThreadMutex read_ahead_lock = BLI_MUTEX_INITIALIZER;
+static ThreadCondition read_ahead_done_cond = PTHREAD_COND_INITIALIZER;
+
+static void ptcache_mem_free(PTCacheMem *pm)
+{
+	ptcache_data_free(pm);
+	ptcache_extra_free(pm);
+	MEM_freeN(pm);
+}
+
+static void ptcache_read_ahead_task(TaskPool * __restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	PTCacheReadAheadElem *elem = taskdata;
+	PTCacheMem *pm;
+
+	BLI_mutex_lock(&read_ahead_lock);
+	if (elem->skip) {
+		BLI_remlink(&read_ahead_queue, elem);
+		MEM_freeN(elem);
+		BLI_mutex_unlock(&read_ahead_lock);
+		return;
+	}
+	elem->is_running = true;
+	BLI_mutex_unlock(&read_ahead_lock);
+
+	pm = ptcache_file_to_mem(elem->filename, elem->frame, elem->type, elem->read_header);
+
+	BLI_mutex_lock(&read_ahead_lock);
+	elem->is_running = false;
+	elem->is_done = true;
+	if (elem->skip) {
+		if (pm)
+			ptcache_mem_free(pm);
+		BLI_remlink(&read_ahead_queue, elem);
+		MEM_freeN(elem);
+	}
+	else {
+		elem->pm = pm;
+	}
+	BLI_condition_notify_all(&read_ahead_done_cond);
+	BLI_mutex_unlock(&read_ahead_lock);
+}
+
+/* caller is holding read_ahead_lock */
+static void ptcache_read_ahead_drop(PTCacheReadAheadElem *elem)
+{
+	if (elem->is_done) {
+		if (elem->pm)
+			ptcache_mem_free(elem->pm);
+		BLI_remlink(&read_ahead_queue, elem);
+		MEM_freeN(elem);
+	}
+	else {
+		elem->skip = true;
+	}
+}
+
+/* caller is holding read_ahead_lock */
+static PTCacheReadAheadElem *ptcache_read_ahead_find(const char *filename, unsigned int type)
+{
+	PTCacheReadAheadElem *elem;
+
+	for (elem = read_ahead_queue.first; elem; elem = elem->next) {
+		if (!elem->skip &&
+		    elem->generation == read_ahead_generation &&
+		    elem->type == type &&
+		    STREQ(elem->filename, filename))
+		{
+			return elem;
+		}
+	}
+
+	return NULL;
+}
+
+/* Takes the frame out of the read-ahead queue. Frames still being loaded are waited for,
+ * frames which weren't started yet are skipped and read by the caller instead, waiting
+ * for them could deadlock when all worker threads are evaluating the depsgraph. */
+static bool ptcache_read_ahead_take(const char *filename, unsigned int type, PTCacheMem **r_pm)
+{
+	PTCacheReadAheadElem *elem;
+	bool found = false;
+
+	BLI_mutex_lock(&read_ahead_lock);
+	while ((elem = ptcache_read_ahead_find(filename, type)) && elem->is_running) {
+		BLI_condition_wait(&read_ahead_done_cond, &read_ahead_lock);
+	}
+
+	if (elem) {
+		if (elem->is_done) {
+			*r_pm = elem->pm;
+			elem->pm = NULL;
+			found = true;
+		}
+		ptcache_read_ahead_drop(elem);
+	}
+	BLI_mutex_unlock(&read_ahead_lock);
+
+	return found;
+}
+
+/* Queues the frames following cfra and drops the other queued frames of the cache. */
+static void ptcache_read_ahead_push(PTCacheID *pid, int cfra)
+{
+	PointCache *cache = pid->cache;
+	PTCacheReadAheadElem *elem, *elem_next;
+	char filenames[PTCACHE_READ_AHEAD_FRAMES][MAX_PTCACHE_FILE];
+	int frames[PTCACHE_READ_AHEAD_FRAMES];
+	const int frame_end = min_ii(cache->endframe, cfra + PTCACHE_READ_AHEAD_FRAMES * max_ii(cache->step, 1));
+	int frame, i, tot = 0;
+
+	/* existence checks and file names need the PTCacheID, so they're done outside of the lock */
+	for (frame = cfra + 1; frame <= frame_end && tot < PTCACHE_READ_AHEAD_FRAMES; frame++) {
+		if (BKE_ptcache_id_exist(pid, frame) && ptcache_read_filename(pid, filenames[tot], frame)) {
+			frames[tot++] = frame;
+		}
+	}
+
+	BLI_mutex_lock(&read_ahead_lock);
+
+	for (elem = read_ahead_queue.first; elem; elem = elem_next) {
+		elem_next = elem->next;
+
+		if (elem->cache == cache && (elem->frame <= cfra || elem->frame > frame_end))
+			ptcache_read_ahead_drop(elem);
+	}
+
+	for (i = 0; i < tot; i++) {
+		if (ptcache_read_ahead_find(filenames[i], pid->type))
+			continue;
+
+		if (read_ahead_pool == NULL)
+			read_ahead_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+
+		elem = MEM_callocN(sizeof(PTCacheReadAheadElem), "PTCacheReadAheadElem");
+		elem->cache = cache;
+		BLI_strncpy(elem->filename, filenames[i], sizeof(elem->filename));
+		elem->frame = frames[i];
+		elem->type = pid->type;
+		elem->read_header = pid->read_header;
+		elem->generation = read_ahead_generation;
+
+		BLI_addtail(&read_ahead_queue, elem);
+		BLI_task_pool_push(read_ahead_pool, ptcache_read_ahead_task, elem, false, TASK_PRIORITY_LOW);
+	}
+
+	BLI_mutex_unlock(&read_ahead_lock);
+}
+
+/* The cache file is about to be written, a frame loaded from it can't be used anymore. */
+static void ptcache_read_ahead_drop_file(const char *filename)
+{
+	PTCacheReadAheadElem *elem, *elem_next;
+
+	BLI_mutex_lock(&read_ahead_lock);
+	for (elem = read_ahead_queue.first; elem; elem = elem_next) {
+		elem_next = elem->next;
+		if (!elem->skip && STREQ(elem->filename, filename))
+			ptcache_read_ahead_drop(elem);
+	}
+	BLI_mutex_unlock(&read_ahead_lock);
+}
+
+/* Copy-on-write copies of a cache are freed on every update, their frames would
+ * otherwise stay queued until the file is read again. */
+static void ptcache_read_ahead_drop_cache(const PointCache *cache)
+{
+	PTCacheReadAheadElem *elem, *elem_next;
+
+	BLI_mutex_lock(&read_ahead_lock);
+	for (elem = read_ahead_queue.first; elem; elem = elem_next) {
+		elem_next = elem->next;
+		if (!elem->skip && elem->cache == cache)
+			ptcache_read_ahead_drop(elem);
+	}
+	BLI_mutex_unlock(&read_ahead_lock);
+}
+
+/* Cache files are about to change, nothing loaded so far can be used anymore. */
+static void ptcache_read_ahead_invalidate(void)
+{
+	PTCacheReadAheadElem *elem, *elem_next;
+
+	BLI_mutex_lock(&read_ahead_lock);
+	read_ahead_generation++;
+	for (elem = read_ahead_queue.first; elem; elem = elem_next) {
+		elem_next = elem->next;
+		ptcache_read_ahead_drop(elem);
+	}
+	BLI_mutex_unlock(&read_ahead_lock);
+}
+
+void BKE_ptcache_read_ahead_free(void)
+{
+	PTCacheReadAheadElem *elem;
+
+	/* cancels the frames which weren't started and waits for the others */
+	if (read_ahead_pool) {
+		BLI_task_pool_free(read_ahead_pool);
+		read_ahead_pool = NULL;
+	}
+
+	while ((elem = BLI_pophead(&read_ahead_queue))) {
+		if (elem->pm)
+			ptcache_mem_free(elem->pm);
+		MEM_freeN(elem);
+	}
+}
+
+/* Disk cache frame, from the read-ahead queue when it was loaded already. */
+static PTCacheMem *ptcache_disk_frame_to_mem_read_ahead(PTCacheID *pid, int cfra)
+{
+	char filename[MAX_PTCACHE_FILE];
+	PTCacheMem *pm = NULL;
+
+	if (!ptcache_read_filename(pid, filename, cfra))
+		return NULL;
+
+	if (!ptcache_read_ahead_take(filename, pid->type, &pm))
+		pm = ptcache_file_to_mem(filename, cfra, pid->type, pid->read_header);
+
+	ptcache_read_ahead_push(pid, cfra);
+
+	return pm;
+}
+
 static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 {
 	PTCacheFile *pf = NULL;
@@ -2639,7 +3189,7 @@ static int ptcache_read(PTCacheID *pid, int cfra)
 
 	/* get a memory cache to read from */
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-		pm = ptcache_disk_frame_to_mem(pid, cfra);
+		pm = ptcache_disk_frame_to_mem_read_ahead(pid, cfra);
 	}
 	else {
 		pm = pid->cache->mem_cache.first;
@@ -2693,7 +3243,7 @@ static int ptcache_interpolate(PTCacheID *pid, float cfra, int cfra1, int cfra2)
 
 	/* get a memory cache to read from */
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-		pm = ptcache_disk_frame_to_mem(pid, cfra2);
+		pm = ptcache_disk_frame_to_mem_read_ahead(pid, cfra2);
 	}
 	else {
 		pm = pid->cache->mem_cache.first;
@@ -3079,6 +3629,9 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 
 	/*if (!G.relbase_valid) return; *//* save blend file before using pointcache */
 
+	if (pid->cache->flag & PTCACHE_DISK_CACHE)
+		ptcache_read_ahead_invalidate();
+
 	const char *fext = ptcache_file_extension(pid);
 
 	/* clear all files in the temp dir with the prefix of the ID and the ".bphys" suffix */
@@ -3521,6 +4074,7 @@ void BKE_ptcache_free_mem(ListBase *mem_cache)
 }
 void BKE_ptcache_free(PointCache *cache)
 {
+	ptcache_read_ahead_drop_cache(cache);
 	BKE_ptcache_free_mem(&cache->mem_cache);
 	if (cache->edit && cache->free_edit)
 		cache->free_edit(cache->edit);
@@ -3944,6 +4498,8 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
 	char old_path_full[MAX_PTCACHE_FILE];
 	char ext[MAX_PTCACHE_PATH];
 
+	ptcache_read_ahead_invalidate();
+
 	/* save old name */
 	BLI_strncpy(old_name, pid->cache->name, sizeof(old_name));
 
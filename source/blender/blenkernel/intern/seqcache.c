@@ -26,7 +26,19 @@
  *  \ingroup bke
  */
 
+
+/* The sequencer cache keeps raw strip inputs (SEQ_STRIPELEM_IBUF_RAW), preprocessed
+ * strips (SEQ_STRIPELEM_IBUF) and composited channel stacks (SEQ_STRIPELEM_IBUF_COMP).
+ *
+ * Every entry remembers how long it took to render. When the memory cache limit is
+ * reached, entries which are cheap to render again and far from the frame being
+ * rendered are freed first. Freed entries which took longer to render than reading
+ * them back would take are written to a compressed disk cache in the session's
+ * temporary directory, if the user preferences enable it. */
+
 #include <stddef.h>
+#include <string.h>
+#include <zlib.h>
 
 #include "BLI_sys_types.h"  /* for intptr_t */
 
@@ -34,42 +46,94 @@
 
 #include "DNA_sequence_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "IMB_moviecache.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_colormanagement.h"
 
+#include "BLI_fileops.h"
+#include "BLI_ghash.h"
 #include "BLI_listbase.h"
-
+#include "BLI_math.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_appdir.h"
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
 
+/* Costs below this are treated as this, so unmeasured entries still age with distance. */
+#define SEQ_CACHE_COST_REFERENCE 0.01f
+
+/* Assumed speed of reading the disk cache back, in bytes per second. */
+#define SEQ_DISK_CACHE_READ_SPEED (256.0f * 1024.0f * 1024.0f)
+/* Buffers waiting to be written are kept in memory, this limits how many of them. */
+#define SEQ_DISK_CACHE_MAX_PENDING ((size_t)512 * 1024 * 1024)
+
 typedef struct SeqCacheKey {
 	struct Sequence *seq;
 	SeqRenderData context;
 	float cfra;
 	eSeqStripElemIBuf type;
+
+	/* not part of the hash, used for eviction */
+	float timeline_frame;
+	float cost;
 } SeqCacheKey;
 
-typedef struct SeqPreprocessCacheElem {
-	struct SeqPreprocessCacheElem *next, *prev;
+typedef struct SeqCachePriorityData {
+	float timeline_frame;
+	float cost;
+} SeqCachePriorityData;
 
-	struct Sequence *seq;
-	SeqRenderData context;
-	eSeqStripElemIBuf type;
+typedef struct SeqDiskCacheEntry {
+	struct SeqDiskCacheEntry *next, *prev;
+
+	SeqCacheKey key;
+	char filepath[FILE_MAX];
+	size_t size;
+
+	/* false while the buffer is waiting to be written */
+	bool is_written;
+	/* removed from the cache while waiting, freed by the write task */
+	bool is_removed;
+} SeqDiskCacheEntry;
 
+typedef struct SeqDiskCacheWriteTask {
+	SeqDiskCacheEntry *entry;
 	ImBuf *ibuf;
-} SeqPreprocessCacheElem;
+	size_t ibuf_size;
+} SeqDiskCacheWriteTask;
 
-typedef struct SeqPreprocessCache {
-	int cfra;
-	ListBase elems;
-} SeqPreprocessCache;
+typedef struct SeqDiskCacheHeader {
+	int x, y;
+	int planes, channels;
+	int has_rect, has_rect_float;
+	char rect_colorspace[64];
+	char float_colorspace[64];
+} SeqDiskCacheHeader;
 
 static struct MovieCache *moviecache = NULL;
-static struct SeqPreprocessCache *preprocess_cache = NULL;
-
-static void preprocessed_cache_destruct(void);
+/* the cache is shared with the prefetch threads */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
+/* incremented when entries get invalid, so renders started before don't store old results */
+static int cache_generation = 0;
+static SeqCacheStats cache_stats = {0};
+
+/* entries are in the order they were added, oldest first */
+static ListBase disk_cache_entries = {NULL, NULL};
+static GHash *disk_cache_hash = NULL;
+static TaskPool *disk_cache_pool = NULL;
+static size_t disk_cache_size = 0;
+static size_t disk_cache_pending_size = 0;
+static unsigned int disk_cache_file_counter = 0;
+/* taken after cache_lock, never the other way around */
+static ThreadMutex disk_cache_lock = BLI_MUTEX_INITIALIZER;
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -121,167 +185,532 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 	        seq_cmp_render_data(&a->context, &b->context));
 }
 
-void BKE_sequencer_cache_destruct(void)
+static void seqcache_key_init(SeqCacheKey *key, const SeqRenderData *context, Sequence *seq,
+                              float cfra, eSeqStripElemIBuf type, float cost)
 {
-	if (moviecache)
-		IMB_moviecache_free(moviecache);
+	key->seq = seq;
+	key->context = *context;
+	key->cfra = cfra - seq->start;
+	key->type = type;
+	key->timeline_frame = cfra;
+	key->cost = cost;
+}
 
-	preprocessed_cache_destruct();
+static void *seqcache_getprioritydata(void *userkey)
+{
+	SeqCacheKey *key = (SeqCacheKey *) userkey;
+	SeqCachePriorityData *priority_data = MEM_mallocN(sizeof(*priority_data), "seq cache priority data");
+
+	priority_data->timeline_frame = key->timeline_frame;
+	priority_data->cost = key->cost;
+
+	return priority_data;
 }
 
-void BKE_sequencer_cache_cleanup(void)
+static int seqcache_getitempriority(void *last_userkey_v, void *priority_data_v)
 {
-	if (moviecache) {
-		IMB_moviecache_free(moviecache);
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
-	}
+	SeqCacheKey *last_userkey = (SeqCacheKey *) last_userkey_v;
+	SeqCachePriorityData *priority_data = (SeqCachePriorityData *) priority_data_v;
+	float distance = fabsf(last_userkey->timeline_frame - priority_data->timeline_frame);
+
+	/* like the movie clip cache the distance in frames is used, scaled down
+	 * for entries which are more expensive to render than the reference */
+	distance *= SEQ_CACHE_COST_REFERENCE / max_ff(priority_data->cost, SEQ_CACHE_COST_REFERENCE);
 
-	BKE_sequencer_preprocessed_cache_cleanup();
+	return -(int)(distance + 0.5f);
 }
 
-static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
+static void seqcache_prioritydeleter(void *priority_data)
 {
-	SeqCacheKey *key = (SeqCacheKey *) userkey;
-	Sequence *seq = (Sequence *) userdata;
+	MEM_freeN(priority_data);
+}
 
-	return key->seq == seq;
+/* *************************** disk cache *************************** */
+
+static bool seqcache_disk_is_enabled(void)
+{
+	return U.seqdiskcachelimit > 0;
 }
 
-void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
+static size_t seqcache_disk_limit(void)
 {
-	if (moviecache)
-		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
+	return (size_t)U.seqdiskcachelimit * 1024 * 1024;
 }
 
-struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
+static void seqcache_disk_entry_path(char *filepath)
 {
-	if (moviecache && seq) {
-		SeqCacheKey key;
+	char dir[FILE_MAX], name[32];
+
+	BLI_join_dirfile(dir, sizeof(dir), BKE_tempdir_session(), "sequencer_cache");
+	BLI_dir_create_recursive(dir);
 
-		key.seq = seq;
-		key.context = *context;
-		key.cfra = cfra - seq->start;
-		key.type = type;
+	BLI_snprintf(name, sizeof(name), "%u.seqcache", disk_cache_file_counter++);
+	BLI_join_dirfile(filepath, FILE_MAX, dir, name);
+}
 
-		return IMB_moviecache_get(moviecache, &key);
+static bool seqcache_disk_write(const char *filepath, ImBuf *ibuf)
+{
+	SeqDiskCacheHeader header;
+	const size_t totpixel = (size_t)ibuf->x * (size_t)ibuf->y;
+	const char *colorspace;
+	gzFile file;
+	bool ok;
+
+	memset(&header, 0, sizeof(header));
+	header.x = ibuf->x;
+	header.y = ibuf->y;
+	header.planes = ibuf->planes;
+	header.channels = ibuf->channels;
+	header.has_rect = ibuf->rect != NULL;
+	header.has_rect_float = ibuf->rect_float != NULL;
+	if ((colorspace = IMB_colormanagement_get_rect_colorspace(ibuf))) {
+		BLI_strncpy(header.rect_colorspace, colorspace, sizeof(header.rect_colorspace));
+	}
+	if ((colorspace = IMB_colormanagement_get_float_colorspace(ibuf))) {
+		BLI_strncpy(header.float_colorspace, colorspace, sizeof(header.float_colorspace));
 	}
 
-	return NULL;
+	/* fastest compression level, the cache is written while playing back */
+	file = BLI_gzopen(filepath, "wb1");
+	if (file == NULL) {
+		return false;
+	}
+
+	ok = gzwrite(file, &header, sizeof(header)) == sizeof(header);
+	if (ok && ibuf->rect) {
+		const size_t size = totpixel * sizeof(unsigned int);
+		ok = gzwrite(file, ibuf->rect, size) == size;
+	}
+	if (ok && ibuf->rect_float) {
+		const size_t size = totpixel * ibuf->channels * sizeof(float);
+		ok = gzwrite(file, ibuf->rect_float, size) == size;
+	}
+
+	if (gzclose(file) != Z_OK) {
+		ok = false;
+	}
+
+	if (!ok) {
+		BLI_delete(filepath, false, false);
+	}
+
+	return ok;
 }
 
-void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
+static ImBuf *seqcache_disk_read(const char *filepath)
 {
-	SeqCacheKey key;
+	SeqDiskCacheHeader header;
+	ImBuf *ibuf = NULL;
+	gzFile file;
+	bool ok;
 
-	if (i == NULL || context->skip_cache) {
-		return;
+	file = BLI_gzopen(filepath, "rb");
+	if (file == NULL) {
+		return NULL;
 	}
 
-	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+	ok = gzread(file, &header, sizeof(header)) == sizeof(header);
+	if (ok) {
+		const size_t totpixel = (size_t)header.x * (size_t)header.y;
+		int flags = (header.has_rect ? IB_rect : 0) | (header.has_rect_float ? IB_rectfloat : 0);
+
+		ibuf = IMB_allocImBuf(header.x, header.y, header.planes, flags);
+		ok = ibuf != NULL;
+
+		if (ok) {
+			ibuf->channels = header.channels;
+		}
+		if (ok && ibuf->rect_float && header.channels != 4) {
+			/* allocated for 4 channels, smaller buffer is still fine */
+			ok = header.channels > 0 && header.channels <= 4;
+		}
+		if (ok && ibuf->rect) {
+			const size_t size = totpixel * sizeof(unsigned int);
+			ok = gzread(file, ibuf->rect, size) == size;
+		}
+		if (ok && ibuf->rect_float) {
+			const size_t size = totpixel * header.channels * sizeof(float);
+			ok = gzread(file, ibuf->rect_float, size) == size;
+		}
 	}
 
-	key.seq = seq;
-	key.context = *context;
-	key.cfra = cfra - seq->start;
-	key.type = type;
+	gzclose(file);
+
+	if (!ok) {
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+		}
+		return NULL;
+	}
 
-	IMB_moviecache_put(moviecache, &key, i);
+	header.rect_colorspace[sizeof(header.rect_colorspace) - 1] = '\0';
+	header.float_colorspace[sizeof(header.float_colorspace) - 1] = '\0';
+	if (header.rect_colorspace[0]) {
+		IMB_colormanagement_assign_rect_colorspace(ibuf, header.rect_colorspace);
+	}
+	if (header.float_colorspace[0]) {
+		IMB_colormanagement_assign_float_colorspace(ibuf, header.float_colorspace);
+	}
+
+	return ibuf;
 }
 
-void BKE_sequencer_preprocessed_cache_cleanup(void)
+/* caller is holding disk_cache_lock */
+static void seqcache_disk_entry_remove(SeqDiskCacheEntry *entry)
 {
-	SeqPreprocessCacheElem *elem;
+	BLI_ghash_remove(disk_cache_hash, &entry->key, NULL, NULL);
+	BLI_remlink(&disk_cache_entries, entry);
 
-	if (!preprocess_cache)
-		return;
+	if (entry->is_written) {
+		BLI_delete(entry->filepath, false, false);
+		disk_cache_size -= entry->size;
+		MEM_freeN(entry);
+	}
+	else {
+		entry->is_removed = true;
+	}
+}
+
+/* caller is holding disk_cache_lock */
+static void seqcache_disk_enforce_limit(void)
+{
+	const size_t limit = seqcache_disk_limit();
+	SeqDiskCacheEntry *entry, *entry_next;
+
+	for (entry = disk_cache_entries.first; entry && disk_cache_size > limit; entry = entry_next) {
+		entry_next = entry->next;
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
-		IMB_freeImBuf(elem->ibuf);
+		if (entry->is_written) {
+			seqcache_disk_entry_remove(entry);
+		}
+	}
+}
+
+static void seqcache_disk_write_task(TaskPool * __restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	SeqDiskCacheWriteTask *task = (SeqDiskCacheWriteTask *) taskdata;
+	SeqDiskCacheEntry *entry = task->entry;
+	bool is_removed, ok = false;
+
+	BLI_mutex_lock(&disk_cache_lock);
+	is_removed = entry->is_removed;
+	BLI_mutex_unlock(&disk_cache_lock);
+
+	if (!is_removed) {
+		ok = seqcache_disk_write(entry->filepath, task->ibuf);
 	}
-	BLI_freelistN(&preprocess_cache->elems);
 
-	BLI_listbase_clear(&preprocess_cache->elems);
+	IMB_freeImBuf(task->ibuf);
+
+	BLI_mutex_lock(&disk_cache_lock);
+	disk_cache_pending_size -= task->ibuf_size;
+
+	if (entry->is_removed) {
+		if (ok) {
+			BLI_delete(entry->filepath, false, false);
+		}
+		MEM_freeN(entry);
+	}
+	else if (!ok) {
+		seqcache_disk_entry_remove(entry);
+		MEM_freeN(entry);
+	}
+	else {
+		entry->is_written = true;
+		entry->size = BLI_file_size(entry->filepath);
+		disk_cache_size += entry->size;
+		seqcache_disk_enforce_limit();
+	}
+	BLI_mutex_unlock(&disk_cache_lock);
 }
 
-static void preprocessed_cache_destruct(void)
+/* Called by the memory cache for buffers which are freed to stay within the memory limit.
+ * Can happen from any thread putting images into any movie cache. */
+static void seqcache_evict(void *userkey, ImBuf *ibuf)
 {
-	if (!preprocess_cache)
+	SeqCacheKey *key = (SeqCacheKey *) userkey;
+	SeqDiskCacheEntry *entry;
+	SeqDiskCacheWriteTask *task;
+	size_t ibuf_size;
+
+	if (!seqcache_disk_is_enabled() || ELEM(key->type, SEQ_STRIPELEM_IBUF_STARTSTILL, SEQ_STRIPELEM_IBUF_ENDSTILL)) {
+		return;
+	}
+
+	ibuf_size = (size_t)ibuf->x * (size_t)ibuf->y *
+	            ((ibuf->rect ? sizeof(unsigned int) : 0) + (ibuf->rect_float ? ibuf->channels * sizeof(float) : 0));
+
+	/* cheap to render again */
+	if (key->cost < (float)ibuf_size / SEQ_DISK_CACHE_READ_SPEED) {
+		return;
+	}
+
+	BLI_mutex_lock(&disk_cache_lock);
+
+	if (disk_cache_pending_size + ibuf_size > SEQ_DISK_CACHE_MAX_PENDING ||
+	    (disk_cache_hash && BLI_ghash_haskey(disk_cache_hash, key)))
+	{
+		BLI_mutex_unlock(&disk_cache_lock);
 		return;
+	}
 
-	BKE_sequencer_preprocessed_cache_cleanup();
+	if (disk_cache_hash == NULL) {
+		disk_cache_hash = BLI_ghash_new(seqcache_hashhash, seqcache_hashcmp, "seq disk cache hash");
+	}
+	if (disk_cache_pool == NULL) {
+		disk_cache_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+	}
+
+	entry = MEM_callocN(sizeof(SeqDiskCacheEntry), "seq disk cache entry");
+	entry->key = *key;
+	seqcache_disk_entry_path(entry->filepath);
+
+	BLI_ghash_insert(disk_cache_hash, &entry->key, entry);
+	BLI_addtail(&disk_cache_entries, entry);
+
+	task = MEM_callocN(sizeof(SeqDiskCacheWriteTask), "seq disk cache write task");
+	task->entry = entry;
+	task->ibuf = ibuf;
+	task->ibuf_size = ibuf_size;
+	IMB_refImBuf(ibuf);
+	disk_cache_pending_size += ibuf_size;
+
+	BLI_task_pool_push(disk_cache_pool, seqcache_disk_write_task, task, true, TASK_PRIORITY_LOW);
 
-	MEM_freeN(preprocess_cache);
-	preprocess_cache = NULL;
+	BLI_mutex_unlock(&disk_cache_lock);
 }
 
-ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
+/* reads the entry with the given key, key's cost is set to the stored one */
+static ImBuf *seqcache_disk_get(SeqCacheKey *key)
 {
-	SeqPreprocessCacheElem *elem;
+	SeqDiskCacheEntry *entry;
+	char filepath[FILE_MAX];
 
-	if (!preprocess_cache)
+	BLI_mutex_lock(&disk_cache_lock);
+	entry = disk_cache_hash ? BLI_ghash_lookup(disk_cache_hash, key) : NULL;
+	if (entry == NULL || !entry->is_written) {
+		BLI_mutex_unlock(&disk_cache_lock);
 		return NULL;
+	}
+	BLI_strncpy(filepath, entry->filepath, sizeof(filepath));
+	key->cost = entry->key.cost;
+	BLI_mutex_unlock(&disk_cache_lock);
 
-	if (preprocess_cache->cfra != cfra)
-		return NULL;
+	/* the file is removed when the entry gets invalid, then this fails */
+	return seqcache_disk_read(filepath);
+}
+
+static void seqcache_disk_cleanup(bool (*check_cb)(SeqCacheKey *key, void *userdata), void *userdata)
+{
+	SeqDiskCacheEntry *entry, *entry_next;
+
+	BLI_mutex_lock(&disk_cache_lock);
+	for (entry = disk_cache_entries.first; entry; entry = entry_next) {
+		entry_next = entry->next;
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
-		if (elem->seq != seq)
-			continue;
+		if (check_cb == NULL || check_cb(&entry->key, userdata)) {
+			seqcache_disk_entry_remove(entry);
+		}
+	}
+	BLI_mutex_unlock(&disk_cache_lock);
+}
 
-		if (elem->type != type)
-			continue;
+static void seqcache_disk_destruct(void)
+{
+	if (disk_cache_pool) {
+		BLI_task_pool_work_and_wait(disk_cache_pool);
+		BLI_task_pool_free(disk_cache_pool);
+		disk_cache_pool = NULL;
+	}
 
-		if (seq_cmp_render_data(&elem->context, context) != 0)
-			continue;
+	seqcache_disk_cleanup(NULL, NULL);
 
-		IMB_refImBuf(elem->ibuf);
-		return elem->ibuf;
+	if (disk_cache_hash) {
+		BLI_ghash_free(disk_cache_hash, NULL, NULL);
+		disk_cache_hash = NULL;
 	}
+}
+
+/* ************************** memory cache ************************** */
 
-	return NULL;
+/* caller is holding cache_lock */
+static void seqcache_put_locked(SeqCacheKey *key, ImBuf *ibuf)
+{
+	if (!moviecache) {
+		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		IMB_moviecache_set_priority_callback(moviecache,
+		                                     seqcache_getprioritydata,
+		                                     seqcache_getitempriority,
+		                                     seqcache_prioritydeleter);
+		IMB_moviecache_set_evict_callback(moviecache, seqcache_evict);
+	}
+
+	IMB_moviecache_put(moviecache, key, ibuf);
 }
 
-void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *ibuf)
+void BKE_sequencer_cache_destruct(void)
 {
-	SeqPreprocessCacheElem *elem;
+	BKE_sequencer_prefetch_free();
 
-	if (!preprocess_cache) {
-		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
+	if (moviecache) {
+		IMB_moviecache_free(moviecache);
+		moviecache = NULL;
 	}
-	else {
-		if (preprocess_cache->cfra != cfra)
-			BKE_sequencer_preprocessed_cache_cleanup();
+
+	seqcache_disk_destruct();
+}
+
+void BKE_sequencer_cache_cleanup(void)
+{
+	BKE_sequencer_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
+	if (moviecache) {
+		IMB_moviecache_free(moviecache);
+		moviecache = NULL;
 	}
+	cache_generation++;
+	BLI_mutex_unlock(&cache_lock);
 
-	elem = MEM_callocN(sizeof(SeqPreprocessCacheElem), "sequencer preprocessed cache element");
+	seqcache_disk_cleanup(NULL, NULL);
+}
 
-	elem->seq = seq;
-	elem->type = type;
-	elem->context = *context;
-	elem->ibuf = ibuf;
+static bool seqcache_key_check_seq(SeqCacheKey *key, Sequence *seq, bool raw)
+{
+	return key->seq == seq && (key->type == SEQ_STRIPELEM_IBUF_RAW) == raw;
+}
 
-	preprocess_cache->cfra = cfra;
+static bool seqcache_key_check_seq_cb(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
+{
+	return seqcache_key_check_seq(userkey, userdata, false);
+}
 
-	IMB_refImBuf(ibuf);
+static bool seqcache_key_check_seq_raw_cb(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
+{
+	return seqcache_key_check_seq(userkey, userdata, true);
+}
 
-	BLI_addtail(&preprocess_cache->elems, elem);
+static bool seqcache_key_check_raw_cb(ImBuf *UNUSED(ibuf), void *userkey, void *UNUSED(userdata))
+{
+	return ((SeqCacheKey *) userkey)->type == SEQ_STRIPELEM_IBUF_RAW;
 }
 
-void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
+static bool seqcache_disk_check_seq_cb(SeqCacheKey *key, void *userdata)
 {
-	SeqPreprocessCacheElem *elem, *elem_next;
+	return seqcache_key_check_seq(key, userdata, false);
+}
 
-	if (!preprocess_cache)
-		return;
+static bool seqcache_disk_check_seq_raw_cb(SeqCacheKey *key, void *userdata)
+{
+	return seqcache_key_check_seq(key, userdata, true);
+}
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem_next) {
-		elem_next = elem->next;
+static bool seqcache_disk_check_raw_cb(SeqCacheKey *key, void *UNUSED(userdata))
+{
+	return key->type == SEQ_STRIPELEM_IBUF_RAW;
+}
 
-		if (elem->seq == seq) {
-			IMB_freeImBuf(elem->ibuf);
+static void seqcache_cleanup_ex(bool (*check_cb)(ImBuf *, void *, void *),
+                                bool (*disk_check_cb)(SeqCacheKey *, void *), void *userdata)
+{
+	BLI_mutex_lock(&cache_lock);
+	if (moviecache)
+		IMB_moviecache_cleanup(moviecache, check_cb, userdata);
+	cache_generation++;
+	BLI_mutex_unlock(&cache_lock);
 
-			BLI_freelinkN(&preprocess_cache->elems, elem);
+	seqcache_disk_cleanup(disk_check_cb, userdata);
+}
+
+void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
+{
+	seqcache_cleanup_ex(seqcache_key_check_seq_cb, seqcache_disk_check_seq_cb, seq);
+}
+
+struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
+{
+	SeqCacheKey key;
+	ImBuf *ibuf = NULL;
+	int generation;
+
+	if (seq == NULL) {
+		return NULL;
+	}
+
+	seqcache_key_init(&key, context, seq, cfra, type, 0.0f);
+
+	BLI_mutex_lock(&cache_lock);
+	if (moviecache) {
+		ibuf = IMB_moviecache_get(moviecache, &key);
+	}
+	if (ibuf) {
+		cache_stats.hits_memory++;
+	}
+	generation = cache_generation;
+	BLI_mutex_unlock(&cache_lock);
+
+	if (ibuf == NULL) {
+		ibuf = seqcache_disk_get(&key);
+
+		BLI_mutex_lock(&cache_lock);
+		if (ibuf) {
+			cache_stats.hits_disk++;
+
+			/* bring it back into memory, unless the cache got invalid while reading */
+			if (generation == cache_generation) {
+				seqcache_put_locked(&key, ibuf);
+			}
+		}
+		else {
+			cache_stats.misses++;
 		}
+		BLI_mutex_unlock(&cache_lock);
 	}
+
+	return ibuf;
+}
+
+void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type,
+                             ImBuf *i, float cost)
+{
+	SeqCacheKey key;
+
+	if (i == NULL || context->skip_cache) {
+		return;
+	}
+
+	seqcache_key_init(&key, context, seq, cfra, type, cost);
+
+	BLI_mutex_lock(&cache_lock);
+	seqcache_put_locked(&key, i);
+	BLI_mutex_unlock(&cache_lock);
+}
+
+void BKE_sequencer_preprocessed_cache_cleanup(void)
+{
+	seqcache_cleanup_ex(seqcache_key_check_raw_cb, seqcache_disk_check_raw_cb, NULL);
+}
+
+void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
+{
+	seqcache_cleanup_ex(seqcache_key_check_seq_raw_cb, seqcache_disk_check_seq_raw_cb, seq);
+}
+
+void BKE_sequencer_cache_stats_get(SeqCacheStats *r_stats)
+{
+	BLI_mutex_lock(&cache_lock);
+	*r_stats = cache_stats;
+	BLI_mutex_unlock(&cache_lock);
+
+	BLI_mutex_lock(&disk_cache_lock);
+	r_stats->disk_size = disk_cache_size;
+	r_stats->disk_items = BLI_listbase_count(&disk_cache_entries);
+	BLI_mutex_unlock(&disk_cache_lock);
+}
+
+void BKE_sequencer_cache_stats_reset(void)
+{
+	BLI_mutex_lock(&cache_lock);
+	memset(&cache_stats, 0, sizeof(cache_stats));
+	BLI_mutex_unlock(&cache_lock);
 }
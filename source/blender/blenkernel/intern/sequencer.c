@@ -35,6 +35,7 @@
 #include <math.h>
 
 #include "MEM_guardedalloc.h"
+#include "MEM_CacheLimiterC-Api.h"
 
 #include "DNA_sequence_types.h"
 #include "DNA_movieclip_types.h"
@@ -43,14 +44,17 @@
 #include "DNA_anim_types.h"
 #include "DNA_object_types.h"
 #include "DNA_sound_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BLI_math.h"
 #include "BLI_fileops.h"
+#include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_linklist.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -80,9 +84,9 @@
 
 #include "RNA_access.h"
 
-#include "RE_pipeline.h"
+#include "PIL_time.h"
 
-#include <pthread.h>
+#include "RE_pipeline.h"
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -103,6 +107,33 @@ typedef struct SeqRenderState {
 	LinkNode *scene_parents;
 } SeqRenderState;
 
+/* protects strip data initialized on demand while rendering, see prefetch api */
+static ThreadMutex seq_render_lock = BLI_MUTEX_INITIALIZER;
+
+/* Movie and proxy animation handles of a strip are opened and decoded by one thread at a
+ * time. Strips are spread over a few locks, so different strips decode in parallel. */
+#define SEQ_STRIP_LOCKS_NUM 16
+static ThreadMutex seq_strip_locks[SEQ_STRIP_LOCKS_NUM];
+static bool seq_strip_locks_initialized = false;
+
+static ThreadMutex *seq_strip_lock_get(const Sequence *seq)
+{
+	ThreadMutex *lock;
+
+	BLI_mutex_lock(&seq_render_lock);
+	if (!seq_strip_locks_initialized) {
+		int i;
+		for (i = 0; i < SEQ_STRIP_LOCKS_NUM; i++) {
+			BLI_mutex_init(&seq_strip_locks[i]);
+		}
+		seq_strip_locks_initialized = true;
+	}
+	lock = &seq_strip_locks[BLI_ghashutil_ptrhash(seq) % SEQ_STRIP_LOCKS_NUM];
+	BLI_mutex_unlock(&seq_render_lock);
+
+	return lock;
+}
+
 static ImBuf *seq_render_strip_stack(
         const SeqRenderData *context, SeqRenderState *state, ListBase *seqbasep,
         float cfra, int chanshown);
@@ -591,6 +622,7 @@ void BKE_sequencer_new_render_data(
 	r_context->motion_blur_shutter = 0;
 	r_context->skip_cache = false;
 	r_context->is_proxy_render = false;
+	r_context->is_prefetch_render = false;
 	r_context->view_id = 0;
 	r_context->gpu_offscreen = NULL;
 	r_context->gpu_samples = (scene->r.mode & R_OSA) ? scene->r.osa : 0;
@@ -1764,23 +1796,29 @@ static ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int c
 
 	if (proxy->storage & SEQ_STORAGE_PROXY_CUSTOM_FILE) {
 		int frameno = (int)give_stripelem_index(seq, cfra) + seq->anim_startofs;
-		if (proxy->anim == NULL) {
-			if (seq_proxy_get_fname(ed, seq, cfra, render_size, name, context->view_id) == 0) {
-				return NULL;
-			}
+		ImBuf *ibuf = NULL;
+		ThreadMutex *strip_lock = seq_strip_lock_get(seq);
+
+		BLI_mutex_lock(strip_lock);
 
-			proxy->anim = openanim(name, IB_rect, 0, seq->strip->colorspace_settings.name);
-		}
 		if (proxy->anim == NULL) {
-			return NULL;
+			if (seq_proxy_get_fname(ed, seq, cfra, render_size, name, context->view_id)) {
+				proxy->anim = openanim(name, IB_rect, 0, seq->strip->colorspace_settings.name);
+			}
 		}
 
-		seq_open_anim_file(context->scene, seq, true);
-		sanim = seq->anims.first;
+		if (proxy->anim) {
+			seq_open_anim_file(context->scene, seq, true);
+			sanim = seq->anims.first;
+
+			frameno = IMB_anim_index_get_frame_index(sanim ? sanim->anim : NULL, seq->strip->proxy->tc, frameno);
+
+			ibuf = IMB_anim_absolute(proxy->anim, frameno, IMB_TC_NONE, IMB_PROXY_NONE);
+		}
 
-		frameno = IMB_anim_index_get_frame_index(sanim ? sanim->anim : NULL, seq->strip->proxy->tc, frameno);
+		BLI_mutex_unlock(strip_lock);
 
-		return IMB_anim_absolute(proxy->anim, frameno, IMB_TC_NONE, IMB_PROXY_NONE);
+		return ibuf;
 	}
 
 	if (seq_proxy_get_fname(ed, seq, cfra, render_size, name, context->view_id) == 0) {
@@ -2054,6 +2092,119 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 	}
 }
 
+/* Contexts of a queue are rebuilt by a few threads taking them in order, each movie already
+ * decodes and encodes on several threads so only a few are rebuilt at the same time. */
+#define SEQ_PROXY_REBUILD_THREADS_MAX 4
+
+typedef struct SeqProxyRebuildThread {
+	struct SeqProxyRebuildQueue *rq;
+	float progress;
+} SeqProxyRebuildThread;
+
+typedef struct SeqProxyRebuildQueue {
+	ThreadMutex lock;
+	ListBase *queue;
+	/* last link taken by a thread, contexts may be added to the queue meanwhile */
+	LinkData *last_link;
+	int tot_done, threads_done;
+
+	short *stop;
+	short do_update;
+} SeqProxyRebuildQueue;
+
+static void *seq_proxy_rebuild_queue_thread(void *data)
+{
+	SeqProxyRebuildThread *thread = data;
+	SeqProxyRebuildQueue *rq = thread->rq;
+
+	while (!*rq->stop && !G.is_break) {
+		LinkData *link;
+
+		BLI_mutex_lock(&rq->lock);
+		link = rq->last_link ? rq->last_link->next : rq->queue->first;
+		if (link) {
+			rq->last_link = link;
+		}
+		BLI_mutex_unlock(&rq->lock);
+
+		if (link == NULL) {
+			break;
+		}
+
+		thread->progress = 0.0f;
+		BKE_sequencer_proxy_rebuild(link->data, rq->stop, &rq->do_update, &thread->progress);
+
+		BLI_mutex_lock(&rq->lock);
+		thread->progress = 0.0f;
+		rq->tot_done++;
+		BLI_mutex_unlock(&rq->lock);
+	}
+
+	BLI_mutex_lock(&rq->lock);
+	rq->threads_done++;
+	BLI_mutex_unlock(&rq->lock);
+
+	return NULL;
+}
+
+/**
+ * Rebuild all contexts of a queue made by #BKE_sequencer_proxy_rebuild_context,
+ * several of them at once. Progress is the average progress of all contexts.
+ */
+void BKE_sequencer_proxy_rebuild_queue(ListBase *queue, short *stop, short *do_update, float *progress)
+{
+	SeqProxyRebuildQueue rq = {{{0}}};
+	SeqProxyRebuildThread *thread_data;
+	ListBase threads;
+	int i, tot, tot_thread;
+
+	tot = BLI_listbase_count(queue);
+	if (tot == 0) {
+		return;
+	}
+
+	BLI_mutex_init(&rq.lock);
+	rq.queue = queue;
+	rq.stop = stop;
+
+	tot_thread = min_iii(tot, BLI_system_thread_count(), SEQ_PROXY_REBUILD_THREADS_MAX);
+	thread_data = MEM_callocN(sizeof(*thread_data) * tot_thread, "seq proxy rebuild threads");
+
+	BLI_threadpool_init(&threads, seq_proxy_rebuild_queue_thread, tot_thread);
+	for (i = 0; i < tot_thread; i++) {
+		thread_data[i].rq = &rq;
+		BLI_threadpool_insert(&threads, &thread_data[i]);
+	}
+
+	while (true) {
+		float progress_sum;
+		bool done;
+
+		PIL_sleep_ms(50);
+
+		BLI_mutex_lock(&rq.lock);
+		done = (rq.threads_done == tot_thread);
+		progress_sum = rq.tot_done;
+		for (i = 0; i < tot_thread; i++) {
+			progress_sum += thread_data[i].progress;
+		}
+		BLI_mutex_unlock(&rq.lock);
+
+		tot = max_ii(BLI_listbase_count(queue), 1);
+		*progress = min_ff(progress_sum / tot, 1.0f);
+		*do_update = true;
+
+		if (done) {
+			break;
+		}
+	}
+
+	BLI_threadpool_end(&threads);
+
+	BLI_mutex_end(&rq.lock);
+	MEM_freeN(thread_data);
+}
+
 void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
 {
 	if (context->index_context) {
@@ -2626,11 +2777,11 @@ static void copy_to_ibuf_still(const SeqRenderData *context, Sequence *seq, floa
 		}
 
 		if (nr == 0) {
-			BKE_sequencer_cache_put(context, seq, seq->start, SEQ_STRIPELEM_IBUF_STARTSTILL, ibuf);
+			BKE_sequencer_cache_put(context, seq, seq->start, SEQ_STRIPELEM_IBUF_STARTSTILL, ibuf, 0.0f);
 		}
 
 		if (nr == seq->len - 1) {
-			BKE_sequencer_cache_put(context, seq, seq->start, SEQ_STRIPELEM_IBUF_ENDSTILL, ibuf);
+			BKE_sequencer_cache_put(context, seq, seq->start, SEQ_STRIPELEM_IBUF_ENDSTILL, ibuf, 0.0f);
 		}
 
 		IMB_freeImBuf(ibuf);
@@ -2887,7 +3038,7 @@ static ImBuf *seq_render_image_strip(const SeqRenderData *context, Sequence *seq
 
 				if (i != context->view_id) {
 					copy_to_ibuf_still(&localcontext, seq, nr, ibufs_arr[i]);
-					BKE_sequencer_cache_put(&localcontext, seq, cfra, SEQ_STRIPELEM_IBUF, ibufs_arr[i]);
+					BKE_sequencer_cache_put(&localcontext, seq, cfra, SEQ_STRIPELEM_IBUF, ibufs_arr[i], 0.0f);
 				}
 			}
 		}
@@ -2932,6 +3083,10 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context, Sequence *seq
 	StripAnim *sanim;
 	bool is_multiview = (seq->flag & SEQ_USE_VIEWS) != 0 &&
 	                    (context->scene->r.scemode & R_MULTIVIEW) != 0;
+	ThreadMutex *strip_lock = seq_strip_lock_get(seq);
+
+	/* animation handles of the strip are opened and used by one thread at a time (prefetching) */
+	BLI_mutex_lock(strip_lock);
 
 	/* load all the videos */
 	seq_open_anim_file(context->scene, seq, false);
@@ -2978,6 +3133,7 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context, Sequence *seq
 			else {
 				/* probably proxy hasn't been created yet */
 				MEM_freeN(ibuf_arr);
+				BLI_mutex_unlock(strip_lock);
 				return NULL;
 			}
 		}
@@ -2992,7 +3148,7 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context, Sequence *seq
 			}
 			if (i != context->view_id) {
 				copy_to_ibuf_still(&localcontext, seq, nr, ibuf_arr[i]);
-				BKE_sequencer_cache_put(&localcontext, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf_arr[i]);
+				BKE_sequencer_cache_put(&localcontext, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf_arr[i], 0.0f);
 			}
 		}
 
@@ -3042,6 +3198,9 @@ monoview_movie:
 			}
 		}
 	}
+
+	BLI_mutex_unlock(strip_lock);
+
 	return ibuf;
 }
 
@@ -3379,7 +3538,7 @@ static ImBuf *seq_render_scene_strip(const SeqRenderData *context, Sequence *seq
 
 			if (i != context->view_id) {
 				copy_to_ibuf_still(&localcontext, seq, nr, ibufs_arr[i]);
-				BKE_sequencer_cache_put(&localcontext, seq, cfra, SEQ_STRIPELEM_IBUF, ibufs_arr[i]);
+				BKE_sequencer_cache_put(&localcontext, seq, cfra, SEQ_STRIPELEM_IBUF, ibufs_arr[i], 0.0f);
 			}
 
 			RE_ReleaseResultImage(re);
@@ -3509,7 +3668,9 @@ static ImBuf *do_render_strip_uncached(
 			float f_cfra;
 			SpeedControlVars *s = (SpeedControlVars *)seq->effectdata;
 
+			BLI_mutex_lock(&seq_render_lock);
 			BKE_sequence_effect_speed_rebuild_map(context->scene, seq, false);
+			BLI_mutex_unlock(&seq_render_lock);
 
 			/* weeek! */
 			f_cfra = seq->start + s->frameMap[(int)nr];
@@ -3595,6 +3756,7 @@ static ImBuf *seq_render_strip(
 	/* all effects are handled similarly with the exception of speed effect */
 	int type = (seq->type & SEQ_TYPE_EFFECT && seq->type != SEQ_TYPE_SPEED) ? SEQ_TYPE_EFFECT : seq->type;
 	bool is_preprocessed = !ELEM(type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP);
+	double start_time = PIL_check_seconds_timer();
 
 	ibuf = BKE_sequencer_cache_get(context, seq, cfra, SEQ_STRIPELEM_IBUF);
 
@@ -3602,7 +3764,7 @@ static ImBuf *seq_render_strip(
 		ibuf = copy_from_ibuf_still(context, seq, nr);
 
 		if (ibuf == NULL) {
-			ibuf = BKE_sequencer_preprocessed_cache_get(context, seq, cfra, SEQ_STRIPELEM_IBUF);
+			ibuf = BKE_sequencer_cache_get(context, seq, cfra, SEQ_STRIPELEM_IBUF_RAW);
 
 			if (ibuf == NULL) {
 				/* MOVIECLIPs have their own proxy management */
@@ -3618,7 +3780,8 @@ static ImBuf *seq_render_strip(
 					if (ELEM(seq->type, SEQ_TYPE_MOVIE, SEQ_TYPE_MOVIECLIP)) {
 						is_proxy_image = (context->preview_render_size != 100);
 					}
-					BKE_sequencer_preprocessed_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf);
+					BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF_RAW, ibuf,
+					                        PIL_check_seconds_timer() - start_time);
 				}
 			}
 		}
@@ -3647,7 +3810,7 @@ static ImBuf *seq_render_strip(
 	if (use_preprocess)
 		ibuf = input_preprocess(context, seq, cfra, ibuf, is_proxy_image, is_preprocessed);
 
-	BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf);
+	BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf, PIL_check_seconds_timer() - start_time);
 
 	return ibuf;
 }
@@ -3721,6 +3884,7 @@ static ImBuf *seq_render_strip_stack(
 	int count;
 	int i;
 	ImBuf *out = NULL;
+	double start_time = PIL_check_seconds_timer();
 
 	count = get_shown_sequences(seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
 
@@ -3785,7 +3949,8 @@ static ImBuf *seq_render_strip_stack(
 			out = seq_render_strip(context, state, seq, cfra);
 		}
 
-		BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+		BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP, out,
+		                        PIL_check_seconds_timer() - start_time);
 
 		return out;
 	}
@@ -3834,7 +3999,8 @@ static ImBuf *seq_render_strip_stack(
 		}
 	}
 
-	BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+	BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out,
+	                        PIL_check_seconds_timer() - start_time);
 
 	i++;
 
@@ -3851,7 +4017,8 @@ static ImBuf *seq_render_strip_stack(
 			IMB_freeImBuf(ibuf2);
 		}
 
-		BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+		BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out,
+		                        PIL_check_seconds_timer() - start_time);
 	}
 
 	return out;
@@ -3901,156 +4068,337 @@ ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra,
 	return seq_render_strip(context, &state, seq, cfra);
 }
 
-/* *********************** threading api ******************* */
+/* *********************** prefetch api ******************* */
+
+/* Frames following the one being displayed are rendered on the task scheduler
+ * threads into the sequencer cache, so playback finds them there.
+ * Every frame is rendered with its own copy of the render context, flagged with
+ * is_prefetch_render.
+ *
+ * Strip data which is initialized lazily during rendering (speed control maps) is
+ * protected by seq_render_lock, animation handles are opened and decoded under a lock
+ * of their strip. Scene and movie clip strips evaluate data outside of the sequencer
+ * and text strips use the global render font, they are never prefetched. Neither are
+ * scenes which animate strip settings.
+ *
+ * Any edit which invalidates the cache stops prefetching and waits for frames
+ * being rendered at that moment. */
 
-static ListBase running_threads;
-static ListBase prefetch_wait;
-static ListBase prefetch_done;
+typedef struct PrefetchQueueElem {
+	struct PrefetchQueueElem *next, *prev;
 
-static pthread_mutex_t queue_lock          = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t wakeup_lock         = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t wakeup_cond          = PTHREAD_COND_INITIALIZER;
+	SeqRenderData context;
+	float cfra;
+	int chanshown;
 
-//static pthread_mutex_t prefetch_ready_lock = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t  prefetch_ready_cond = PTHREAD_COND_INITIALIZER;
+	/* prefetch_generation at the moment the frame was requested */
+	int generation;
+	bool is_running;
+	/* the frame was rendered by the caller in the meantime, or is not wanted anymore */
+	bool skip;
+} PrefetchQueueElem;
 
-static pthread_mutex_t frame_done_lock     = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t frame_done_cond      = PTHREAD_COND_INITIALIZER;
+static ThreadMutex prefetch_lock = BLI_MUTEX_INITIALIZER;
+static ThreadCondition prefetch_done_cond;
+static TaskPool *prefetch_pool = NULL;
+static ListBase prefetch_queue = {NULL, NULL};
+static int prefetch_generation = 0;
+/* last frame which has been requested, frames up to it are rendered or queued */
+static float prefetch_last_cfra = 0.0f;
+static bool prefetch_last_cfra_valid = false;
 
-static volatile bool seq_thread_shutdown = true;
-static volatile int seq_last_given_monoton_cfra = 0;
-static int monoton_cfra = 0;
+static bool seq_prefetch_context_equal(const SeqRenderData *a, const SeqRenderData *b)
+{
+	return (a->scene == b->scene &&
+	        a->rectx == b->rectx &&
+	        a->recty == b->recty &&
+	        a->preview_render_size == b->preview_render_size &&
+	        a->view_id == b->view_id);
+}
 
-typedef struct PrefetchThread {
-	struct PrefetchThread *next, *prev;
+static void seq_prefetch_task(TaskPool * __restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	PrefetchQueueElem *elem = taskdata;
+	bool skip;
 
-	Scene *scene;
-	struct PrefetchQueueElem *current;
-	pthread_t pthread;
-	int running;
+	BLI_mutex_lock(&prefetch_lock);
+	skip = elem->skip || elem->generation != prefetch_generation;
+	elem->is_running = !skip;
+	BLI_mutex_unlock(&prefetch_lock);
 
-} PrefetchThread;
+	if (!skip) {
+		/* the result is stored in the cache by the render itself */
+		ImBuf *ibuf = BKE_sequencer_give_ibuf(&elem->context, elem->cfra, elem->chanshown);
 
-typedef struct PrefetchQueueElem {
-	struct PrefetchQueueElem *next, *prev;
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+		}
+	}
 
-	int rectx;
-	int recty;
-	float cfra;
-	int chanshown;
-	int preview_render_size;
+	/* elem itself is freed by the task pool */
+	BLI_mutex_lock(&prefetch_lock);
+	BLI_remlink(&prefetch_queue, elem);
+	BLI_condition_notify_all(&prefetch_done_cond);
+	BLI_mutex_unlock(&prefetch_lock);
+}
 
-	int monoton_cfra;
+/* caller is holding prefetch_lock */
+static PrefetchQueueElem *seq_prefetch_find(const SeqRenderData *context, float cfra, int chanshown)
+{
+	PrefetchQueueElem *elem;
 
-	ImBuf *ibuf;
-} PrefetchQueueElem;
+	for (elem = prefetch_queue.first; elem; elem = elem->next) {
+		if (elem->cfra == cfra &&
+		    elem->chanshown == chanshown &&
+		    !elem->skip &&
+		    seq_prefetch_context_equal(&elem->context, context))
+		{
+			return elem;
+		}
+	}
 
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chanshown)
+	return NULL;
+}
+
+/* caller is holding prefetch_lock */
+static void seq_prefetch_push(const SeqRenderData *context, float cfra, int chanshown)
 {
-	PrefetchQueueElem *e;
-	if (seq_thread_shutdown) {
+	PrefetchQueueElem *elem;
+
+	if (seq_prefetch_find(context, cfra, chanshown)) {
 		return;
 	}
 
-	e = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
-	e->rectx = context->rectx;
-	e->recty = context->recty;
-	e->cfra = cfra;
-	e->chanshown = chanshown;
-	e->preview_render_size = context->preview_render_size;
-	e->monoton_cfra = monoton_cfra++;
+	if (prefetch_pool == NULL) {
+		BLI_condition_init(&prefetch_done_cond);
+		prefetch_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+	}
 
-	pthread_mutex_lock(&queue_lock);
-	BLI_addtail(&prefetch_wait, e);
-	pthread_mutex_unlock(&queue_lock);
+	elem = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
+	elem->context = *context;
+	elem->context.is_prefetch_render = true;
+	elem->cfra = cfra;
+	elem->chanshown = chanshown;
+	elem->generation = prefetch_generation;
 
-	pthread_mutex_lock(&wakeup_lock);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_lock);
+	BLI_addtail(&prefetch_queue, elem);
+	BLI_task_pool_push(prefetch_pool, seq_prefetch_task, elem, true, TASK_PRIORITY_LOW);
 }
 
-ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+/* Scene strips update the whole scene while rendering and movie clips use the clip
+ * editor's cache. Text strips draw with the render font and its buffer, which are shared
+ * with the playback thread, effects rendering any of them as input are done by the same
+ * thread as well. Prefetching is not done for frames which show any of them. */
+static bool seq_prefetch_is_supported(Sequence *seq)
 {
-	PrefetchQueueElem *e = NULL;
-	bool found_something = false;
+	if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_TEXT)) {
+		return false;
+	}
 
-	if (seq_thread_shutdown) {
-		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
+	if ((seq->seq1 && !seq_prefetch_is_supported(seq->seq1)) ||
+	    (seq->seq2 && !seq_prefetch_is_supported(seq->seq2)) ||
+	    (seq->seq3 && !seq_prefetch_is_supported(seq->seq3)))
+	{
+		return false;
 	}
 
-	while (!e) {
-		bool success = false;
-		pthread_mutex_lock(&queue_lock);
+	return true;
+}
 
-		for (e = prefetch_done.first; e; e = e->next) {
-			if (cfra == e->cfra &&
-			    chanshown == e->chanshown &&
-			    context->rectx == e->rectx &&
-			    context->recty == e->recty &&
-			    context->preview_render_size == e->preview_render_size)
-			{
-				success = true;
-				found_something = true;
-				break;
-			}
+static bool seq_prefetch_fcurves_animate_strips(ListBase *fcurves)
+{
+	FCurve *fcu;
+
+	for (fcu = fcurves->first; fcu; fcu = fcu->next) {
+		if (fcu->rna_path && STRPREFIX(fcu->rna_path, "sequence_editor")) {
+			return true;
 		}
+	}
 
-		if (!e) {
-			for (e = prefetch_wait.first; e; e = e->next) {
-				if (cfra == e->cfra &&
-				    chanshown == e->chanshown &&
-				    context->rectx == e->rectx &&
-				    context->recty == e->recty &&
-				    context->preview_render_size == e->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
+	return false;
+}
+
+/* Frames are prefetched with the strip settings of the displayed frame. Animated settings
+ * (opacity, effect and transform settings...) aren't part of the cache key, and the strips
+ * are written by animation evaluation on the main thread while prefetch renders read them.
+ * So nothing is prefetched when the scene animates strip settings. */
+static bool seq_prefetch_scene_animates_strips(Scene *scene)
+{
+	AnimData *adt = scene->adt;
+	NlaTrack *nlt;
+	NlaStrip *strip;
+
+	if (adt == NULL) {
+		return false;
+	}
+
+	if (adt->action && seq_prefetch_fcurves_animate_strips(&adt->action->curves)) {
+		return true;
+	}
+	if (seq_prefetch_fcurves_animate_strips(&adt->drivers)) {
+		return true;
+	}
+	for (nlt = adt->nla_tracks.first; nlt; nlt = nlt->next) {
+		for (strip = nlt->strips.first; strip; strip = strip->next) {
+			if (strip->act && seq_prefetch_fcurves_animate_strips(&strip->act->curves)) {
+				return true;
 			}
 		}
+	}
 
-		if (!e) {
-			PrefetchThread *tslot;
+	return false;
+}
 
-			for (tslot = running_threads.first;
-			     tslot;
-			     tslot = tslot->next)
-			{
-				if (tslot->current &&
-				    cfra == tslot->current->cfra &&
-				    chanshown == tslot->current->chanshown &&
-				    context->rectx == tslot->current->rectx &&
-				    context->recty == tslot->current->recty &&
-				    context->preview_render_size == tslot->current->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
+/* Number of frames after cfra which can be prefetched. */
+static int seq_prefetch_frames_count(const SeqRenderData *context, float cfra)
+{
+	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
+	Sequence *seq;
+	size_t frame_size, mem_limit;
+	int count = U.prefetchframes;
+
+	if (ed == NULL || count <= 0) {
+		return 0;
+	}
+
+	if (seq_prefetch_scene_animates_strips(context->scene)) {
+		return 0;
+	}
+
+	/* Keep the prefetched frames well within the cache memory limit, otherwise they
+	 * would push each other (and the frame being displayed) out of the cache.
+	 * Frames are assumed to be float, which is the worst case. */
+	frame_size = (size_t)context->rectx * (size_t)context->recty * 4 * sizeof(float);
+	mem_limit = MEM_CacheLimiter_get_maximum();
+	if (frame_size > 0) {
+		count = (int)min_zz((size_t)count, mem_limit / 2 / frame_size);
+	}
+
+	/* stop at the end of the scene and before the first unsupported strip */
+	count = min_ii(count, context->scene->r.efra - (int)cfra);
+
+	SEQ_BEGIN (ed, seq)
+	{
+		if (!seq_prefetch_is_supported(seq) && seq->enddisp > cfra) {
+			count = min_ii(count, (int)max_ff(seq->startdisp - cfra - 1.0f, 0.0f));
 		}
+	}
+	SEQ_END;
 
-		/* e->ibuf is unrefed by render thread on next round. */
+	return max_ii(count, 0);
+}
+
+void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chanshown)
+{
+	if (context->is_prefetch_render || context->for_render) {
+		return;
+	}
 
-		if (e) {
-			seq_last_given_monoton_cfra = e->monoton_cfra;
+	BLI_mutex_lock(&prefetch_lock);
+	seq_prefetch_push(context, cfra, chanshown);
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+void BKE_sequencer_prefetch_stop(void)
+{
+	/* frames already being rendered are finished, so this has to happen before the scene
+	 * is modified, and it can't happen from the prefetch tasks themselves */
+	PrefetchQueueElem *elem, *elem_next;
+
+	BLI_mutex_lock(&prefetch_lock);
+	prefetch_generation++;
+	prefetch_last_cfra_valid = false;
+
+	/* Canceled elements are freed by the pool without going through seq_prefetch_task,
+	 * so unlink everything which isn't running yet. Unlinked elements which do start
+	 * before the cancel see the changed generation and don't render. */
+	for (elem = prefetch_queue.first; elem; elem = elem_next) {
+		elem_next = elem->next;
+
+		if (!elem->is_running) {
+			BLI_remlink(&prefetch_queue, elem);
+			elem->next = elem->prev = NULL;
 		}
+	}
+	BLI_mutex_unlock(&prefetch_lock);
 
-		pthread_mutex_unlock(&queue_lock);
+	if (prefetch_pool) {
+		BLI_task_pool_cancel(prefetch_pool);
+	}
 
-		if (!success) {
-			e = NULL;
+	BLI_assert(BLI_listbase_is_empty(&prefetch_queue));
+}
 
-			if (!found_something) {
-				fprintf(stderr, "SEQ-THREAD: Requested frame not in queue ???\n");
-				break;
-			}
-			pthread_mutex_lock(&frame_done_lock);
-			pthread_cond_wait(&frame_done_cond, &frame_done_lock);
-			pthread_mutex_unlock(&frame_done_lock);
+void BKE_sequencer_prefetch_free(void)
+{
+	BKE_sequencer_prefetch_stop();
+
+	if (prefetch_pool) {
+		BLI_task_pool_free(prefetch_pool);
+		prefetch_pool = NULL;
+		BLI_condition_end(&prefetch_done_cond);
+	}
+}
+
+/* Wait until all requested frames are rendered (or skipped). */
+void BKE_sequencer_prefetch_wait(void)
+{
+	BLI_mutex_lock(&prefetch_lock);
+	while (!BLI_listbase_is_empty(&prefetch_queue)) {
+		BLI_condition_wait(&prefetch_done_cond, &prefetch_lock);
+	}
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+/* Gives the frame like BKE_sequencer_give_ibuf, then requests rendering of the
+ * frames following it. If the frame is being prefetched it's waited for, if it is
+ * queued it's rendered right away and the queued render is skipped. */
+ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+{
+	PrefetchQueueElem *elem;
+	int count, i;
+	float first_cfra;
+
+	if (context->for_render || context->is_prefetch_render) {
+		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
+	}
+
+	BLI_mutex_lock(&prefetch_lock);
+	while ((elem = seq_prefetch_find(context, cfra, chanshown))) {
+		if (!elem->is_running) {
+			elem->skip = true;
+			break;
+		}
+		BLI_condition_wait(&prefetch_done_cond, &prefetch_lock);
+	}
+
+	/* frames which are not going to be displayed anymore */
+	for (elem = prefetch_queue.first; elem; elem = elem->next) {
+		if (elem->cfra < cfra || elem->chanshown != chanshown ||
+		    !seq_prefetch_context_equal(&elem->context, context))
+		{
+			elem->skip = true;
 		}
 	}
+	BLI_mutex_unlock(&prefetch_lock);
 
-	return e ? e->ibuf : NULL;
+	count = seq_prefetch_frames_count(context, cfra);
+
+	BLI_mutex_lock(&prefetch_lock);
+	first_cfra = cfra + 1.0f;
+	if (prefetch_last_cfra_valid && prefetch_last_cfra >= cfra && prefetch_last_cfra < cfra + count) {
+		first_cfra = prefetch_last_cfra + 1.0f;
+	}
+	for (i = (int)(first_cfra - cfra); i <= count; i++) {
+		seq_prefetch_push(context, cfra + i, chanshown);
+	}
+	if (count > 0) {
+		prefetch_last_cfra = cfra + count;
+		prefetch_last_cfra_valid = true;
+	}
+	BLI_mutex_unlock(&prefetch_lock);
+
+	return BKE_sequencer_give_ibuf(context, cfra, chanshown);
 }
 
 /* check whether sequence cur depends on seq */
@@ -4102,6 +4450,9 @@ static void sequence_invalidate_cache(Scene *scene, Sequence *seq, bool invalida
 {
 	Editing *ed = scene->ed;
 
+	/* prefetched frames would be rendered from the old state */
+	BKE_sequencer_prefetch_stop();
+
 	/* invalidate cache for current sequence */
 	if (invalidate_self) {
 		/* Animation structure holds some buffers inside,
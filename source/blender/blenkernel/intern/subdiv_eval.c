@@ -86,20 +86,24 @@ static void set_coarse_positions(Subdiv *subdiv, const Mesh *mesh)
 			BLI_BITMAP_ENABLE(vertex_used_map, loop->v);
 		}
 	}
-	for (int vertex_index = 0, manifold_veretx_index = 0;
-	     vertex_index < mesh->totvert;
-	     vertex_index++)
-	{
+	/* Gather coordinates into a continuous buffer, so they are all passed to
+	 * the evaluator with a single call instead of doing it per-vertex.
+	 */
+	float (*positions)[3] = MEM_malloc_arrayN(
+	        mesh->totvert, sizeof(float[3]), "subdiv coarse positions");
+	int manifold_vertex_count = 0;
+	for (int vertex_index = 0; vertex_index < mesh->totvert; vertex_index++) {
 		if (!BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
 			continue;
 		}
 		const MVert *vertex = &mvert[vertex_index];
-		subdiv->evaluator->setCoarsePositions(
-		        subdiv->evaluator,
-		        vertex->co,
-		        manifold_veretx_index, 1);
-		manifold_veretx_index++;
+		copy_v3_v3(positions[manifold_vertex_count], vertex->co);
+		manifold_vertex_count++;
 	}
+	subdiv->evaluator->setCoarsePositions(subdiv->evaluator,
+	                                      &positions[0][0],
+	                                      0, manifold_vertex_count);
+	MEM_freeN(positions);
 	MEM_freeN(vertex_used_map);
 }
 
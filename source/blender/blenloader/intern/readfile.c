@@ -2844,6 +2844,7 @@ static void direct_link_animdata(FileData *fd, AnimData *adt)
 	link_list(fd, &adt->drivers);
 	direct_link_fcurves(fd, &adt->drivers);
 	adt->driver_array = NULL;
+	adt->binding_cache = NULL;
 
 	/* link overrides */
 	// TODO...
@@ -5064,6 +5065,7 @@ static void direct_link_modifiers(FileData *fd, ListBase *lb)
 
 	for (md = lb->first; md; md = md->next) {
 		md->error = NULL;
+		md->runtime = NULL;
 
 		/* if modifiers disappear, or for upward compatibility */
 		if (NULL == modifierType_getInfo(md->type))
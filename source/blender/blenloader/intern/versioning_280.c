@@ -2729,6 +2729,14 @@ void blo_do_versions_280(FileData *fd, Library *UNUSED(lib), Main *bmain)
 			}
 		}
 
+		if (!DNA_struct_elem_find(fd->filesdna, "bNodeTree", "int", "cache_size")) {
+			for (Scene *scene = bmain->scene.first; scene; scene = scene->id.next) {
+				if (scene->nodetree) {
+					scene->nodetree->cache_size = 256;
+				}
+			}
+		}
+
 		/* Grease pencil target weight  */
 		if (!DNA_struct_elem_find(fd->filesdna, "GP_Sculpt_Settings", "float", "weight")) {
 			for (Scene *scene = bmain->scene.first; scene; scene = scene->id.next) {
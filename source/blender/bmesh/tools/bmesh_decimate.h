@@ -27,6 +27,12 @@
  *  \ingroup bmesh
  */
 
+void BM_mesh_decimate_collapse_ex(
+        BMesh *bm, const float factor,
+        float *vweights, float vweight_factor,
+        const bool do_triangulate,
+        const int symmetry_axis, const float symmetry_eps,
+        const bool use_threading);
 void BM_mesh_decimate_collapse(
         BMesh *bm, const float factor,
         float *vweights, float vweight_factor,
@@ -40,6 +40,8 @@
 #include "BLI_edgehash.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines_stack.h"
 
 
@@ -73,6 +75,19 @@
 #define OPTIMIZE_EPS 1e-8
 #define COST_INVALID FLT_MAX
 
+/* Minimum number of elements to calculate initial quadrics and costs on
+ * multiple threads, below this threading overhead isn't worth it. */
+#define DECIM_THREADED_MIN 1024
+
+/* Meshes with at least twice this many faces (after triangulating) are split into regions,
+ * the regions are decimated independently, see #bm_decim_collapse_regions. */
+#define DECIM_REGION_FACES_MIN 32768
+#define DECIM_REGIONS_MAX 64
+/* Regions only do this much of their share of collapses, what is left is done in a single heap,
+ * so cheap edges at the region borders are collapsed as well. */
+#define DECIM_REGION_COLLAPSE_FAC 0.9f
+#define DECIM_REGION_SPLIT_BINS 256
+
 typedef enum CD_UseFlag {
 	CD_DO_VERT = (1 << 0),
 	CD_DO_EDGE = (1 << 1),
@@ -83,35 +98,68 @@ typedef enum CD_UseFlag {
 /* BMesh Helper Functions
  * ********************** */
 
+typedef struct FaceQuadricData {
+	BMFace **ftable;
+	Quadric *fquadrics;
+} FaceQuadricData;
+
+static void bm_decim_build_face_quadric_cb(
+        void *__restrict userdata,
+        const int index,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	FaceQuadricData *data = userdata;
+	BMFace *f = data->ftable[index];
+	float center[3];
+	double plane_db[4];
+
+	BM_face_calc_center_median(f, center);
+	copy_v3db_v3fl(plane_db, f->no);
+	plane_db[3] = -dot_v3db_v3fl(plane_db, center);
+
+	BLI_quadric_from_plane(&data->fquadrics[index], plane_db);
+}
+
 /**
  * \param vquadrics: must be calloc'd
  */
-static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics)
+static void bm_decim_build_quadrics(BMesh *bm, Quadric *vquadrics, const bool use_threading)
 {
 	BMIter iter;
 	BMFace *f;
 	BMEdge *e;
-
-	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+	int i;
+
+	/* Face planes are calculated on multiple threads, vertex quadrics are
+	 * accumulated afterwards in face order, so they don't depend on the
+	 * number of threads. */
+	FaceQuadricData data;
+	BM_mesh_elem_table_ensure(bm, BM_FACE);
+	data.ftable = bm->ftable;
+	data.fquadrics = MEM_mallocN(sizeof(Quadric) * bm->totface, __func__);
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = use_threading && (bm->totface >= DECIM_THREADED_MIN);
+	BLI_task_parallel_range(
+	        0, bm->totface,
+	        &data,
+	        bm_decim_build_face_quadric_cb,
+	        &settings);
+
+	BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
 		BMLoop *l_first;
 		BMLoop *l_iter;
-
-		float center[3];
-		double plane_db[4];
-		Quadric q;
-
-		BM_face_calc_center_median(f, center);
-		copy_v3db_v3fl(plane_db, f->no);
-		plane_db[3] = -dot_v3db_v3fl(plane_db, center);
-
-		BLI_quadric_from_plane(&q, plane_db);
+		const Quadric *q = &data.fquadrics[i];
 
 		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
 		do {
-			BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(l_iter->v)], &q);
+			BLI_quadric_add_qu_qu(&vquadrics[BM_elem_index_get(l_iter->v)], q);
 		} while ((l_iter = l_iter->next) != l_first);
 	}
 
+	MEM_freeN(data.fquadrics);
+
 	/* boundary edges */
 	BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
 		if (UNLIKELY(BM_edge_is_boundary(e))) {
@@ -248,11 +296,17 @@ static float bm_decim_build_edge_cost_single__topology(BMEdge *e)
 
 #endif  /* USE_TOPOLOGY_FALLBACK */
 
-static void bm_decim_build_edge_cost_single(
+/**
+ * Calculate collapse cost of the edge.
+ *
+ * \return false when the edge must not be collapsed at all.
+ * \note Only reads the mesh, so it's safe to call from multiple threads.
+ */
+static bool bm_decim_calc_edge_cost(
         BMEdge *e,
         const Quadric *vquadrics,
         const float *vweights, const float vweight_factor,
-        Heap *eheap, HeapNode **eheap_table)
+        float *r_cost)
 {
 	float cost;
 
@@ -260,7 +314,7 @@ static void bm_decim_build_edge_cost_single(
 	             ((vweights[BM_elem_index_get(e->v1)] == 0.0f) ||
 	              (vweights[BM_elem_index_get(e->v2)] == 0.0f))))
 	{
-		goto clear;
+		return false;
 	}
 
 	/* check we can collapse, some edges we better not touch */
@@ -270,7 +324,7 @@ static void bm_decim_build_edge_cost_single(
 		}
 		else {
 			/* only collapse tri's */
-			goto clear;
+			return false;
 		}
 	}
 	else if (BM_edge_is_manifold(e)) {
@@ -279,11 +333,11 @@ static void bm_decim_build_edge_cost_single(
 		}
 		else {
 			/* only collapse tri's */
-			goto clear;
+			return false;
 		}
 	}
 	else {
-		goto clear;
+		return false;
 	}
 	/* end sanity check */
 
@@ -337,14 +391,27 @@ static void bm_decim_build_edge_cost_single(
 		}
 	}
 
-	BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
-	return;
+	*r_cost = cost;
+	return true;
+}
 
-clear:
-	if (eheap_table[BM_elem_index_get(e)]) {
-		BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
+static void bm_decim_build_edge_cost_single(
+        BMEdge *e,
+        const Quadric *vquadrics,
+        const float *vweights, const float vweight_factor,
+        Heap *eheap, HeapNode **eheap_table)
+{
+	float cost;
+
+	if (bm_decim_calc_edge_cost(e, vquadrics, vweights, vweight_factor, &cost)) {
+		BLI_heap_insert_or_update(eheap, &eheap_table[BM_elem_index_get(e)], cost, e);
+	}
+	else {
+		if (eheap_table[BM_elem_index_get(e)]) {
+			BLI_heap_remove(eheap, eheap_table[BM_elem_index_get(e)]);
+		}
+		eheap_table[BM_elem_index_get(e)] = NULL;
 	}
-	eheap_table[BM_elem_index_get(e)] = NULL;
 }
 
 
@@ -358,20 +425,75 @@ static void bm_decim_invalid_edge_cost_single(
 	eheap_table[BM_elem_index_get(e)] = BLI_heap_insert(eheap, COST_INVALID, e);
 }
 
+typedef struct EdgeCostData {
+	BMEdge **etable;
+	const Quadric *vquadrics;
+	const float *vweights;
+	float vweight_factor;
+	/* Edge index aligned, cost is only valid when use_edge is set. */
+	float *costs;
+	bool *use_edge;
+} EdgeCostData;
+
+static void bm_decim_build_edge_cost_cb(
+        void *__restrict userdata,
+        const int index,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	EdgeCostData *data = userdata;
+	data->use_edge[index] = bm_decim_calc_edge_cost(
+	        data->etable[index], data->vquadrics, data->vweights, data->vweight_factor,
+	        &data->costs[index]);
+}
+
+/**
+ * Calculate the cost of all edges, the caller fills heaps from \a data and frees the arrays.
+ * Costs are calculated on multiple threads, heaps are filled afterwards in edge order,
+ * so collapse order matches a single threaded build.
+ */
+static void bm_decim_calc_edge_costs(
+        BMesh *bm,
+        const Quadric *vquadrics,
+        const float *vweights, const float vweight_factor,
+        const bool use_threading,
+        EdgeCostData *data)
+{
+	BM_mesh_elem_table_ensure(bm, BM_EDGE);
+	data->etable = bm->etable;
+	data->vquadrics = vquadrics;
+	data->vweights = vweights;
+	data->vweight_factor = vweight_factor;
+	data->costs = MEM_mallocN(sizeof(*data->costs) * bm->totedge, __func__);
+	data->use_edge = MEM_mallocN(sizeof(*data->use_edge) * bm->totedge, __func__);
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = use_threading && (bm->totedge >= DECIM_THREADED_MIN);
+	BLI_task_parallel_range(
+	        0, bm->totedge,
+	        data,
+	        bm_decim_build_edge_cost_cb,
+	        &settings);
+}
+
 static void bm_decim_build_edge_cost(
         BMesh *bm,
         const Quadric *vquadrics,
         const float *vweights, const float vweight_factor,
-        Heap *eheap, HeapNode **eheap_table)
+        Heap *eheap, HeapNode **eheap_table,
+        const bool use_threading)
 {
-	BMIter iter;
-	BMEdge *e;
-	uint i;
+	EdgeCostData data;
+	bm_decim_calc_edge_costs(bm, vquadrics, vweights, vweight_factor, use_threading, &data);
 
-	BM_ITER_MESH_INDEX (e, &iter, bm, BM_EDGES_OF_MESH, i) {
-		eheap_table[i] = NULL;  /* keep sanity check happy */
-		bm_decim_build_edge_cost_single(e, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+	for (int i = 0; i < bm->totedge; i++) {
+		BMEdge *e = data.etable[i];
+		BLI_assert(BM_elem_index_get(e) == i);
+		eheap_table[i] = (data.use_edge[i]) ? BLI_heap_insert(eheap, data.costs[i], e) : NULL;
 	}
+
+	MEM_freeN(data.costs);
+	MEM_freeN(data.use_edge);
 }
 
 #ifdef USE_SYMMETRY
@@ -961,11 +1083,12 @@ static bool bm_edge_collapse(
 #endif
 #ifdef USE_CUSTOMDATA
         const CD_UseFlag customdata_flag,
-        const float customdata_fac
+        const float customdata_fac,
 #else
         const CD_UseFlag UNUSED(customdata_flag),
-        const float UNUSED(customdata_fac)
+        const float UNUSED(customdata_fac),
 #endif
+        ThreadMutex *kill_lock
         )
 {
 	BMVert *v_other;
@@ -1039,6 +1162,11 @@ static bool bm_edge_collapse(
 		}
 #endif
 
+		/* freeing elements changes the mesh totals and memory pools */
+		if (kill_lock) {
+			BLI_mutex_lock(kill_lock);
+		}
+
 		BM_edge_kill(bm, e_clear);
 
 		v_other->head.hflag |= v_clear->head.hflag;
@@ -1049,6 +1177,10 @@ static bool bm_edge_collapse(
 		BM_edge_splice(bm, e_a_other[1], e_a_other[0]);
 		BM_edge_splice(bm, e_b_other[1], e_b_other[0]);
 
+		if (kill_lock) {
+			BLI_mutex_unlock(kill_lock);
+		}
+
 #ifdef USE_SYMMETRY
 		/* update mirror map */
 		if (edge_symmetry_map) {
@@ -1100,6 +1232,10 @@ static bool bm_edge_collapse(
 		}
 #endif
 
+		if (kill_lock) {
+			BLI_mutex_lock(kill_lock);
+		}
+
 		BM_edge_kill(bm, e_clear);
 
 		v_other->head.hflag |= v_clear->head.hflag;
@@ -1108,6 +1244,10 @@ static bool bm_edge_collapse(
 		e_a_other[1]->head.hflag |= e_a_other[0]->head.hflag;
 		BM_edge_splice(bm, e_a_other[1], e_a_other[0]);
 
+		if (kill_lock) {
+			BLI_mutex_unlock(kill_lock);
+		}
+
 #ifdef USE_SYMMETRY
 		/* update mirror map */
 		if (edge_symmetry_map) {
@@ -1130,6 +1270,7 @@ static bool bm_edge_collapse(
 /**
  * Collapse e the edge, removing e->v2
  *
+ * \param kill_lock: Held while freeing elements, when other threads collapse edges of the mesh.
  * \return true when the edge was collapsed.
  */
 static bool bm_decim_edge_collapse(
@@ -1141,7 +1282,8 @@ static bool bm_decim_edge_collapse(
         int *edge_symmetry_map,
 #endif
         const CD_UseFlag customdata_flag,
-        float optimize_co[3], bool optimize_co_calc
+        float optimize_co[3], bool optimize_co_calc,
+        ThreadMutex *kill_lock
         )
 {
 	int e_clear_other[2];
@@ -1192,7 +1334,8 @@ static bool bm_decim_edge_collapse(
 #ifdef USE_SYMMETRY
 	        edge_symmetry_map,
 #endif
-	        customdata_flag, customdata_fac))
+	        customdata_flag, customdata_fac,
+	        kill_lock))
 	{
 		/* update collapse info */
 		int i;
@@ -1276,6 +1419,271 @@ static bool bm_decim_edge_collapse(
 }
 
 
+/* Region Decimation
+ * ***************** */
+
+/* Large meshes are split into spatial regions (by vertex). Each region collapses edges from its own
+ * heap, on multiple threads. An edge is only collapsed by its region when all vertices connected
+ * to it belong to the region too. Collapsing reads and writes nothing beyond the faces around the
+ * edge and the edges between those vertices, so regions never touch the same elements.
+ * Only freeing elements (mesh totals, memory pools) is done under a lock.
+ *
+ * Edges between regions are locked, they are collapsed afterwards by a single heap of all edges,
+ * along with anything the regions left. Regions are only based on the mesh, not the number of
+ * threads, so the result is the same with or without threading. */
+
+static int bm_decim_regions_count(const BMesh *bm)
+{
+	int tot_regions = 1;
+
+	while ((tot_regions * 2 <= DECIM_REGIONS_MAX) &&
+	       (bm->totface / (tot_regions * 2) >= DECIM_REGION_FACES_MIN))
+	{
+		tot_regions *= 2;
+	}
+	return tot_regions;
+}
+
+BLI_INLINE int bm_decim_region_split_bin(const float co[3], const float bounds[2][3], const int axis)
+{
+	const float size = bounds[1][axis] - bounds[0][axis];
+	int bin = 0;
+
+	if (size > 0.0f) {
+		bin = (int)(((co[axis] - bounds[0][axis]) / size) * DECIM_REGION_SPLIT_BINS);
+		CLAMP(bin, 0, DECIM_REGION_SPLIT_BINS - 1);
+	}
+	return bin;
+}
+
+/**
+ * Split vertices into \a tot_regions (a power of two) regions of about the same size,
+ * each split is done at the median of the longest axis of the region.
+ *
+ * \return vertex index aligned region indices.
+ */
+static int *bm_decim_regions_build(BMesh *bm, const int tot_regions)
+{
+	BMIter iter;
+	BMVert *v;
+	int i;
+
+	int *vregions = MEM_callocN(sizeof(*vregions) * bm->totvert, __func__);
+	float (*bounds)[2][3] = MEM_mallocN(sizeof(*bounds) * tot_regions, __func__);
+	int *axis = MEM_mallocN(sizeof(*axis) * tot_regions, __func__);
+	int *split_bin = MEM_mallocN(sizeof(*split_bin) * tot_regions, __func__);
+	int (*bins)[DECIM_REGION_SPLIT_BINS] = MEM_mallocN(sizeof(*bins) * tot_regions, __func__);
+
+	for (int tot = 1; tot < tot_regions; tot *= 2) {
+		for (int r = 0; r < tot; r++) {
+			INIT_MINMAX(bounds[r][0], bounds[r][1]);
+		}
+		BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+			const int r = vregions[i];
+			minmax_v3v3_v3(bounds[r][0], bounds[r][1], v->co);
+		}
+
+		memset(bins, 0, sizeof(*bins) * tot);
+		for (int r = 0; r < tot; r++) {
+			float size[3];
+			sub_v3_v3v3(size, bounds[r][1], bounds[r][0]);
+			axis[r] = axis_dominant_v3_single(size);
+		}
+		BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+			const int r = vregions[i];
+			bins[r][bm_decim_region_split_bin(v->co, bounds[r], axis[r])]++;
+		}
+
+		for (int r = 0; r < tot; r++) {
+			int tot_vert = 0, tot_vert_half = 0;
+			for (int b = 0; b < DECIM_REGION_SPLIT_BINS; b++) {
+				tot_vert += bins[r][b];
+			}
+			for (split_bin[r] = 0; split_bin[r] < DECIM_REGION_SPLIT_BINS - 1; split_bin[r]++) {
+				tot_vert_half += bins[r][split_bin[r]];
+				if (tot_vert_half * 2 >= tot_vert) {
+					break;
+				}
+			}
+		}
+
+		BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+			const int r = vregions[i];
+			vregions[i] = (r * 2) + (bm_decim_region_split_bin(v->co, bounds[r], axis[r]) > split_bin[r]);
+		}
+	}
+
+	MEM_freeN(bounds);
+	MEM_freeN(axis);
+	MEM_freeN(split_bin);
+	MEM_freeN(bins);
+
+	return vregions;
+}
+
+/**
+ * Check the edge can be collapsed by the region: all vertices connected to either of its
+ * vertices are in the region.
+ */
+static bool bm_decim_edge_is_region_local(BMEdge *e, const int *vregions, const int region)
+{
+	for (int i = 0; i < 2; i++) {
+		BMVert *v = *((&e->v1) + i);
+		BMEdge *e_iter = v->e;
+		do {
+			if (vregions[BM_elem_index_get(BM_edge_other_vert(e_iter, v))] != region) {
+				return false;
+			}
+		} while ((e_iter = bmesh_disk_edge_next(e_iter, v)) != v->e);
+	}
+	return true;
+}
+
+typedef struct DecimRegionData {
+	BMesh *bm;
+	Quadric *vquadrics;
+	float *vweights;
+	float vweight_factor;
+	CD_UseFlag customdata_flag;
+
+	const int *vregions;
+	/* region aligned */
+	Heap **eheaps;
+	int *face_remove_tot;
+	/* edge index aligned, nodes are in the heap of the region of the edge */
+	HeapNode **eheap_table;
+
+	ThreadMutex kill_lock;
+} DecimRegionData;
+
+static void bm_decim_collapse_region_cb(
+        void *__restrict userdata,
+        const int region,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	DecimRegionData *data = userdata;
+	Heap *eheap = data->eheaps[region];
+	int face_remove_tot = data->face_remove_tot[region];
+
+	while ((face_remove_tot > 0) &&
+	       (BLI_heap_is_empty(eheap) == false) &&
+	       (BLI_heap_top_value(eheap) != COST_INVALID))
+	{
+		BMEdge *e = BLI_heap_pop_min(eheap);
+		float optimize_co[3];
+
+		data->eheap_table[BM_elem_index_get(e)] = NULL;
+
+		if (!bm_decim_edge_is_region_local(e, data->vregions, region)) {
+			/* left for the single heap */
+			continue;
+		}
+
+		/* collapsible edges have one or two triangles */
+		const int e_face_tot = BM_edge_is_manifold(e) ? 2 : 1;
+
+		if (bm_decim_edge_collapse(
+		        data->bm, e, data->vquadrics, data->vweights, data->vweight_factor,
+		        eheap, data->eheap_table,
+#ifdef USE_SYMMETRY
+		        NULL,
+#endif
+		        data->customdata_flag,
+		        optimize_co, true,
+		        &data->kill_lock))
+		{
+			face_remove_tot -= e_face_tot;
+		}
+	}
+}
+
+/**
+ * Collapse edges inside of regions, leaving edges between regions untouched.
+ *
+ * \param face_tot_target: Number of faces wanted for the whole mesh.
+ */
+static void bm_decim_collapse_regions(
+        BMesh *bm, const int tot_regions, const int face_tot_target,
+        Quadric *vquadrics,
+        float *vweights, const float vweight_factor,
+        HeapNode **eheap_table,
+        const CD_UseFlag customdata_flag,
+        const bool use_threading)
+{
+	DecimRegionData data;
+	BMIter iter;
+	BMFace *f;
+	EdgeCostData cost_data;
+	const float face_remove_fac = (1.0f - ((float)face_tot_target / (float)bm->totface)) * DECIM_REGION_COLLAPSE_FAC;
+
+	data.bm = bm;
+	data.vquadrics = vquadrics;
+	data.vweights = vweights;
+	data.vweight_factor = vweight_factor;
+	data.customdata_flag = customdata_flag;
+	data.vregions = bm_decim_regions_build(bm, tot_regions);
+	data.eheaps = MEM_mallocN(sizeof(*data.eheaps) * tot_regions, __func__);
+	data.face_remove_tot = MEM_callocN(sizeof(*data.face_remove_tot) * tot_regions, __func__);
+	data.eheap_table = eheap_table;
+	BLI_mutex_init(&data.kill_lock);
+
+	for (int r = 0; r < tot_regions; r++) {
+		data.eheaps[r] = BLI_heap_new();
+	}
+
+	/* edges between regions aren't added to any heap */
+	bm_decim_calc_edge_costs(bm, vquadrics, vweights, vweight_factor, use_threading, &cost_data);
+	for (int i = 0; i < bm->totedge; i++) {
+		BMEdge *e = cost_data.etable[i];
+		const int region = data.vregions[BM_elem_index_get(e->v1)];
+		BLI_assert(BM_elem_index_get(e) == i);
+		if (cost_data.use_edge[i] && (region == data.vregions[BM_elem_index_get(e->v2)])) {
+			eheap_table[i] = BLI_heap_insert(data.eheaps[region], cost_data.costs[i], e);
+		}
+		else {
+			eheap_table[i] = NULL;
+		}
+	}
+	MEM_freeN(cost_data.costs);
+	MEM_freeN(cost_data.use_edge);
+
+	/* each region removes its share of the faces inside of it */
+	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+		BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
+		BMLoop *l_iter = l_first;
+		const int region = data.vregions[BM_elem_index_get(l_first->v)];
+		while (((l_iter = l_iter->next) != l_first) && (data.vregions[BM_elem_index_get(l_iter->v)] == region)) {
+			/* pass */
+		}
+		if (l_iter == l_first) {
+			data.face_remove_tot[region]++;
+		}
+	}
+	for (int r = 0; r < tot_regions; r++) {
+		data.face_remove_tot[r] = (int)((float)data.face_remove_tot[r] * face_remove_fac);
+	}
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = use_threading;
+	settings.min_iter_per_thread = 1;
+	BLI_task_parallel_range(
+	        0, tot_regions,
+	        &data,
+	        bm_decim_collapse_region_cb,
+	        &settings);
+
+	for (int r = 0; r < tot_regions; r++) {
+		BLI_heap_free(data.eheaps[r], NULL);
+	}
+
+	BLI_mutex_end(&data.kill_lock);
+	MEM_freeN((void *)data.vregions);
+	MEM_freeN(data.eheaps);
+	MEM_freeN(data.face_remove_tot);
+}
+
+
 /* Main Decimate Function
  * ********************** */
 
@@ -1287,13 +1695,16 @@ static bool bm_decim_edge_collapse(
  *        a vertex group is the usual source for this.
  * \param symmetry_axis: Axis of symmetry, -1 to disable mirror decimate.
  * \param symmetry_eps: Threshold when matching mirror verts.
+ * \param use_threading: Calculate the initial quadrics and edge costs and decimate regions of
+ *        large meshes on multiple threads, the result is the same either way.
  */
-void BM_mesh_decimate_collapse(
+void BM_mesh_decimate_collapse_ex(
         BMesh *bm,
         const float factor,
         float *vweights, float vweight_factor,
         const bool do_triangulate,
-        const int symmetry_axis, const float symmetry_eps)
+        const int symmetry_axis, const float symmetry_eps,
+        const bool use_threading)
 {
 	Heap *eheap;             /* edge heap */
 	HeapNode **eheap_table;  /* edge index aligned table pointing to the eheap */
@@ -1326,18 +1737,9 @@ void BM_mesh_decimate_collapse(
 
 
 	/* build initial edge collapse cost data */
-	bm_decim_build_quadrics(bm, vquadrics);
-
-	bm_decim_build_edge_cost(bm, vquadrics, vweights, vweight_factor, eheap, eheap_table);
+	bm_decim_build_quadrics(bm, vquadrics, use_threading);
 
 	face_tot_target = bm->totface * factor;
-	bm->elem_index_dirty |= BM_ALL;
-
-#ifdef USE_SYMMETRY
-	edge_symmetry_map = (use_symmetry) ? bm_edge_symmetry_map(bm, symmetry_axis, symmetry_eps) : NULL;
-#else
-	UNUSED_VARS(symmetry_axis, symmetry_eps);
-#endif
 
 #ifdef USE_CUSTOMDATA
 	/* initialize customdata flag, we only need math for loops */
@@ -1346,6 +1748,31 @@ void BM_mesh_decimate_collapse(
 	if (CustomData_has_math(&bm->ldata))    customdata_flag |= CD_DO_LOOP;
 #endif
 
+	/* the mirror edge of an edge may be in another region, symmetric decimation is never split */
+#ifdef USE_SYMMETRY
+	if (use_symmetry == false)
+#endif
+	{
+		const int tot_regions = bm_decim_regions_count(bm);
+		if (tot_regions > 1) {
+			bm_decim_collapse_regions(
+			        bm, tot_regions, face_tot_target, vquadrics, vweights, vweight_factor, eheap_table,
+			        customdata_flag, use_threading);
+			/* vertex indices stay, they are used for the quadrics */
+			BM_mesh_elem_index_ensure(bm, BM_EDGE);
+		}
+	}
+
+	bm_decim_build_edge_cost(bm, vquadrics, vweights, vweight_factor, eheap, eheap_table, use_threading);
+
+	bm->elem_index_dirty |= BM_ALL;
+
+#ifdef USE_SYMMETRY
+	edge_symmetry_map = (use_symmetry) ? bm_edge_symmetry_map(bm, symmetry_axis, symmetry_eps) : NULL;
+#else
+	UNUSED_VARS(symmetry_axis, symmetry_eps);
+#endif
+
 	/* iterative edge collapse and maintain the eheap */
 #ifdef USE_SYMMETRY
 	if (use_symmetry == false)
@@ -1371,7 +1798,8 @@ void BM_mesh_decimate_collapse(
 			        edge_symmetry_map,
 #endif
 			        customdata_flag,
-			        optimize_co, true
+			        optimize_co, true,
+			        NULL
 			        );
 		}
 	}
@@ -1452,7 +1880,8 @@ void BM_mesh_decimate_collapse(
 			        bm, e, vquadrics, vweights, vweight_factor, eheap, eheap_table,
 			        edge_symmetry_map,
 			        customdata_flag,
-			        optimize_co, false))
+			        optimize_co, false,
+			        NULL))
 			{
 				if (e_mirr && (eheap_table[e_index_mirr])) {
 					BLI_assert(e_index_mirr != e_index);
@@ -1463,7 +1892,8 @@ void BM_mesh_decimate_collapse(
 					        bm, e_mirr, vquadrics, vweights, vweight_factor, eheap, eheap_table,
 					        edge_symmetry_map,
 					        customdata_flag,
-					        optimize_co, false);
+					        optimize_co, false,
+					        NULL);
 				}
 			}
 			else {
@@ -1513,3 +1943,15 @@ invalidate:
 
 	(void)tot_edge_orig;  /* quiet release build warning */
 }
+
+void BM_mesh_decimate_collapse(
+        BMesh *bm,
+        const float factor,
+        float *vweights, float vweight_factor,
+        const bool do_triangulate,
+        const int symmetry_axis, const float symmetry_eps)
+{
+	BM_mesh_decimate_collapse_ex(
+	        bm, factor, vweights, vweight_factor, do_triangulate,
+	        symmetry_axis, symmetry_eps, true);
+}
@@ -145,7 +145,10 @@ extern "C" {
  * ExecutionGroup A) is asked to calculate the area ExecutionGroup B is missing.
  * [@ref ExecutionGroup.scheduleAreaWhenPossible]
  * ExecutionGroup B checks what chunks the area spans, and tries to schedule these chunks.
- * If all input data is available these chunks are scheduled [@ref ExecutionGroup.scheduleChunk]
+ * Together the chunks form a dependency graph: every chunk counts the input chunks it is waiting for and
+ * is registered with them. When all input data is available a chunk is scheduled [@ref ExecutionGroup.scheduleChunks]
+ * The worker thread that finishes the last missing input chunk schedules the waiting chunk, so chunks of
+ * different ExecutionGroups can be executed at the same time.
  *
  * <pre>
  *
@@ -169,7 +172,7 @@ extern "C" {
  *            .                                .  .                                         .  O-------/
  *            .                                .  .                                         .  O
  *            .                                .  .                                         .  O
- *            .                                .  .                                         .  O-------\ ExecutionGroup.scheduleChunk
+ *            .                                .  .                                         .  O-------\ ExecutionGroup.scheduleChunks
  *            .                                .  .                                         .  .       |
  *            .                                .  .                                         .  .  O----/
  *            .                                .  .                                         .  O<=O
@@ -211,7 +214,7 @@ extern "C" {
  * checks if all input data is available. Can trigger dependent chunks to be calculated
  * \see ExecutionGroup.scheduleAreaWhenPossible Tries to schedule an area. This can be multiple chunks
  * (is called from [@ref ExecutionGroup.scheduleChunkWhenPossible])
- * \see ExecutionGroup.scheduleChunk Schedule a chunk on the WorkScheduler
+ * \see ExecutionGroup.scheduleChunks Schedule chunks on the WorkScheduler
  * \see NodeOperation.determineDependingAreaOfInterest Influence the area of interest of a chunk.
  * \see WriteBufferOperation Operation to write to a MemoryProxy/MemoryBuffer
  * \see ReadBufferOperation Operation to read from a MemoryProxy/MemoryBuffer
@@ -329,7 +332,7 @@ void COM_deinitialize(void);
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 #ifdef __cplusplus
 }
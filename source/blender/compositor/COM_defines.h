@@ -111,4 +111,23 @@ typedef enum OrderOfChunks {
 
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * \brief Execute non-complex operations a row at a time instead of pixel by pixel
+ * \see SocketReader.executeRow
+ * \ingroup Execution
+ */
+#define COM_ROW_EXECUTION
+
+/**
+ * \brief maximum number of pixels passed to SocketReader.executeRow in one call
+ * Longer rows are split, so operations can keep their row buffers on the stack.
+ */
+#define COM_ROW_LENGTH 128
+
+/**
+ * \brief minimum kernel area in pixels for which blurs use FFTConvolution instead of convolving spatially
+ * \see FFTConvolution
+ */
+#define COM_FFT_CONVOLUTION_MIN_AREA (32 * 32)
+
 #endif  /* __COM_DEFINES_H__ */
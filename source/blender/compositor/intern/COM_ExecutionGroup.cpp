@@ -25,8 +25,6 @@
 #include <sstream>
 #include <stdlib.h>
 
-#include "atomic_ops.h"
-
 #include "COM_ExecutionGroup.h"
 #include "COM_defines.h"
 #include "COM_ExecutionSystem.h"
@@ -40,16 +38,43 @@
 #include "MEM_guardedalloc.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLT_translation.h"
 #include "PIL_time.h"
 #include "WM_api.h"
 #include "WM_types.h"
 
+/* The chunk dependency graph spans all execution groups and is updated from the worker threads
+ * when chunks finish, it is protected by a single lock. The condition wakes up the thread
+ * executing the output group whenever a chunk finishes. */
+static ThreadMutex g_scheduleMutex = BLI_MUTEX_INITIALIZER;
+static ThreadCondition g_scheduleCondition;
+static bool g_scheduleInitialized = false;
+/* number of chunks in the dependency graph that aren't executed yet */
+static unsigned int g_chunksScheduled = 0;
+
+void ExecutionGroup::initializeScheduling()
+{
+	if (!g_scheduleInitialized) {
+		BLI_condition_init(&g_scheduleCondition);
+		g_scheduleInitialized = true;
+	}
+}
+
+void ExecutionGroup::deinitializeScheduling()
+{
+	if (g_scheduleInitialized) {
+		BLI_condition_end(&g_scheduleCondition);
+		g_scheduleInitialized = false;
+	}
+}
+
 ExecutionGroup::ExecutionGroup()
 {
 	this->m_isOutput = false;
 	this->m_complex = false;
 	this->m_chunkExecutionStates = NULL;
+	this->m_chunkDependencies = NULL;
 	this->m_bTree = NULL;
 	this->m_height = 0;
 	this->m_width = 0;
@@ -122,6 +147,8 @@ void ExecutionGroup::initExecution()
 		for (index = 0; index < this->m_numberOfChunks; index++) {
 			this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
 		}
+		this->m_chunkDependencies = (unsigned int *)MEM_callocN(sizeof(unsigned int) * this->m_numberOfChunks, __func__);
+		this->m_chunkDependents.resize(this->m_numberOfChunks);
 	}
 
 
@@ -146,12 +173,35 @@ void ExecutionGroup::deinitExecution()
 		MEM_freeN(this->m_chunkExecutionStates);
 		this->m_chunkExecutionStates = NULL;
 	}
+	if (this->m_chunkDependencies != NULL) {
+		MEM_freeN(this->m_chunkDependencies);
+		this->m_chunkDependencies = NULL;
+	}
+	this->m_chunkDependents.clear();
 	this->m_numberOfChunks = 0;
 	this->m_numberOfXChunks = 0;
 	this->m_numberOfYChunks = 0;
 	this->m_cachedReadOperations.clear();
 	this->m_bTree = NULL;
 }
+
+void ExecutionGroup::setAllChunksExecuted()
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+}
+
+bool ExecutionGroup::isAllChunksExecuted() const
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void ExecutionGroup::determineResolution(unsigned int resolution[2])
 {
 	NodeOperation *operation = this->getOutputOperation();
@@ -304,46 +354,60 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	DebugInfo::execution_group_started(this);
 	DebugInfo::graphviz(graph);
 
+	/* Output chunks are added to the chunk dependency graph in chunk order, a limited number at a
+	 * time so the order stays visible. Chunks of other groups are scheduled as soon as the input
+	 * chunks they need are executed, so execution groups overlap. */
 	bool breaked = false;
-	bool finished = false;
-	unsigned int startIndex = 0;
-	const int maxNumberEvaluated = BLI_system_thread_count() * 2;
-
-	while (!finished && !breaked) {
-		bool startEvaluated = false;
-		finished = true;
-		int numberEvaluated = 0;
-
-		for (index = startIndex; index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated; index++) {
-			chunkNumber = chunkOrder[index];
+	unsigned int numberScheduled = 0;
+	const unsigned int maxNumberEvaluated = BLI_system_thread_count() * 2;
+	vector<ChunkReference> readyChunks;
+
+	BLI_mutex_lock(&g_scheduleMutex);
+	index = 0;
+	while (true) {
+		while (!breaked && index < this->m_numberOfChunks &&
+		       numberScheduled - this->m_chunksFinished < maxNumberEvaluated)
+		{
+			chunkNumber = chunkOrder[index++];
 			int yChunk = chunkNumber / this->m_numberOfXChunks;
 			int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-			const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-			if (state == COM_ES_NOT_SCHEDULED) {
-				scheduleChunkWhenPossible(graph, xChunk, yChunk);
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-
-				if (bTree->update_draw)
-					bTree->update_draw(bTree->udh);
-			}
-			else if (state == COM_ES_SCHEDULED) {
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-			}
-			else if (state == COM_ES_EXECUTED && !startEvaluated) {
-				startIndex = index + 1;
+			if (!scheduleChunkWhenPossible(graph, xChunk, yChunk, NULL, &readyChunks)) {
+				numberScheduled++;
 			}
 		}
 
-		WorkScheduler::finish();
+		if (!readyChunks.empty()) {
+			BLI_mutex_unlock(&g_scheduleMutex);
+			scheduleChunks(readyChunks);
+			readyChunks.clear();
+			BLI_mutex_lock(&g_scheduleMutex);
+		}
+
+		/* when breaked, wait for the scheduled chunks, they read buffers owned by the ExecutionSystem */
+		if ((breaked || index == this->m_numberOfChunks) && g_chunksScheduled == 0) {
+			break;
+		}
+
+		/* Chunks can finish while the lock is released above (always when the WorkScheduler executes
+		 * them inline), their notifications are lost then. Only wait when chunks are in flight and
+		 * no output chunk can be added, otherwise loop back and add chunks. */
+		const bool canScheduleMore = (!breaked && index < this->m_numberOfChunks &&
+		                              numberScheduled - this->m_chunksFinished < maxNumberEvaluated);
+		if (g_chunksScheduled > 0 && !canScheduleMore) {
+			BLI_condition_wait(&g_scheduleCondition, &g_scheduleMutex);
+		}
+		BLI_mutex_unlock(&g_scheduleMutex);
+
+		if (bTree->update_draw)
+			bTree->update_draw(bTree->udh);
 
 		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
 			breaked = true;
 		}
+		BLI_mutex_lock(&g_scheduleMutex);
 	}
+	BLI_mutex_unlock(&g_scheduleMutex);
+
 	DebugInfo::execution_group_finished(this);
 	DebugInfo::graphviz(graph);
 
@@ -380,10 +444,30 @@ MemoryBuffer *ExecutionGroup::constructConsolidatedMemoryBuffer(MemoryProxy *mem
 
 void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
 {
+	vector<ChunkReference> readyChunks;
+
+	BLI_mutex_lock(&g_scheduleMutex);
 	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED)
 		this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
 
-	atomic_add_and_fetch_u(&this->m_chunksFinished, 1);
+	this->m_chunksFinished++;
+	g_chunksScheduled--;
+
+	/* chunks waiting for this chunk can be executed when it was the last input they needed */
+	vector<ChunkReference> &dependents = this->m_chunkDependents[chunkNumber];
+	for (unsigned int index = 0; index < dependents.size(); index++) {
+		ChunkReference &dependent = dependents[index];
+		if (--dependent.group->m_chunkDependencies[dependent.chunkNumber] == 0) {
+			readyChunks.push_back(dependent);
+		}
+	}
+	dependents.clear();
+
+	BLI_condition_notify_all(&g_scheduleCondition);
+	BLI_mutex_unlock(&g_scheduleMutex);
+
+	scheduleChunks(readyChunks);
+
 	if (memoryBuffers) {
 		for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
 			MemoryBuffer *buffer = memoryBuffers[index];
@@ -448,10 +532,12 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/,
 }
 
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+unsigned int ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area,
+                                                      const ChunkReference *dependent,
+                                                      vector<ChunkReference> *readyChunks)
 {
 	if (this->m_singleThreaded) {
-		return scheduleChunkWhenPossible(graph, 0, 0);
+		return scheduleChunkWhenPossible(graph, 0, 0, dependent, readyChunks) ? 0 : 1;
 	}
 	// find all chunks inside the rect
 	// determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -470,29 +556,28 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
 	maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
 
-	bool result = true;
+	unsigned int numberOfDependencies = 0;
 	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
 		for (indexy = minychunk; indexy < maxychunk; indexy++) {
-			if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
-				result = false;
+			if (!scheduleChunkWhenPossible(graph, indexx, indexy, dependent, readyChunks)) {
+				numberOfDependencies++;
 			}
 		}
 	}
 
-	return result;
+	return numberOfDependencies;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+void ExecutionGroup::scheduleChunks(const vector<ChunkReference> &chunks)
 {
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
-		this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-		WorkScheduler::schedule(this, chunkNumber);
-		return true;
+	for (unsigned int index = 0; index < chunks.size(); index++) {
+		WorkScheduler::schedule(chunks[index].group, chunks[index].chunkNumber);
 	}
-	return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk,
+                                               const ChunkReference *dependent,
+                                               vector<ChunkReference> *readyChunks)
 {
 	if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
 		return true;
@@ -500,48 +585,52 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 	if (yChunk < 0 || yChunk >= (int)this->m_numberOfYChunks) {
 		return true;
 	}
-	int chunkNumber = yChunk * this->m_numberOfXChunks + xChunk;
+	unsigned int chunkNumber = yChunk * this->m_numberOfXChunks + xChunk;
 	// chunk is already executed
 	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_EXECUTED) {
 		return true;
 	}
 
-	// chunk is scheduled, but not executed
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
-		return false;
-	}
-
-	// chunk is nor executed nor scheduled.
-	vector<MemoryProxy *> memoryProxies;
-	this->determineDependingMemoryProxies(&memoryProxies);
-
-	rcti rect;
-	determineChunkRect(&rect, xChunk, yChunk);
-	unsigned int index;
-	bool canBeExecuted = true;
-	rcti area;
-
-	for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
-		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
-		BLI_rcti_init(&area, 0, 0, 0, 0);
-		MemoryProxy *memoryProxy = memoryProxies[index];
-		determineDependingAreaOfInterest(&rect, readOperation, &area);
-		ExecutionGroup *group = memoryProxy->getExecutor();
-
-		if (group != NULL) {
-			if (!group->scheduleAreaWhenPossible(graph, &area)) {
-				canBeExecuted = false;
+	// chunk is nor executed nor scheduled, add the input chunks it needs to the graph
+	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
+		this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
+		g_chunksScheduled++;
+
+		vector<MemoryProxy *> memoryProxies;
+		this->determineDependingMemoryProxies(&memoryProxies);
+
+		const ChunkReference chunk = {this, chunkNumber};
+		rcti rect;
+		determineChunkRect(&rect, xChunk, yChunk);
+		unsigned int index;
+		unsigned int numberOfDependencies = 0;
+		rcti area;
+
+		for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
+			ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+			BLI_rcti_init(&area, 0, 0, 0, 0);
+			MemoryProxy *memoryProxy = memoryProxies[index];
+			determineDependingAreaOfInterest(&rect, readOperation, &area);
+			ExecutionGroup *group = memoryProxy->getExecutor();
+
+			if (group != NULL) {
+				numberOfDependencies += group->scheduleAreaWhenPossible(graph, &area, &chunk, readyChunks);
+			}
+			else {
+				throw "ERROR";
 			}
 		}
-		else {
-			throw "ERROR";
+
+		this->m_chunkDependencies[chunkNumber] = numberOfDependencies;
+		if (numberOfDependencies == 0) {
+			readyChunks->push_back(chunk);
 		}
 	}
 
-	if (canBeExecuted) {
-		scheduleChunk(chunkNumber);
+	// chunk is scheduled, but not executed
+	if (dependent) {
+		this->m_chunkDependents[chunkNumber].push_back(*dependent);
 	}
-
 	return false;
 }
 
@@ -33,6 +33,7 @@
 
 using std::vector;
 
+class ExecutionGroup;
 class ExecutionSystem;
 class MemoryProxy;
 class ReadBufferOperation;
@@ -57,6 +58,16 @@ typedef enum ChunkExecutionState {
 	COM_ES_EXECUTED = 2
 } ChunkExecutionState;
 
+/**
+ * \brief reference to a chunk of an ExecutionGroup
+ * \see ExecutionGroup.scheduleChunkWhenPossible
+ * \ingroup Execution
+ */
+typedef struct ChunkReference {
+	ExecutionGroup *group;
+	unsigned int chunkNumber;
+} ChunkReference;
+
 /**
  * \brief Class ExecutionGroup is a group of Operations that are executed as one.
  * This grouping is used to combine Operations that can be executed as one whole when multi-processing.
@@ -156,6 +167,17 @@ private:
 	 */
 	ChunkExecutionState *m_chunkExecutionStates;
 
+	/**
+	 * \brief per scheduled chunk the number of input chunks it is still waiting for.
+	 * When this reaches zero the chunk is added to the WorkScheduler.
+	 */
+	unsigned int *m_chunkDependencies;
+
+	/**
+	 * \brief per chunk the chunks of other ExecutionGroups that are waiting for it
+	 */
+	vector<vector<ChunkReference> > m_chunkDependents;
+
 	/**
 	 * \brief indicator when this ExecutionGroup has valid Operations in its vector for Execution
 	 * \note When building the ExecutionGroup Operations are added via recursion. First a WriteBufferOperations is added, then the
@@ -208,34 +230,39 @@ private:
 	void determineNumberOfChunks();
 
 	/**
-	 * \brief try to schedule a specific chunk.
-	 * \note scheduling succeeds when all input requirements are met and the chunks hasn't been scheduled yet.
+	 * \brief add a chunk to the chunk dependency graph.
+	 * \note A chunk that isn't scheduled yet registers itself with the input chunks it needs,
+	 * these are scheduled recursively. Chunks without unfinished inputs are added to readyChunks.
+	 * \note must be called with the schedule lock held
 	 * \param graph:
 	 * \param xChunk:
 	 * \param yChunk:
+	 * \param dependent: chunk to notify when this chunk is executed, can be NULL
+	 * \param readyChunks: chunks that can be added to the WorkScheduler
 	 * \return [true:false]
-	 * true: package(s) are scheduled
-	 * false: scheduling is deferred (depending workpackages are scheduled)
+	 * true: the chunk is already executed
+	 * false: the chunk is scheduled, the dependent is notified when it is executed
 	 */
-	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk,
+	                               const ChunkReference *dependent, vector<ChunkReference> *readyChunks);
 
 	/**
-	 * \brief try to schedule a specific area.
-	 * \note Check if a certain area is available, when not available this are will be checked.
+	 * \brief add the chunks of a specific area to the chunk dependency graph.
 	 * \note This method is called from other ExecutionGroup's.
 	 * \param graph:
 	 * \param rect:
-	 * \return [true:false]
-	 * true: package(s) are scheduled
-	 * false: scheduling is deferred (depending workpackages are scheduled)
+	 * \param dependent: chunk to notify when the chunks of the area are executed
+	 * \param readyChunks: chunks that can be added to the WorkScheduler
+	 * \return the number of chunks in the area that are not executed yet
 	 */
-	bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
+	unsigned int scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect,
+	                                      const ChunkReference *dependent, vector<ChunkReference> *readyChunks);
 
 	/**
-	 * \brief add a chunk to the WorkScheduler.
-	 * \param chunknumber:
+	 * \brief add chunks whose inputs are executed to the WorkScheduler.
+	 * \note must be called without the schedule lock held
 	 */
-	bool scheduleChunk(unsigned int chunkNumber);
+	static void scheduleChunks(const vector<ChunkReference> &chunks);
 
 	/**
 	 * \brief determine the area of interest of a certain input area
@@ -359,6 +386,17 @@ public:
 	 */
 	void deinitExecution();
 
+	/**
+	 * \brief mark all chunks as executed, used when the output buffer is restored from the ResultCache
+	 * \note must be called after initExecution
+	 */
+	void setAllChunksExecuted();
+
+	/**
+	 * \brief have all chunks of this ExecutionGroup been executed
+	 */
+	bool isAllChunksExecuted() const;
+
 
 	/**
 	 * \brief schedule an ExecutionGroup
@@ -376,6 +414,18 @@ public:
 	 */
 	void execute(ExecutionSystem *system);
 
+	/**
+	 * \brief initialize the state used to schedule chunks of all execution groups
+	 * \note called once by WorkScheduler.initialize
+	 */
+	static void initializeScheduling();
+
+	/**
+	 * \brief free the state used to schedule chunks
+	 * \note called by WorkScheduler.deinitialize
+	 */
+	static void deinitializeScheduling();
+
 	/**
 	 * \brief this method determines the MemoryProxy's where this execution group depends on.
 	 * \note After this method determineDependingAreaOfInterest can be called to determine
@@ -36,8 +36,13 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_Debug.h"
 
+#include <set>
+#include <typeinfo>
+
 #ifdef WITH_CXX_GUARDEDALLOC
 #include "MEM_guardedalloc.h"
 #endif
@@ -133,6 +138,12 @@ void ExecutionSystem::execute()
 
 	DebugInfo::execute_started(this);
 
+	/* cache_size is in MB */
+	ResultCache::setLimit((editingtree->cache_size > 0) ? (size_t)editingtree->cache_size * 1024 * 1024 : 0);
+	if (ResultCache::isEnabled() && !this->m_context.isRendering()) {
+		determineResultKeys();
+	}
+
 	unsigned int order = 0;
 	for (vector<NodeOperation *>::iterator iter = this->m_operations.begin(); iter != this->m_operations.end(); ++iter) {
 		NodeOperation *operation = *iter;
@@ -174,6 +185,8 @@ void ExecutionSystem::execute()
 		executionGroup->initExecution();
 	}
 
+	restoreCachedResults();
+
 	WorkScheduler::start(this->m_context);
 
 	executeGroups(COM_PRIORITY_HIGH);
@@ -185,6 +198,8 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	storeCachedResults();
+
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | De-initializing execution"));
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -196,6 +211,171 @@ void ExecutionSystem::execute()
 	}
 }
 
+typedef struct OperationResultKey {
+	ResultKey key;
+	bool valid;
+} OperationResultKey;
+
+typedef std::map<NodeOperation *, OperationResultKey> OperationResultKeys;
+
+static bool operation_result_key(NodeOperation *operation, const OperationHash &seed,
+                                 OperationResultKeys &keys, ResultKey *r_key);
+
+static bool operation_input_result_key(NodeOperationOutput *output, const OperationHash &seed,
+                                       OperationResultKeys &keys, OperationHash &hash)
+{
+	NodeOperation *operation = &output->getOperation();
+	ResultKey key;
+	if (!operation_result_key(operation, seed, keys, &key)) {
+		return false;
+	}
+	hash.add(key);
+
+	for (unsigned int index = 0; index < operation->getNumberOfOutputSockets(); index++) {
+		if (operation->getOutputSocket(index) == output) {
+			hash.add((int)index);
+			break;
+		}
+	}
+	return true;
+}
+
+/* The key of an operation combines its type, resolution and settings with the keys
+ * of its inputs, so any change upstream changes the key. */
+static bool operation_result_key(NodeOperation *operation, const OperationHash &seed,
+                                 OperationResultKeys &keys, ResultKey *r_key)
+{
+	OperationResultKeys::const_iterator it = keys.find(operation);
+	if (it != keys.end()) {
+		*r_key = it->second.key;
+		return it->second.valid;
+	}
+
+	OperationHash hash = seed;
+	hash.addString(typeid(*operation).name());
+	hash.add((int)operation->getWidth());
+	hash.add((int)operation->getHeight());
+
+	bool valid = operation->hashSettings(hash);
+
+	if (valid && operation->isReadBufferOperation()) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+		WriteBufferOperation *writeOperation = readOperation->getMemoryProxy()->getWriteBufferOperation();
+		ResultKey key;
+		valid = operation_result_key(writeOperation, seed, keys, &key);
+		hash.add(key);
+	}
+
+	for (unsigned int index = 0; valid && index < operation->getNumberOfInputSockets(); index++) {
+		NodeOperationInput *input = operation->getInputSocket(index);
+		hash.add((int)input->getDataType());
+		hash.add((int)input->getResizeMode());
+		if (input->isConnected()) {
+			valid = operation_input_result_key(input->getLink(), seed, keys, hash);
+		}
+	}
+
+	OperationResultKey &result = keys[operation];
+	result.key = hash.getKey();
+	result.valid = valid;
+
+	*r_key = result.key;
+	return valid;
+}
+
+void ExecutionSystem::determineResultKeys()
+{
+	/* settings of the context that change the result of operations */
+	OperationHash seed;
+	seed.add((int)this->m_context.getQuality());
+	seed.add(this->m_context.isFastCalculation());
+
+	OperationResultKeys keys;
+	for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			ResultKey key;
+			if (operation_result_key(operation, seed, keys, &key)) {
+				this->m_resultKeys[(WriteBufferOperation *)operation] = key;
+			}
+		}
+	}
+}
+
+static void restore_cached_results_recursive(NodeOperation *operation,
+                                             const std::map<WriteBufferOperation *, ResultKey> &resultKeys,
+                                             std::set<NodeOperation *> &visited)
+{
+	if (visited.find(operation) != visited.end()) {
+		return;
+	}
+	visited.insert(operation);
+
+	if (operation->isWriteBufferOperation()) {
+		WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+		std::map<WriteBufferOperation *, ResultKey>::const_iterator it = resultKeys.find(writeOperation);
+		if (it != resultKeys.end()) {
+			MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+			ExecutionGroup *group = memoryProxy->getExecutor();
+			if (group && ResultCache::restore(it->second, memoryProxy->getBuffer())) {
+				/* operations before this buffer are not needed */
+				group->setAllChunksExecuted();
+				return;
+			}
+		}
+	}
+	else if (operation->isReadBufferOperation()) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+		restore_cached_results_recursive(readOperation->getMemoryProxy()->getWriteBufferOperation(),
+		                                 resultKeys, visited);
+	}
+
+	for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+		NodeOperationInput *input = operation->getInputSocket(index);
+		if (input->isConnected()) {
+			restore_cached_results_recursive(&input->getLink()->getOperation(), resultKeys, visited);
+		}
+	}
+}
+
+void ExecutionSystem::restoreCachedResults()
+{
+	if (this->m_resultKeys.empty()) {
+		return;
+	}
+
+	/* only restore buffers which are read, directly or through buffers that need calculation */
+	vector<ExecutionGroup *> outputGroups;
+	findOutputExecutionGroup(&outputGroups);
+
+	std::set<NodeOperation *> visited;
+	for (unsigned int index = 0; index < outputGroups.size(); index++) {
+		ExecutionGroup *group = outputGroups[index];
+		if (this->m_context.isFastCalculation() && group->getRenderPriotrity() != COM_PRIORITY_HIGH) {
+			continue;
+		}
+		restore_cached_results_recursive(group->getOutputOperation(), this->m_resultKeys, visited);
+	}
+}
+
+void ExecutionSystem::storeCachedResults()
+{
+	const bNodeTree *editingtree = this->m_context.getbNodeTree();
+	if (this->m_resultKeys.empty() || editingtree->test_break(editingtree->tbh)) {
+		/* buffers of a cancelled execution may be incomplete */
+		return;
+	}
+
+	std::map<WriteBufferOperation *, ResultKey>::const_iterator it;
+	for (it = this->m_resultKeys.begin(); it != this->m_resultKeys.end(); ++it) {
+		MemoryProxy *memoryProxy = it->first->getMemoryProxy();
+		ExecutionGroup *group = memoryProxy->getExecutor();
+		if (group && group->isAllChunksExecuted()) {
+			ResultCache::store(it->second, memoryProxy->getBuffer());
+		}
+	}
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
 	unsigned int index;
@@ -31,6 +31,9 @@ class ExecutionGroup;
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_NodeOperation.h"
+#include "COM_ResultCache.h"
+
+#include <map>
 
 /**
  * \page execution Execution model
@@ -131,6 +134,11 @@ private:
 	 */
 	Groups m_groups;
 
+	/**
+	 * \brief ResultCache keys of the write buffer operations whose result can be cached
+	 */
+	std::map<WriteBufferOperation *, ResultKey> m_resultKeys;
+
 private: //methods
 	/**
 	 * find all execution group with output nodes
@@ -177,6 +185,23 @@ public:
 private:
 	void executeGroups(CompositorPriority priority);
 
+	/**
+	 * \brief calculate the ResultCache keys of all write buffer operations
+	 */
+	void determineResultKeys();
+
+	/**
+	 * \brief restore cached buffers that are needed by the output groups
+	 * ExecutionGroups of restored buffers are marked as executed, so they (and the
+	 * groups they depend on) are not scheduled.
+	 */
+	void restoreCachedResults();
+
+	/**
+	 * \brief store the fully calculated buffers in the ResultCache
+	 */
+	void storeCachedResults();
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
@@ -0,0 +1,458 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+typedef float fREAL;
+
+// returns next highest power of 2 of x, as well it's log2 in L2
+static unsigned int nextPow2(unsigned int x, unsigned int *L2)
+{
+	unsigned int pw, x_notpow2 = x & (x - 1);
+	*L2 = 0;
+	while (x >>= 1) ++(*L2);
+	pw = 1 << (*L2);
+	if (x_notpow2) { (*L2)++;  pw <<= 1; }
+	return pw;
+}
+
+//------------------------------------------------------------------------------
+
+// from FXT library by Joerg Arndt, faster in order bitreversal
+// use: r = revbin_upd(r, h) where h = N>>1
+static unsigned int revbin_upd(unsigned int r, unsigned int h)
+{
+	while (!((r ^= h) & h)) h >>= 1;
+	return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
+{
+	double tt, fc, dc, fs, ds, a = M_PI;
+	fREAL t1, t2;
+	int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+	int i, j = 0;
+	unsigned int Nh = len >> 1;
+	for (i = 1; i < (len - 1); ++i) {
+		j = revbin_upd(j, Nh);
+		if (j > i) {
+			t1 = data[i];
+			data[i] = data[j];
+			data[j] = t1;
+		}
+	}
+
+	do {
+		fREAL *data_n = &data[n];
+
+		istep = n << 1;
+		for (k = 0; k < len; k += istep) {
+			t1 = data_n[k];
+			data_n[k] = data[k] - t1;
+			data[k] += t1;
+		}
+
+		n2 = n >> 1;
+		if (n > 2) {
+			fc = dc = cos(a);
+			fs = ds = sqrt(1.0 - fc * fc); //sin(a);
+			bd = n - 2;
+			for (bl = 1; bl < n2; bl++) {
+				fREAL *data_nbd = &data_n[bd];
+				fREAL *data_bd = &data[bd];
+				for (k = bl; k < len; k += istep) {
+					t1 = fc * (double)data_n[k] + fs * (double)data_nbd[k];
+					t2 = fs * (double)data_n[k] - fc * (double)data_nbd[k];
+					data_n[k] = data[k] - t1;
+					data_nbd[k] = data_bd[k] - t2;
+					data[k] += t1;
+					data_bd[k] += t2;
+				}
+				tt = fc * dc - fs * ds;
+				fs = fs * dc + fc * ds;
+				fc = tt;
+				bd -= 2;
+			}
+		}
+
+		if (n > 1) {
+			for (k = n2; k < len; k += istep) {
+				t1 = data_n[k];
+				data_n[k] = data[k] - t1;
+				data[k] += t1;
+			}
+		}
+
+		n = istep;
+		a *= 0.5;
+	} while (n < len);
+
+	if (inverse) {
+		fREAL sc = (fREAL)1 / (fREAL)len;
+		for (k = 0; k < len; ++k)
+			data[k] *= sc;
+	}
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above */
+static void FHT2D(fREAL *data, unsigned int Mx, unsigned int My,
+                  unsigned int nzp, unsigned int inverse)
+{
+	unsigned int i, j, Nx, Ny, maxy;
+
+	Nx = 1 << Mx;
+	Ny = 1 << My;
+
+	// rows (forward transform skips 0 pad data)
+	maxy = inverse ? Ny : nzp;
+	for (j = 0; j < maxy; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// transpose data
+	if (Nx == Ny) {  // square
+		for (j = 0; j < Ny; ++j)
+			for (i = j + 1; i < Nx; ++i) {
+				unsigned int op = i + (j << Mx), np = j + (i << My);
+				SWAP(fREAL, data[op], data[np]);
+			}
+	}
+	else {  // rectangular
+		unsigned int k, Nym = Ny - 1, stm = 1 << (Mx + My);
+		for (i = 0; stm > 0; i++) {
+#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+			for (j = PRED(i); j > i; j = PRED(j)) ;
+			if (j < i) continue;
+			for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+				SWAP(fREAL, data[j], data[k]);
+			}
+#undef PRED
+			stm--;
+		}
+	}
+
+	SWAP(unsigned int, Nx, Ny);
+	SWAP(unsigned int, Mx, My);
+
+	// now columns == transposed rows
+	for (j = 0; j < Ny; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// finalize
+	for (j = 0; j <= (Ny >> 1); j++) {
+		unsigned int jm = (Ny - j) & (Ny - 1);
+		unsigned int ji = j << Mx;
+		unsigned int jmi = jm << Mx;
+		for (i = 0; i <= (Nx >> 1); i++) {
+			unsigned int im = (Nx - i) & (Nx - 1);
+			fREAL A = data[ji + i];
+			fREAL B = data[jmi + i];
+			fREAL C = data[ji + im];
+			fREAL D = data[jmi + im];
+			fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+			data[ji + i] = A - E;
+			data[jmi + i] = B + E;
+			data[ji + im] = C + E;
+			data[jmi + im] = D - E;
+		}
+	}
+
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height */
+static void fht_convolve(fREAL *d1, const fREAL *d2, unsigned int M, unsigned int N)
+{
+	fREAL a, b;
+	unsigned int i, j, k, L, mj, mL;
+	unsigned int m = 1 << M, n = 1 << N;
+	unsigned int m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+	unsigned int mn2 = m << (N - 1);
+
+	d1[0] *= d2[0];
+	d1[mn2] *= d2[mn2];
+	d1[m2] *= d2[m2];
+	d1[m2 + mn2] *= d2[m2 + mn2];
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		a = d1[i] * d2[i] - d1[k] * d2[k];
+		b = d1[k] * d2[i] + d1[i] * d2[k];
+		d1[i] = (b + a) * (fREAL)0.5;
+		d1[k] = (b - a) * (fREAL)0.5;
+		a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+		b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+		d1[i + mn2] = (b + a) * (fREAL)0.5;
+		d1[k + mn2] = (b - a) * (fREAL)0.5;
+	}
+	for (j = 1; j < n2; j++) {
+		L = n - j;
+		mj = j << M;
+		mL = L << M;
+		a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+		b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+		d1[mj] = (b + a) * (fREAL)0.5;
+		d1[mL] = (b - a) * (fREAL)0.5;
+		a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+		b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+		d1[m2 + mj] = (b + a) * (fREAL)0.5;
+		d1[m2 + mL] = (b - a) * (fREAL)0.5;
+	}
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		for (j = 1; j < n2; j++) {
+			L = n - j;
+			mj = j << M;
+			mL = L << M;
+			a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+			b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+			d1[i + mj] = (b + a) * (fREAL)0.5;
+			d1[k + mL] = (b - a) * (fREAL)0.5;
+			a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+			b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+			d1[i + mL] = (b + a) * (fREAL)0.5;
+			d1[k + mj] = (b - a) * (fREAL)0.5;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+
+typedef struct FFTConvolutionData {
+	/* image, interleaved channels */
+	const float *image;
+	int imageWidth, imageHeight, imageChannels;
+	int numChannels;
+
+	/* kernel, interleaved channels */
+	const float *kernel;
+	int kernelWidth, kernelHeight, kernelChannels;
+	/* transformed kernel, one plane of w2 * h2 per channel */
+	fREAL *kernelPlanes;
+	int numKernelPlanes;
+
+	/* FFT size and log2 */
+	unsigned int w2, h2, log2_w, log2_h;
+	/* size and number of the image blocks */
+	int blockWidth, blockHeight, numBlocksX, numBlocksY;
+	/* first block row of the current pass */
+	int blockRowStart;
+
+	/* summed area tables of the kernel planes, used to normalize */
+	double *kernelSums;
+
+	float *output;
+} FFTConvolutionData;
+
+static void fft_convolve_kernel_plane(void *__restrict userdata,
+                                      const int plane,
+                                      const ParallelRangeTLS *__restrict /*tls*/)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	fREAL *fp = &data->kernelPlanes[(size_t)plane * data->w2 * data->h2];
+	const int channel = (data->kernelChannels == 1) ? 0 : plane;
+
+	for (int y = 0; y < data->kernelHeight; y++) {
+		const float *kp = &data->kernel[((size_t)y * data->kernelWidth) * data->kernelChannels + channel];
+		for (int x = 0; x < data->kernelWidth; x++, kp += data->kernelChannels) {
+			fp[y * data->w2 + x] = *kp;
+		}
+	}
+	FHT2D(fp, data->log2_w, data->log2_h, data->kernelHeight, 0);
+}
+
+/* Convolve a row of blocks for a single channel. Rows of blocks are processed in two passes,
+ * the results of rows with the same parity never overlap, so they can be added without locking. */
+static void fft_convolve_block_row(void *__restrict userdata,
+                                   const int iter,
+                                   const ParallelRangeTLS *__restrict /*tls*/)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int channel = iter % data->numChannels;
+	const int ybl = data->blockRowStart + 2 * (iter / data->numChannels);
+	const int kernelPlane = (data->numKernelPlanes == 1) ? 0 : channel;
+	const fREAL *kernelPlaneData = &data->kernelPlanes[(size_t)kernelPlane * data->w2 * data->h2];
+	const int hw = data->kernelWidth >> 1;
+	const int hh = data->kernelHeight >> 1;
+	const int y0 = ybl * data->blockHeight;
+	const int numRows = min_ii(data->blockHeight, data->imageHeight - y0);
+
+	fREAL *block = (fREAL *)MEM_mallocN(sizeof(fREAL) * data->w2 * data->h2, "FFT convolution block");
+
+	for (int xbl = 0; xbl < data->numBlocksX; xbl++) {
+		const int x0 = xbl * data->blockWidth;
+		const int numColumns = min_ii(data->blockWidth, data->imageWidth - x0);
+
+		memset(block, 0, sizeof(fREAL) * data->w2 * data->h2);
+		for (int y = 0; y < numRows; y++) {
+			fREAL *fp = &block[y * data->w2];
+			const float *ip = &data->image[((size_t)(y0 + y) * data->imageWidth + x0) * data->imageChannels + channel];
+			for (int x = 0; x < numColumns; x++, ip += data->imageChannels) {
+				fp[x] = *ip;
+			}
+		}
+
+		// forward FHT, rows after the image data are zero
+		FHT2D(block, data->log2_w, data->log2_h, numRows, 0);
+
+		// FHT2D transposed data, row/col now swapped
+		// convolve & inverse FHT
+		fht_convolve(block, kernelPlaneData, data->log2_h, data->log2_w);
+		FHT2D(block, data->log2_h, data->log2_w, 0, 1);
+		// data again transposed, so in order again
+
+		// overlap-add result
+		for (int y = 0; y < (int)data->h2; y++) {
+			const int yy = y0 + y - hh;
+			if ((yy < 0) || (yy >= data->imageHeight)) continue;
+			const fREAL *fp = &block[y * data->w2];
+			float *op = &data->output[(size_t)yy * data->imageWidth * data->imageChannels + channel];
+			for (int x = 0; x < (int)data->w2; x++) {
+				const int xx = x0 + x - hw;
+				if ((xx < 0) || (xx >= data->imageWidth)) continue;
+				op[xx * data->imageChannels] += fp[x];
+			}
+		}
+	}
+
+	MEM_freeN(block);
+}
+
+/* Sum of the kernel weights overlapping the image for an output pixel, from the summed area table. */
+BLI_INLINE double fft_convolve_kernel_sum(const FFTConvolutionData *data, const double *sums, int x, int y)
+{
+	const int hw = data->kernelWidth >> 1;
+	const int hh = data->kernelHeight >> 1;
+	const int stride = data->kernelWidth + 1;
+	/* kernel pixel t is applied to image pixel x + center - t */
+	const int tx0 = max_ii(0, x + hw - (data->imageWidth - 1));
+	const int tx1 = min_ii(data->kernelWidth - 1, x + hw) + 1;
+	const int ty0 = max_ii(0, y + hh - (data->imageHeight - 1));
+	const int ty1 = min_ii(data->kernelHeight - 1, y + hh) + 1;
+	return sums[ty1 * stride + tx1] - sums[ty0 * stride + tx1] - sums[ty1 * stride + tx0] + sums[ty0 * stride + tx0];
+}
+
+static void fft_convolve_finalize_row(void *__restrict userdata,
+                                      const int y,
+                                      const ParallelRangeTLS *__restrict /*tls*/)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const size_t sumsSize = (size_t)(data->kernelWidth + 1) * (data->kernelHeight + 1);
+	float *op = &data->output[(size_t)y * data->imageWidth * data->imageChannels];
+
+	for (int x = 0; x < data->imageWidth; x++, op += data->imageChannels) {
+		for (int ch = 0; ch < data->numChannels; ch++) {
+			const int kernelPlane = (data->numKernelPlanes == 1) ? 0 : ch;
+			const double sum = fft_convolve_kernel_sum(data, &data->kernelSums[kernelPlane * sumsSize], x, y);
+			op[ch] = (sum != 0.0) ? (float)(op[ch] / sum) : 0.0f;
+		}
+	}
+}
+
+static void fft_convolve_kernel_sums(FFTConvolutionData *data)
+{
+	const int stride = data->kernelWidth + 1;
+	const size_t sumsSize = (size_t)stride * (data->kernelHeight + 1);
+
+	data->kernelSums = (double *)MEM_callocN(sizeof(double) * sumsSize * data->numKernelPlanes,
+	                                         "FFT convolution kernel sums");
+	for (int plane = 0; plane < data->numKernelPlanes; plane++) {
+		double *sums = &data->kernelSums[plane * sumsSize];
+		const int channel = (data->kernelChannels == 1) ? 0 : plane;
+		for (int y = 0; y < data->kernelHeight; y++) {
+			const float *kp = &data->kernel[((size_t)y * data->kernelWidth) * data->kernelChannels + channel];
+			double rowSum = 0.0;
+			for (int x = 0; x < data->kernelWidth; x++, kp += data->kernelChannels) {
+				rowSum += *kp;
+				sums[(y + 1) * stride + x + 1] = sums[y * stride + x + 1] + rowSum;
+			}
+		}
+	}
+}
+
+void FFTConvolution::convolve(float *output, MemoryBuffer *image, MemoryBuffer *kernel,
+                              int numChannels, bool normalize)
+{
+	FFTConvolutionData data;
+	ParallelRangeSettings settings;
+
+	BLI_assert(kernel->get_num_channels() == 1 || (int)kernel->get_num_channels() >= numChannels);
+	BLI_assert((int)image->get_num_channels() >= numChannels);
+
+	data.image = image->getBuffer();
+	data.imageWidth = image->getWidth();
+	data.imageHeight = image->getHeight();
+	data.imageChannels = image->get_num_channels();
+	data.numChannels = numChannels;
+	data.kernel = kernel->getBuffer();
+	data.kernelWidth = kernel->getWidth();
+	data.kernelHeight = kernel->getHeight();
+	data.kernelChannels = kernel->get_num_channels();
+	data.numKernelPlanes = (data.kernelChannels == 1) ? 1 : numChannels;
+	data.kernelSums = NULL;
+	data.output = output;
+
+	memset(output, 0, sizeof(float) * data.imageWidth * data.imageHeight * data.imageChannels);
+	if (data.imageWidth == 0 || data.imageHeight == 0 || numChannels == 0) {
+		return;
+	}
+
+	// convolution result width & height
+	// FFT pow2 required size & log2
+	data.w2 = nextPow2(2 * data.kernelWidth - 1, &data.log2_w);
+	data.h2 = nextPow2(2 * data.kernelHeight - 1, &data.log2_h);
+
+	// block add-overlap
+	data.blockWidth = (data.w2 + 1) - data.kernelWidth;
+	data.blockHeight = (data.h2 + 1) - data.kernelHeight;
+	data.numBlocksX = (data.imageWidth + data.blockWidth - 1) / data.blockWidth;
+	data.numBlocksY = (data.imageHeight + data.blockHeight - 1) / data.blockHeight;
+
+	// only need to calc fht data of the kernel once, re-used for every block
+	data.kernelPlanes = (fREAL *)MEM_callocN(sizeof(fREAL) * data.w2 * data.h2 * data.numKernelPlanes,
+	                                         "FFT convolution kernel");
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 1;
+	BLI_task_parallel_range(0, data.numKernelPlanes, &data, fft_convolve_kernel_plane, &settings);
+
+	for (data.blockRowStart = 0; data.blockRowStart < 2; data.blockRowStart++) {
+		const int numBlockRows = (data.numBlocksY - data.blockRowStart + 1) / 2;
+		BLI_task_parallel_range(0, numBlockRows * numChannels, &data, fft_convolve_block_row, &settings);
+	}
+
+	MEM_freeN(data.kernelPlanes);
+
+	if (normalize) {
+		fft_convolve_kernel_sums(&data);
+		settings.min_iter_per_thread = 16;
+		BLI_task_parallel_range(0, data.imageHeight, &data, fft_convolve_finalize_row, &settings);
+		MEM_freeN(data.kernelSums);
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __COM_FFTCONVOLUTION_H__
+#define __COM_FFTCONVOLUTION_H__
+
+#include "COM_defines.h"
+
+class MemoryBuffer;
+
+/**
+ * \brief convolution of a whole image with a large kernel using Fast Hartley Transforms.
+ *
+ * The image is split in blocks which are transformed, multiplied with the transformed
+ * kernel and added to the result (overlap-add). Blocks are processed on multiple threads.
+ * The cost per pixel grows with the logarithm of the kernel size instead of its area.
+ * \ingroup Execution
+ */
+class FFTConvolution {
+public:
+	/**
+	 * \brief is a kernel of the given size faster to apply with convolve than spatially
+	 */
+	static bool isFaster(int kernelWidth, int kernelHeight)
+	{
+		return kernelWidth * kernelHeight >= COM_FFT_CONVOLUTION_MIN_AREA;
+	}
+
+	/**
+	 * \brief convolve the first numChannels channels of image with kernel
+	 *
+	 * The kernel is centered at (width / 2, height / 2) and has a single channel, used for all
+	 * image channels, or at least numChannels channels.
+	 * \param output: buffer with the size and channels of image, channels from numChannels on are cleared
+	 * \param normalize: divide each pixel by the sum of the kernel weights that overlap the image,
+	 * like the spatial blur operations do at the borders of the image
+	 */
+	static void convolve(float *output, MemoryBuffer *image, MemoryBuffer *kernel,
+	                     int numChannels, bool normalize);
+};
+
+#endif  /* __COM_FFTCONVOLUTION_H__ */
@@ -129,6 +129,8 @@ public:
 
 	unsigned int get_num_channels() { return this->m_num_channels; }
 
+	DataType get_datatype() const { return this->m_datatype; }
+
 	/**
 	 * \brief get the data of this MemoryBuffer
 	 * \note buffer should already be available in memory
@@ -250,6 +252,30 @@ public:
 		memcpy(result, buffer, sizeof(float) * this->m_num_channels);
 	}
 
+	/**
+	 * \brief read a row of pixels, pixels outside the buffer rect are zero
+	 * \param result: pixel i is stored at result + i * stride
+	 */
+	inline void readRow(float *result, int x, int y, int num, int stride)
+	{
+		if (y >= m_rect.ymin && y < m_rect.ymax && x >= m_rect.xmin && x + num <= m_rect.xmax) {
+			const float *buffer = &this->m_buffer[(this->m_width * y + x) * this->m_num_channels];
+			if (stride == (int)this->m_num_channels) {
+				memcpy(result, buffer, sizeof(float) * this->m_num_channels * num);
+			}
+			else {
+				for (int i = 0; i < num; i++, result += stride, buffer += this->m_num_channels) {
+					memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+				}
+			}
+		}
+		else {
+			for (int i = 0; i < num; i++, result += stride) {
+				read(result, x + i, y);
+			}
+		}
+	}
+
 	void writePixel(int x, int y, const float color[4]);
 	void addPixel(int x, int y, const float color[4]);
 	inline void readBilinear(float *result, float x, float y,
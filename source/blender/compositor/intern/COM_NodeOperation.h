@@ -36,6 +36,7 @@ extern "C" {
 #include "COM_Node.h"
 #include "COM_MemoryBuffer.h"
 #include "COM_MemoryProxy.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketReader.h"
 
 #include "clew.h"
@@ -296,6 +297,18 @@ public:
 
 	virtual bool useDatatypeConversion() const { return true; }
 
+	/**
+	 * \brief add the settings of this operation to the hash of its result
+	 *
+	 * The type, resolution and inputs of the operation are added by the ExecutionSystem,
+	 * operations only add members that change their result.
+	 * Results depending on operations that don't implement this are never cached.
+	 * \note subclasses adding settings must extend the hash of their parent class
+	 * \return true when the result of the operation can be cached
+	 * \see ResultCache
+	 */
+	virtual bool hashSettings(OperationHash & /*hash*/) { return false; }
+
 	inline bool isBreaked() const {
 		return this->m_btree->test_break(this->m_btree->tbh);
 	}
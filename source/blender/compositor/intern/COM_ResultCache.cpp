@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <list>
+#include <map>
+
+#include "COM_ResultCache.h"
+#include "COM_MemoryBuffer.h"
+
+extern "C" {
+#include "BLI_rect.h"
+}
+
+/* ******** Operation Hash ******** */
+
+OperationHash::OperationHash()
+{
+	BLI_hash_mm2a_init(&this->m_hash[0], 0);
+	BLI_hash_mm2a_init(&this->m_hash[1], 0x9e3779b9);
+}
+
+void OperationHash::add(const void *data, size_t size)
+{
+	BLI_hash_mm2a_add(&this->m_hash[0], (const unsigned char *)data, size);
+	BLI_hash_mm2a_add(&this->m_hash[1], (const unsigned char *)data, size);
+}
+
+void OperationHash::addString(const char *str)
+{
+	if (str) {
+		add(str, strlen(str) + 1);
+	}
+	else {
+		add(-1);
+	}
+}
+
+ResultKey OperationHash::getKey() const
+{
+	/* finishing changes the state, keep this hash usable for adding more data */
+	BLI_HashMurmur2A hash[2] = {this->m_hash[0], this->m_hash[1]};
+	return ((ResultKey)BLI_hash_mm2a_end(&hash[0]) << 32) | (ResultKey)BLI_hash_mm2a_end(&hash[1]);
+}
+
+/* ******** Result Cache ******** */
+
+typedef struct ResultCacheEntry {
+	ResultKey key;
+	MemoryBuffer *buffer;
+	size_t size;
+} ResultCacheEntry;
+
+/* most recently used entries first */
+typedef std::list<ResultCacheEntry> ResultCacheEntries;
+typedef std::map<ResultKey, ResultCacheEntries::iterator> ResultCacheMap;
+
+static ResultCacheEntries g_entries;
+static ResultCacheMap g_map;
+static size_t g_memory_in_use = 0;
+static size_t g_limit = 0;
+
+static size_t buffer_size_in_bytes(MemoryBuffer *buffer)
+{
+	return (size_t)buffer->getWidth() * (size_t)buffer->getHeight() *
+	       (size_t)buffer->get_num_channels() * sizeof(float);
+}
+
+void ResultCache::setLimit(size_t limit)
+{
+	g_limit = limit;
+	if (limit == 0) {
+		clear();
+	}
+	else {
+		freeUntil(limit);
+	}
+}
+
+bool ResultCache::isEnabled()
+{
+	return g_limit != 0;
+}
+
+bool ResultCache::contains(ResultKey key)
+{
+	return g_map.find(key) != g_map.end();
+}
+
+bool ResultCache::restore(ResultKey key, MemoryBuffer *buffer)
+{
+	ResultCacheMap::iterator it = g_map.find(key);
+	if (it == g_map.end()) {
+		return false;
+	}
+
+	ResultCacheEntries::iterator entry = it->second;
+	MemoryBuffer *cached = entry->buffer;
+	if (!BLI_rcti_compare(cached->getRect(), buffer->getRect()) ||
+	    cached->get_num_channels() != buffer->get_num_channels())
+	{
+		return false;
+	}
+
+	buffer->copyContentFrom(cached);
+
+	/* move to the front, it was used most recently */
+	g_entries.splice(g_entries.begin(), g_entries, entry);
+	return true;
+}
+
+void ResultCache::store(ResultKey key, MemoryBuffer *buffer)
+{
+	const size_t size = buffer_size_in_bytes(buffer);
+	if (size == 0 || size > g_limit) {
+		/* would free the entire cache and still not fit */
+		return;
+	}
+
+	ResultCacheMap::iterator it = g_map.find(key);
+	if (it != g_map.end()) {
+		/* same content, nothing to update */
+		g_entries.splice(g_entries.begin(), g_entries, it->second);
+		return;
+	}
+
+	freeUntil(g_limit - size);
+
+	ResultCacheEntry entry;
+	entry.key = key;
+	entry.buffer = new MemoryBuffer(buffer->get_datatype(), buffer->getRect());
+	entry.buffer->copyContentFrom(buffer);
+	entry.size = size;
+
+	g_entries.push_front(entry);
+	g_map[key] = g_entries.begin();
+	g_memory_in_use += size;
+}
+
+void ResultCache::clear()
+{
+	for (ResultCacheEntries::iterator it = g_entries.begin(); it != g_entries.end(); ++it) {
+		delete it->buffer;
+	}
+	g_entries.clear();
+	g_map.clear();
+	g_memory_in_use = 0;
+}
+
+size_t ResultCache::getMemoryInUse()
+{
+	return g_memory_in_use;
+}
+
+void ResultCache::freeUntil(size_t limit)
+{
+	while (g_memory_in_use > limit && !g_entries.empty()) {
+		ResultCacheEntry &entry = g_entries.back();
+		g_memory_in_use -= entry.size;
+		g_map.erase(entry.key);
+		delete entry.buffer;
+		g_entries.pop_back();
+	}
+}
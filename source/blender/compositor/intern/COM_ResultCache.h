@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __COM_RESULTCACHE_H__
+#define __COM_RESULTCACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+extern "C" {
+#include "BLI_hash_mm2a.h"
+}
+
+class MemoryBuffer;
+
+/**
+ * \brief key identifying the content of an operation result
+ * \see OperationHash
+ * \ingroup Execution
+ */
+typedef uint64_t ResultKey;
+
+/**
+ * \brief incremental content hash of an operation result.
+ *
+ * Operations add their settings using NodeOperation.hashSettings,
+ * the ExecutionSystem adds the type, resolution and the hashes of the inputs.
+ * \ingroup Execution
+ */
+class OperationHash {
+private:
+	/* two 32 bit hashes with different seeds, combined into a ResultKey */
+	BLI_HashMurmur2A m_hash[2];
+
+public:
+	OperationHash();
+
+	void add(const void *data, size_t size);
+	void add(int value) { add(&value, sizeof(value)); }
+	void add(float value) { add(&value, sizeof(value)); }
+	void add(bool value) { add((int)value); }
+	void add(const void *pointer) { add(&pointer, sizeof(pointer)); }
+	/** \brief add a string, NULL is a valid value */
+	void addString(const char *str);
+	void add(ResultKey key) { add(&key, sizeof(key)); }
+
+	ResultKey getKey() const;
+};
+
+/**
+ * \brief keeps results of write buffer operations between executions.
+ *
+ * Buffers are stored under the ResultKey of the WriteBufferOperation,
+ * when an unchanged part of the node tree is executed again its buffer
+ * is restored instead of being calculated.
+ * The least recently used buffers are freed when the memory limit is exceeded.
+ *
+ * Only used from ExecutionSystem, which is protected by the compositor mutex.
+ * \ingroup Execution
+ */
+class ResultCache {
+public:
+	/**
+	 * \brief set the maximum memory used by the cache in bytes, 0 disables the cache
+	 */
+	static void setLimit(size_t limit);
+
+	static bool isEnabled();
+
+	/**
+	 * \brief check if a result is available, without changing its use order
+	 */
+	static bool contains(ResultKey key);
+
+	/**
+	 * \brief copy a cached result into the given buffer
+	 * \return false when the result isn't cached or doesn't match the buffer
+	 */
+	static bool restore(ResultKey key, MemoryBuffer *buffer);
+
+	/**
+	 * \brief store a copy of the buffer, frees least recently used results when needed
+	 */
+	static void store(ResultKey key, MemoryBuffer *buffer);
+
+	/**
+	 * \brief free all cached results
+	 */
+	static void clear();
+
+	/**
+	 * \brief the memory used by the cached results in bytes
+	 */
+	static size_t getMemoryInUse();
+
+private:
+	static void freeUntil(size_t limit);
+};
+
+#endif  /* __COM_RESULTCACHE_H__ */
@@ -95,6 +95,25 @@ protected:
 	                                  float /*x*/, float /*y*/,
 	                                  float /*dx*/[2], float /*dy*/[2]) {}
 
+	/**
+	 * \brief calculate a row of pixels using nearest sampling
+	 * \note this method is called for non-complex, num is never larger than COM_ROW_LENGTH
+	 *
+	 * Operations can override this to process a whole row per call, the default
+	 * implementation calls executePixelSampled for each pixel.
+	 *
+	 * \param output: pixel i is stored at output + i * stride
+	 * \param x: the x-coordinate of the first pixel in image space
+	 * \param y: the y-coordinate of the row in image space
+	 * \param num: the number of pixels to calculate
+	 * \param stride: the number of floats between two pixels in output
+	 */
+	virtual void executeRow(float *output, int x, int y, int num, int stride) {
+		for (int i = 0; i < num; i++, output += stride) {
+			executePixelSampled(output, x + i, y, COM_PS_NEAREST);
+		}
+	}
+
 public:
 	inline void readSampled(float result[4], float x, float y, PixelSampler sampler) {
 		executePixelSampled(result, x, y, sampler);
@@ -105,6 +124,15 @@ public:
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2]) {
 		executePixelFiltered(result, x, y, dx, dy);
 	}
+	inline void readRow(float *result, int x, int y, int num, int stride) {
+		while (num > 0) {
+			const int len = (num < COM_ROW_LENGTH) ? num : COM_ROW_LENGTH;
+			executeRow(result, x, y, len, stride);
+			result += len * stride;
+			x += len;
+			num -= len;
+		}
+	}
 
 	virtual void *initializeTileData(rcti * /*rect*/) { return 0; }
 	virtual void deinitializeTileData(rcti * /*rect*/, void * /*data*/) {}
@@ -211,6 +211,8 @@ static void CL_CALLBACK clContextError(const char *errinfo,
 
 void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 {
+	ExecutionGroup::initializeScheduling();
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	/* deinitialize if number of threads doesn't match */
 	if (g_cpudevices.size() != num_cpu_threads) {
@@ -311,6 +313,8 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 
 void WorkScheduler::deinitialize()
 {
+	ExecutionGroup::deinitializeScheduling();
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	/* deinitialize CPU threads */
 	if (g_cpuInitialized) {
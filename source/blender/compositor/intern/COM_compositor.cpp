@@ -32,6 +32,7 @@ extern "C" {
 
 #include "COM_compositor.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
@@ -80,6 +81,11 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	}
 	BKE_node_preview_init_tree(editingtree, preview_width, preview_height, false);
 
+	/* a new render gives new input, cached results of a previous render can't be used */
+	if (rendering) {
+		ResultCache::clear();
+	}
+
 	/* initialize workscheduler, will check if already done. TODO deinitialize somewhere */
 	bool use_opencl = (editingtree->flag & NTREE_COM_OPENCL) != 0;
 	WorkScheduler::initialize(use_opencl, BKE_render_num_threads(rd));
@@ -111,10 +117,20 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	BLI_mutex_unlock(&s_compositorMutex);
 }
 
+void COM_clearCaches()
+{
+	if (is_compositorMutex_init) {
+		BLI_mutex_lock(&s_compositorMutex);
+		ResultCache::clear();
+		BLI_mutex_unlock(&s_compositorMutex);
+	}
+}
+
 void COM_deinitialize()
 {
 	if (is_compositorMutex_init) {
 		BLI_mutex_lock(&s_compositorMutex);
+		ResultCache::clear();
 		WorkScheduler::deinitialize();
 		is_compositorMutex_init = false;
 		BLI_mutex_unlock(&s_compositorMutex);
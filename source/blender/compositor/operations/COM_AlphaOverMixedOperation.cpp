@@ -54,3 +54,9 @@ void AlphaOverMixedOperation::executePixelSampled(float output[4], float x, floa
 		output[3] = (mul * inputColor1[3]) + value[0] * inputOverColor[3];
 	}
 }
+
+bool AlphaOverMixedOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_x);
+	return MixBaseOperation::hashSettings(hash);
+}
@@ -44,5 +44,6 @@ public:
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
 	void setX(float x) { this->m_x = x; }
+	bool hashSettings(OperationHash &hash);
 };
 #endif
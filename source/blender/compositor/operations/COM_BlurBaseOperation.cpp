@@ -166,6 +166,15 @@ void BlurBaseOperation::setData(const NodeBlurData *data)
 	memcpy(&m_data, data, sizeof(NodeBlurData));
 }
 
+bool BlurBaseOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(&this->m_data, sizeof(this->m_data));
+	hash.add(this->m_size);
+	hash.add(this->m_sizeavailable);
+	hash.add(this->m_extend_bounds);
+	return true;
+}
+
 void BlurBaseOperation::updateSize()
 {
 	if (!this->m_sizeavailable) {
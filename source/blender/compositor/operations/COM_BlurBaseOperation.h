@@ -76,5 +76,6 @@ public:
 
 	void determineResolution(unsigned int resolution[2],
 	                         unsigned int preferredResolution[2]);
+	bool hashSettings(OperationHash &hash);
 };
 #endif
@@ -23,6 +23,7 @@
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
+#include "COM_FFTConvolution.h"
 
 extern "C" {
 #  include "RE_pipeline.h"
@@ -45,6 +46,9 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputBoundingBoxReader = NULL;
 
 	this->m_extend_bounds = false;
+
+	this->m_useFFT = false;
+	this->m_fftResult = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -54,10 +58,45 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
 		updateSize();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_useFFT) {
+		if (this->m_fftResult == NULL) {
+			this->m_fftResult = createFFTResult((MemoryBuffer *)buffer);
+		}
+		buffer = this->m_fftResult;
+	}
 	unlockMutex();
 	return buffer;
 }
 
+MemoryBuffer *BokehBlurOperation::createFFTResult(MemoryBuffer *inputBuffer)
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	const int pixelSize = this->m_size * max_dim / 100.0f;
+	const float m = this->m_bokehDimension / pixelSize;
+	float bokeh[4];
+
+	/* weight of the offset (pixelSize - x, pixelSize - y), mirrored like a convolution kernel.
+	 * executePixel samples offsets -pixelSize to pixelSize - 1, so the first row and column
+	 * (offset pixelSize) stay empty and the kernel is centered at (pixelSize, pixelSize). */
+	rcti kernelRect;
+	BLI_rcti_init(&kernelRect, 0, 2 * pixelSize + 1, 0, 2 * pixelSize + 1);
+	MemoryBuffer *kernel = new MemoryBuffer(COM_DT_COLOR, &kernelRect);
+	kernel->clear();
+	for (int y = 1; y <= 2 * pixelSize; y++) {
+		for (int x = 1; x <= 2 * pixelSize; x++) {
+			float u = this->m_bokehMidX - (pixelSize - x) * m;
+			float v = this->m_bokehMidY - (pixelSize - y) * m;
+			this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+			kernel->writePixel(x, y, bokeh);
+		}
+	}
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	FFTConvolution::convolve(result->getBuffer(), inputBuffer, kernel, COM_NUM_CHANNELS_COLOR, true);
+	delete kernel;
+	return result;
+}
+
 void BokehBlurOperation::initExecution()
 {
 	initMutex();
@@ -74,6 +113,14 @@ void BokehBlurOperation::initExecution()
 	this->m_bokehMidY = height / 2.0f;
 	this->m_bokehDimension = dimension / 2.0f;
 	QualityStepHelper::initExecution(COM_QH_INCREASE);
+
+	/* the size must be known before chunks are scheduled, the whole input is needed.
+	 * Lower qualities skip pixels depending on the image border, they stay spatial. */
+	if (this->m_sizeavailable && getStep() == 1) {
+		const float max_dim = max(this->getWidth(), this->getHeight());
+		const int kernelSize = 2 * (int)(this->m_size * max_dim / 100.0f) + 1;
+		this->m_useFFT = FFTConvolution::isFaster(kernelSize, kernelSize);
+	}
 }
 
 void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
@@ -84,6 +131,11 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 
 	this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
 	if (tempBoundingBox[0] > 0.0f) {
+		if (this->m_useFFT) {
+			((MemoryBuffer *)data)->read(output, x, y);
+			return;
+		}
+
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -138,19 +190,38 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 
 void BokehBlurOperation::deinitExecution()
 {
+	if (this->m_fftResult) {
+		delete this->m_fftResult;
+		this->m_fftResult = NULL;
+	}
+	this->m_useFFT = false;
 	deinitMutex();
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
 }
 
+bool BokehBlurOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_size);
+	hash.add(this->m_sizeavailable);
+	hash.add(this->m_extend_bounds);
+	return true;
+}
+
 bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	rcti newInput;
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (this->m_useFFT) {
+		newInput.xmin = 0;
+		newInput.ymin = 0;
+		newInput.xmax = this->getWidth();
+		newInput.ymax = this->getHeight();
+	}
+	else if (this->m_sizeavailable) {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
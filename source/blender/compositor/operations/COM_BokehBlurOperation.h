@@ -38,6 +38,11 @@ private:
 	float m_bokehMidY;
 	float m_bokehDimension;
 	bool m_extend_bounds;
+
+	/* large blurs are convolved with FFTConvolution, the whole result is stored in m_fftResult */
+	bool m_useFFT;
+	MemoryBuffer *m_fftResult;
+	MemoryBuffer *createFFTResult(MemoryBuffer *inputBuffer);
 public:
 	BokehBlurOperation();
 
@@ -70,5 +75,6 @@ public:
 
 	void determineResolution(unsigned int resolution[2],
 	                         unsigned int preferredResolution[2]);
+	bool hashSettings(OperationHash &hash);
 };
 #endif
@@ -116,6 +116,15 @@ void BokehImageOperation::deinitExecution()
 	}
 }
 
+bool BokehImageOperation::hashSettings(OperationHash &hash)
+{
+	if (this->m_data == NULL) {
+		return false;
+	}
+	hash.add(this->m_data, sizeof(*this->m_data));
+	return true;
+}
+
 void BokehImageOperation::determineResolution(unsigned int resolution[2], unsigned int /*preferredResolution*/[2])
 {
 	resolution[0] = COM_BLUR_BOKEH_PIXELS;
@@ -144,5 +144,7 @@ public:
 	 *It should not be called when the data has been created by the node-editor/user.
 	 */
 	void deleteDataOnFinish() { this->m_deleteData = true; }
+
+	bool hashSettings(OperationHash &hash);
 };
 #endif
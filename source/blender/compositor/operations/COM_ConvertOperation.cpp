@@ -58,6 +58,16 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4], float x,
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = output[1] = output[2] = input[i * 4];
+		output[3] = 1.0f;
+	}
+}
+
 
 /* ******** Color to Value ******** */
 
@@ -74,6 +84,16 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4], float x,
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *inputColor = &input[i * 4];
+		output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
+	}
+}
+
 
 /* ******** Color to BW ******** */
 
@@ -90,6 +110,15 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, fl
 	output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = IMB_colormanagement_get_luminance(&input[i * 4]);
+	}
+}
+
 
 /* ******** Color to Vector ******** */
 
@@ -105,6 +134,15 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x
 	this->m_inputOperation->readSampled(color, x, y, sampler);
 	copy_v3_v3(output, color);}
 
+void ConvertColorToVectorOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		copy_v3_v3(output, &input[i * 4]);
+	}
+}
+
 
 /* ******** Value to Vector ******** */
 
@@ -121,6 +159,15 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x
 	output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = output[1] = output[2] = input[i * 4];
+	}
+}
+
 
 /* ******** Vector to Color ******** */
 
@@ -136,6 +183,16 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x
 	output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		copy_v3_v3(output, &input[i * 4]);
+		output[3] = 1.0f;
+	}
+}
+
 
 /* ******** Vector to Value ******** */
 
@@ -152,6 +209,16 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x
 	output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float input[COM_ROW_LENGTH * 4];
+	this->m_inputOperation->readRow(input, x, y, num, 4);
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *vector = &input[i * 4];
+		output[0] = (vector[0] + vector[1] + vector[2]) / 3.0f;
+	}
+}
+
 
 /* ******** RGB to YCC ******** */
 
@@ -191,6 +258,12 @@ void ConvertRGBToYCCOperation::executePixelSampled(float output[4], float x, flo
 	output[3] = inputColor[3];
 }
 
+bool ConvertRGBToYCCOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_mode);
+	return ConvertBaseOperation::hashSettings(hash);
+}
+
 /* ******** YCC to RGB ******** */
 
 ConvertYCCToRGBOperation::ConvertYCCToRGBOperation() : ConvertBaseOperation()
@@ -228,6 +301,12 @@ void ConvertYCCToRGBOperation::executePixelSampled(float output[4], float x, flo
 	output[3] = inputColor[3];
 }
 
+bool ConvertYCCToRGBOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_mode);
+	return ConvertBaseOperation::hashSettings(hash);
+}
+
 
 /* ******** RGB to YUV ******** */
 
@@ -377,6 +456,12 @@ void SeparateChannelOperation::executePixelSampled(float output[4], float x, flo
 	output[0] = input[this->m_channel];
 }
 
+bool SeparateChannelOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_channel);
+	return true;
+}
+
 
 /* ******** Combine Channels ******** */
 
@@ -35,6 +35,8 @@ public:
 
 	void initExecution();
 	void deinitExecution();
+
+	bool hashSettings(OperationHash & /*hash*/) { return true; }
 };
 
 
@@ -43,6 +45,7 @@ public:
 	ConvertValueToColorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -51,6 +54,7 @@ public:
 	ConvertColorToValueOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -59,6 +63,7 @@ public:
 	ConvertColorToBWOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -67,6 +72,7 @@ public:
 	ConvertColorToVectorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -75,6 +81,7 @@ public:
 	ConvertValueToVectorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -83,6 +90,7 @@ public:
 	ConvertVectorToColorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -91,6 +99,7 @@ public:
 	ConvertVectorToValueOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 };
 
 
@@ -105,6 +114,8 @@ public:
 
 	/** Set the YCC mode */
 	void setMode(int mode);
+
+	bool hashSettings(OperationHash &hash);
 };
 
 
@@ -119,6 +130,8 @@ public:
 
 	/** Set the YCC mode */
 	void setMode(int mode);
+
+	bool hashSettings(OperationHash &hash);
 };
 
 
@@ -182,6 +195,8 @@ public:
 	void deinitExecution();
 
 	void setChannel(int channel) { this->m_channel = channel; }
+
+	bool hashSettings(OperationHash &hash);
 };
 
 
@@ -197,6 +212,8 @@ public:
 
 	void initExecution();
 	void deinitExecution();
+
+	bool hashSettings(OperationHash & /*hash*/) { return true; }
 };
 
 #endif
@@ -288,6 +288,13 @@ void FastGaussianBlurValueOperation::deinitExecution()
 	deinitMutex();
 }
 
+bool FastGaussianBlurValueOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_sigma);
+	hash.add(this->m_overlay);
+	return true;
+}
+
 void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 {
 	lockMutex();
@@ -71,6 +71,7 @@ public:
 
 	/* used for DOF blurring ZBuffer */
 	void setOverlay(int overlay) { this->m_overlay = overlay; }
+	bool hashSettings(OperationHash &hash);
 };
 
 #endif
@@ -53,6 +53,26 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
 	output[3] = inputValue[3];
 }
 
+void GammaOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue[COM_ROW_LENGTH * 4];
+	float inputGamma[COM_ROW_LENGTH * 4];
+
+	this->m_inputProgram->readRow(inputValue, x, y, num, 4);
+	this->m_inputGammaProgram->readRow(inputGamma, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *color = &inputValue[i * 4];
+		const float gamma = inputGamma[i * 4];
+		/* check for negative to avoid nan's */
+		output[0] = color[0] > 0.0f ? powf(color[0], gamma) : color[0];
+		output[1] = color[1] > 0.0f ? powf(color[1], gamma) : color[1];
+		output[2] = color[2] > 0.0f ? powf(color[2], gamma) : color[2];
+
+		output[3] = color[3];
+	}
+}
+
 void GammaOperation::deinitExecution()
 {
 	this->m_inputProgram = NULL;
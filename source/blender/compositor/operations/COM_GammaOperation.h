@@ -40,6 +40,7 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 
 	/**
 	 * Initialize the execution
@@ -50,5 +51,6 @@ public:
 	 * Deinitialize the execution
 	 */
 	void deinitExecution();
+	bool hashSettings(OperationHash & /*hash*/) { return true; }
 };
 #endif
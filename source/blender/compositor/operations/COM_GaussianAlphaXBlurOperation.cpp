@@ -159,6 +159,13 @@ void GaussianAlphaXBlurOperation::deinitExecution()
 	deinitMutex();
 }
 
+bool GaussianAlphaXBlurOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_falloff);
+	hash.add(this->m_do_subtract);
+	return BlurBaseOperation::hashSettings(hash);
+}
+
 bool GaussianAlphaXBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	rcti newInput;
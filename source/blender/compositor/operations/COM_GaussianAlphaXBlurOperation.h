@@ -60,5 +60,6 @@ public:
 	 */
 	void setSubtract(bool subtract) { this->m_do_subtract = subtract; }
 	void setFalloff(int falloff) { this->m_falloff = falloff; }
+	bool hashSettings(OperationHash &hash);
 };
 #endif
@@ -160,6 +160,13 @@ void GaussianAlphaYBlurOperation::deinitExecution()
 	deinitMutex();
 }
 
+bool GaussianAlphaYBlurOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_falloff);
+	hash.add(this->m_do_subtract);
+	return BlurBaseOperation::hashSettings(hash);
+}
+
 bool GaussianAlphaYBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	rcti newInput;
@@ -23,6 +23,7 @@
 #include "COM_GaussianBokehBlurOperation.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
+#include "COM_FFTConvolution.h"
 extern "C" {
 #  include "RE_pipeline.h"
 }
@@ -30,6 +31,8 @@ extern "C" {
 GaussianBokehBlurOperation::GaussianBokehBlurOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
 	this->m_gausstab = NULL;
+	this->m_useFFT = false;
+	this->m_fftResult = NULL;
 }
 
 void *GaussianBokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -39,10 +42,30 @@ void *GaussianBokehBlurOperation::initializeTileData(rcti * /*rect*/)
 		updateGauss();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_useFFT) {
+		if (this->m_fftResult == NULL) {
+			this->m_fftResult = createFFTResult((MemoryBuffer *)buffer);
+		}
+		buffer = this->m_fftResult;
+	}
 	unlockMutex();
 	return buffer;
 }
 
+MemoryBuffer *GaussianBokehBlurOperation::createFFTResult(MemoryBuffer *inputBuffer)
+{
+	rcti kernelRect;
+	BLI_rcti_init(&kernelRect, 0, 2 * this->m_radx + 1, 0, 2 * this->m_rady + 1);
+	MemoryBuffer *kernel = new MemoryBuffer(COM_DT_VALUE, &kernelRect);
+	memcpy(kernel->getBuffer(), this->m_gausstab,
+	       sizeof(float) * kernel->getWidth() * kernel->getHeight());
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	FFTConvolution::convolve(result->getBuffer(), inputBuffer, kernel, COM_NUM_CHANNELS_COLOR, true);
+	delete kernel;
+	return result;
+}
+
 void GaussianBokehBlurOperation::initExecution()
 {
 	BlurBaseOperation::initExecution();
@@ -51,6 +74,8 @@ void GaussianBokehBlurOperation::initExecution()
 
 	if (this->m_sizeavailable) {
 		updateGauss();
+		/* the size must be known before chunks are scheduled, the whole input is needed */
+		this->m_useFFT = FFTConvolution::isFaster(2 * this->m_radx + 1, 2 * this->m_rady + 1);
 	}
 }
 
@@ -116,6 +141,11 @@ void GaussianBokehBlurOperation::updateGauss()
 
 void GaussianBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+	if (this->m_useFFT) {
+		((MemoryBuffer *)data)->read(output, x, y);
+		return;
+	}
+
 	float tempColor[4];
 	tempColor[0] = 0;
 	tempColor[1] = 0;
@@ -163,6 +193,12 @@ void GaussianBokehBlurOperation::deinitExecution()
 		this->m_gausstab = NULL;
 	}
 
+	if (this->m_fftResult) {
+		delete this->m_fftResult;
+		this->m_fftResult = NULL;
+	}
+	this->m_useFFT = false;
+
 	deinitMutex();
 }
 
@@ -32,6 +32,11 @@ private:
 	int m_radx, m_rady;
 	void updateGauss();
 
+	/* large blurs are convolved with FFTConvolution, the whole result is stored in m_fftResult */
+	bool m_useFFT;
+	MemoryBuffer *m_fftResult;
+	MemoryBuffer *createFFTResult(MemoryBuffer *inputBuffer);
+
 public:
 	GaussianBokehBlurOperation();
 	void initExecution();
@@ -72,6 +72,12 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+bool MathBaseOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_useClamp);
+	return true;
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -85,6 +91,20 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
 	clampIfNeeded(output);
 }
 
+void MathAddOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue1[COM_ROW_LENGTH * 4];
+	float inputValue2[COM_ROW_LENGTH * 4];
+
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, num, 4);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = inputValue1[i * 4] + inputValue2[i * 4];
+		clampIfNeeded(output);
+	}
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -98,6 +118,20 @@ void MathSubtractOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue1[COM_ROW_LENGTH * 4];
+	float inputValue2[COM_ROW_LENGTH * 4];
+
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, num, 4);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = inputValue1[i * 4] - inputValue2[i * 4];
+		clampIfNeeded(output);
+	}
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -111,6 +145,20 @@ void MathMultiplyOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue1[COM_ROW_LENGTH * 4];
+	float inputValue2[COM_ROW_LENGTH * 4];
+
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, num, 4);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = inputValue1[i * 4] * inputValue2[i * 4];
+		clampIfNeeded(output);
+	}
+}
+
 void MathDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -127,6 +175,23 @@ void MathDivideOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue1[COM_ROW_LENGTH * 4];
+	float inputValue2[COM_ROW_LENGTH * 4];
+
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, num, 4);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		if (inputValue2[i * 4] == 0) /* We don't want to divide by zero. */
+			output[0] = 0.0;
+		else
+			output[0] = inputValue1[i * 4] / inputValue2[i * 4];
+		clampIfNeeded(output);
+	}
+}
+
 void MathSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -265,6 +330,20 @@ void MathMinimumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue1[COM_ROW_LENGTH * 4];
+	float inputValue2[COM_ROW_LENGTH * 4];
+
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, num, 4);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = min(inputValue1[i * 4], inputValue2[i * 4]);
+		clampIfNeeded(output);
+	}
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -278,6 +357,20 @@ void MathMaximumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputValue1[COM_ROW_LENGTH * 4];
+	float inputValue2[COM_ROW_LENGTH * 4];
+
+	this->m_inputValue1Operation->readRow(inputValue1, x, y, num, 4);
+	this->m_inputValue2Operation->readRow(inputValue2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = max(inputValue1[i * 4], inputValue2[i * 4]);
+		clampIfNeeded(output);
+	}
+}
+
 void MathRoundOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
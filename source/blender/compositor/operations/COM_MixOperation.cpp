@@ -100,6 +100,13 @@ void MixBaseOperation::deinitExecution()
 	this->m_inputColor2Operation = NULL;
 }
 
+bool MixBaseOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_valueAlphaMultiply);
+	hash.add(this->m_useClamp);
+	return true;
+}
+
 /* ******** Mix Add Operation ******** */
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
@@ -129,6 +136,32 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputColor1[COM_ROW_LENGTH * 4];
+	float inputColor2[COM_ROW_LENGTH * 4];
+	float inputValue[COM_ROW_LENGTH * 4];
+
+	this->m_inputValueOperation->readRow(inputValue, x, y, num, 4);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, num, 4);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *color1 = &inputColor1[i * 4];
+		const float *color2 = &inputColor2[i * 4];
+		float value = inputValue[i * 4];
+		if (this->useValueAlphaMultiply()) {
+			value *= color2[3];
+		}
+		output[0] = color1[0] + value * color2[0];
+		output[1] = color1[1] + value * color2[1];
+		output[2] = color1[2] + value * color2[2];
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +193,33 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputColor1[COM_ROW_LENGTH * 4];
+	float inputColor2[COM_ROW_LENGTH * 4];
+	float inputValue[COM_ROW_LENGTH * 4];
+
+	this->m_inputValueOperation->readRow(inputValue, x, y, num, 4);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, num, 4);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *color1 = &inputColor1[i * 4];
+		const float *color2 = &inputColor2[i * 4];
+		float value = inputValue[i * 4];
+		if (this->useValueAlphaMultiply()) {
+			value *= color2[3];
+		}
+		float valuem = 1.0f - value;
+		output[0] = valuem * (color1[0]) + value * (color2[0]);
+		output[1] = valuem * (color1[1]) + value * (color2[1]);
+		output[2] = valuem * (color1[2]) + value * (color2[2]);
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -623,6 +683,33 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputColor1[COM_ROW_LENGTH * 4];
+	float inputColor2[COM_ROW_LENGTH * 4];
+	float inputValue[COM_ROW_LENGTH * 4];
+
+	this->m_inputValueOperation->readRow(inputValue, x, y, num, 4);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, num, 4);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *color1 = &inputColor1[i * 4];
+		const float *color2 = &inputColor2[i * 4];
+		float value = inputValue[i * 4];
+		if (this->useValueAlphaMultiply()) {
+			value *= color2[3];
+		}
+		float valuem = 1.0f - value;
+		output[0] = color1[0] * (valuem + value * color2[0]);
+		output[1] = color1[1] * (valuem + value * color2[1]);
+		output[2] = color1[2] * (valuem + value * color2[2]);
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -806,6 +893,32 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	float inputColor1[COM_ROW_LENGTH * 4];
+	float inputColor2[COM_ROW_LENGTH * 4];
+	float inputValue[COM_ROW_LENGTH * 4];
+
+	this->m_inputValueOperation->readRow(inputValue, x, y, num, 4);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, num, 4);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, num, 4);
+
+	for (int i = 0; i < num; i++, output += stride) {
+		const float *color1 = &inputColor1[i * 4];
+		const float *color2 = &inputColor2[i * 4];
+		float value = inputValue[i * 4];
+		if (this->useValueAlphaMultiply()) {
+			value *= color2[3];
+		}
+		output[0] = color1[0] - value * (color2[0]);
+		output[1] = color1[1] - value * (color2[1]);
+		output[2] = color1[2] - value * (color2[2]);
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
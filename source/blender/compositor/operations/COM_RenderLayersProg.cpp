@@ -176,6 +176,29 @@ void RenderLayersProg::deinitExecution()
 	this->m_inputBuffer = NULL;
 }
 
+bool RenderLayersProg::hashSettings(OperationHash &hash)
+{
+	Render *re = (this->m_scene) ? RE_GetSceneRender(this->m_scene) : NULL;
+
+	/* Passes are written again by every render, while the render, layer and pass names stay
+	 * the same. The start time identifies the render: it's only set when a render begins
+	 * (RE_InitState, do_render_all_options), which is exactly when the pass contents change.
+	 * Changing frames or the frame range without rendering keeps it, so results stay cached.
+	 * Without it a new render would be composited from the results of the previous one. */
+	hash.add((const void *)re);
+	if (re) {
+		RenderStats *stats = RE_GetStats(re);
+		hash.add(&stats->starttime, sizeof(stats->starttime));
+	}
+
+	hash.add((const void *)this->m_scene);
+	hash.add((int)this->m_layerId);
+	hash.addString(this->m_passName.c_str());
+	hash.addString(this->m_viewName);
+	hash.add(this->m_elementsize);
+	return true;
+}
+
 void RenderLayersProg::determineResolution(unsigned int resolution[2], unsigned int /*preferredResolution*/[2])
 {
 	Scene *sce = this->getScene();
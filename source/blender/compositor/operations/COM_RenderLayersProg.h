@@ -103,6 +103,8 @@ public:
 	void initExecution();
 	void deinitExecution();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+	bool hashSettings(OperationHash &hash);
 };
 
 class RenderLayersAOOperation : public RenderLayersProg {
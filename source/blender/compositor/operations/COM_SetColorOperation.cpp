@@ -34,6 +34,19 @@ void SetColorOperation::executePixelSampled(float output[4],
 	copy_v4_v4(output, this->m_color);
 }
 
+void SetColorOperation::executeRow(float *output, int /*x*/, int /*y*/, int num, int stride)
+{
+	for (int i = 0; i < num; i++, output += stride) {
+		copy_v4_v4(output, this->m_color);
+	}
+}
+
+bool SetColorOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_color, sizeof(this->m_color));
+	return true;
+}
+
 void SetColorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
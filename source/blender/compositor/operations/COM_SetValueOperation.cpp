@@ -34,6 +34,19 @@ void SetValueOperation::executePixelSampled(float output[4],
 	output[0] = this->m_value;
 }
 
+void SetValueOperation::executeRow(float *output, int /*x*/, int /*y*/, int num, int stride)
+{
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = this->m_value;
+	}
+}
+
+bool SetValueOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_value);
+	return true;
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
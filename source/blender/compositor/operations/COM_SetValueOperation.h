@@ -47,8 +47,10 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
 	bool isSetOperation() const { return true; }
+	bool hashSettings(OperationHash &hash);
 };
 #endif
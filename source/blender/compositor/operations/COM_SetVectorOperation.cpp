@@ -37,6 +37,24 @@ void SetVectorOperation::executePixelSampled(float output[4],
 	output[2] = this->m_z;
 }
 
+void SetVectorOperation::executeRow(float *output, int /*x*/, int /*y*/, int num, int stride)
+{
+	for (int i = 0; i < num; i++, output += stride) {
+		output[0] = this->m_x;
+		output[1] = this->m_y;
+		output[2] = this->m_z;
+	}
+}
+
+bool SetVectorOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_x);
+	hash.add(this->m_y);
+	hash.add(this->m_z);
+	hash.add(this->m_w);
+	return true;
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -55,6 +55,7 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 
 	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 	bool isSetOperation() const { return true; }
@@ -64,5 +65,6 @@ public:
 		setY(vector[1]);
 		setZ(vector[2]);
 	}
+	bool hashSettings(OperationHash &hash);
 };
 #endif
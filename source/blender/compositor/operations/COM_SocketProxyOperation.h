@@ -35,6 +35,8 @@ public:
 	bool getUseConversion() const { return m_use_conversion; }
 	void setUseConversion(bool use_conversion) { m_use_conversion = use_conversion; }
 
+	bool hashSettings(OperationHash & /*hash*/) { return true; }
+
 private:
 	bool m_use_conversion;
 };
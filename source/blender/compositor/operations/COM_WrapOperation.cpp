@@ -74,6 +74,12 @@ void WrapOperation::executePixelSampled(float output[4], float x, float y, Pixel
 	executePixelExtend(output, nx, ny, sampler, extend_x, extend_y);
 }
 
+void WrapOperation::executeRow(float *output, int x, int y, int num, int stride)
+{
+	/* wrapping is done per pixel, don't read rows directly from the buffer */
+	NodeOperation::executeRow(output, x, y, num, stride);
+}
+
 bool WrapOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	rcti newInput;
@@ -108,3 +114,9 @@ void WrapOperation::setWrapping(int wrapping_type)
 {
 	m_wrappingType = wrapping_type;
 }
+
+bool WrapOperation::hashSettings(OperationHash &hash)
+{
+	hash.add(this->m_wrappingType);
+	return ReadBufferOperation::hashSettings(hash);
+}
@@ -32,12 +32,14 @@ public:
 	WrapOperation(DataType datetype);
 	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num, int stride);
 
 	void setWrapping(int wrapping_type);
 	float getWrappedOriginalXPos(float x);
 	float getWrappedOriginalYPos(float y);
 
 	void setFactorXY(float factorX, float factorY);
+	bool hashSettings(OperationHash &hash);
 };
 
 #endif
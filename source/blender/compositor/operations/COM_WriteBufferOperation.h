@@ -52,5 +52,6 @@ public:
 		return m_input;
 	}
 
+	bool hashSettings(OperationHash & /*hash*/) { return true; }
 };
 #endif
@@ -57,6 +57,7 @@ extern "C" {
 #include "DEG_depsgraph_build.h"
 
 #include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_pose_batch.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/nodes/deg_node.h"
 #include "intern/nodes/deg_node_component.h"
@@ -67,6 +68,22 @@ extern "C" {
 
 namespace DEG {
 
+namespace {
+
+void pose_eval_bone_batch(::Depsgraph *depsgraph,
+                          Scene *scene,
+                          Object *object,
+                          const vector<int> &pchan_indices)
+{
+	BKE_pose_eval_bone_batch(depsgraph,
+	                         scene,
+	                         object,
+	                         &pchan_indices[0],
+	                         pchan_indices.size());
+}
+
+}  // namespace
+
 void DepsgraphNodeBuilder::build_pose_constraints(
         Object *object,
         bPoseChannel *pchan,
@@ -235,6 +252,19 @@ void DepsgraphNodeBuilder::build_rig(Object *object, bool is_object_visible)
 	                                           object_cow),
 	                             DEG_OPCODE_POSE_DONE);
 	op_node->set_as_exit();
+	/* Batches of unconstrained bones, one per root bone. */
+	PoseBoneBatches bone_batches(object);
+	for (size_t i = 0; i < bone_batches.roots.size(); i++) {
+		add_operation_node(&object->id,
+		                   DEG_NODE_TYPE_EVAL_POSE,
+		                   bone_batches.roots[i]->name,
+		                   function_bind(pose_eval_bone_batch,
+		                                 _1,
+		                                 scene_cow,
+		                                 object_cow,
+		                                 bone_batches.pchan_indices[i]),
+		                   DEG_OPCODE_POSE_BATCH);
+	}
 	/* Bones. */
 	int pchan_index = 0;
 	LISTBASE_FOREACH (bPoseChannel *, pchan, &object->pose->chanbase) {
@@ -243,24 +273,33 @@ void DepsgraphNodeBuilder::build_rig(Object *object, bool is_object_visible)
 		                             DEG_OPCODE_BONE_LOCAL);
 		op_node->set_as_entry();
 
-		add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
-		                   function_bind(BKE_pose_eval_bone, _1,
-		                                 scene_cow,
-		                                 object_cow,
-		                                 pchan_index),
-		                   DEG_OPCODE_BONE_POSE_PARENT);
-
-		/* NOTE: Dedicated noop for easier relationship construction. */
-		add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
-		                   NULL,
-		                   DEG_OPCODE_BONE_READY);
+		if (bone_batches.batch_root(pchan_index) != NULL) {
+			/* Evaluated by the batch, only keep entry and exit points for
+			 * relations from outside of the rig. */
+			op_node = add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
+			                             NULL,
+			                             DEG_OPCODE_BONE_DONE);
+		}
+		else {
+			add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
+			                   function_bind(BKE_pose_eval_bone, _1,
+			                                 scene_cow,
+			                                 object_cow,
+			                                 pchan_index),
+			                   DEG_OPCODE_BONE_POSE_PARENT);
+
+			/* NOTE: Dedicated noop for easier relationship construction. */
+			add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
+			                   NULL,
+			                   DEG_OPCODE_BONE_READY);
 
-		op_node = add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
-		                             function_bind(BKE_pose_bone_done,
-		                                           _1,
-		                                           object_cow,
-		                                           pchan_index),
-		                             DEG_OPCODE_BONE_DONE);
+			op_node = add_operation_node(&object->id, DEG_NODE_TYPE_BONE, pchan->name,
+			                             function_bind(BKE_pose_bone_done,
+			                                           _1,
+			                                           object_cow,
+			                                           pchan_index),
+			                             DEG_OPCODE_BONE_DONE);
+		}
 
 		/* B-Bone shape computation - the real last step if present. */
 		if (pchan->bone != NULL && pchan->bone->segments > 1) {
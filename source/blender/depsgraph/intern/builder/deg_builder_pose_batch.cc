@@ -0,0 +1,189 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2018 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): None Yet
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/depsgraph/intern/builder/deg_builder_pose_batch.cc
+ *  \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_pose_batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+extern "C" {
+#include "DNA_anim_types.h"
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_action.h"
+}
+
+#include "util/deg_util_foreach.h"
+
+namespace DEG {
+
+namespace {
+
+typedef std::pair<int, int> DepthIndex;
+
+bool depth_index_less(const DepthIndex &a, const DepthIndex &b)
+{
+	return a.first < b.first;
+}
+
+int pchan_index_get(GHash *index_map, bPoseChannel *pchan)
+{
+	return POINTER_AS_INT(BLI_ghash_lookup(index_map, pchan));
+}
+
+/* Exclude bones which have their transform driven: the driver might read
+ * other bones of the same batch, which would make the batch depend on itself. */
+void exclude_driven_bones(AnimData *adt,
+                          bPose *pose,
+                          GHash *index_map,
+                          vector<bool> *excluded)
+{
+	if (adt == NULL) {
+		return;
+	}
+	LISTBASE_FOREACH (FCurve *, fcu, &adt->drivers) {
+		if (fcu->rna_path == NULL) {
+			continue;
+		}
+		char *bone_name = BLI_str_quoted_substrN(fcu->rna_path, "bones[");
+		if (bone_name == NULL) {
+			continue;
+		}
+		/* Custom properties are evaluated separately from the bone itself. */
+		const char *suffix = strstr(fcu->rna_path, "\"]");
+		if (suffix == NULL || suffix[2] != '[') {
+			bPoseChannel *pchan = BKE_pose_channel_find_name(pose, bone_name);
+			if (pchan != NULL) {
+				(*excluded)[pchan_index_get(index_map, pchan)] = true;
+			}
+		}
+		MEM_freeN(bone_name);
+	}
+}
+
+}  // namespace
+
+PoseBoneBatches::PoseBoneBatches(Object *object)
+{
+	bPose *pose = object->pose;
+	bArmature *armature = (bArmature *)object->data;
+	const int num_pchans = BLI_listbase_count(&pose->chanbase);
+	GHash *index_map = BLI_ghash_ptr_new_ex(__func__, num_pchans);
+	vector<bool> excluded(num_pchans, false);
+	int pchan_index = 0;
+	LISTBASE_FOREACH (bPoseChannel *, pchan, &pose->chanbase) {
+		BLI_ghash_insert(index_map, pchan, POINTER_FROM_INT(pchan_index++));
+	}
+	/* Constraints, and all bones which might be a part of an IK chain. */
+	pchan_index = 0;
+	LISTBASE_FOREACH (bPoseChannel *, pchan, &pose->chanbase) {
+		if (pchan->constraints.first != NULL) {
+			excluded[pchan_index] = true;
+		}
+		LISTBASE_FOREACH (bConstraint *, con, &pchan->constraints) {
+			if (ELEM(con->type,
+			         CONSTRAINT_TYPE_KINEMATIC,
+			         CONSTRAINT_TYPE_SPLINEIK))
+			{
+				for (bPoseChannel *parchan = pchan->parent;
+				     parchan != NULL;
+				     parchan = parchan->parent)
+				{
+					excluded[pchan_index_get(index_map, parchan)] = true;
+				}
+			}
+		}
+		pchan_index++;
+	}
+	exclude_driven_bones(object->adt, pose, index_map, &excluded);
+	exclude_driven_bones(armature->adt, pose, index_map, &excluded);
+	/* Bones with all of their parents batched are put into the batch of the
+	 * root bone. */
+	vector<int> root_batch_index(num_pchans, -1);
+	vector<vector<DepthIndex> > batches;
+	batch_index_.resize(num_pchans, -1);
+	pchan_index = 0;
+	LISTBASE_FOREACH (bPoseChannel *, pchan, &pose->chanbase) {
+		bool is_batched = !excluded[pchan_index];
+		bPoseChannel *rootchan = pchan;
+		int depth = 0;
+		for (bPoseChannel *parchan = pchan->parent;
+		     parchan != NULL && is_batched;
+		     parchan = parchan->parent)
+		{
+			is_batched = !excluded[pchan_index_get(index_map, parchan)];
+			rootchan = parchan;
+			depth++;
+		}
+		if (is_batched) {
+			const int root_index = pchan_index_get(index_map, rootchan);
+			if (root_batch_index[root_index] == -1) {
+				root_batch_index[root_index] = roots.size();
+				roots.push_back(rootchan);
+				batches.push_back(vector<DepthIndex>());
+			}
+			batch_index_[pchan_index] = root_batch_index[root_index];
+			batches[batch_index_[pchan_index]].push_back(
+			        DepthIndex(depth, pchan_index));
+		}
+		pchan_index++;
+	}
+	/* Evaluation order within a batch. */
+	pchan_indices.resize(batches.size());
+	for (size_t i = 0; i < batches.size(); i++) {
+		std::stable_sort(batches[i].begin(),
+		                 batches[i].end(),
+		                 depth_index_less);
+		foreach (const DepthIndex &depth_index, batches[i]) {
+			pchan_indices[i].push_back(depth_index.second);
+		}
+	}
+	BLI_ghash_free(index_map, NULL, NULL);
+}
+
+bPoseChannel *PoseBoneBatches::batch_root(int pchan_index) const
+{
+	const int batch_index = batch_index_[pchan_index];
+	if (batch_index == -1) {
+		return NULL;
+	}
+	return roots[batch_index];
+}
+
+}  // namespace DEG
@@ -0,0 +1,66 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2018 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): None Yet
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/depsgraph/intern/builder/deg_builder_pose_batch.h
+ *  \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "intern/depsgraph_types.h"
+
+struct Object;
+struct bPoseChannel;
+
+namespace DEG {
+
+/* Bones of a rig which are evaluated in batches instead of by their own
+ * pose and done operations.
+ *
+ * A bone is batched when neither it nor any of its parents has constraints
+ * or is driven, and it is not a part of an IK chain. All batched bones under
+ * the same root bone are evaluated by one operation, so independent hierarchies
+ * of a rig (and the rigs of a crowd) are evaluated in parallel, without the
+ * scheduling overhead of every single bone. Bones which need their own steps
+ * keep them, and depend on the "done" step of their batched parent.
+ */
+struct PoseBoneBatches {
+	PoseBoneBatches(Object *object);
+
+	/* Root bone of the batch which evaluates the given pose channel,
+	 * NULL if the channel is evaluated by its own operations. */
+	bPoseChannel *batch_root(int pchan_index) const;
+
+	/* Root bone of every batch. */
+	vector<bPoseChannel *> roots;
+	/* Indices of the pose channels of every batch, parents before children. */
+	vector<vector<int> > pchan_indices;
+
+protected:
+	/* Batch of every pose channel, -1 for channels which are not batched. */
+	vector<int> batch_index_;
+};
+
+}  // namespace DEG
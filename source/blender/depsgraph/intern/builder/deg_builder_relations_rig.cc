@@ -59,6 +59,7 @@ extern "C" {
 
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_pchanmap.h"
+#include "intern/builder/deg_builder_pose_batch.h"
 
 #include "intern/nodes/deg_node.h"
 #include "intern/nodes/deg_node_component.h"
@@ -406,7 +407,10 @@ void DepsgraphRelationBuilder::build_rig(Object *object)
 		add_relation(local_transform_key, pose_key, "Local Transforms");
 	}
 	/* Links between operations for each bone. */
+	PoseBoneBatches bone_batches(object);
+	int pchan_index = 0;
 	LISTBASE_FOREACH (bPoseChannel *, pchan, &object->pose->chanbase) {
+		bPoseChannel *batch_rootchan = bone_batches.batch_root(pchan_index++);
 		OperationKey bone_local_key(&object->id,
 		                            DEG_NODE_TYPE_BONE,
 		                            pchan->name,
@@ -429,10 +433,21 @@ void DepsgraphRelationBuilder::build_rig(Object *object)
 		             bone_local_key,
 		             "Pose Init - Bone Local",
 		             DEPSREL_FLAG_GODMODE);
-		/* Local to pose parenting operation. */
-		add_relation(bone_local_key, bone_pose_key, "Bone Local - Bone Pose");
+		if (batch_rootchan != NULL) {
+			/* Parents and the whole pose/done chain are handled by the batch. */
+			OperationKey batch_key(&object->id,
+			                       DEG_NODE_TYPE_EVAL_POSE,
+			                       batch_rootchan->name,
+			                       DEG_OPCODE_POSE_BATCH);
+			add_relation(bone_local_key, batch_key, "Bone Local -> Bone Batch");
+			add_relation(batch_key, bone_done_key, "Bone Batch -> Done");
+		}
+		else {
+			/* Local to pose parenting operation. */
+			add_relation(bone_local_key, bone_pose_key, "Bone Local - Bone Pose");
+		}
 		/* Parent relation. */
-		if (pchan->parent != NULL) {
+		if (pchan->parent != NULL && batch_rootchan == NULL) {
 			eDepsOperation_Code parent_key_opcode;
 			/* NOTE: this difference in handling allows us to prevent lockups
 			 * while ensuring correct poses for separate chains. */
@@ -475,7 +490,7 @@ void DepsgraphRelationBuilder::build_rig(Object *object)
 			add_relation(
 			        constraints_key, bone_ready_key, "Constraints -> Ready");
 		}
-		else {
+		else if (batch_rootchan == NULL) {
 			/* Pose -> Ready */
 			add_relation(bone_pose_key, bone_ready_key, "Pose -> Ready");
 		}
@@ -483,7 +498,9 @@ void DepsgraphRelationBuilder::build_rig(Object *object)
 		 * NOTE: For bones without IK, this is all that's needed.
 		 *       For IK chains however, an additional rel is created from IK
 		 *       to done, with transitive reduction removing this one. */
-		add_relation(bone_ready_key, bone_done_key, "Ready -> Done");
+		if (batch_rootchan == NULL) {
+			add_relation(bone_ready_key, bone_done_key, "Ready -> Done");
+		}
 		/* B-Bone shape is the real final step after Done if present. */
 		if (pchan->bone != NULL && pchan->bone->segments > 1) {
 			OperationKey bone_segments_key(&object->id,
@@ -44,6 +44,7 @@ extern "C" {
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "BKE_animsys.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 } /* extern "C" */
@@ -285,6 +286,8 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
 #endif
 	/* Relations are up to date. */
 	deg_graph->need_update = false;
+	/* Pre-resolved animation bindings might point to data which is gone. */
+	BKE_animsys_bindings_invalidate();
 	/* Finish statistics. */
 	if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
 		printf("Depsgraph built in %f seconds.\n",
@@ -238,6 +238,8 @@ typedef enum eDepsOperation_Code {
 	/* IK/Spline Solvers */
 	DEG_OPCODE_POSE_IK_SOLVER,
 	DEG_OPCODE_POSE_SPLINE_IK_SOLVER,
+	/* Unconstrained bones under a common root, evaluated in one go. */
+	DEG_OPCODE_POSE_BATCH,
 
 	/* Bone. ---------------------------------------------------------------- */
 	/* Bone local transforms - entry point */
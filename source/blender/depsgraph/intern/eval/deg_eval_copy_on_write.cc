@@ -958,6 +958,10 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph,
 			drawdata_ptr->first = drawdata_ptr->last = NULL;
 		}
 	}
+	/* Pointers of pre-resolved animation bindings into this datablock are
+	 * about to become invalid.
+	 */
+	BKE_animsys_bindings_invalidate();
 	deg_free_copy_on_write_datablock(id_cow);
 	deg_expand_copy_on_write_datablock(depsgraph, id_node);
 	/* Restore GPU materials. */
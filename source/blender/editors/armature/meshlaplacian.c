@@ -37,6 +37,7 @@
 #include "BLI_memarena.h"
 #include "BLI_string.h"
 #include "BLI_alloca.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -928,34 +929,42 @@ static void harmonic_ray_callback(void *userdata, int index, const BVHTreeRay *r
 	}
 }
 
-static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const float co1[3], const float co2[3])
+/* Cast a ray from co1 to co2 against the cage, doesn't allocate so it's safe to use from multiple threads. */
+static bool meshdeform_ray_tree_cast(
+        MeshDeformBind *mdb, const float co1[3], const float co2[3],
+        MeshDeformIsect *r_isect_mdef, BVHTreeRayHit *r_hit)
 {
-	BVHTreeRayHit hit;
-	MeshDeformIsect isect_mdef;
 	struct MeshRayCallbackData data = {
 		mdb,
-		&isect_mdef,
+		r_isect_mdef,
 	};
 	float end[3], vec_normal[3];
 
 	/* happens binding when a cage has no faces */
 	if (UNLIKELY(mdb->bvhtree == NULL))
-		return NULL;
+		return false;
 
 	/* setup isec */
-	memset(&isect_mdef, 0, sizeof(isect_mdef));
-	isect_mdef.lambda = 1e10f;
+	memset(r_isect_mdef, 0, sizeof(*r_isect_mdef));
+	r_isect_mdef->lambda = 1e10f;
 
-	copy_v3_v3(isect_mdef.start, co1);
+	copy_v3_v3(r_isect_mdef->start, co1);
 	copy_v3_v3(end, co2);
-	sub_v3_v3v3(isect_mdef.vec, end, isect_mdef.start);
-	isect_mdef.vec_length = normalize_v3_v3(vec_normal, isect_mdef.vec);
+	sub_v3_v3v3(r_isect_mdef->vec, end, r_isect_mdef->start);
+	r_isect_mdef->vec_length = normalize_v3_v3(vec_normal, r_isect_mdef->vec);
 
-	hit.index = -1;
-	hit.dist = BVH_RAYCAST_DIST_MAX;
-	if (BLI_bvhtree_ray_cast_ex(mdb->bvhtree, isect_mdef.start, vec_normal,
-	                            0.0, &hit, harmonic_ray_callback, &data, BVH_RAYCAST_WATERTIGHT) != -1)
-	{
+	r_hit->index = -1;
+	r_hit->dist = BVH_RAYCAST_DIST_MAX;
+	return (BLI_bvhtree_ray_cast_ex(mdb->bvhtree, r_isect_mdef->start, vec_normal,
+	                                0.0, r_hit, harmonic_ray_callback, &data, BVH_RAYCAST_WATERTIGHT) != -1);
+}
+
+static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const float co1[3], const float co2[3])
+{
+	BVHTreeRayHit hit;
+	MeshDeformIsect isect_mdef;
+
+	if (meshdeform_ray_tree_cast(mdb, co1, co2, &isect_mdef, &hit)) {
 		const MLoop *mloop = mdb->cagemesh_cache.mloop;
 		const MLoopTri *lt = &mdb->cagemesh_cache.looptri[hit.index];
 		const MPoly *mp = &mdb->cagemesh_cache.mpoly[lt->poly];
@@ -993,8 +1002,9 @@ static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb, const
 
 static int meshdeform_inside_cage(MeshDeformBind *mdb, float *co)
 {
-	MDefBoundIsect *isect;
-	float outside[3], start[3], dir[3];
+	BVHTreeRayHit hit;
+	MeshDeformIsect isect_mdef;
+	float outside[3];
 	int i;
 
 	for (i = 1; i <= 6; i++) {
@@ -1002,18 +1012,25 @@ static int meshdeform_inside_cage(MeshDeformBind *mdb, float *co)
 		outside[1] = co[1] + (mdb->max[1] - mdb->min[1] + 1.0f) * MESHDEFORM_OFFSET[i][1];
 		outside[2] = co[2] + (mdb->max[2] - mdb->min[2] + 1.0f) * MESHDEFORM_OFFSET[i][2];
 
-		copy_v3_v3(start, co);
-		sub_v3_v3v3(dir, outside, start);
-		normalize_v3(dir);
-
-		isect = meshdeform_ray_tree_intersect(mdb, start, outside);
-		if (isect && !isect->facing)
+		if (meshdeform_ray_tree_cast(mdb, co, outside, &isect_mdef, &hit) && !isect_mdef.isect)
 			return 1;
 	}
 
 	return 0;
 }
 
+static void meshdeform_inside_cage_task(
+        void *__restrict userdata,
+        const int a,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	MeshDeformBind *mdb = userdata;
+	float vec[3];
+
+	copy_v3_v3(vec, mdb->vertexcos[a]);
+	mdb->inside[a] = meshdeform_inside_cage(mdb, vec);
+}
+
 /* solving */
 
 BLI_INLINE int meshdeform_index(MeshDeformBind *mdb, int x, int y, int z, int n)
@@ -1321,10 +1338,33 @@ static void meshdeform_matrix_add_exterior_phi(MeshDeformBind *mdb, int x, int y
 		mdb->phi[acenter] = phi / totweight;
 }
 
+typedef struct MeshDeformWeightsData {
+	MeshDeformBind *mdb;
+	int cagevert;
+} MeshDeformWeightsData;
+
+static void meshdeform_static_weights_task(
+        void *__restrict userdata,
+        const int b,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	MeshDeformWeightsData *data = userdata;
+	MeshDeformBind *mdb = data->mdb;
+	float vec[3], gridvec[3];
+
+	if (mdb->inside[b]) {
+		copy_v3_v3(vec, mdb->vertexcos[b]);
+		gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
+		gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
+		gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
+
+		mdb->weights[b * mdb->totcagevert + data->cagevert] = meshdeform_interp_w(mdb, gridvec, vec, data->cagevert);
+	}
+}
+
 static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
 {
 	LinearSolver *context;
-	float vec[3], gridvec[3];
 	int a, b, x, y, z, totvar;
 	char message[256];
 
@@ -1376,16 +1416,11 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
 
 			if (mdb->weights) {
 				/* static bind : compute weights for each vertex */
-				for (b = 0; b < mdb->totvert; b++) {
-					if (mdb->inside[b]) {
-						copy_v3_v3(vec, mdb->vertexcos[b]);
-						gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
-						gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
-						gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
-
-						mdb->weights[b * mdb->totcagevert + a] = meshdeform_interp_w(mdb, gridvec, vec, a);
-					}
-				}
+				MeshDeformWeightsData data = {mdb, a};
+				ParallelRangeSettings settings;
+				BLI_parallel_range_settings_defaults(&settings);
+				settings.min_iter_per_thread = 128;
+				BLI_task_parallel_range(0, mdb->totvert, &data, meshdeform_static_weights_task, &settings);
 			}
 			else {
 				MDefBindInfluence *inf;
@@ -1432,7 +1467,7 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
 	MDefBindInfluence *inf;
 	MDefInfluence *mdinf;
 	MDefCell *cell;
-	float center[3], vec[3], maxwidth, totweight;
+	float center[3], maxwidth, totweight;
 	int a, b, x, y, z, totinside, offset;
 
 	/* compute bounding box of the cage mesh */
@@ -1491,18 +1526,19 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
 
 	progress_bar(0, "Setting up mesh deform system");
 
+	{
+		ParallelRangeSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.min_iter_per_thread = 128;
+		BLI_task_parallel_range(0, mdb->totvert, mdb, meshdeform_inside_cage_task, &settings);
+	}
+
 	totinside = 0;
 	for (a = 0; a < mdb->totvert; a++) {
-		copy_v3_v3(vec, mdb->vertexcos[a]);
-		mdb->inside[a] = meshdeform_inside_cage(mdb, vec);
 		if (mdb->inside[a])
 			totinside++;
 	}
 
-	/* free temporary MDefBoundIsects */
-	BLI_memarena_free(mdb->memarena);
-	mdb->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "harmonic coords arena");
-
 	/* start with all cells untyped */
 	for (a = 0; a < mdb->size3; a++)
 		mdb->tag[a] = MESHDEFORM_TAG_UNTYPED;
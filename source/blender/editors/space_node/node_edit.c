@@ -486,6 +486,7 @@ void ED_node_composit_default(const bContext *C, struct Scene *sce)
 	sce->nodetree->chunksize = 256;
 	sce->nodetree->edit_quality = NTREE_QUALITY_HIGH;
 	sce->nodetree->render_quality = NTREE_QUALITY_HIGH;
+	sce->nodetree->cache_size = 256;
 
 	out = nodeAddStaticNode(C, sce->nodetree, CMP_NODE_COMPOSITE);
 	out->locx = 300.0f; out->locy = 400.0f;
@@ -47,6 +47,7 @@ typedef void (*MovieCacheGetKeyDataFP) (void *userkey, int *framenr, int *proxy,
 typedef void  *(*MovieCacheGetPriorityDataFP) (void *userkey);
 typedef int    (*MovieCacheGetItemPriorityFP) (void *last_userkey, void *priority_data);
 typedef void   (*MovieCachePriorityDeleterFP) (void *priority_data);
+typedef void   (*MovieCacheEvictFP) (void *userkey, struct ImBuf *ibuf);
 
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
@@ -56,6 +57,8 @@ void IMB_moviecache_set_getdata_callback(struct MovieCache *cache, MovieCacheGet
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
+/* called for buffers which are freed to keep the cache within its memory limit */
+void IMB_moviecache_set_evict_callback(struct MovieCache *cache, MovieCacheEvictFP evictfp);
 
 void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
@@ -147,6 +147,12 @@ struct anim {
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	/* frames decoded ahead on a separate thread, see anim_movie.c */
+	struct AnimReadAhead *read_ahead;
+	/* row bands converted to RGBA in parallel, NULL when not used */
+	struct AnimConvertSlice *convert_slices;
+	int convert_slices_num;
 #endif
 
 	char index_dir[768];
@@ -63,10 +63,17 @@
 #endif
 
 #include "BLI_utildefines.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
+#include "MEM_CacheLimiterC-Api.h"
+
+#include "PIL_time.h"
 
 #ifdef WITH_AVI
 #  include "AVI_avi.h"
@@ -88,6 +95,7 @@
 #  include <libavformat/avformat.h>
 #  include <libavcodec/avcodec.h>
 #  include <libavutil/rational.h>
+#  include <libavutil/pixdesc.h>
 #  include <libswscale/swscale.h>
 
 #  include "ffmpeg_compat.h"
@@ -473,6 +481,193 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 	return (anim->x & 31) != 0;
 }
 
+/* Create a context converting rows of the decoded frame to RGBA,
+ * height is the number of rows converted by a single call to sws_scale. */
+static struct SwsContext *ffmpeg_sws_context_create(struct anim *anim, int height, int flags)
+{
+	struct SwsContext *sws_ctx;
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* The following for color space determination */
+	int srcRange, dstRange, brightness, contrast, saturation;
+	int *table;
+	const int *inv_table;
+#endif
+
+	sws_ctx = sws_getContext(
+	        anim->x,
+	        height,
+	        anim->pCodecCtx->pix_fmt,
+	        anim->x,
+	        height,
+	        AV_PIX_FMT_RGBA,
+	        flags,
+	        NULL, NULL, NULL);
+
+	if (!sws_ctx) {
+		return NULL;
+	}
+
+#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+	if (!sws_getColorspaceDetails(sws_ctx, (int **)&inv_table, &srcRange,
+	                              &table, &dstRange, &brightness, &contrast, &saturation))
+	{
+		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+		if (sws_setColorspaceDetails(sws_ctx, (int *)inv_table, srcRange,
+		                             table, dstRange, brightness, contrast, saturation))
+		{
+			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+		}
+	}
+	else {
+		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+	}
+#endif
+
+	return sws_ctx;
+}
+
+/* Color conversion of large frames is split in bands of rows which are converted
+ * in parallel, each by its own scaling context. Bands are converted with a few extra
+ * rows on both sides so vertical chroma interpolation matches a conversion of the
+ * whole frame, only the interior rows are copied to the image. */
+
+#define FFMPEG_SLICE_MIN_ROWS 128
+#define FFMPEG_SLICE_OVERLAP 8
+
+typedef struct AnimConvertSlice {
+	struct SwsContext *sws_ctx;
+	/* rows written to the image */
+	int y_start, y_end;
+	/* rows converted, including the overlap */
+	int src_start, src_end;
+	int stride;
+	uint8_t *buffer;
+} AnimConvertSlice;
+
+static void ffmpeg_convert_slices_free(struct anim *anim)
+{
+	int i;
+
+	if (anim->convert_slices == NULL) {
+		return;
+	}
+
+	for (i = 0; i < anim->convert_slices_num; i++) {
+		AnimConvertSlice *slice = &anim->convert_slices[i];
+
+		if (slice->sws_ctx) {
+			sws_freeContext(slice->sws_ctx);
+		}
+		if (slice->buffer) {
+			MEM_freeN(slice->buffer);
+		}
+	}
+
+	MEM_freeN(anim->convert_slices);
+	anim->convert_slices = NULL;
+	anim->convert_slices_num = 0;
+}
+
+static void ffmpeg_convert_slices_init(struct anim *anim)
+{
+	const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+	int unsupported_flags = AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_HWACCEL;
+	int slices_num, align, i;
+
+	anim->convert_slices = NULL;
+	anim->convert_slices_num = 0;
+
+#ifdef AV_PIX_FMT_FLAG_PSEUDOPAL
+	unsupported_flags |= AV_PIX_FMT_FLAG_PSEUDOPAL;
+#endif
+
+	/* big endian needs the byte swapping conversion in ffmpeg_postprocess */
+	if (ENDIAN_ORDER == B_ENDIAN || desc == NULL || (desc->flags & unsupported_flags)) {
+		return;
+	}
+
+	slices_num = min_ii(BLI_system_thread_count(), anim->y / FFMPEG_SLICE_MIN_ROWS);
+	if (slices_num < 2) {
+		return;
+	}
+
+	/* band borders have to fall on chroma rows */
+	align = 1 << desc->log2_chroma_h;
+
+	anim->convert_slices = MEM_callocN(sizeof(AnimConvertSlice) * slices_num, "anim convert slices");
+	anim->convert_slices_num = slices_num;
+
+	for (i = 0; i < slices_num; i++) {
+		AnimConvertSlice *slice = &anim->convert_slices[i];
+
+		slice->y_start = (i == 0) ? 0 : (anim->y * i / slices_num) & ~(align - 1);
+		slice->y_end = (i == slices_num - 1) ? anim->y : (anim->y * (i + 1) / slices_num) & ~(align - 1);
+		slice->src_start = max_ii(slice->y_start - FFMPEG_SLICE_OVERLAP, 0) & ~(align - 1);
+		slice->src_end = min_ii(slice->y_end + FFMPEG_SLICE_OVERLAP, anim->y);
+		slice->stride = (anim->x * 4 + 31) & ~31;
+
+		slice->sws_ctx = ffmpeg_sws_context_create(
+		        anim, slice->src_end - slice->src_start, SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT);
+		slice->buffer = MEM_mallocN_aligned(
+		        (size_t)slice->stride * (slice->src_end - slice->src_start), 32, "anim convert slice");
+
+		if (slice->sws_ctx == NULL || slice->buffer == NULL) {
+			ffmpeg_convert_slices_free(anim);
+			return;
+		}
+	}
+}
+
+typedef struct ConvertSlicesData {
+	struct anim *anim;
+	AVFrame *input;
+	ImBuf *ibuf;
+	int log2_chroma_h;
+} ConvertSlicesData;
+
+static void ffmpeg_convert_slice_cb(void *__restrict userdata,
+                                    const int index,
+                                    const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ConvertSlicesData *data = userdata;
+	struct anim *anim = data->anim;
+	AVFrame *input = data->input;
+	AnimConvertSlice *slice = &anim->convert_slices[index];
+	const uint8_t *src[4];
+	uint8_t *dst[4] = {slice->buffer, NULL, NULL, NULL};
+	int dst_stride[4] = {slice->stride, 0, 0, 0};
+	int p, y;
+
+	for (p = 0; p < 4; p++) {
+		int shift = (p == 1 || p == 2) ? data->log2_chroma_h : 0;
+		src[p] = input->data[p] ? input->data[p] + (slice->src_start >> shift) * input->linesize[p] : NULL;
+	}
+
+	sws_scale(slice->sws_ctx, src, input->linesize, 0,
+	          slice->src_end - slice->src_start, dst, dst_stride);
+
+	/* ImBuf rows are stored bottom to top */
+	for (y = slice->y_start; y < slice->y_end; y++) {
+		memcpy((uint8_t *)data->ibuf->rect + (size_t)(anim->y - 1 - y) * anim->x * 4,
+		       slice->buffer + (size_t)(y - slice->src_start) * slice->stride,
+		       anim->x * 4);
+	}
+}
+
+static void ffmpeg_convert_slices(struct anim *anim, AVFrame *input, ImBuf *ibuf)
+{
+	const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+	ConvertSlicesData data = {anim, input, ibuf, desc->log2_chroma_h};
+	ParallelRangeSettings settings;
+
+	BLI_parallel_range_settings_defaults(&settings);
+	BLI_task_parallel_range(0, anim->convert_slices_num, &data, ffmpeg_convert_slice_cb, &settings);
+}
+
 static int startffmpeg(struct anim *anim)
 {
 	int i, videoStream;
@@ -485,13 +680,6 @@ static int startffmpeg(struct anim *anim)
 	double frs_den;
 	int streamcount;
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* The following for color space determination */
-	int srcRange, dstRange, brightness, contrast, saturation;
-	int *table;
-	const int *inv_table;
-#endif
-
 	if (anim == NULL) return(-1);
 
 	streamcount = anim->streamindex;
@@ -645,15 +833,8 @@ static int startffmpeg(struct anim *anim)
 		anim->preseek = 0;
 	}
 
-	anim->img_convert_ctx = sws_getContext(
-	        anim->x,
-	        anim->y,
-	        anim->pCodecCtx->pix_fmt,
-	        anim->x,
-	        anim->y,
-	        AV_PIX_FMT_RGBA,
-	        SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-	        NULL, NULL, NULL);
+	anim->img_convert_ctx = ffmpeg_sws_context_create(
+	        anim, anim->y, SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT);
 
 	if (!anim->img_convert_ctx) {
 		fprintf(stderr,
@@ -667,24 +848,7 @@ static int startffmpeg(struct anim *anim)
 		return -1;
 	}
 
-#ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-	/* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-	if (!sws_getColorspaceDetails(anim->img_convert_ctx, (int **)&inv_table, &srcRange,
-	                              &table, &dstRange, &brightness, &contrast, &saturation))
-	{
-		srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-		inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
-
-		if (sws_setColorspaceDetails(anim->img_convert_ctx, (int *)inv_table, srcRange,
-		                             table, dstRange, brightness, contrast, saturation))
-		{
-			fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-		}
-	}
-	else {
-		fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-	}
-#endif
+	ffmpeg_convert_slices_init(anim);
 
 	return (0);
 }
@@ -692,13 +856,12 @@ static int startffmpeg(struct anim *anim)
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
 	AVFrame *input = anim->pFrame;
-	ImBuf *ibuf = anim->last_frame;
 	int filter_y = 0;
 
 	if (!anim->pFrameComplete) {
@@ -738,6 +901,15 @@ static void ffmpeg_postprocess(struct anim *anim)
 		}
 	}
 
+	if (anim->convert_slices) {
+		ffmpeg_convert_slices(anim, input, ibuf);
+
+		if (filter_y) {
+			IMB_filtery(ibuf);
+		}
+		return;
+	}
+
 	if (!need_aligned_ffmpeg_buffer(anim)) {
 		avpicture_fill((AVPicture *) anim->pFrameRGB,
 		               (unsigned char *) ibuf->rect,
@@ -963,6 +1135,393 @@ static void ffmpeg_decode_video_frame_scan(
 	}
 }
 
+/* ******************************* read-ahead api ******************************* */
+
+/* After a frame was fetched during forward playback, a thread keeps decoding and
+ * converting the following frames into a small queue, so the next fetches find them
+ * ready. While the thread is started it owns the decoder state (pFormatCtx, pCodecCtx,
+ * pFrame, next_pts and next_packet), fetches only take frames from the queue or stop
+ * the thread before decoding themselves.
+ *
+ * The thread ends when the queue is full, fetches taking frames start it again, so
+ * anims that aren't played don't keep a thread. Queued frames of all anims share one
+ * memory budget, queues of anims that weren't fetched from for a while are freed when
+ * another anim needs the memory. */
+
+/* memory used by the queued frames of all anims */
+#define ANIM_READ_AHEAD_MEMORY (128 * 1024 * 1024)
+#define ANIM_READ_AHEAD_MIN 2
+#define ANIM_READ_AHEAD_MAX 8
+/* seconds without fetches after which queued frames can be freed for other anims */
+#define ANIM_READ_AHEAD_IDLE_TIME 1.0
+
+typedef struct AnimReadAheadFrame {
+	ImBuf *ibuf;
+	int64_t pts;
+	/* pts of the frame decoded after this one, equal to pts at the end of the stream */
+	int64_t next_pts;
+} AnimReadAheadFrame;
+
+typedef struct AnimReadAhead {
+	struct AnimReadAhead *next, *prev;
+
+	ThreadMutex lock;
+	ThreadCondition cond;
+	ListBase threads;
+
+	/* ring buffer of decoded frames */
+	AnimReadAheadFrame frames[ANIM_READ_AHEAD_MAX];
+	int first, num, capacity;
+	size_t framesize;
+
+	double last_fetch_time;
+	/* queued frames were freed for another anim, dropped_pts is the first of them */
+	bool is_dropped;
+	int64_t dropped_pts;
+
+	/* thread was started and has to be joined */
+	bool is_started;
+	/* thread may still add frames to the queue */
+	bool is_running;
+	/* thread reached the end of the stream */
+	bool is_eof;
+	bool stop;
+} AnimReadAhead;
+
+/* all read-ahead queues, to free the ones of anims that aren't played */
+static ListBase anim_read_ahead_list = {NULL, NULL};
+static ThreadMutex anim_read_ahead_list_lock = BLI_MUTEX_INITIALIZER;
+/* memory of the queued frames, anim_read_ahead_memory_lock is never held while locking others */
+static size_t anim_read_ahead_memory = 0;
+static ThreadMutex anim_read_ahead_memory_lock = BLI_MUTEX_INITIALIZER;
+
+static size_t ffmpeg_read_ahead_budget(void)
+{
+	/* the queued frames aren't in the movie cache, keep them to a part of its limit too */
+	size_t budget = MEM_CacheLimiter_get_maximum() / 8;
+
+	if (budget == 0 || budget > ANIM_READ_AHEAD_MEMORY) {
+		budget = ANIM_READ_AHEAD_MEMORY;
+	}
+	return budget;
+}
+
+static bool ffmpeg_read_ahead_memory_add(size_t size)
+{
+	bool ok;
+
+	BLI_mutex_lock(&anim_read_ahead_memory_lock);
+	ok = (anim_read_ahead_memory + size <= ffmpeg_read_ahead_budget());
+	if (ok) {
+		anim_read_ahead_memory += size;
+	}
+	BLI_mutex_unlock(&anim_read_ahead_memory_lock);
+
+	return ok;
+}
+
+static void ffmpeg_read_ahead_memory_remove(size_t size)
+{
+	BLI_mutex_lock(&anim_read_ahead_memory_lock);
+	BLI_assert(anim_read_ahead_memory >= size);
+	anim_read_ahead_memory -= size;
+	BLI_mutex_unlock(&anim_read_ahead_memory_lock);
+}
+
+/* free all queued frames, called with ra->lock held */
+static void ffmpeg_read_ahead_clear(AnimReadAhead *ra)
+{
+	while (ra->num > 0) {
+		IMB_freeImBuf(ra->frames[ra->first].ibuf);
+		ra->first = (ra->first + 1) % ra->capacity;
+		ra->num--;
+		ffmpeg_read_ahead_memory_remove(ra->framesize);
+	}
+}
+
+/* Memory for one more queued frame, when the budget is used up the queues
+ * of anims that weren't fetched from for a while are freed. */
+static bool ffmpeg_read_ahead_reserve(AnimReadAhead *ra)
+{
+	AnimReadAhead *ra_other;
+	double time;
+
+	if (ffmpeg_read_ahead_memory_add(ra->framesize)) {
+		return true;
+	}
+
+	time = PIL_check_seconds_timer();
+
+	BLI_mutex_lock(&anim_read_ahead_list_lock);
+	for (ra_other = anim_read_ahead_list.first; ra_other; ra_other = ra_other->next) {
+		if (ra_other == ra) {
+			continue;
+		}
+		BLI_mutex_lock(&ra_other->lock);
+		if (!ra_other->is_running && ra_other->num > 0 &&
+		    time - ra_other->last_fetch_time > ANIM_READ_AHEAD_IDLE_TIME)
+		{
+			/* the decoder of the other anim is past these frames now, its next fetch seeks */
+			ra_other->dropped_pts = ra_other->frames[ra_other->first].pts;
+			ra_other->is_dropped = true;
+			ffmpeg_read_ahead_clear(ra_other);
+		}
+		BLI_mutex_unlock(&ra_other->lock);
+	}
+	BLI_mutex_unlock(&anim_read_ahead_list_lock);
+
+	return ffmpeg_read_ahead_memory_add(ra->framesize);
+}
+
+static AnimReadAhead *ffmpeg_read_ahead_create(struct anim *anim)
+{
+	AnimReadAhead *ra = MEM_callocN(sizeof(AnimReadAhead), "anim read ahead");
+
+	BLI_mutex_init(&ra->lock);
+	BLI_condition_init(&ra->cond);
+
+	ra->framesize = anim->framesize;
+	ra->capacity = (ra->framesize > 0) ? ffmpeg_read_ahead_budget() / ra->framesize : ANIM_READ_AHEAD_MAX;
+	CLAMP(ra->capacity, ANIM_READ_AHEAD_MIN, ANIM_READ_AHEAD_MAX);
+
+	BLI_mutex_lock(&anim_read_ahead_list_lock);
+	BLI_addtail(&anim_read_ahead_list, ra);
+	BLI_mutex_unlock(&anim_read_ahead_list_lock);
+
+	return ra;
+}
+
+static void *ffmpeg_read_ahead_thread(void *anim_v)
+{
+	struct anim *anim = anim_v;
+	AnimReadAhead *ra = anim->read_ahead;
+	bool is_eof = false;
+
+	while (true) {
+		AnimReadAheadFrame frame;
+		bool ok;
+
+		BLI_mutex_lock(&ra->lock);
+		if (ra->stop || ra->num == ra->capacity) {
+			BLI_mutex_unlock(&ra->lock);
+			break;
+		}
+		BLI_mutex_unlock(&ra->lock);
+
+		if (!anim->pFrameComplete) {
+			is_eof = true;
+			break;
+		}
+
+		if (!ffmpeg_read_ahead_reserve(ra)) {
+			break;
+		}
+
+		frame.ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+		frame.ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+		ffmpeg_postprocess(anim, frame.ibuf);
+		frame.pts = anim->next_pts;
+
+		ok = ffmpeg_decode_video_frame(anim);
+		frame.next_pts = anim->next_pts;
+
+		BLI_mutex_lock(&ra->lock);
+		ra->frames[(ra->first + ra->num) % ra->capacity] = frame;
+		ra->num++;
+		BLI_condition_notify_all(&ra->cond);
+		BLI_mutex_unlock(&ra->lock);
+
+		if (!ok) {
+			is_eof = true;
+			break;
+		}
+	}
+
+	BLI_mutex_lock(&ra->lock);
+	ra->is_running = false;
+	ra->is_eof = is_eof;
+	BLI_condition_notify_all(&ra->cond);
+	BLI_mutex_unlock(&ra->lock);
+
+	return NULL;
+}
+
+/* Start the thread, or start it again when it ended on a full queue
+ * and half of the queue was taken since. */
+static void ffmpeg_read_ahead_start(struct anim *anim)
+{
+	AnimReadAhead *ra;
+	bool was_started;
+
+	if (anim->read_ahead == NULL) {
+		anim->read_ahead = ffmpeg_read_ahead_create(anim);
+	}
+	ra = anim->read_ahead;
+
+	BLI_mutex_lock(&ra->lock);
+	if (ra->is_started) {
+		if (ra->is_running || ra->is_eof || ra->is_dropped || ra->num > ra->capacity / 2) {
+			BLI_mutex_unlock(&ra->lock);
+			return;
+		}
+	}
+	else if (!anim->pFrameComplete) {
+		BLI_mutex_unlock(&ra->lock);
+		return;
+	}
+	else {
+		BLI_assert(ra->num == 0);
+	}
+
+	/* set as running right away so the queue isn't freed for other anims meanwhile */
+	was_started = ra->is_started;
+	ra->stop = false;
+	ra->is_started = true;
+	ra->is_running = true;
+	ra->last_fetch_time = PIL_check_seconds_timer();
+	BLI_mutex_unlock(&ra->lock);
+
+	if (was_started) {
+		/* the previous thread ended already, the decoder state follows the last queued frame */
+		BLI_threadpool_end(&ra->threads);
+	}
+
+	BLI_threadpool_init(&ra->threads, ffmpeg_read_ahead_thread, 1);
+	BLI_threadpool_insert(&ra->threads, anim);
+}
+
+/* Stop and join the thread, returns true when queued frames had to be dropped:
+ * the decoder state is then past the last fetched frame and a seek is needed. */
+static bool ffmpeg_read_ahead_stop(struct anim *anim)
+{
+	AnimReadAhead *ra = anim->read_ahead;
+	bool dropped;
+
+	if (ra == NULL || !ra->is_started) {
+		return false;
+	}
+
+	BLI_mutex_lock(&ra->lock);
+	ra->stop = true;
+	BLI_condition_notify_all(&ra->cond);
+	BLI_mutex_unlock(&ra->lock);
+
+	BLI_threadpool_end(&ra->threads);
+
+	BLI_mutex_lock(&ra->lock);
+	dropped = (ra->num > 0) || ra->is_dropped;
+	ffmpeg_read_ahead_clear(ra);
+
+	ra->is_started = false;
+	ra->is_running = false;
+	ra->is_eof = false;
+	ra->is_dropped = false;
+	BLI_mutex_unlock(&ra->lock);
+
+	return dropped;
+}
+
+static void ffmpeg_read_ahead_free(struct anim *anim)
+{
+	AnimReadAhead *ra = anim->read_ahead;
+
+	if (ra == NULL) {
+		return;
+	}
+
+	BLI_mutex_lock(&anim_read_ahead_list_lock);
+	BLI_remlink(&anim_read_ahead_list, ra);
+	BLI_mutex_unlock(&anim_read_ahead_list_lock);
+
+	ffmpeg_read_ahead_stop(anim);
+
+	BLI_condition_end(&ra->cond);
+	BLI_mutex_end(&ra->lock);
+
+	MEM_freeN(ra);
+	anim->read_ahead = NULL;
+}
+
+/* pts of the frame following anim->last_frame, waits for the thread to decode it */
+static int64_t ffmpeg_read_ahead_next_pts(struct anim *anim)
+{
+	AnimReadAhead *ra = anim->read_ahead;
+	int64_t next_pts;
+
+	if (ra == NULL || !ra->is_started) {
+		return anim->next_pts;
+	}
+
+	BLI_mutex_lock(&ra->lock);
+	ra->last_fetch_time = PIL_check_seconds_timer();
+	while (ra->is_running && ra->num == 0) {
+		BLI_condition_wait(&ra->cond, &ra->lock);
+	}
+	if (ra->num > 0) {
+		next_pts = ra->frames[ra->first].pts;
+	}
+	else {
+		next_pts = ra->is_dropped ? ra->dropped_pts : anim->next_pts;
+	}
+	BLI_mutex_unlock(&ra->lock);
+
+	return next_pts;
+}
+
+/* Take the queued frame showing pts_to_search, waiting for the thread to decode it
+ * and dropping the frames before it. Returns false when the frame won't be queued. */
+static bool ffmpeg_read_ahead_take(struct anim *anim, int64_t pts_to_search, AnimReadAheadFrame *r_frame)
+{
+	AnimReadAhead *ra = anim->read_ahead;
+	/* same limit as ffmpeg_decode_video_frame_scan */
+	int count = 1000;
+	bool found = false;
+
+	if (ra == NULL || !ra->is_started) {
+		return false;
+	}
+
+	BLI_mutex_lock(&ra->lock);
+	ra->last_fetch_time = PIL_check_seconds_timer();
+	while (count > 0) {
+		AnimReadAheadFrame *frame;
+
+		if (ra->num == 0) {
+			if (!ra->is_running) {
+				break;
+			}
+			BLI_condition_wait(&ra->cond, &ra->lock);
+			continue;
+		}
+
+		frame = &ra->frames[ra->first];
+
+		if (frame->pts > pts_to_search) {
+			/* frame is behind the queue */
+			break;
+		}
+
+		/* taken frames belong to the caller, they aren't counted anymore */
+		ra->first = (ra->first + 1) % ra->capacity;
+		ra->num--;
+		ffmpeg_read_ahead_memory_remove(ra->framesize);
+		BLI_condition_notify_all(&ra->cond);
+
+		if (frame->next_pts <= pts_to_search && frame->pts < pts_to_search) {
+			IMB_freeImBuf(frame->ibuf);
+			count--;
+			continue;
+		}
+
+		*r_frame = *frame;
+		found = true;
+		break;
+	}
+	BLI_mutex_unlock(&ra->lock);
+
+	return found;
+}
+
 static int match_format(const char *name, AVFormatContext *pFormatCtx)
 {
 	const char *p;
@@ -1014,6 +1573,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	AVStream *v_st;
 	int new_frame_index = 0; /* To quiet gcc barking... */
 	int old_frame_index = 0; /* To quiet gcc barking... */
+	bool can_scan, need_seek = false;
+	bool is_sequential;
+	AnimReadAheadFrame frame;
 
 	if (anim == NULL) return (0);
 
@@ -1053,19 +1615,53 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	       "(pts_timebase=%g, frame_rate=%g, st_time=%lld)\n",
 	       (long long int)pts_to_search, pts_time_base, frame_rate, st_time);
 
-	if (anim->last_frame &&
-	    anim->last_pts <= pts_to_search && anim->next_pts > pts_to_search)
-	{
+	if (anim->last_frame && anim->last_pts <= pts_to_search) {
+		int64_t next_pts = ffmpeg_read_ahead_next_pts(anim);
+
+		if (next_pts > pts_to_search) {
+			av_log(anim->pFormatCtx, AV_LOG_DEBUG,
+			       "FETCH: frame repeat: last: %lld next: %lld\n",
+			       (long long int)anim->last_pts,
+			       (long long int)next_pts);
+			IMB_refImBuf(anim->last_frame);
+			anim->curposition = position;
+			return anim->last_frame;
+		}
+	}
+
+	is_sequential = (position == anim->curposition + 1);
+	can_scan = is_sequential ||
+	           (position > anim->curposition + 1 &&
+	            anim->preseek &&
+	            !tc_index &&
+	            position - (anim->curposition + 1) < anim->preseek) ||
+	           (tc_index &&
+	            IMB_indexer_can_scan(tc_index, old_frame_index,
+	                                 new_frame_index));
+
+	if (can_scan && ffmpeg_read_ahead_take(anim, pts_to_search, &frame)) {
 		av_log(anim->pFormatCtx, AV_LOG_DEBUG,
-		       "FETCH: frame repeat: last: %lld next: %lld\n",
-		       (long long int)anim->last_pts,
-		       (long long int)anim->next_pts);
-		IMB_refImBuf(anim->last_frame);
+		       "FETCH: decoded ahead: PTS=%lld\n",
+		       (long long int)frame.pts);
+
+		IMB_freeImBuf(anim->last_frame);
+		anim->last_frame = frame.ibuf;
+		anim->last_pts = frame.pts;
 		anim->curposition = position;
+
+		IMB_refImBuf(anim->last_frame);
+
+		/* continue decoding ahead in case the thread ended on a full queue */
+		ffmpeg_read_ahead_start(anim);
+
 		return anim->last_frame;
 	}
 
-	if (position > anim->curposition + 1 &&
+	/* decode on this thread, continuing from where the read-ahead thread stopped */
+	need_seek = ffmpeg_read_ahead_stop(anim);
+
+	if (!need_seek &&
+	    position > anim->curposition + 1 &&
 	    anim->preseek &&
 	    !tc_index &&
 	    position - (anim->curposition + 1) < anim->preseek)
@@ -1075,7 +1671,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 
 		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
 	}
-	else if (tc_index &&
+	else if (!need_seek &&
+	         tc_index &&
 	         IMB_indexer_can_scan(tc_index, old_frame_index,
 	                              new_frame_index))
 	{
@@ -1085,7 +1682,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 
 		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
 	}
-	else if (position != anim->curposition + 1) {
+	else if (need_seek || position != anim->curposition + 1) {
 		long long pos;
 		int ret;
 
@@ -1178,7 +1775,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
 	anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-	ffmpeg_postprocess(anim);
+	ffmpeg_postprocess(anim, anim->last_frame);
 
 	anim->last_pts = anim->next_pts;
 
@@ -1186,6 +1783,11 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 
 	anim->curposition = position;
 
+	/* only forward playback benefits from decoding ahead */
+	if (is_sequential) {
+		ffmpeg_read_ahead_start(anim);
+	}
+
 	IMB_refImBuf(anim->last_frame);
 
 	return anim->last_frame;
@@ -1196,6 +1798,8 @@ static void free_anim_ffmpeg(struct anim *anim)
 	if (anim == NULL) return;
 
 	if (anim->pCodecCtx) {
+		ffmpeg_read_ahead_free(anim);
+
 		avcodec_close(anim->pCodecCtx);
 		avformat_close_input(&anim->pFormatCtx);
 
@@ -1221,6 +1825,7 @@ static void free_anim_ffmpeg(struct anim *anim)
 		av_frame_free(&anim->pFrameDeinterlaced);
 
 		sws_freeContext(anim->img_convert_ctx);
+		ffmpeg_convert_slices_free(anim);
 		IMB_freeImBuf(anim->last_frame);
 		if (anim->next_packet.stream_index != -1) {
 			av_free_packet(&anim->next_packet);
@@ -107,8 +107,27 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Display and color space transform processors are kept for reuse, creating them
+ * from the configuration costs more than applying them to a render tile or a strip. */
+#define PROCESSOR_CACHE_MAX_ITEMS 16
+#define PROCESSOR_CACHE_KEY_SIZE (6 * MAX_COLORSPACE_NAME)
+
+typedef struct ColormanageProcessorCacheItem {
+	struct ColormanageProcessorCacheItem *next, *prev;
+	char key[PROCESSOR_CACHE_KEY_SIZE];
+	OCIO_ConstProcessorRcPtr *processor;
+	/* number of ColormanageProcessor using this processor, only unused ones are freed */
+	int users;
+} ColormanageProcessorCacheItem;
+
+/* most recently used first */
+static ListBase global_processor_cache = {NULL, NULL};
+static ThreadMutex processor_cache_lock = BLI_MUTEX_INITIALIZER;
+
 typedef struct ColormanageProcessor {
 	OCIO_ConstProcessorRcPtr *processor;
+	/* owner of processor when it's shared with other users */
+	ColormanageProcessorCacheItem *cache_item;
 	CurveMapping *curve_mapping;
 	bool is_data_result;
 } ColormanageProcessor;
@@ -571,11 +590,28 @@ static void colormanage_load_config(OCIO_ConstConfigRcPtr *config)
 	invert_m3_m3(imbuf_linear_srgb_to_xyz, imbuf_xyz_to_linear_srgb);
 }
 
+static void colormanage_processor_cache_free(void)
+{
+	ColormanageProcessorCacheItem *item;
+
+	BLI_mutex_lock(&processor_cache_lock);
+
+	for (item = global_processor_cache.first; item; item = item->next) {
+		BLI_assert(item->users == 0);
+		OCIO_processorRelease(item->processor);
+	}
+	BLI_freelistN(&global_processor_cache);
+
+	BLI_mutex_unlock(&processor_cache_lock);
+}
+
 static void colormanage_free_config(void)
 {
 	ColorSpace *colorspace;
 	ColorManagedDisplay *display;
 
+	colormanage_processor_cache_free();
+
 	/* free color spaces */
 	colorspace = global_colorspaces.first;
 	while (colorspace) {
@@ -3249,6 +3285,77 @@ void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin,
 
 /*********************** Pixel processor functions *************************/
 
+/* Find a processor created for the same key, the returned item is in use until
+ * processor_cache_release() is called. */
+static ColormanageProcessorCacheItem *processor_cache_acquire(const char *key)
+{
+	ColormanageProcessorCacheItem *item;
+
+	BLI_mutex_lock(&processor_cache_lock);
+
+	item = BLI_findstring(&global_processor_cache, key, offsetof(ColormanageProcessorCacheItem, key));
+	if (item) {
+		item->users++;
+
+		BLI_remlink(&global_processor_cache, item);
+		BLI_addhead(&global_processor_cache, item);
+	}
+
+	BLI_mutex_unlock(&processor_cache_lock);
+
+	return item;
+}
+
+/* Add a newly created processor, the cache takes ownership of it. */
+static ColormanageProcessorCacheItem *processor_cache_add(const char *key, OCIO_ConstProcessorRcPtr *processor)
+{
+	ColormanageProcessorCacheItem *item, *item_prev;
+	int tot_items = 0;
+
+	BLI_mutex_lock(&processor_cache_lock);
+
+	/* another thread might have created the same processor meanwhile */
+	item = BLI_findstring(&global_processor_cache, key, offsetof(ColormanageProcessorCacheItem, key));
+	if (item) {
+		OCIO_processorRelease(processor);
+	}
+	else {
+		item = MEM_callocN(sizeof(ColormanageProcessorCacheItem), "colormanagement processor cache item");
+		BLI_strncpy(item->key, key, sizeof(item->key));
+		item->processor = processor;
+		BLI_addhead(&global_processor_cache, item);
+	}
+	item->users++;
+
+	/* free least recently used processors which are not in use */
+	for (item_prev = global_processor_cache.last; item_prev; item_prev = item_prev->prev) {
+		tot_items++;
+	}
+	for (item_prev = global_processor_cache.last; item_prev && tot_items > PROCESSOR_CACHE_MAX_ITEMS;) {
+		ColormanageProcessorCacheItem *prev = item_prev->prev;
+
+		if (item_prev->users == 0) {
+			OCIO_processorRelease(item_prev->processor);
+			BLI_freelinkN(&global_processor_cache, item_prev);
+			tot_items--;
+		}
+
+		item_prev = prev;
+	}
+
+	BLI_mutex_unlock(&processor_cache_lock);
+
+	return item;
+}
+
+static void processor_cache_release(ColormanageProcessorCacheItem *item)
+{
+	BLI_mutex_lock(&processor_cache_lock);
+	BLI_assert(item->users > 0);
+	item->users--;
+	BLI_mutex_unlock(&processor_cache_lock);
+}
+
 ColormanageProcessor *IMB_colormanagement_display_processor_new(const ColorManagedViewSettings *view_settings,
                                                                 const ColorManagedDisplaySettings *display_settings)
 {
@@ -3256,6 +3363,7 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(const ColorManag
 	ColorManagedViewSettings default_view_settings;
 	const ColorManagedViewSettings *applied_view_settings;
 	ColorSpace *display_space;
+	char key[PROCESSOR_CACHE_KEY_SIZE];
 
 	cm_processor = MEM_callocN(sizeof(ColormanageProcessor), "colormanagement processor");
 
@@ -3272,12 +3380,30 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(const ColorManag
 	if (display_space)
 		cm_processor->is_data_result = display_space->is_data;
 
-	cm_processor->processor = create_display_buffer_processor(applied_view_settings->look,
-	                                                          applied_view_settings->view_transform,
-	                                                          display_settings->display_device,
-	                                                          applied_view_settings->exposure,
-	                                                          applied_view_settings->gamma,
-	                                                          global_role_scene_linear);
+	BLI_snprintf(key, sizeof(key), "display:%s:%s:%s:%a:%a",
+	             applied_view_settings->look,
+	             applied_view_settings->view_transform,
+	             display_settings->display_device,
+	             applied_view_settings->exposure,
+	             applied_view_settings->gamma);
+
+	cm_processor->cache_item = processor_cache_acquire(key);
+	if (cm_processor->cache_item == NULL) {
+		OCIO_ConstProcessorRcPtr *processor;
+
+		processor = create_display_buffer_processor(applied_view_settings->look,
+		                                            applied_view_settings->view_transform,
+		                                            display_settings->display_device,
+		                                            applied_view_settings->exposure,
+		                                            applied_view_settings->gamma,
+		                                            global_role_scene_linear);
+		if (processor) {
+			cm_processor->cache_item = processor_cache_add(key, processor);
+		}
+	}
+	if (cm_processor->cache_item) {
+		cm_processor->processor = cm_processor->cache_item->processor;
+	}
 
 	if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
 		cm_processor->curve_mapping = curvemapping_copy(applied_view_settings->curve_mapping);
@@ -3291,13 +3417,26 @@ ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *f
 {
 	ColormanageProcessor *cm_processor;
 	ColorSpace *color_space;
+	char key[PROCESSOR_CACHE_KEY_SIZE];
 
 	cm_processor = MEM_callocN(sizeof(ColormanageProcessor), "colormanagement processor");
 
 	color_space = colormanage_colorspace_get_named(to_colorspace);
 	cm_processor->is_data_result = color_space->is_data;
 
-	cm_processor->processor = create_colorspace_transform_processor(from_colorspace, to_colorspace);
+	BLI_snprintf(key, sizeof(key), "transform:%s:%s", from_colorspace, to_colorspace);
+
+	cm_processor->cache_item = processor_cache_acquire(key);
+	if (cm_processor->cache_item == NULL) {
+		OCIO_ConstProcessorRcPtr *processor = create_colorspace_transform_processor(from_colorspace, to_colorspace);
+
+		if (processor) {
+			cm_processor->cache_item = processor_cache_add(key, processor);
+		}
+	}
+	if (cm_processor->cache_item) {
+		cm_processor->processor = cm_processor->cache_item->processor;
+	}
 
 	return cm_processor;
 }
@@ -3389,22 +3528,28 @@ void IMB_colormanagement_processor_apply_byte(ColormanageProcessor *cm_processor
 	 * but for now it's not so important.
 	 */
 	BLI_assert(channels == 4);
-	float pixel[4];
+
+	/* convert row by row, so the processor is applied to whole rows of pixels at once */
+	float *row = MEM_mallocN(sizeof(float) * 4 * width, "colormanagement byte row");
 	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			size_t offset = channels * (((size_t)y) * width + x);
-			rgba_uchar_to_float(pixel, buffer + offset);
-			IMB_colormanagement_processor_apply_v4(cm_processor, pixel);
-			rgba_float_to_uchar(buffer + offset, pixel);
-		}
+		unsigned char *row_byte = buffer + ((size_t)y) * width * channels;
+
+		IMB_buffer_float_from_byte(row, row_byte, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false,
+		                           width, 1, width, width);
+		IMB_colormanagement_processor_apply(cm_processor, row, width, 1, 4, false);
+		IMB_buffer_byte_from_float(row_byte, row, 4, 0.0f, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false,
+		                           width, 1, width, width);
 	}
+	MEM_freeN(row);
 }
 
 void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 {
 	if (cm_processor->curve_mapping)
 		curvemapping_free(cm_processor->curve_mapping);
-	if (cm_processor->processor)
+	if (cm_processor->cache_item)
+		processor_cache_release(cm_processor->cache_item);
+	else if (cm_processor->processor)
 		OCIO_processorRelease(cm_processor->processor);
 
 	MEM_freeN(cm_processor);
@@ -45,6 +45,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /************************* Floyd-Steinberg dithering *************************/
 
 typedef struct DitherContext {
@@ -82,6 +86,95 @@ MINLINE unsigned char ftochar(float value)
 	return unit_float_to_uchar_clamp(value);
 }
 
+/* Conversion of rows of RGBA pixels, the SSE2 versions convert four pixels at a time
+ * and give the same results as rgba_float_to_uchar() and rgba_uchar_to_float(). */
+
+#ifdef __SSE2__
+MALWAYS_INLINE __m128 premul_to_straight_sse2(const __m128 premul)
+{
+	const __m128 alpha = _mm_shuffle_ps(premul, premul, _MM_SHUFFLE(3, 3, 3, 3));
+	const __m128 alpha_lane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	/* keep the pixel as is for zero and full alpha, alpha itself is always kept */
+	const __m128 keep = _mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(alpha, _mm_setzero_ps()),
+	                                        _mm_cmpeq_ps(alpha, _mm_set1_ps(1.0f))),
+	                              alpha_lane);
+	const __m128 straight = _mm_mul_ps(premul, _mm_div_ps(_mm_set1_ps(1.0f), alpha));
+
+	return _mm_or_ps(_mm_and_ps(keep, premul), _mm_andnot_ps(keep, straight));
+}
+
+MALWAYS_INLINE __m128i unit_float_to_uchar_clamp_sse2(const __m128 f)
+{
+	__m128 v = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+	/* max returns zero for NaN like the scalar version */
+	v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+	return _mm_cvttps_epi32(v);
+}
+#endif  /* __SSE2__ */
+
+static void float_to_byte_row_v4(uchar *to, const float *from, int width, bool predivide)
+{
+	int x = 0;
+
+#ifdef __SSE2__
+	for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+		__m128 p0 = _mm_loadu_ps(from);
+		__m128 p1 = _mm_loadu_ps(from + 4);
+		__m128 p2 = _mm_loadu_ps(from + 8);
+		__m128 p3 = _mm_loadu_ps(from + 12);
+		__m128i lo, hi;
+
+		if (predivide) {
+			p0 = premul_to_straight_sse2(p0);
+			p1 = premul_to_straight_sse2(p1);
+			p2 = premul_to_straight_sse2(p2);
+			p3 = premul_to_straight_sse2(p3);
+		}
+
+		lo = _mm_packs_epi32(unit_float_to_uchar_clamp_sse2(p0), unit_float_to_uchar_clamp_sse2(p1));
+		hi = _mm_packs_epi32(unit_float_to_uchar_clamp_sse2(p2), unit_float_to_uchar_clamp_sse2(p3));
+		_mm_storeu_si128((__m128i *)to, _mm_packus_epi16(lo, hi));
+	}
+#endif
+
+	for (; x < width; x++, from += 4, to += 4) {
+		if (predivide) {
+			float straight[4];
+
+			premul_to_straight_v4_v4(straight, from);
+			rgba_float_to_uchar(to, straight);
+		}
+		else {
+			rgba_float_to_uchar(to, from);
+		}
+	}
+}
+
+static void byte_to_float_row_v4(float *to, const uchar *from, int width)
+{
+	int x = 0;
+
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+	for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i *)from);
+		const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+
+		_mm_storeu_ps(to, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(to + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(to + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(to + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+#endif
+
+	for (; x < width; x++, from += 4, to += 4) {
+		rgba_uchar_to_float(to, from);
+	}
+}
+
 MINLINE void ushort_to_byte_dither_v4(uchar b[4], const unsigned short us[4], DitherContext *di, float s, float t)
 {
 #define USHORTTOFLOAT(val) ((float)val / 65535.0f)
@@ -182,15 +275,8 @@ void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
 					for (x = 0; x < width; x++, from += 4, to += 4)
 						float_to_byte_dither_v4(to, from, di, (float) x * inv_width, t);
 				}
-				else if (predivide) {
-					for (x = 0; x < width; x++, from += 4, to += 4) {
-						premul_to_straight_v4_v4(straight, from);
-						rgba_float_to_uchar(to, straight);
-					}
-				}
 				else {
-					for (x = 0; x < width; x++, from += 4, to += 4)
-						rgba_float_to_uchar(to, from);
+					float_to_byte_row_v4(to, from, width, predivide);
 				}
 			}
 			else if (profile_to == IB_PROFILE_SRGB) {
@@ -356,8 +442,7 @@ void IMB_buffer_float_from_byte(float *rect_to, const uchar *rect_from,
 
 		if (profile_to == profile_from) {
 			/* no color space conversion */
-			for (x = 0; x < width; x++, from += 4, to += 4)
-				rgba_uchar_to_float(to, from);
+			byte_to_float_row_v4(to, from, width);
 		}
 		else if (profile_to == IB_PROFILE_LINEAR_RGB) {
 			/* convert sRGB to linear */
@@ -35,6 +35,8 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
@@ -42,6 +44,20 @@
 
 #include "imbuf.h"
 
+/* Images with less pixels than this are filtered on the calling thread. */
+#define FILTER_THREADED_MIN_PIXELS (256 * 256)
+
+static void filter_parallel_range(ImBuf *ibuf, const int tot, void *userdata, TaskParallelRangeFunc func)
+{
+	ParallelRangeSettings settings;
+
+	BLI_parallel_range_settings_defaults(&settings);
+	/* also keep to the calling thread when running with a single thread (-t 1) */
+	settings.use_threading = ((size_t)ibuf->x * ibuf->y >= FILTER_THREADED_MIN_PIXELS) &&
+	                         (BLI_system_thread_count() > 1);
+	BLI_task_parallel_range(0, tot, userdata, func, &settings);
+}
+
 static void filtrow(unsigned char *point, int x)
 {
 	unsigned int c1, c2, c3, error;
@@ -125,176 +141,187 @@ static void filtcolumf(float *point, int y, int skip)
 	}
 }
 
-void IMB_filtery(struct ImBuf *ibuf)
+/* columns and rows are filtered independently, each one is a task */
+static void imb_filtery_column_cb(void *__restrict userdata,
+                                  const int x,
+                                  const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-	unsigned char *point;
-	float *pointf;
-	int x, y, skip;
-
-	point = (unsigned char *)ibuf->rect;
-	pointf = ibuf->rect_float;
-
-	x = ibuf->x;
-	y = ibuf->y;
-	skip = x << 2;
-
-	for (; x > 0; x--) {
-		if (point) {
-			if (ibuf->planes > 24) filtcolum(point, y, skip);
-			point++;
-			filtcolum(point, y, skip);
-			point++;
-			filtcolum(point, y, skip);
-			point++;
-			filtcolum(point, y, skip);
-			point++;
-		}
-		if (pointf) {
-			if (ibuf->planes > 24) filtcolumf(pointf, y, skip);
-			pointf++;
-			filtcolumf(pointf, y, skip);
-			pointf++;
-			filtcolumf(pointf, y, skip);
-			pointf++;
-			filtcolumf(pointf, y, skip);
-			pointf++;
-		}
+	ImBuf *ibuf = userdata;
+	const int y = ibuf->y;
+	const int skip = ibuf->x << 2;
+
+	if (ibuf->rect) {
+		unsigned char *point = (unsigned char *)ibuf->rect + ((size_t)x << 2);
+
+		if (ibuf->planes > 24) filtcolum(point, y, skip);
+		point++;
+		filtcolum(point, y, skip);
+		point++;
+		filtcolum(point, y, skip);
+		point++;
+		filtcolum(point, y, skip);
+	}
+	if (ibuf->rect_float) {
+		float *pointf = ibuf->rect_float + ((size_t)x << 2);
+
+		if (ibuf->planes > 24) filtcolumf(pointf, y, skip);
+		pointf++;
+		filtcolumf(pointf, y, skip);
+		pointf++;
+		filtcolumf(pointf, y, skip);
+		pointf++;
+		filtcolumf(pointf, y, skip);
 	}
 }
 
+void IMB_filtery(struct ImBuf *ibuf)
+{
+	filter_parallel_range(ibuf, ibuf->x, ibuf, imb_filtery_column_cb);
+}
 
-void imb_filterx(struct ImBuf *ibuf)
+static void imb_filterx_row_cb(void *__restrict userdata,
+                               const int y,
+                               const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-	unsigned char *point;
-	float *pointf;
-	int x, y, skip;
-
-	point = (unsigned char *)ibuf->rect;
-	pointf = ibuf->rect_float;
-
-	x = ibuf->x;
-	y = ibuf->y;
-	skip = (x << 2) - 3;
-
-	for (; y > 0; y--) {
-		if (point) {
-			if (ibuf->planes > 24) filtrow(point, x);
-			point++;
-			filtrow(point, x);
-			point++;
-			filtrow(point, x);
-			point++;
-			filtrow(point, x);
-			point += skip;
-		}
-		if (pointf) {
-			if (ibuf->planes > 24) filtrowf(pointf, x);
-			pointf++;
-			filtrowf(pointf, x);
-			pointf++;
-			filtrowf(pointf, x);
-			pointf++;
-			filtrowf(pointf, x);
-			pointf += skip;
-		}
+	ImBuf *ibuf = userdata;
+	const int x = ibuf->x;
+
+	if (ibuf->rect) {
+		unsigned char *point = (unsigned char *)ibuf->rect + ((size_t)y * x << 2);
+
+		if (ibuf->planes > 24) filtrow(point, x);
+		point++;
+		filtrow(point, x);
+		point++;
+		filtrow(point, x);
+		point++;
+		filtrow(point, x);
+	}
+	if (ibuf->rect_float) {
+		float *pointf = ibuf->rect_float + ((size_t)y * x << 2);
+
+		if (ibuf->planes > 24) filtrowf(pointf, x);
+		pointf++;
+		filtrowf(pointf, x);
+		pointf++;
+		filtrowf(pointf, x);
+		pointf++;
+		filtrowf(pointf, x);
 	}
 }
 
-static void imb_filterN(ImBuf *out, ImBuf *in)
+void imb_filterx(struct ImBuf *ibuf)
 {
-	BLI_assert(out->channels == in->channels);
-	BLI_assert(out->x == in->x && out->y == in->y);
+	filter_parallel_range(ibuf, ibuf->y, ibuf, imb_filterx_row_cb);
+}
 
+typedef struct FilterNData {
+	ImBuf *out, *in;
+} FilterNData;
+
+static void imb_filterN_row_cb(void *__restrict userdata,
+                               const int y,
+                               const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	FilterNData *data = userdata;
+	ImBuf *out = data->out;
+	ImBuf *in = data->in;
 	const int channels = in->channels;
 	const int rowlen = in->x;
 
 	if (in->rect && out->rect) {
-		for (int y = 0; y < in->y; y++) {
-			/* setup rows */
-			const char *row2 = (const char *)in->rect + y * channels * rowlen;
-			const char *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
-			const char *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
-
-			char *cp = (char *)out->rect + y * channels * rowlen;
+		/* setup rows */
+		const char *row2 = (const char *)in->rect + y * channels * rowlen;
+		const char *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
+		const char *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
 
-			for (int x = 0; x < rowlen; x++) {
-				const char *r11, *r13, *r21, *r23, *r31, *r33;
+		char *cp = (char *)out->rect + y * channels * rowlen;
 
-				if (x == 0) {
-					r11 = row1;
-					r21 = row2;
-					r31 = row3;
-				}
-				else {
-					r11 = row1 - channels;
-					r21 = row2 - channels;
-					r31 = row3 - channels;
-				}
+		for (int x = 0; x < rowlen; x++) {
+			const char *r11, *r13, *r21, *r23, *r31, *r33;
 
-				if (x == rowlen - 1) {
-					r13 = row1;
-					r23 = row2;
-					r33 = row3;
-				}
-				else {
-					r13 = row1 + channels;
-					r23 = row2 + channels;
-					r33 = row3 + channels;
-				}
+			if (x == 0) {
+				r11 = row1;
+				r21 = row2;
+				r31 = row3;
+			}
+			else {
+				r11 = row1 - channels;
+				r21 = row2 - channels;
+				r31 = row3 - channels;
+			}
 
-				cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] + 2 * row3[0] + r33[0]) >> 4;
-				cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] + 2 * row3[1] + r33[1]) >> 4;
-				cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] + 2 * row3[2] + r33[2]) >> 4;
-				cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] + 2 * row3[3] + r33[3]) >> 4;
-				cp += channels; row1 += channels; row2 += channels; row3 += channels;
+			if (x == rowlen - 1) {
+				r13 = row1;
+				r23 = row2;
+				r33 = row3;
 			}
+			else {
+				r13 = row1 + channels;
+				r23 = row2 + channels;
+				r33 = row3 + channels;
+			}
+
+			cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] + 2 * row3[0] + r33[0]) >> 4;
+			cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] + 2 * row3[1] + r33[1]) >> 4;
+			cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] + 2 * row3[2] + r33[2]) >> 4;
+			cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] + 2 * row3[3] + r33[3]) >> 4;
+			cp += channels; row1 += channels; row2 += channels; row3 += channels;
 		}
 	}
 
 	if (in->rect_float && out->rect_float) {
-		for (int y = 0; y < in->y; y++) {
-			/* setup rows */
-			const float *row2 = (const float *)in->rect_float + y * channels * rowlen;
-			const float *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
-			const float *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
-
-			float *cp = (float *)out->rect_float + y * channels * rowlen;
+		/* setup rows */
+		const float *row2 = (const float *)in->rect_float + y * channels * rowlen;
+		const float *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
+		const float *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
 
-			for (int x = 0; x < rowlen; x++) {
-				const float *r11, *r13, *r21, *r23, *r31, *r33;
+		float *cp = (float *)out->rect_float + y * channels * rowlen;
 
-				if (x == 0) {
-					r11 = row1;
-					r21 = row2;
-					r31 = row3;
-				}
-				else {
-					r11 = row1 - channels;
-					r21 = row2 - channels;
-					r31 = row3 - channels;
-				}
+		for (int x = 0; x < rowlen; x++) {
+			const float *r11, *r13, *r21, *r23, *r31, *r33;
 
-				if (x == rowlen - 1) {
-					r13 = row1;
-					r23 = row2;
-					r33 = row3;
-				}
-				else {
-					r13 = row1 + channels;
-					r23 = row2 + channels;
-					r33 = row3 + channels;
-				}
+			if (x == 0) {
+				r11 = row1;
+				r21 = row2;
+				r31 = row3;
+			}
+			else {
+				r11 = row1 - channels;
+				r21 = row2 - channels;
+				r31 = row3 - channels;
+			}
 
-				cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] + 2 * row3[0] + r33[0]) * (1.0f / 16.0f);
-				cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] + 2 * row3[1] + r33[1]) * (1.0f / 16.0f);
-				cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] + 2 * row3[2] + r33[2]) * (1.0f / 16.0f);
-				cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] + 2 * row3[3] + r33[3]) * (1.0f / 16.0f);
-				cp += channels; row1 += channels; row2 += channels; row3 += channels;
+			if (x == rowlen - 1) {
+				r13 = row1;
+				r23 = row2;
+				r33 = row3;
 			}
+			else {
+				r13 = row1 + channels;
+				r23 = row2 + channels;
+				r33 = row3 + channels;
+			}
+
+			cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] + 2 * row3[0] + r33[0]) * (1.0f / 16.0f);
+			cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] + 2 * row3[1] + r33[1]) * (1.0f / 16.0f);
+			cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] + 2 * row3[2] + r33[2]) * (1.0f / 16.0f);
+			cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] + 2 * row3[3] + r33[3]) * (1.0f / 16.0f);
+			cp += channels; row1 += channels; row2 += channels; row3 += channels;
 		}
 	}
 }
 
+static void imb_filterN(ImBuf *out, ImBuf *in)
+{
+	BLI_assert(out->channels == in->channels);
+	BLI_assert(out->x == in->x && out->y == in->y);
+
+	/* the 3x3 kernel only reads from the input, so all rows can be done at once */
+	FilterNData data = {out, in};
+	filter_parallel_range(in, in->y, &data, imb_filterN_row_cb);
+}
+
 void IMB_filter(struct ImBuf *ibuf)
 {
 	IMB_filtery(ibuf);
@@ -540,7 +567,8 @@ void IMB_remakemipmap(ImBuf *ibuf, int use_filter)
 	}
 }
 
-/* frees too (if there) and recreates new data */
+/* frees too (if there) and recreates new data,
+ * every level is made from the previous one, the rows of a level are done in parallel */
 void IMB_makemipmap(ImBuf *ibuf, int use_filter)
 {
 	ImBuf *hbuf = ibuf;
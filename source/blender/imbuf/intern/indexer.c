@@ -36,6 +36,7 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -540,6 +541,10 @@ static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
 		rv->c->flags |= CODEC_FLAG_GLOBAL_HEADER;
 	}
 
+	/* MJPEG encodes slices of a frame in parallel */
+	rv->c->thread_count = 0;
+	rv->c->thread_type = FF_THREAD_SLICE;
+
 	if (avio_open(&rv->of->pb, fname, AVIO_FLAG_WRITE) < 0) {
 		fprintf(stderr, "Couldn't open outputfile! "
 		        "Proxy not built!\n");
@@ -694,6 +699,14 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx,
 	MEM_freeN(ctx);
 }
 
+#define INDEX_KEY_FRAME_HISTORY 32
+
+typedef struct IndexKeyFrame {
+	unsigned long long pos;
+	unsigned long long dts;
+	unsigned long long pts;
+} IndexKeyFrame;
+
 typedef struct FFmpegIndexBuilderContext {
 	int anim_type;
 
@@ -712,11 +725,12 @@ typedef struct FFmpegIndexBuilderContext {
 	IMB_Timecode_Type tcs_in_use;
 	IMB_Proxy_Size proxy_sizes_in_use;
 
-	unsigned long long seek_pos;
-	unsigned long long last_seek_pos;
-	unsigned long long seek_pos_dts;
-	unsigned long long seek_pos_pts;
-	unsigned long long last_seek_pos_dts;
+	/* most recent key frames read, the frame threaded decoder returns frames
+	 * several packets after they were read */
+	IndexKeyFrame key_frames[INDEX_KEY_FRAME_HISTORY];
+	int key_frames_num;
+	int key_frame_last;
+
 	unsigned long long start_pts;
 	double frame_rate;
 	double pts_time_base;
@@ -784,6 +798,10 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 
 	context->iCodecCtx->workaround_bugs = 1;
 
+	/* every frame is decoded, decode several of them at once */
+	context->iCodecCtx->thread_count = 0;
+	context->iCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
 		avformat_close_input(&context->iFormatCtx);
 		MEM_freeN(context);
@@ -842,18 +860,86 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 	MEM_freeN(context);
 }
 
+static void index_rebuild_ffmpeg_add_key_frame(FFmpegIndexBuilderContext *context,
+                                               AVPacket *packet)
+{
+	IndexKeyFrame *key_frame;
+
+	context->key_frame_last = (context->key_frame_last + 1) % INDEX_KEY_FRAME_HISTORY;
+	context->key_frames_num = MIN2(context->key_frames_num + 1, INDEX_KEY_FRAME_HISTORY);
+
+	key_frame = &context->key_frames[context->key_frame_last];
+	key_frame->pos = packet->pos;
+	key_frame->dts = packet->dts;
+	key_frame->pts = packet->pts;
+}
+
+/* decoding starts *always* on I-Frames,
+ * so: P-Frames won't work, even if all the
+ * information is in place, when we seek
+ * to the I-Frame presented *after* the P-Frame,
+ * but located before the P-Frame within
+ * the stream. Use the most recent key frame presented
+ * before the frame. */
+static void index_rebuild_ffmpeg_find_key_frame(FFmpegIndexBuilderContext *context,
+                                                unsigned long long pts,
+                                                unsigned long long *r_pos,
+                                                unsigned long long *r_dts)
+{
+	const IndexKeyFrame *key_frame = NULL;
+	int i;
+
+	for (i = 0; i < context->key_frames_num; i++) {
+		key_frame = &context->key_frames[
+		        (context->key_frame_last - i + INDEX_KEY_FRAME_HISTORY) % INDEX_KEY_FRAME_HISTORY];
+
+		if (key_frame->pts <= pts) {
+			break;
+		}
+	}
+
+	*r_pos = key_frame ? key_frame->pos : 0;
+	*r_dts = key_frame ? key_frame->dts : 0;
+}
+
+typedef struct ProxyOutputData {
+	FFmpegIndexBuilderContext *context;
+	AVFrame *frame;
+} ProxyOutputData;
+
+static void index_rebuild_ffmpeg_proxy_output_cb(void *__restrict userdata,
+                                                 const int i,
+                                                 const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ProxyOutputData *data = userdata;
+
+	add_to_proxy_output_ffmpeg(data->context->proxy_ctx[i], data->frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
         FFmpegIndexBuilderContext *context,
         AVPacket *curr_packet,
         AVFrame *in_frame)
 {
-	int i;
-	unsigned long long s_pos = context->seek_pos;
-	unsigned long long s_dts = context->seek_pos_dts;
+	int i, num_proxies = 0;
+	unsigned long long s_pos, s_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
 	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+		if (context->proxy_ctx[i]) {
+			num_proxies++;
+		}
+	}
+
+	/* proxy sizes are scaled and encoded independently of each other */
+	if (num_proxies > 0) {
+		ProxyOutputData data = {context, in_frame};
+		ParallelRangeSettings settings;
+
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = (num_proxies > 1);
+		BLI_task_parallel_range(0, context->num_proxy_sizes, &data,
+		                        index_rebuild_ffmpeg_proxy_output_cb, &settings);
 	}
 
 	if (!context->start_pts_set) {
@@ -865,17 +951,7 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	                         context->pts_time_base  *
 	                         context->frame_rate + 0.5);
 
-	/* decoding starts *always* on I-Frames,
-	 * so: P-Frames won't work, even if all the
-	 * information is in place, when we seek
-	 * to the I-Frame presented *after* the P-Frame,
-	 * but located before the P-Frame within
-	 * the stream */
-
-	if (pts < context->seek_pos_pts) {
-		s_pos = context->last_seek_pos;
-		s_dts = context->last_seek_pos_dts;
-	}
+	index_rebuild_ffmpeg_find_key_frame(context, pts, &s_pos, &s_dts);
 
 	for (i = 0; i < context->num_indexers; i++) {
 		if (context->tcs_in_use & tc_types[i]) {
@@ -929,11 +1005,7 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 
 		if (next_packet.stream_index == context->videoStream) {
 			if (next_packet.flags & AV_PKT_FLAG_KEY) {
-				context->last_seek_pos = context->seek_pos;
-				context->last_seek_pos_dts = context->seek_pos_dts;
-				context->seek_pos = next_packet.pos;
-				context->seek_pos_dts = next_packet.dts;
-				context->seek_pos_pts = next_packet.pts;
+				index_rebuild_ffmpeg_add_key_frame(context, &next_packet);
 			}
 
 			avcodec_decode_video2(
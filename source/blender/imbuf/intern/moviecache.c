@@ -72,6 +72,7 @@ typedef struct MovieCache {
 	MovieCacheGetPriorityDataFP getprioritydatafp;
 	MovieCacheGetItemPriorityFP getitempriorityfp;
 	MovieCachePriorityDeleterFP prioritydeleterfp;
+	MovieCacheEvictFP evictfp;
 
 	struct BLI_mempool *keys_pool;
 	struct BLI_mempool *items_pool;
@@ -92,6 +93,7 @@ typedef struct MovieCacheKey {
 
 typedef struct MovieCacheItem {
 	MovieCache *cache_owner;
+	void *userkey;
 	ImBuf *ibuf;
 	MEM_CacheLimiterHandleC *c_handle;
 	void *priority_data;
@@ -180,6 +182,10 @@ static void IMB_moviecache_destructor(void *p)
 
 		PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
+		if (cache->evictfp) {
+			cache->evictfp(item->userkey, item->ibuf);
+		}
+
 		IMB_freeImBuf(item->ibuf);
 
 		item->ibuf = NULL;
@@ -334,6 +340,11 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGe
 	cache->prioritydeleterfp = prioritydeleterfp;
 }
 
+void IMB_moviecache_set_evict_callback(MovieCache *cache, MovieCacheEvictFP evictfp)
+{
+	cache->evictfp = evictfp;
+}
+
 static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
 {
 	MovieCacheKey *key;
@@ -355,6 +366,7 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
 	item->ibuf = ibuf;
 	item->cache_owner = cache;
+	item->userkey = key->userkey;
 	item->c_handle = NULL;
 	item->priority_data = NULL;
 
@@ -86,7 +86,9 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -117,6 +119,7 @@ static bool exr_has_multipart_file(MultiPartInputFile& file);
 static bool exr_has_alpha(MultiPartInputFile& file);
 static bool exr_has_zbuffer(MultiPartInputFile& file);
 static void exr_printf(const char *__restrict format, ...);
+static void exr_num_threads_ensure(void);
 static void imb_exr_type_by_channels(ChannelList& channels, StringVector& views,
                                      bool *r_singlelayer, bool *r_multilayer, bool *r_multiview);
 }
@@ -540,6 +543,8 @@ int imb_save_openexr(struct ImBuf *ibuf, const char *name, int flags)
 		return(0);
 	}
 
+	exr_num_threads_ensure();
+
 	if (ibuf->foptions.flag & OPENEXR_HALF)
 		return (int) imb_save_openexr_half(ibuf, name, flags);
 	else {
@@ -562,6 +567,10 @@ int imb_save_openexr(struct ImBuf *ibuf, const char *name, int flags)
 
 static ListBase exrhandles = {NULL, NULL};
 
+/* Scanline blocks for writing half float channels, see IMB_exr_write_channels. */
+#define EXR_WRITE_BLOCK_MIN_ROWS     256
+#define EXR_WRITE_BLOCK_THREAD_ROWS  32
+
 typedef struct ExrHandle {
 	struct ExrHandle *next, *prev;
 	char name[FILE_MAX];
@@ -780,6 +789,8 @@ int IMB_exr_begin_write(void *handle, const char *filename, int width, int heigh
 	data->width = width;
 	data->height = height;
 
+	exr_num_threads_ensure();
+
 	bool is_singlelayer, is_multilayer, is_multiview;
 
 	for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
@@ -833,6 +844,8 @@ void IMB_exrtile_begin_write(void *handle, const char *filename, int mipmap, int
 	data->height = height;
 	data->mipmap = mipmap;
 
+	exr_num_threads_ensure();
+
 	header.setTileDescription(TileDescription(tilex, tiley, (mipmap) ? MIPMAP_LEVELS : ONE_LEVEL));
 	header.compression() = RLE_COMPRESSION;
 	header.setType(TILEDIMAGE);
@@ -886,6 +899,8 @@ int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *heig
 	ExrHandle *data = (ExrHandle *)handle;
 	ExrChannel *echan;
 
+	exr_num_threads_ensure();
+
 	if (BLI_exists(filename) && BLI_file_size(filename) > 32) {   /* 32 is arbitrary, but zero length files crashes exr */
 		/* avoid crash/abort when we don't have permission to write here */
 		try {
@@ -1004,52 +1019,121 @@ void IMB_exr_clear_channels(void *handle)
 	BLI_freelistN(&data->channels);
 }
 
+/* Half float channels are converted and written in blocks of scanlines, while OpenEXR compresses
+ * one block the next one is converted on other threads. Float channels are written directly. */
+typedef struct ExrHalfBlockTask {
+	ExrChannel *echan;
+	half *rect_half;
+	int width, height;
+	int ystart, yend;
+} ExrHalfBlockTask;
+
+static void exr_half_block_convert(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	ExrHalfBlockTask *task = (ExrHalfBlockTask *)taskdata;
+	ExrChannel *echan = task->echan;
+	half *cur = task->rect_half;
+
+	/* Writing starts from last scanline, file row y is Blender row height - 1 - y. */
+	for (int y = task->ystart; y < task->yend; y++) {
+		const float *rect = echan->rect + echan->xstride * (task->height - 1L - y) * task->width;
+		for (int x = 0; x < task->width; x++, cur++) {
+			*cur = rect[x * echan->xstride];
+		}
+	}
+}
+
+static void exr_half_block_push(ExrHandle *data, TaskPool *pool, half *rect_half, int ystart, int yend)
+{
+	const size_t block_pixels = ((size_t)data->width) * (yend - ystart);
+
+	for (ExrChannel *echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+		if (echan->use_half_float) {
+			ExrHalfBlockTask *task = (ExrHalfBlockTask *)MEM_mallocN(sizeof(ExrHalfBlockTask), __func__);
+			task->echan = echan;
+			task->rect_half = rect_half;
+			task->width = data->width;
+			task->height = data->height;
+			task->ystart = ystart;
+			task->yend = yend;
+			BLI_task_pool_push(pool, exr_half_block_convert, task, true, TASK_PRIORITY_HIGH);
+			rect_half += block_pixels;
+		}
+	}
+}
+
+static void exr_framebuffer_block(ExrHandle *data, FrameBuffer& frameBuffer, half *rect_half, int ystart, int yend)
+{
+	const size_t block_pixels = ((size_t)data->width) * (yend - ystart);
+
+	for (ExrChannel *echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+		if (echan->use_half_float) {
+			/* Block buffers are in file order, offset so that scanline ystart maps to their start. */
+			half *rect_to_write = rect_half - (size_t)ystart * data->width;
+			frameBuffer.insert(echan->name, Slice(Imf::HALF,  (char *)rect_to_write,
+			                                      sizeof(half), data->width * sizeof(half)));
+			rect_half += block_pixels;
+		}
+		else {
+			/* Writing starts from last scanline, stride negative. */
+			float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
+			frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)rect,
+			                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+		}
+	}
+}
+
 void IMB_exr_write_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
-	FrameBuffer frameBuffer;
-	ExrChannel *echan;
 
 	if (data->channels.first) {
-		const size_t num_pixels = ((size_t)data->width) * data->height;
-		half *rect_half = NULL, *current_rect_half = NULL;
+		half *rect_half[2] = {NULL, NULL};
+		TaskPool *pool = NULL;
+		int block_rows = data->height;
 
-		/* We allocate teporary storage for half pixels for all the channels at once. */
 		if (data->num_half_channels != 0) {
-			rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels, __func__);
-			current_rect_half = rect_half;
+			/* Enough scanlines per block for OpenEXR to compress on all its threads. */
+			block_rows = min_ii(data->height, max_ii(EXR_WRITE_BLOCK_MIN_ROWS,
+			                                         EXR_WRITE_BLOCK_THREAD_ROWS * BLI_system_thread_count()));
+			const size_t block_size = sizeof(half) * data->num_half_channels * data->width * block_rows;
+			rect_half[0] = (half *)MEM_mallocN(block_size, __func__);
+			rect_half[1] = (half *)MEM_mallocN(block_size, __func__);
+
+			pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+			exr_half_block_push(data, pool, rect_half[0], 0, block_rows);
+			BLI_task_pool_work_and_wait(pool);
 		}
 
-		for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-			/* Writing starts from last scanline, stride negative. */
-			if (echan->use_half_float) {
-				float *rect = echan->rect;
-				half *cur = current_rect_half;
-				for (size_t i = 0; i < num_pixels; ++i, ++cur) {
-					*cur = rect[i * echan->xstride];
+		try {
+			for (int ystart = 0, block = 0; ystart < data->height; ystart += block_rows, block ^= 1) {
+				const int yend = min_ii(ystart + block_rows, data->height);
+				FrameBuffer frameBuffer;
+
+				/* Convert the next block while this one is compressed. */
+				if (pool && yend < data->height) {
+					exr_half_block_push(data, pool, rect_half[block ^ 1], yend, min_ii(yend + block_rows, data->height));
 				}
-				half *rect_to_write = current_rect_half + (data->height - 1L) * data->width;
-				frameBuffer.insert(echan->name, Slice(Imf::HALF,  (char *)rect_to_write,
-				                                      sizeof(half), -data->width * sizeof(half)));
-				current_rect_half += num_pixels;
-			}
-			else {
-				float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
-				frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)rect,
-				                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
-			}
-		}
 
-		data->ofile->setFrameBuffer(frameBuffer);
-		try {
-			data->ofile->writePixels(data->height);
+				exr_framebuffer_block(data, frameBuffer, rect_half[block], ystart, yend);
+				data->ofile->setFrameBuffer(frameBuffer);
+				data->ofile->writePixels(yend - ystart);
+
+				if (pool) {
+					BLI_task_pool_work_and_wait(pool);
+				}
+			}
 		}
 		catch (const std::exception& exc) {
 			std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
 		}
+
 		/* Free temporary buffers. */
-		if (rect_half != NULL) {
-			MEM_freeN(rect_half);
+		if (pool != NULL) {
+			BLI_task_pool_work_and_wait(pool);
+			BLI_task_pool_free(pool);
+			MEM_freeN(rect_half[0]);
+			MEM_freeN(rect_half[1]);
 		}
 	}
 	else {
@@ -1749,6 +1833,8 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 
 	colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
 
+	exr_num_threads_ensure();
+
 	try
 	{
 		bool is_multi;
@@ -1914,11 +2000,27 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 
 }
 
-void imb_initopenexr(void)
+/* Number of threads in OpenEXR's global thread pool, used for (de)compressing scanline blocks.
+ * It follows BLI_system_thread_count(), which can be changed from the command line after
+ * startup, so it's checked again every time a file is read or written. */
+static int exr_num_threads = 0;
+static ThreadMutex exr_num_threads_lock = BLI_MUTEX_INITIALIZER;
+
+static void exr_num_threads_ensure(void)
 {
-	int num_threads = BLI_system_thread_count();
+	const int num_threads = BLI_system_thread_count();
+
+	BLI_mutex_lock(&exr_num_threads_lock);
+	if (num_threads != exr_num_threads) {
+		setGlobalThreadCount(num_threads);
+		exr_num_threads = num_threads;
+	}
+	BLI_mutex_unlock(&exr_num_threads_lock);
+}
 
-	setGlobalThreadCount(num_threads);
+void imb_initopenexr(void)
+{
+	exr_num_threads_ensure();
 }
 
 void imb_exitopenexr(void)
@@ -1926,7 +2028,10 @@ void imb_exitopenexr(void)
 	/* Tells OpenEXR to free thread pool, also ensures there is no running
 	 * tasks.
 	 */
+	BLI_mutex_lock(&exr_num_threads_lock);
 	setGlobalThreadCount(0);
+	exr_num_threads = 0;
+	BLI_mutex_unlock(&exr_num_threads_lock);
 }
 
 } // export "C"
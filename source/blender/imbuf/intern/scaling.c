@@ -35,6 +35,8 @@
 #include "BLI_utildefines.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -45,6 +47,20 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Images with less pixels than this are processed on the calling thread,
+ * the threading overhead is higher than the gain for them. */
+#define SCALE_THREADED_MIN_PIXELS (256 * 256)
+
+static bool scale_use_threading(const size_t tot_pixels)
+{
+	/* also keep to the calling thread when running with a single thread (-t 1) */
+	return (tot_pixels >= SCALE_THREADED_MIN_PIXELS) && (BLI_system_thread_count() > 1);
+}
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
 	uchar *p1, *_p1, *dest;
@@ -334,80 +350,97 @@ MINLINE void premul_ushort_to_straight_uchar(unsigned char *result, const unsign
 	}
 }
 
-/* result in ibuf2, scaling should be done correctly */
-void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
-{
-	int x, y;
-	const short do_rect = (ibuf1->rect != NULL);
-	const short do_float = (ibuf1->rect_float != NULL) && (ibuf2->rect_float != NULL);
-
-	if (do_rect && (ibuf2->rect == NULL)) {
-		imb_addrectImBuf(ibuf2);
-	}
+typedef struct OneHalfData {
+	ImBuf *ibuf1, *ibuf2;
+	bool do_rect, do_float;
+} OneHalfData;
 
-	if (ibuf1->x <= 1) {
-		imb_half_y_no_alloc(ibuf2, ibuf1);
-		return;
-	}
-	if (ibuf1->y <= 1) {
-		imb_half_x_no_alloc(ibuf2, ibuf1);
-		return;
-	}
+static void imb_onehalf_row_cb(void *__restrict userdata,
+                               const int y,
+                               const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	OneHalfData *data = userdata;
+	ImBuf *ibuf1 = data->ibuf1;
+	ImBuf *ibuf2 = data->ibuf2;
+	int x;
 
-	if (do_rect) {
+	if (data->do_rect) {
 		unsigned char *cp1, *cp2, *dest;
 
-		cp1 = (unsigned char *) ibuf1->rect;
-		dest = (unsigned char *) ibuf2->rect;
+		cp1 = (unsigned char *) ibuf1->rect + ((size_t)y * 2 * ibuf1->x << 2);
+		cp2 = cp1 + (ibuf1->x << 2);
+		dest = (unsigned char *) ibuf2->rect + ((size_t)y * ibuf2->x << 2);
 
-		for (y = ibuf2->y; y > 0; y--) {
-			cp2 = cp1 + (ibuf1->x << 2);
-			for (x = ibuf2->x; x > 0; x--) {
-				unsigned short p1i[8], p2i[8], desti[4];
+		for (x = ibuf2->x; x > 0; x--) {
+			unsigned short p1i[8], p2i[8], desti[4];
 
-				straight_uchar_to_premul_ushort(p1i, cp1);
-				straight_uchar_to_premul_ushort(p2i, cp2);
-				straight_uchar_to_premul_ushort(p1i + 4, cp1 + 4);
-				straight_uchar_to_premul_ushort(p2i + 4, cp2 + 4);
+			straight_uchar_to_premul_ushort(p1i, cp1);
+			straight_uchar_to_premul_ushort(p2i, cp2);
+			straight_uchar_to_premul_ushort(p1i + 4, cp1 + 4);
+			straight_uchar_to_premul_ushort(p2i + 4, cp2 + 4);
 
-				desti[0] = ((unsigned int) p1i[0] + p2i[0] + p1i[4] + p2i[4]) >> 2;
-				desti[1] = ((unsigned int) p1i[1] + p2i[1] + p1i[5] + p2i[5]) >> 2;
-				desti[2] = ((unsigned int) p1i[2] + p2i[2] + p1i[6] + p2i[6]) >> 2;
-				desti[3] = ((unsigned int) p1i[3] + p2i[3] + p1i[7] + p2i[7]) >> 2;
+			desti[0] = ((unsigned int) p1i[0] + p2i[0] + p1i[4] + p2i[4]) >> 2;
+			desti[1] = ((unsigned int) p1i[1] + p2i[1] + p1i[5] + p2i[5]) >> 2;
+			desti[2] = ((unsigned int) p1i[2] + p2i[2] + p1i[6] + p2i[6]) >> 2;
+			desti[3] = ((unsigned int) p1i[3] + p2i[3] + p1i[7] + p2i[7]) >> 2;
 
-				premul_ushort_to_straight_uchar(dest, desti);
+			premul_ushort_to_straight_uchar(dest, desti);
 
-				cp1 += 8;
-				cp2 += 8;
-				dest += 4;
-			}
-			cp1 = cp2;
-			if (ibuf1->x & 1) cp1 += 4;
+			cp1 += 8;
+			cp2 += 8;
+			dest += 4;
 		}
 	}
 
-	if (do_float) {
+	if (data->do_float) {
 		float *p1f, *p2f, *destf;
 
-		p1f = ibuf1->rect_float;
-		destf = ibuf2->rect_float;
-		for (y = ibuf2->y; y > 0; y--) {
-			p2f = p1f + (ibuf1->x << 2);
-			for (x = ibuf2->x; x > 0; x--) {
-				destf[0] = 0.25f * (p1f[0] + p2f[0] + p1f[4] + p2f[4]);
-				destf[1] = 0.25f * (p1f[1] + p2f[1] + p1f[5] + p2f[5]);
-				destf[2] = 0.25f * (p1f[2] + p2f[2] + p1f[6] + p2f[6]);
-				destf[3] = 0.25f * (p1f[3] + p2f[3] + p1f[7] + p2f[7]);
-				p1f += 8;
-				p2f += 8;
-				destf += 4;
-			}
-			p1f = p2f;
-			if (ibuf1->x & 1) p1f += 4;
+		p1f = ibuf1->rect_float + ((size_t)y * 2 * ibuf1->x << 2);
+		p2f = p1f + (ibuf1->x << 2);
+		destf = ibuf2->rect_float + ((size_t)y * ibuf2->x << 2);
+
+		for (x = ibuf2->x; x > 0; x--) {
+			destf[0] = 0.25f * (p1f[0] + p2f[0] + p1f[4] + p2f[4]);
+			destf[1] = 0.25f * (p1f[1] + p2f[1] + p1f[5] + p2f[5]);
+			destf[2] = 0.25f * (p1f[2] + p2f[2] + p1f[6] + p2f[6]);
+			destf[3] = 0.25f * (p1f[3] + p2f[3] + p1f[7] + p2f[7]);
+			p1f += 8;
+			p2f += 8;
+			destf += 4;
 		}
 	}
 }
 
+/* result in ibuf2, scaling should be done correctly */
+void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
+{
+	OneHalfData data;
+	ParallelRangeSettings settings;
+
+	data.ibuf1 = ibuf1;
+	data.ibuf2 = ibuf2;
+	data.do_rect = (ibuf1->rect != NULL);
+	data.do_float = (ibuf1->rect_float != NULL) && (ibuf2->rect_float != NULL);
+
+	if (data.do_rect && (ibuf2->rect == NULL)) {
+		imb_addrectImBuf(ibuf2);
+	}
+
+	if (ibuf1->x <= 1) {
+		imb_half_y_no_alloc(ibuf2, ibuf1);
+		return;
+	}
+	if (ibuf1->y <= 1) {
+		imb_half_x_no_alloc(ibuf2, ibuf1);
+		return;
+	}
+
+	/* every destination row is the average of its own pair of source rows */
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = scale_use_threading((size_t)ibuf1->x * ibuf1->y);
+	BLI_task_parallel_range(0, ibuf2->y, &data, imb_onehalf_row_cb, &settings);
+}
+
 ImBuf *IMB_onehalf(struct ImBuf *ibuf1)
 {
 	struct ImBuf *ibuf2;
@@ -876,604 +909,514 @@ static bool q_scale_linear_interpolation(
 	return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+/* Scaling of the separable passes below is done per line: every row (x passes) or
+ * column (y passes) only reads its own source line, so lines are spread over threads.
+ * The line functions take the distance between two pixels of a line as \a step,
+ * they return the source pointer past the last pixel read. */
+
+static const uchar *scaledown_line_byte(
+        const uchar *rect, uchar *newrect, const size_t step, const int newlen, const float add)
 {
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
+	float sample = 0.0f;
+	float val[4] = {0.0f, 0.0f, 0.0f, 0.0f}, nval[4];
+	int i;
 
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y;
+	for (i = newlen; i > 0; i--) {
+		nval[0] = -val[0] * sample;
+		nval[1] = -val[1] * sample;
+		nval[2] = -val[2] * sample;
+		nval[3] = -val[3] * sample;
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+		sample += add;
 
-	if (!do_rect && !do_float) return (ibuf);
+		while (sample >= 1.0f) {
+			sample -= 1.0f;
+			nval[0] += rect[0];
+			nval[1] += rect[1];
+			nval[2] += rect[2];
+			nval[3] += rect[3];
+			rect += step;
+		}
 
-	if (do_rect) {
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-		if (_newrect == NULL) return(ibuf);
+		val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
+		rect += step;
+
+		newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
+		newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
+		newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
+		newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
+		newrect += step;
+
+		sample -= 1.0f;
 	}
-	if (do_float) {
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
+
+	return rect;
+}
+
+/* An RGBA float pixel fits in one SSE2 register, the operations are the same
+ * as in the scalar version so the results don't depend on the instruction set. */
+static const float *scaledown_line_float(
+        const float *rectf, float *newrectf, const size_t step, const int newlen, const float add)
+{
+	float sample = 0.0f;
+	int i;
+
+#ifdef __SSE2__
+	const __m128 add_v = _mm_set1_ps(add);
+	__m128 valf = _mm_setzero_ps();
+
+	for (i = newlen; i > 0; i--) {
+		__m128 nvalf = _mm_mul_ps(valf, _mm_set1_ps(-sample));
+
+		sample += add;
+
+		while (sample >= 1.0f) {
+			sample -= 1.0f;
+			nvalf = _mm_add_ps(nvalf, _mm_loadu_ps(rectf));
+			rectf += step;
 		}
-	}
 
-	add = (ibuf->x - 0.01) / newx;
+		valf = _mm_loadu_ps(rectf);
+		rectf += step;
+		_mm_storeu_ps(newrectf, _mm_div_ps(_mm_add_ps(nvalf, _mm_mul_ps(_mm_set1_ps(sample), valf)), add_v));
+		newrectf += step;
 
-	if (do_rect) {
-		rect = (uchar *) ibuf->rect;
-		newrect = _newrect;
+		sample -= 1.0f;
 	}
-	if (do_float) {
-		rectf = ibuf->rect_float;
-		newrectf = _newrectf;
+#else
+	float valf[4] = {0.0f, 0.0f, 0.0f, 0.0f}, nvalf[4];
+
+	for (i = newlen; i > 0; i--) {
+		nvalf[0] = -valf[0] * sample;
+		nvalf[1] = -valf[1] * sample;
+		nvalf[2] = -valf[2] * sample;
+		nvalf[3] = -valf[3] * sample;
+
+		sample += add;
+
+		while (sample >= 1.0f) {
+			sample -= 1.0f;
+			nvalf[0] += rectf[0];
+			nvalf[1] += rectf[1];
+			nvalf[2] += rectf[2];
+			nvalf[3] += rectf[3];
+			rectf += step;
+		}
+
+		valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
+		rectf += step;
+
+		newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
+		newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
+		newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
+		newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+		newrectf += step;
+
+		sample -= 1.0f;
 	}
+#endif  /* __SSE2__ */
 
-	for (y = ibuf->y; y > 0; y--) {
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+	return rectf;
+}
 
-		for (x = newx; x > 0; x--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
+static void scaleup_line_byte(
+        const uchar *rect, uchar *newrect, const size_t step, const int newlen, const float add)
+{
+	float sample = 0.0f;
+	float val[4], nval[4], diff[4];
+	int i;
 
-			sample += add;
-
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += 4;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += 4;
-				}
-			}
+	val[0] = rect[0];
+	nval[0] = rect[step];
+	diff[0] = nval[0] - val[0];
+	val[0] += 0.5f;
+
+	val[1] = rect[1];
+	nval[1] = rect[step + 1];
+	diff[1] = nval[1] - val[1];
+	val[1] += 0.5f;
+
+	val[2] = rect[2];
+	nval[2] = rect[step + 2];
+	diff[2] = nval[2] - val[2];
+	val[2] += 0.5f;
+
+	val[3] = rect[3];
+	nval[3] = rect[step + 3];
+	diff[3] = nval[3] - val[3];
+	val[3] += 0.5f;
+	rect += 2 * step;
+
+	for (i = newlen; i > 0; i--) {
+		if (sample >= 1.0f) {
+			sample -= 1.0f;
+			val[0] = nval[0];
+			nval[0] = rect[0];
+			diff[0] = nval[0] - val[0];
+			val[0] += 0.5f;
+
+			val[1] = nval[1];
+			nval[1] = rect[1];
+			diff[1] = nval[1] - val[1];
+			val[1] += 0.5f;
+
+			val[2] = nval[2];
+			nval[2] = rect[2];
+			diff[2] = nval[2] - val[2];
+			val[2] += 0.5f;
+
+			val[3] = nval[3];
+			nval[3] = rect[3];
+			diff[3] = nval[3] - val[3];
+			val[3] += 0.5f;
+			rect += step;
+		}
+		newrect[0] = val[0] + sample * diff[0];
+		newrect[1] = val[1] + sample * diff[1];
+		newrect[2] = val[2] + sample * diff[2];
+		newrect[3] = val[3] + sample * diff[3];
+		newrect += step;
+		sample += add;
+	}
+}
 
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += 4;
+static void scaleup_line_float(
+        const float *rectf, float *newrectf, const size_t step, const int newlen, const float add)
+{
+	float sample = 0.0f;
+	int i;
 
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
+#ifdef __SSE2__
+	__m128 valf = _mm_loadu_ps(rectf);
+	__m128 nvalf = _mm_loadu_ps(rectf + step);
+	__m128 difff = _mm_sub_ps(nvalf, valf);
+	rectf += 2 * step;
 
-				newrect += 4;
-			}
-			if (do_float) {
+	for (i = newlen; i > 0; i--) {
+		if (sample >= 1.0f) {
+			sample -= 1.0f;
+			valf = nvalf;
+			nvalf = _mm_loadu_ps(rectf);
+			difff = _mm_sub_ps(nvalf, valf);
+			rectf += step;
+		}
+		_mm_storeu_ps(newrectf, _mm_add_ps(valf, _mm_mul_ps(_mm_set1_ps(sample), difff)));
+		newrectf += step;
+		sample += add;
+	}
+#else
+	float valf[4], nvalf[4], difff[4];
 
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += 4;
+	valf[0] = rectf[0];
+	nvalf[0] = rectf[step];
+	difff[0] = nvalf[0] - valf[0];
 
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+	valf[1] = rectf[1];
+	nvalf[1] = rectf[step + 1];
+	difff[1] = nvalf[1] - valf[1];
 
-				newrectf += 4;
-			}
+	valf[2] = rectf[2];
+	nvalf[2] = rectf[step + 2];
+	difff[2] = nvalf[2] - valf[2];
 
+	valf[3] = rectf[3];
+	nvalf[3] = rectf[step + 3];
+	difff[3] = nvalf[3] - valf[3];
+	rectf += 2 * step;
+
+	for (i = newlen; i > 0; i--) {
+		if (sample >= 1.0f) {
 			sample -= 1.0f;
+			valf[0] = nvalf[0];
+			nvalf[0] = rectf[0];
+			difff[0] = nvalf[0] - valf[0];
+
+			valf[1] = nvalf[1];
+			nvalf[1] = rectf[1];
+			difff[1] = nvalf[1] - valf[1];
+
+			valf[2] = nvalf[2];
+			nvalf[2] = rectf[2];
+			difff[2] = nvalf[2] - valf[2];
+
+			valf[3] = nvalf[3];
+			nvalf[3] = rectf[3];
+			difff[3] = nvalf[3] - valf[3];
+			rectf += step;
 		}
+		newrectf[0] = valf[0] + sample * difff[0];
+		newrectf[1] = valf[1] + sample * difff[1];
+		newrectf[2] = valf[2] + sample * difff[2];
+		newrectf[3] = valf[3] + sample * difff[3];
+		newrectf += step;
+		sample += add;
 	}
+#endif  /* __SSE2__ */
+}
+
+typedef struct ScaleLinesData {
+	ImBuf *ibuf;
+	uchar *newrect;
+	float *newrectf;
+	int newlen;
+	float add;
+} ScaleLinesData;
+
+static void scale_lines_parallel(ScaleLinesData *data, const int tot_lines, TaskParallelRangeFunc func)
+{
+	ParallelRangeSettings settings;
+
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = scale_use_threading((size_t)data->ibuf->x * data->ibuf->y);
+	BLI_task_parallel_range(0, tot_lines, data, func, &settings);
+}
+
+static void scaledownx_line_cb(void *__restrict userdata,
+                               const int y,
+                               const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ScaleLinesData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t row_size = (size_t)ibuf->x * 4;
+	const size_t newrow_size = (size_t)data->newlen * 4;
+
+	/* each row has to end exactly at the start of the next one, see bug [#26502] */
+	if (data->newrect) {
+		const uchar *rect = scaledown_line_byte(
+		        (uchar *)ibuf->rect + y * row_size, data->newrect + y * newrow_size, 4, data->newlen, data->add);
+		BLI_assert((rect - (uchar *)ibuf->rect) == (y + 1) * row_size);
+		UNUSED_VARS_NDEBUG(rect);
+	}
+	if (data->newrectf) {
+		const float *rectf = scaledown_line_float(
+		        ibuf->rect_float + y * row_size, data->newrectf + y * newrow_size, 4, data->newlen, data->add);
+		BLI_assert((rectf - ibuf->rect_float) == (y + 1) * row_size);
+		UNUSED_VARS_NDEBUG(rectf);
+	}
+}
+
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+	const int do_rect = (ibuf->rect != NULL);
+	const int do_float = (ibuf->rect_float != NULL);
+	ScaleLinesData data = {NULL};
+
+	if (!do_rect && !do_float) return (ibuf);
+
+	if (do_rect) {
+		data.newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
+		if (data.newrect == NULL) return(ibuf);
+	}
+	if (do_float) {
+		data.newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
+			return(ibuf);
+		}
+	}
+
+	data.ibuf = ibuf;
+	data.newlen = newx;
+	data.add = (ibuf->x - 0.01) / newx;
+
+	scale_lines_parallel(&data, ibuf->y, scaledownx_line_cb);
 
 	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
 	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
-	(void)rect_size; /* UNUSED in release builds */
 
 	ibuf->x = newx;
 	return(ibuf);
 }
 
+static void scaledowny_line_cb(void *__restrict userdata,
+                               const int column,
+                               const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ScaleLinesData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t skipx = (size_t)ibuf->x * 4;
+	const size_t x = (size_t)column * 4;
+
+	/* each column has to end exactly past the last row, see bug [#26502] */
+	if (data->newrect) {
+		const uchar *rect = scaledown_line_byte(
+		        (uchar *)ibuf->rect + x, data->newrect + x, skipx, data->newlen, data->add);
+		BLI_assert((rect - (uchar *)ibuf->rect) == skipx * ibuf->y + x);
+		UNUSED_VARS_NDEBUG(rect);
+	}
+	if (data->newrectf) {
+		const float *rectf = scaledown_line_float(
+		        ibuf->rect_float + x, data->newrectf + x, skipx, data->newlen, data->add);
+		BLI_assert((rectf - ibuf->rect_float) == skipx * ibuf->y + x);
+		UNUSED_VARS_NDEBUG(rectf);
+	}
+}
 
 static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 {
 	const int do_rect = (ibuf->rect != NULL);
 	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y, skipx;
-
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+	ScaleLinesData data = {NULL};
 
 	if (!do_rect && !do_float) return (ibuf);
 
 	if (do_rect) {
-		_newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-		if (_newrect == NULL) return(ibuf);
+		data.newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
+		if (data.newrect == NULL) return(ibuf);
 	}
 	if (do_float) {
-		_newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
+		data.newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
 			return(ibuf);
 		}
 	}
 
-	add = (ibuf->y - 0.01) / newy;
-	skipx = 4 * ibuf->x;
-
-	for (x = skipx - 4; x >= 0; x -= 4) {
-		if (do_rect) {
-			rect = ((uchar *) ibuf->rect) + x;
-			newrect = _newrect + x;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + x;
-			newrectf = _newrectf + x;
-		}
-
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-		for (y = newy; y > 0; y--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-
-			sample += add;
-
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += skipx;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += skipx;
-				}
-			}
-
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += skipx;
-
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
+	data.ibuf = ibuf;
+	data.newlen = newy;
+	data.add = (ibuf->y - 0.01) / newy;
 
-				newrect += skipx;
-			}
-			if (do_float) {
-
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += skipx;
-
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-				newrectf += skipx;
-			}
-
-			sample -= 1.0f;
-		}
-	}
+	scale_lines_parallel(&data, ibuf->x, scaledowny_line_cb);
 
 	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
 	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
-	(void)rect_size; /* UNUSED in release builds */
 
 	ibuf->y = newy;
 	return(ibuf);
 }
 
+static void scaleupx_line_cb(void *__restrict userdata,
+                             const int y,
+                             const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ScaleLinesData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t row_size = (size_t)ibuf->x * 4;
+	const size_t newrow_size = (size_t)data->newlen * 4;
+
+	if (data->newrect) {
+		scaleup_line_byte(
+		        (uchar *)ibuf->rect + y * row_size, data->newrect + y * newrow_size, 4, data->newlen, data->add);
+	}
+	if (data->newrectf) {
+		scaleup_line_float(
+		        ibuf->rect_float + y * row_size, data->newrectf + y * newrow_size, 4, data->newlen, data->add);
+	}
+}
 
 static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y;
+	ScaleLinesData data = {NULL};
 	bool do_rect = false, do_float = false;
 
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
 	if (ibuf == NULL) return(NULL);
 	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
 	if (ibuf->rect) {
 		do_rect = true;
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-		if (_newrect == NULL) return(ibuf);
+		data.newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
+		if (data.newrect == NULL) return(ibuf);
 	}
 	if (ibuf->rect_float) {
 		do_float = true;
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
+		data.newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
 			return(ibuf);
 		}
 	}
 
-	add = (ibuf->x - 1.001) / (newx - 1.0);
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
+	data.ibuf = ibuf;
+	data.newlen = newx;
+	data.add = (ibuf->x - 1.001) / (newx - 1.0);
 
-	for (y = ibuf->y; y > 0; y--) {
-
-		sample = 0;
-
-		if (do_rect) {
-			val_a = rect[0];
-			nval_a = rect[4];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[5];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[6];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[7];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 8;
-		}
-		if (do_float) {
-			val_af = rectf[0];
-			nval_af = rectf[4];
-			diff_af = nval_af - val_af;
-
-			val_bf = rectf[1];
-			nval_bf = rectf[5];
-			diff_bf = nval_bf - val_bf;
-
-			val_gf = rectf[2];
-			nval_gf = rectf[6];
-			diff_gf = nval_gf - val_gf;
-
-			val_rf = rectf[3];
-			nval_rf = rectf[7];
-			diff_rf = nval_rf - val_rf;
-
-			rectf += 8;
-		}
-		for (x = newx; x > 0; x--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += 4;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += 4;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += 4;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += 4;
-			}
-			sample += add;
-		}
-	}
+	scale_lines_parallel(&data, ibuf->y, scaleupx_line_cb);
 
 	if (do_rect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
 	if (do_float) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
 
 	ibuf->x = newx;
 	return(ibuf);
 }
 
+static void scaleupy_line_cb(void *__restrict userdata,
+                             const int column,
+                             const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ScaleLinesData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t skipx = (size_t)ibuf->x * 4;
+	const size_t x = (size_t)column * 4;
+
+	if (data->newrect) {
+		scaleup_line_byte((uchar *)ibuf->rect + x, data->newrect + x, skipx, data->newlen, data->add);
+	}
+	if (data->newrectf) {
+		scaleup_line_float(ibuf->rect_float + x, data->newrectf + x, skipx, data->newlen, data->add);
+	}
+}
+
 static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y, skipx;
+	ScaleLinesData data = {NULL};
 	bool do_rect = false, do_float = false;
 
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
 	if (ibuf == NULL) return(NULL);
 	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
 	if (ibuf->rect) {
 		do_rect = true;
-		_newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-		if (_newrect == NULL) return(ibuf);
+		data.newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
+		if (data.newrect == NULL) return(ibuf);
 	}
 	if (ibuf->rect_float) {
 		do_float = true;
-		_newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
+		data.newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
 			return(ibuf);
 		}
 	}
 
-	add = (ibuf->y - 1.001) / (newy - 1.0);
-	skipx = 4 * ibuf->x;
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
-
-	for (x = ibuf->x; x > 0; x--) {
-
-		sample = 0;
-		if (do_rect) {
-			rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-			newrect = _newrect + 4 * (x - 1);
-
-			val_a = rect[0];
-			nval_a = rect[skipx];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[skipx + 1];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[skipx + 2];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[skipx + 3];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 2 * skipx;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + 4 * (x - 1);
-			newrectf = _newrectf + 4 * (x - 1);
-
-			val_af = rectf[0];
-			nval_af = rectf[skipx];
-			diff_af = nval_af - val_af;
+	data.ibuf = ibuf;
+	data.newlen = newy;
+	data.add = (ibuf->y - 1.001) / (newy - 1.0);
 
-			val_bf = rectf[1];
-			nval_bf = rectf[skipx + 1];
-			diff_bf = nval_bf - val_bf;
-
-			val_gf = rectf[2];
-			nval_gf = rectf[skipx + 2];
-			diff_gf = nval_gf - val_gf;
-
-			val_rf = rectf[3];
-			nval_rf = rectf[skipx + 3];
-			diff_rf = nval_rf - val_rf;
-
-			rectf += 2 * skipx;
-		}
-
-		for (y = newy; y > 0; y--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += skipx;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += skipx;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += skipx;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += skipx;
-			}
-			sample += add;
-		}
-	}
+	scale_lines_parallel(&data, ibuf->x, scaleupy_line_cb);
 
 	if (do_rect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = (unsigned int *) _newrect;
+		ibuf->rect = (unsigned int *) data.newrect;
 	}
 	if (do_float) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *) _newrectf;
+		ibuf->rect_float = data.newrectf;
 	}
 
 	ibuf->y = newy;
@@ -1579,19 +1522,53 @@ struct imbufRGBA {
 	float r, g, b, a;
 };
 
+typedef struct ScaleFastData {
+	ImBuf *ibuf;
+	unsigned int *newrect;
+	struct imbufRGBA *newrectf;
+	unsigned int newx;
+	size_t stepx, stepy;
+} ScaleFastData;
+
+static void scalefast_row_cb(void *__restrict userdata,
+                             const int y,
+                             const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	ScaleFastData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const size_t ofsy = 32768 + (size_t)y * data->stepy;
+	size_t ofsx;
+	int x;
+
+	if (data->newrect) {
+		unsigned int *rect = ibuf->rect + (ofsy >> 16) * ibuf->x;
+		unsigned int *newrect = data->newrect + (size_t)y * data->newx;
+		ofsx = 32768;
+
+		for (x = data->newx; x > 0; x--, ofsx += data->stepx) {
+			*newrect++ = rect[ofsx >> 16];
+		}
+	}
+
+	if (data->newrectf) {
+		struct imbufRGBA *rectf = (struct imbufRGBA *)ibuf->rect_float + (ofsy >> 16) * ibuf->x;
+		struct imbufRGBA *newrectf = data->newrectf + (size_t)y * data->newx;
+		ofsx = 32768;
+
+		for (x = data->newx; x > 0; x--, ofsx += data->stepx) {
+			*newrectf++ = rectf[ofsx >> 16];
+		}
+	}
+}
+
 /**
  * Return true if \a ibuf is modified.
  */
 bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-	unsigned int *rect, *_newrect, *newrect;
-	struct imbufRGBA *rectf, *_newrectf, *newrectf;
-	int x, y;
+	ScaleFastData data = {NULL};
+	ParallelRangeSettings settings;
 	bool do_float = false, do_rect = false;
-	size_t ofsx, ofsy, stepx, stepy;
-
-	rect = NULL; _newrect = NULL; newrect = NULL;
-	rectf = NULL; _newrectf = NULL; newrectf = NULL;
 
 	if (ibuf == NULL) return false;
 	if (ibuf->rect) do_rect = true;
@@ -1601,56 +1578,37 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
 	if (newx == ibuf->x && newy == ibuf->y) return false;
 
 	if (do_rect) {
-		_newrect = MEM_mallocN(newx * newy * sizeof(int), "scalefastimbuf");
-		if (_newrect == NULL) return false;
-		newrect = _newrect;
+		data.newrect = MEM_mallocN(newx * newy * sizeof(int), "scalefastimbuf");
+		if (data.newrect == NULL) return false;
 	}
 
 	if (do_float) {
-		_newrectf = MEM_mallocN(newx * newy * sizeof(float) * 4, "scalefastimbuf f");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
+		data.newrectf = MEM_mallocN(newx * newy * sizeof(float) * 4, "scalefastimbuf f");
+		if (data.newrectf == NULL) {
+			if (data.newrect) MEM_freeN(data.newrect);
 			return false;
 		}
-		newrectf = _newrectf;
 	}
 
-	stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
-	stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
-	ofsy = 32768;
+	data.ibuf = ibuf;
+	data.newx = newx;
+	data.stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
+	data.stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
 
-	for (y = newy; y > 0; y--, ofsy += stepy) {
-		if (do_rect) {
-			rect = ibuf->rect;
-			rect += (ofsy >> 16) * ibuf->x;
-			ofsx = 32768;
-
-			for (x = newx; x > 0; x--, ofsx += stepx) {
-				*newrect++ = rect[ofsx >> 16];
-			}
-		}
-
-		if (do_float) {
-			rectf = (struct imbufRGBA *)ibuf->rect_float;
-			rectf += (ofsy >> 16) * ibuf->x;
-			ofsx = 32768;
-
-			for (x = newx; x > 0; x--, ofsx += stepx) {
-				*newrectf++ = rectf[ofsx >> 16];
-			}
-		}
-	}
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = scale_use_threading((size_t)newx * newy);
+	BLI_task_parallel_range(0, newy, &data, scalefast_row_cb, &settings);
 
 	if (do_rect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
-		ibuf->rect = _newrect;
+		ibuf->rect = data.newrect;
 	}
 
 	if (do_float) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
-		ibuf->rect_float = (float *)_newrectf;
+		ibuf->rect_float = (float *)data.newrectf;
 	}
 
 	scalefast_Z_ImBuf(ibuf, newx, newy);
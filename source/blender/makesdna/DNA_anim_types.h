@@ -506,6 +506,10 @@ typedef struct FCurve {
 	float color[3];			/* the last-color this curve took */
 
 	float prev_norm_factor, prev_offset;
+
+		/* runtime */
+	int eval_segment;		/* keyframe index found by the last evaluation, a hint to start the next one from (not threadsafe, only validated) */
+	int pad2;
 } FCurve;
 
 
@@ -880,6 +884,7 @@ typedef struct AnimData {
 	ListBase    overrides;  /* temp storage (AnimOverride) of values for settings that are animated (but the value hasn't been keyframed) */
 
 	FCurve **driver_array;  /* runtime data, for depsgraph evaluation */
+	struct AnimBindingCache *binding_cache;  /* runtime data, pre-resolved RNA of the active action F-Curves */
 
 		/* settings for animation evaluation */
 	int flag;               /* user-defined settings */
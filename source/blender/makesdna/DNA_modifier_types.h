@@ -115,6 +115,11 @@ typedef struct ModifierData {
 	char name[64];  /* MAX_NAME */
 
 	char *error;
+
+	/* Runtime field which contains runtime data which is specific to a
+	 * modifier type. Is not written to file, and is owned by the modifier.
+	 */
+	void *runtime;
 } ModifierData;
 
 typedef enum {
@@ -357,7 +357,7 @@ typedef struct bNodeTree {
 	int update;						/* update flags */
 	short is_updating;				/* flag to prevent reentrant update calls */
 	short done;						/* generic temporary flag for recursion check (DFS/BFS) */
-	int pad2;
+	int cache_size;					/* compositor result cache memory limit in MB, 0 disables caching */
 
 	int nodetype DNA_DEPRECATED;	/* specific node type this tree is used for */
 
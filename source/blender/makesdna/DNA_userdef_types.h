@@ -619,7 +619,7 @@ typedef struct UserDef {
 	int view_frame_keyframes; /* number of keyframes to zoom around current frame */
 	float view_frame_seconds; /* seconds to zoom around current frame */
 
-	char _pad1[4];
+	int seqdiskcachelimit;    /* megabytes of sequencer cache on disk, 0 disables it */
 
 	short widget_unit;		/* private, defaults to 20 for 72 DPI setting */
 	short anisotropic_filter;
@@ -910,6 +910,34 @@ static void rna_SequenceEditor_overlay_lock_set(PointerRNA *ptr, bool value)
 	}
 }
 
+static int rna_SequenceEditor_cache_hits_memory_get(PointerRNA *UNUSED(ptr))
+{
+	SeqCacheStats stats;
+	BKE_sequencer_cache_stats_get(&stats);
+	return stats.hits_memory;
+}
+
+static int rna_SequenceEditor_cache_hits_disk_get(PointerRNA *UNUSED(ptr))
+{
+	SeqCacheStats stats;
+	BKE_sequencer_cache_stats_get(&stats);
+	return stats.hits_disk;
+}
+
+static int rna_SequenceEditor_cache_misses_get(PointerRNA *UNUSED(ptr))
+{
+	SeqCacheStats stats;
+	BKE_sequencer_cache_stats_get(&stats);
+	return stats.misses;
+}
+
+static int rna_SequenceEditor_cache_disk_size_get(PointerRNA *UNUSED(ptr))
+{
+	SeqCacheStats stats;
+	BKE_sequencer_cache_stats_get(&stats);
+	return (int)(stats.disk_size / (1024 * 1024));
+}
+
 static int rna_SequenceEditor_overlay_frame_get(PointerRNA *ptr)
 {
 	Scene *scene = (Scene *)ptr->id.data;
@@ -1711,6 +1739,27 @@ static void rna_def_editor(BlenderRNA *brna)
 	                           "rna_SequenceEditor_overlay_frame_set", NULL);
 	RNA_def_property_update(prop, NC_SPACE | ND_SPACE_SEQUENCER, NULL);
 
+	/* cache statistics, shared by all scenes */
+	prop = RNA_def_property(srna, "cache_hits_memory", PROP_INT, PROP_NONE);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+	RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_hits_memory_get", NULL, NULL);
+	RNA_def_property_ui_text(prop, "Memory Cache Hits", "Number of images found in the sequencer memory cache");
+
+	prop = RNA_def_property(srna, "cache_hits_disk", PROP_INT, PROP_NONE);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+	RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_hits_disk_get", NULL, NULL);
+	RNA_def_property_ui_text(prop, "Disk Cache Hits", "Number of images read back from the sequencer disk cache");
+
+	prop = RNA_def_property(srna, "cache_misses", PROP_INT, PROP_NONE);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+	RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_misses_get", NULL, NULL);
+	RNA_def_property_ui_text(prop, "Cache Misses", "Number of images which had to be rendered");
+
+	prop = RNA_def_property(srna, "cache_disk_size", PROP_INT, PROP_NONE);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+	RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_disk_size_get", NULL, NULL);
+	RNA_def_property_ui_text(prop, "Disk Cache Size", "Size of the sequencer disk cache (in megabytes)");
+
 	prop = RNA_def_property(srna, "proxy_storage", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_items(prop, editing_storage_items);
 	RNA_def_property_ui_text(prop, "Proxy Storage", "How to store proxies for this project");
@@ -106,45 +106,69 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
 	}
 }
 
-static void sphere_do(
-        CastModifierData *cmd, const ModifierEvalContext *ctx,
-        Object *ob, Mesh *mesh,
-        float (*vertexCos)[3], int numVerts)
-{
-	MDeformVert *dvert = NULL;
-
-	Object *ctrl_ob = NULL;
-
-	int i, defgrp_index;
-	bool has_radius = false;
-	short flag, type;
-	float len = 0.0f;
-	float fac = cmd->fac;
-	float facm = 1.0f - fac;
-	const float fac_orig = fac;
-	float vec[3], center[3] = {0.0f, 0.0f, 0.0f};
+typedef struct CastKernelData {
+	short flag;
+	bool use_ctrl_ob;
+	bool has_radius;
+	float radius;
+	float fac;
+	/* sphere and cylinder */
+	bool is_cylinder;
+	float len;
+	/* cuboid */
+	float bb[8][3];
+	float center[3];
 	float mat[4][4], imat[4][4];
+} CastKernelData;
 
-	flag = cmd->flag;
-	type = cmd->type; /* projection type: sphere or cylinder */
+/* into the space of the control object */
+BLI_INLINE void cast_co_to_ctrl(const CastKernelData *data, float co[3])
+{
+	if (data->use_ctrl_ob) {
+		if (data->flag & MOD_CAST_USE_OB_TRANSFORM) {
+			mul_m4_v3(data->mat, co);
+		}
+		else {
+			sub_v3_v3(co, data->center);
+		}
+	}
+}
+
+BLI_INLINE void cast_co_from_ctrl(const CastKernelData *data, float co[3])
+{
+	if (data->use_ctrl_ob) {
+		if (data->flag & MOD_CAST_USE_OB_TRANSFORM) {
+			mul_m4_v3(data->imat, co);
+		}
+		else {
+			add_v3_v3(co, data->center);
+		}
+	}
+}
 
-	if (type == MOD_CAST_TYPE_CYLINDER)
-		flag &= ~MOD_CAST_Z;
+static void cast_kernel_data_init(
+        CastModifierData *cmd, const ModifierEvalContext *ctx, Object *ob, CastKernelData *data)
+{
+	Object *ctrl_ob = DEG_get_evaluated_object(ctx->depsgraph, cmd->object);
 
-	ctrl_ob = DEG_get_evaluated_object(ctx->depsgraph, cmd->object);
+	memset(data, 0, sizeof(*data));
+	data->flag = cmd->flag;
+	data->fac = cmd->fac;
+	data->radius = cmd->radius;
+	data->use_ctrl_ob = (ctrl_ob != NULL);
 
-	/* spherify's center is {0, 0, 0} (the ob's own center in its local
+	/* cast's center is {0, 0, 0} (the ob's own center in its local
 	 * space), by default, but if the user defined a control object,
 	 * we use its location, transformed to ob's local space */
 	if (ctrl_ob) {
-		if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-			invert_m4_m4(imat, ctrl_ob->obmat);
-			mul_m4_m4m4(mat, imat, ob->obmat);
-			invert_m4_m4(imat, mat);
+		if (data->flag & MOD_CAST_USE_OB_TRANSFORM) {
+			invert_m4_m4(data->imat, ctrl_ob->obmat);
+			mul_m4_m4m4(data->mat, data->imat, ob->obmat);
+			invert_m4_m4(data->imat, data->mat);
 		}
 
 		invert_m4_m4(ob->imat, ob->obmat);
-		mul_v3_m4v3(center, ob->imat, ctrl_ob->obmat[3]);
+		mul_v3_m4v3(data->center, ob->imat, ctrl_ob->obmat[3]);
 	}
 
 	/* now we check which options the user wants */
@@ -152,58 +176,37 @@ static void sphere_do(
 	/* 1) (flag was checked in the "if (ctrl_ob)" block above) */
 	/* 2) cmd->radius > 0.0f: only the vertices within this radius from
 	 * the center of the effect should be deformed */
-	if (cmd->radius > FLT_EPSILON) has_radius = 1;
+	if (cmd->radius > FLT_EPSILON) data->has_radius = true;
+}
 
-	/* 3) if we were given a vertex group name,
-	 * only those vertices should be affected */
-	MOD_get_vgroup(ob, mesh, cmd->defgrp_name, &dvert, &defgrp_index);
+static void cast_sphere_kernel(void *__restrict userdata, ModDeformBlock *__restrict block)
+{
+	const CastKernelData *data = userdata;
+	const short flag = data->flag;
+	const float len = data->len;
+	int i;
 
-	if (flag & MOD_CAST_SIZE_FROM_RADIUS) {
-		len = cmd->radius;
-	}
-	else {
-		len = cmd->size;
-	}
+	for (i = 0; i < block->len; i++) {
+		const float fac = data->fac * block->weight[i];
+		const float facm = 1.0f - fac;
+		float vec[3], tmp_co[3];
 
-	if (len <= 0) {
-		for (i = 0; i < numVerts; i++) {
-			len += len_v3v3(center, vertexCos[i]);
+		if (block->weight[i] == 0.0f) {
+			continue;
 		}
-		len /= numVerts;
-
-		if (len == 0.0f) len = 10.0f;
-	}
-
-	for (i = 0; i < numVerts; i++) {
-		float tmp_co[3];
 
-		copy_v3_v3(tmp_co, vertexCos[i]);
-		if (ctrl_ob) {
-			if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-				mul_m4_v3(mat, tmp_co);
-			}
-			else {
-				sub_v3_v3(tmp_co, center);
-			}
-		}
+		tmp_co[0] = block->co[0][i];
+		tmp_co[1] = block->co[1][i];
+		tmp_co[2] = block->co[2][i];
+		cast_co_to_ctrl(data, tmp_co);
 
 		copy_v3_v3(vec, tmp_co);
 
-		if (type == MOD_CAST_TYPE_CYLINDER)
+		if (data->is_cylinder)
 			vec[2] = 0.0f;
 
-		if (has_radius) {
-			if (len_v3(vec) > cmd->radius) continue;
-		}
-
-		if (dvert) {
-			const float weight = defvert_find_weight(&dvert[i], defgrp_index);
-			if (weight == 0.0f) {
-				continue;
-			}
-
-			fac = fac_orig * weight;
-			facm = 1.0f - fac;
+		if (data->has_radius) {
+			if (len_v3(vec) > data->radius) continue;
 		}
 
 		normalize_v3(vec);
@@ -215,151 +218,88 @@ static void sphere_do(
 		if (flag & MOD_CAST_Z)
 			tmp_co[2] = fac * vec[2] * len + facm * tmp_co[2];
 
-		if (ctrl_ob) {
-			if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-				mul_m4_v3(imat, tmp_co);
-			}
-			else {
-				add_v3_v3(tmp_co, center);
-			}
-		}
+		cast_co_from_ctrl(data, tmp_co);
 
-		copy_v3_v3(vertexCos[i], tmp_co);
+		block->co[0][i] = tmp_co[0];
+		block->co[1][i] = tmp_co[1];
+		block->co[2][i] = tmp_co[2];
 	}
 }
 
-static void cuboid_do(
+static void sphere_do(
         CastModifierData *cmd, const ModifierEvalContext *ctx,
         Object *ob, Mesh *mesh,
         float (*vertexCos)[3], int numVerts)
 {
 	MDeformVert *dvert = NULL;
-	Object *ctrl_ob = NULL;
-
+	CastKernelData data;
 	int i, defgrp_index;
-	bool has_radius = false;
-	short flag;
-	float fac = cmd->fac;
-	float facm = 1.0f - fac;
-	const float fac_orig = fac;
-	float min[3], max[3], bb[8][3];
-	float center[3] = {0.0f, 0.0f, 0.0f};
-	float mat[4][4], imat[4][4];
-
-	flag = cmd->flag;
+	float len = 0.0f;
 
-	ctrl_ob = DEG_get_evaluated_object(ctx->depsgraph, cmd->object);
+	cast_kernel_data_init(cmd, ctx, ob, &data);
 
-	/* now we check which options the user wants */
-
-	/* 1) (flag was checked in the "if (ctrl_ob)" block above) */
-	/* 2) cmd->radius > 0.0f: only the vertices within this radius from
-	 * the center of the effect should be deformed */
-	if (cmd->radius > FLT_EPSILON) has_radius = 1;
+	/* projection type: sphere or cylinder */
+	if (cmd->type == MOD_CAST_TYPE_CYLINDER) {
+		data.is_cylinder = true;
+		data.flag &= ~MOD_CAST_Z;
+	}
 
 	/* 3) if we were given a vertex group name,
 	 * only those vertices should be affected */
 	MOD_get_vgroup(ob, mesh, cmd->defgrp_name, &dvert, &defgrp_index);
 
-	if (ctrl_ob) {
-		if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-			invert_m4_m4(imat, ctrl_ob->obmat);
-			mul_m4_m4m4(mat, imat, ob->obmat);
-			invert_m4_m4(imat, mat);
-		}
-
-		invert_m4_m4(ob->imat, ob->obmat);
-		mul_v3_m4v3(center, ob->imat, ctrl_ob->obmat[3]);
-	}
-
-	if ((flag & MOD_CAST_SIZE_FROM_RADIUS) && has_radius) {
-		for (i = 0; i < 3; i++) {
-			min[i] = -cmd->radius;
-			max[i] = cmd->radius;
-		}
-	}
-	else if (!(flag & MOD_CAST_SIZE_FROM_RADIUS) && cmd->size > 0) {
-		for (i = 0; i < 3; i++) {
-			min[i] = -cmd->size;
-			max[i] = cmd->size;
-		}
+	if (data.flag & MOD_CAST_SIZE_FROM_RADIUS) {
+		len = cmd->radius;
 	}
 	else {
-		/* get bound box */
-		/* We can't use the object's bound box because other modifiers
-		 * may have changed the vertex data. */
-		INIT_MINMAX(min, max);
-
-		/* Cast's center is the ob's own center in its local space,
-		 * by default, but if the user defined a control object, we use
-		 * its location, transformed to ob's local space. */
-		if (ctrl_ob) {
-			float vec[3];
-
-			/* let the center of the ctrl_ob be part of the bound box: */
-			minmax_v3v3_v3(min, max, center);
+		len = cmd->size;
+	}
 
-			for (i = 0; i < numVerts; i++) {
-				sub_v3_v3v3(vec, vertexCos[i], center);
-				minmax_v3v3_v3(min, max, vec);
-			}
-		}
-		else {
-			for (i = 0; i < numVerts; i++) {
-				minmax_v3v3_v3(min, max, vertexCos[i]);
-			}
+	if (len <= 0) {
+		for (i = 0; i < numVerts; i++) {
+			len += len_v3v3(data.center, vertexCos[i]);
 		}
+		len /= numVerts;
 
-		/* we want a symmetric bound box around the origin */
-		if (fabsf(min[0]) > fabsf(max[0])) max[0] = fabsf(min[0]);
-		if (fabsf(min[1]) > fabsf(max[1])) max[1] = fabsf(min[1]);
-		if (fabsf(min[2]) > fabsf(max[2])) max[2] = fabsf(min[2]);
-		min[0] = -max[0];
-		min[1] = -max[1];
-		min[2] = -max[2];
+		if (len == 0.0f) len = 10.0f;
 	}
+	data.len = len;
 
-	/* building our custom bounding box */
-	bb[0][0] = bb[2][0] = bb[4][0] = bb[6][0] = min[0];
-	bb[1][0] = bb[3][0] = bb[5][0] = bb[7][0] = max[0];
-	bb[0][1] = bb[1][1] = bb[4][1] = bb[5][1] = min[1];
-	bb[2][1] = bb[3][1] = bb[6][1] = bb[7][1] = max[1];
-	bb[0][2] = bb[1][2] = bb[2][2] = bb[3][2] = min[2];
-	bb[4][2] = bb[5][2] = bb[6][2] = bb[7][2] = max[2];
+	/* without deform verts all vertices are affected, even when the group exists */
+	MOD_deform_verts_parallel(
+	        vertexCos, numVerts, dvert, dvert ? defgrp_index : -1, false,
+	        &data, cast_sphere_kernel);
+}
 
-	/* ready to apply the effect, one vertex at a time */
-	for (i = 0; i < numVerts; i++) {
+static void cast_cuboid_kernel(void *__restrict userdata, ModDeformBlock *__restrict block)
+{
+	const CastKernelData *data = userdata;
+	const short flag = data->flag;
+	int i;
+
+	for (i = 0; i < block->len; i++) {
+		const float fac = data->fac * block->weight[i];
+		const float facm = 1.0f - fac;
 		int octant, coord;
 		float d[3], dmax, apex[3], fbb;
 		float tmp_co[3];
 
-		copy_v3_v3(tmp_co, vertexCos[i]);
-		if (ctrl_ob) {
-			if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-				mul_m4_v3(mat, tmp_co);
-			}
-			else {
-				sub_v3_v3(tmp_co, center);
-			}
+		if (block->weight[i] == 0.0f) {
+			continue;
 		}
 
-		if (has_radius) {
-			if (fabsf(tmp_co[0]) > cmd->radius ||
-			    fabsf(tmp_co[1]) > cmd->radius ||
-			    fabsf(tmp_co[2]) > cmd->radius)
-			{
-				continue;
-			}
-		}
+		tmp_co[0] = block->co[0][i];
+		tmp_co[1] = block->co[1][i];
+		tmp_co[2] = block->co[2][i];
+		cast_co_to_ctrl(data, tmp_co);
 
-		if (dvert) {
-			const float weight = defvert_find_weight(&dvert[i], defgrp_index);
-			if (weight == 0.0f) {
+		if (data->has_radius) {
+			if (fabsf(tmp_co[0]) > data->radius ||
+			    fabsf(tmp_co[1]) > data->radius ||
+			    fabsf(tmp_co[2]) > data->radius)
+			{
 				continue;
 			}
-
-			fac = fac_orig * weight;
-			facm = 1.0f - fac;
 		}
 
 		/* The algo used to project the vertices to their
@@ -377,7 +317,7 @@ static void cuboid_do(
 		if (tmp_co[2] > 0.0f) octant += 4;
 
 		/* apex is the bb's vertex at the chosen octant */
-		copy_v3_v3(apex, bb[octant]);
+		copy_v3_v3(apex, data->bb[octant]);
 
 		/* find which bb plane is closest to this vertex ... */
 		d[0] = tmp_co[0] / apex[0];
@@ -413,17 +353,92 @@ static void cuboid_do(
 		if (flag & MOD_CAST_Z)
 			tmp_co[2] = facm * tmp_co[2] + fac * tmp_co[2] * fbb;
 
-		if (ctrl_ob) {
-			if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-				mul_m4_v3(imat, tmp_co);
+		cast_co_from_ctrl(data, tmp_co);
+
+		block->co[0][i] = tmp_co[0];
+		block->co[1][i] = tmp_co[1];
+		block->co[2][i] = tmp_co[2];
+	}
+}
+
+static void cuboid_do(
+        CastModifierData *cmd, const ModifierEvalContext *ctx,
+        Object *ob, Mesh *mesh,
+        float (*vertexCos)[3], int numVerts)
+{
+	MDeformVert *dvert = NULL;
+	CastKernelData data;
+	int i, defgrp_index;
+	float min[3], max[3];
+	float (*bb)[3] = data.bb;
+	const short flag = cmd->flag;
+
+	cast_kernel_data_init(cmd, ctx, ob, &data);
+
+	/* 3) if we were given a vertex group name,
+	 * only those vertices should be affected */
+	MOD_get_vgroup(ob, mesh, cmd->defgrp_name, &dvert, &defgrp_index);
+
+	if ((flag & MOD_CAST_SIZE_FROM_RADIUS) && data.has_radius) {
+		for (i = 0; i < 3; i++) {
+			min[i] = -cmd->radius;
+			max[i] = cmd->radius;
+		}
+	}
+	else if (!(flag & MOD_CAST_SIZE_FROM_RADIUS) && cmd->size > 0) {
+		for (i = 0; i < 3; i++) {
+			min[i] = -cmd->size;
+			max[i] = cmd->size;
+		}
+	}
+	else {
+		/* get bound box */
+		/* We can't use the object's bound box because other modifiers
+		 * may have changed the vertex data. */
+		INIT_MINMAX(min, max);
+
+		/* Cast's center is the ob's own center in its local space,
+		 * by default, but if the user defined a control object, we use
+		 * its location, transformed to ob's local space. */
+		if (data.use_ctrl_ob) {
+			float vec[3];
+
+			/* let the center of the ctrl_ob be part of the bound box: */
+			minmax_v3v3_v3(min, max, data.center);
+
+			for (i = 0; i < numVerts; i++) {
+				sub_v3_v3v3(vec, vertexCos[i], data.center);
+				minmax_v3v3_v3(min, max, vec);
 			}
-			else {
-				add_v3_v3(tmp_co, center);
+		}
+		else {
+			for (i = 0; i < numVerts; i++) {
+				minmax_v3v3_v3(min, max, vertexCos[i]);
 			}
 		}
 
-		copy_v3_v3(vertexCos[i], tmp_co);
+		/* we want a symmetric bound box around the origin */
+		if (fabsf(min[0]) > fabsf(max[0])) max[0] = fabsf(min[0]);
+		if (fabsf(min[1]) > fabsf(max[1])) max[1] = fabsf(min[1]);
+		if (fabsf(min[2]) > fabsf(max[2])) max[2] = fabsf(min[2]);
+		min[0] = -max[0];
+		min[1] = -max[1];
+		min[2] = -max[2];
 	}
+
+	/* building our custom bounding box */
+	bb[0][0] = bb[2][0] = bb[4][0] = bb[6][0] = min[0];
+	bb[1][0] = bb[3][0] = bb[5][0] = bb[7][0] = max[0];
+	bb[0][1] = bb[1][1] = bb[4][1] = bb[5][1] = min[1];
+	bb[2][1] = bb[3][1] = bb[6][1] = bb[7][1] = max[1];
+	bb[0][2] = bb[1][2] = bb[2][2] = bb[3][2] = min[2];
+	bb[4][2] = bb[5][2] = bb[6][2] = bb[7][2] = max[2];
+
+	/* ready to apply the effect, without deform verts all vertices are affected,
+	 * even when the group exists */
+	MOD_deform_verts_parallel(
+	        vertexCos, numVerts, dvert, dvert ? defgrp_index : -1, false,
+	        &data, cast_cuboid_kernel);
 }
 
 static void deformVerts(
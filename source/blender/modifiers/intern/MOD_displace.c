@@ -39,7 +39,6 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
-#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_editmesh.h"
@@ -166,115 +165,109 @@ typedef struct DisplaceUserdata {
 	/*const*/ DisplaceModifierData *dmd;
 	struct Scene *scene;
 	struct ImagePool *pool;
-	MDeformVert *dvert;
-	float weight;
-	int defgrp_index;
 	int direction;
 	bool use_global_direction;
 	Tex *tex_target;
 	float (*tex_co)[3];
-	float (*vertexCos)[3];
 	float local_mat[4][4];
 	MVert *mvert;
 	float (*vert_clnors)[3];
 } DisplaceUserdata;
 
-static void displaceModifier_do_task(
-        void *__restrict userdata,
-        const int iter,
-        const ParallelRangeTLS *__restrict UNUSED(tls))
+static void displaceModifier_do_kernel(void *__restrict userdata, ModDeformBlock *__restrict block)
 {
 	DisplaceUserdata *data = (DisplaceUserdata *)userdata;
 	DisplaceModifierData *dmd = data->dmd;
-	MDeformVert *dvert = data->dvert;
-	float weight = data->weight;
-	int defgrp_index = data->defgrp_index;
 	int direction = data->direction;
 	bool use_global_direction = data->use_global_direction;
 	float (*tex_co)[3] = data->tex_co;
-	float (*vertexCos)[3] = data->vertexCos;
 	MVert *mvert = data->mvert;
 	float (*vert_clnors)[3] = data->vert_clnors;
+	float *co_x = block->co[0], *co_y = block->co[1], *co_z = block->co[2];
+	int i;
 
 	const float delta_fixed = 1.0f - dmd->midlevel;  /* when no texture is used, we fallback to white */
 
-	TexResult texres;
-	float strength = dmd->strength;
-	float delta;
-	float local_vec[3];
+	for (i = 0; i < block->len; i++) {
+		const int index = block->index_start + i;
+		const float weight = block->weight[i];
+		TexResult texres;
+		float strength = dmd->strength;
+		float delta;
+		float local_vec[3];
 
-	if (dvert) {
-		weight = defvert_find_weight(dvert + iter, defgrp_index);
 		if (weight == 0.0f) {
-			return;
+			continue;
 		}
-	}
 
-	if (data->tex_target) {
-		texres.nor = NULL;
-		BKE_texture_get_value_ex(data->scene, data->tex_target, tex_co[iter], &texres, data->pool, false);
-		delta = texres.tin - dmd->midlevel;
-	}
-	else {
-		delta = delta_fixed;  /* (1.0f - dmd->midlevel) */  /* never changes */
-	}
+		if (data->tex_target) {
+			texres.nor = NULL;
+			BKE_texture_get_value_ex(data->scene, data->tex_target, tex_co[index], &texres, data->pool, false);
+			delta = texres.tin - dmd->midlevel;
+		}
+		else {
+			delta = delta_fixed;  /* (1.0f - dmd->midlevel) */  /* never changes */
+		}
 
-	if (dvert) {
 		strength *= weight;
-	}
 
-	delta *= strength;
-	CLAMP(delta, -10000, 10000);
-
-	switch (direction) {
-		case MOD_DISP_DIR_X:
-			if (use_global_direction) {
-				vertexCos[iter][0] += delta * data->local_mat[0][0];
-				vertexCos[iter][1] += delta * data->local_mat[1][0];
-				vertexCos[iter][2] += delta * data->local_mat[2][0];
-			}
-			else {
-				vertexCos[iter][0] += delta;
-			}
-			break;
-		case MOD_DISP_DIR_Y:
-			if (use_global_direction) {
-				vertexCos[iter][0] += delta * data->local_mat[0][1];
-				vertexCos[iter][1] += delta * data->local_mat[1][1];
-				vertexCos[iter][2] += delta * data->local_mat[2][1];
-			}
-			else {
-				vertexCos[iter][1] += delta;
-			}
-			break;
-		case MOD_DISP_DIR_Z:
-			if (use_global_direction) {
-				vertexCos[iter][0] += delta * data->local_mat[0][2];
-				vertexCos[iter][1] += delta * data->local_mat[1][2];
-				vertexCos[iter][2] += delta * data->local_mat[2][2];
-			}
-			else {
-				vertexCos[iter][2] += delta;
-			}
-			break;
-		case MOD_DISP_DIR_RGB_XYZ:
-			local_vec[0] = texres.tr - dmd->midlevel;
-			local_vec[1] = texres.tg - dmd->midlevel;
-			local_vec[2] = texres.tb - dmd->midlevel;
-			if (use_global_direction) {
-				mul_transposed_mat3_m4_v3(data->local_mat, local_vec);
-			}
-			mul_v3_fl(local_vec, strength);
-			add_v3_v3(vertexCos[iter], local_vec);
-			break;
-		case MOD_DISP_DIR_NOR:
-			vertexCos[iter][0] += delta * (mvert[iter].no[0] / 32767.0f);
-			vertexCos[iter][1] += delta * (mvert[iter].no[1] / 32767.0f);
-			vertexCos[iter][2] += delta * (mvert[iter].no[2] / 32767.0f);
-			break;
-		case MOD_DISP_DIR_CLNOR:
-			madd_v3_v3fl(vertexCos[iter], vert_clnors[iter], delta);
-			break;
+		delta *= strength;
+		CLAMP(delta, -10000, 10000);
+
+		switch (direction) {
+			case MOD_DISP_DIR_X:
+				if (use_global_direction) {
+					co_x[i] += delta * data->local_mat[0][0];
+					co_y[i] += delta * data->local_mat[1][0];
+					co_z[i] += delta * data->local_mat[2][0];
+				}
+				else {
+					co_x[i] += delta;
+				}
+				break;
+			case MOD_DISP_DIR_Y:
+				if (use_global_direction) {
+					co_x[i] += delta * data->local_mat[0][1];
+					co_y[i] += delta * data->local_mat[1][1];
+					co_z[i] += delta * data->local_mat[2][1];
+				}
+				else {
+					co_y[i] += delta;
+				}
+				break;
+			case MOD_DISP_DIR_Z:
+				if (use_global_direction) {
+					co_x[i] += delta * data->local_mat[0][2];
+					co_y[i] += delta * data->local_mat[1][2];
+					co_z[i] += delta * data->local_mat[2][2];
+				}
+				else {
+					co_z[i] += delta;
+				}
+				break;
+			case MOD_DISP_DIR_RGB_XYZ:
+				local_vec[0] = texres.tr - dmd->midlevel;
+				local_vec[1] = texres.tg - dmd->midlevel;
+				local_vec[2] = texres.tb - dmd->midlevel;
+				if (use_global_direction) {
+					mul_transposed_mat3_m4_v3(data->local_mat, local_vec);
+				}
+				mul_v3_fl(local_vec, strength);
+				co_x[i] += local_vec[0];
+				co_y[i] += local_vec[1];
+				co_z[i] += local_vec[2];
+				break;
+			case MOD_DISP_DIR_NOR:
+				co_x[i] += delta * (mvert[index].no[0] / 32767.0f);
+				co_y[i] += delta * (mvert[index].no[1] / 32767.0f);
+				co_z[i] += delta * (mvert[index].no[2] / 32767.0f);
+				break;
+			case MOD_DISP_DIR_CLNOR:
+				co_x[i] += vert_clnors[index][0] * delta;
+				co_y[i] += vert_clnors[index][1] * delta;
+				co_z[i] += vert_clnors[index][2] * delta;
+				break;
+		}
 	}
 }
 
@@ -288,7 +281,6 @@ static void displaceModifier_do(
 	int direction = dmd->direction;
 	int defgrp_index;
 	float (*tex_co)[3];
-	float weight = 1.0f; /* init value unused but some compilers may complain */
 	float (*vert_clnors)[3] = NULL;
 	float local_mat[4][4] = {{0}};
 	const bool use_global_direction = dmd->space == MOD_DISP_SPACE_GLOBAL;
@@ -339,14 +331,10 @@ static void displaceModifier_do(
 	DisplaceUserdata data = {NULL};
 	data.scene = DEG_get_evaluated_scene(ctx->depsgraph);
 	data.dmd = dmd;
-	data.dvert = dvert;
-	data.weight = weight;
-	data.defgrp_index = defgrp_index;
 	data.direction = direction;
 	data.use_global_direction = use_global_direction;
 	data.tex_target = tex_target;
 	data.tex_co = tex_co;
-	data.vertexCos = vertexCos;
 	copy_m4_m4(data.local_mat, local_mat);
 	data.mvert = mvert;
 	data.vert_clnors = vert_clnors;
@@ -354,13 +342,10 @@ static void displaceModifier_do(
 		data.pool = BKE_image_pool_new();
 		BKE_texture_fetch_images_for_pool(tex_target, data.pool);
 	}
-	ParallelRangeSettings settings;
-	BLI_parallel_range_settings_defaults(&settings);
-	settings.use_threading = (numVerts > 512);
-	BLI_task_parallel_range(0, numVerts,
-	                        &data,
-	                        displaceModifier_do_task,
-	                        &settings);
+	/* without deform verts all vertices are displaced, even when the group exists */
+	MOD_deform_verts_parallel(
+	        vertexCos, numVerts, dvert, dvert ? defgrp_index : -1, false,
+	        &data, displaceModifier_do_kernel);
 
 	if (data.pool != NULL) {
 		BKE_image_pool_free(data.pool);
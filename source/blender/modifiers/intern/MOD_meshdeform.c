@@ -451,61 +451,94 @@ static void deformVertsEM(
 
 #define MESHDEFORM_MIN_INFLUENCE 0.00001f
 
-void modifier_mdef_compact_influences(ModifierData *md)
+typedef struct MeshdeformCompactData {
+	const float *weights;
+	int totcagevert;
+	int *bindoffsets;
+	MDefInfluence *bindinfluences;
+} MeshdeformCompactData;
+
+static void meshdeform_compact_count_task(
+        void *__restrict userdata,
+        const int b,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-	MeshDeformModifierData *mmd = (MeshDeformModifierData *)md;
-	float weight, *weights, totweight;
-	int totinfluence, totvert, totcagevert, a, b;
+	MeshdeformCompactData *data = userdata;
+	const float *weights = data->weights + b * data->totcagevert;
+	int totinfluence = 0;
 
-	weights = mmd->bindweights;
-	if (!weights)
-		return;
+	for (int a = 0; a < data->totcagevert; a++) {
+		if (weights[a] > MESHDEFORM_MIN_INFLUENCE)
+			totinfluence++;
+	}
 
-	totvert = mmd->totvert;
-	totcagevert = mmd->totcagevert;
+	/* Turned into offsets afterwards. */
+	data->bindoffsets[b + 1] = totinfluence;
+}
 
-	/* count number of influences above threshold */
-	for (b = 0; b < totvert; b++) {
-		for (a = 0; a < totcagevert; a++) {
-			weight = weights[a + b * totcagevert];
+static void meshdeform_compact_write_task(
+        void *__restrict userdata,
+        const int b,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	MeshdeformCompactData *data = userdata;
+	const float *weights = data->weights + b * data->totcagevert;
+	MDefInfluence *inf = data->bindinfluences + data->bindoffsets[b];
+	float totweight = 0.0f;
+	int a;
+
+	/* sum total weight */
+	for (a = 0; a < data->totcagevert; a++) {
+		if (weights[a] > MESHDEFORM_MIN_INFLUENCE)
+			totweight += weights[a];
+	}
 
-			if (weight > MESHDEFORM_MIN_INFLUENCE)
-				mmd->totinfluence++;
+	/* assign weights normalized */
+	for (a = 0; a < data->totcagevert; a++) {
+		if (weights[a] > MESHDEFORM_MIN_INFLUENCE) {
+			inf->weight = weights[a] / totweight;
+			inf->vertex = a;
+			inf++;
 		}
 	}
+}
 
-	/* allocate bind influences */
-	mmd->bindinfluences = MEM_calloc_arrayN(mmd->totinfluence, sizeof(MDefInfluence), "MDefBindInfluence");
-	mmd->bindoffsets = MEM_calloc_arrayN((totvert + 1), sizeof(int), "MDefBindOffset");
+/* Convert dense bind weights into per vertex influence lists,
+ * #MeshDeformModifierData.bindoffsets index into #MeshDeformModifierData.bindinfluences. */
+void modifier_mdef_compact_influences(ModifierData *md)
+{
+	MeshDeformModifierData *mmd = (MeshDeformModifierData *)md;
+	MeshdeformCompactData data;
+	int totvert, b;
 
-	/* write influences */
-	totinfluence = 0;
+	if (!mmd->bindweights)
+		return;
 
-	for (b = 0; b < totvert; b++) {
-		mmd->bindoffsets[b] = totinfluence;
-		totweight = 0.0f;
+	totvert = mmd->totvert;
 
-		/* sum total weight */
-		for (a = 0; a < totcagevert; a++) {
-			weight = weights[a + b * totcagevert];
+	data.weights = mmd->bindweights;
+	data.totcagevert = mmd->totcagevert;
+	data.bindoffsets = MEM_calloc_arrayN((totvert + 1), sizeof(int), "MDefBindOffset");
+	data.bindinfluences = NULL;
 
-			if (weight > MESHDEFORM_MIN_INFLUENCE)
-				totweight += weight;
-		}
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 16;
 
-		/* assign weights normalized */
-		for (a = 0; a < totcagevert; a++) {
-			weight = weights[a + b * totcagevert];
+	/* count number of influences above threshold */
+	BLI_task_parallel_range(0, totvert, &data, meshdeform_compact_count_task, &settings);
 
-			if (weight > MESHDEFORM_MIN_INFLUENCE) {
-				mmd->bindinfluences[totinfluence].weight = weight / totweight;
-				mmd->bindinfluences[totinfluence].vertex = a;
-				totinfluence++;
-			}
-		}
+	for (b = 0; b < totvert; b++) {
+		data.bindoffsets[b + 1] += data.bindoffsets[b];
 	}
+	mmd->totinfluence = data.bindoffsets[totvert];
+
+	/* allocate and write bind influences */
+	data.bindinfluences = MEM_calloc_arrayN(mmd->totinfluence, sizeof(MDefInfluence), "MDefBindInfluence");
+	BLI_task_parallel_range(0, totvert, &data, meshdeform_compact_write_task, &settings);
 
-	mmd->bindoffsets[b] = totinfluence;
+	mmd->bindoffsets = data.bindoffsets;
+	mmd->bindinfluences = data.bindinfluences;
 
 	/* free */
 	MEM_freeN(mmd->bindweights);
@@ -28,6 +28,7 @@
 
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_meshdata_types.h"
@@ -176,7 +177,8 @@ static Mesh *applyModifier(
 	                 rmd->threshold,
 	                 rmd->hermite_num,
 	                 rmd->scale,
-	                 rmd->depth);
+	                 rmd->depth,
+	                 BLI_system_thread_count());
 	result = output->mesh;
 	MEM_freeN(output);
 
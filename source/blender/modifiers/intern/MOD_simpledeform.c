@@ -186,13 +186,79 @@ static void simpleDeform_bend(const float factor, const int axis, const float dc
 }
 
 
+typedef struct SimpleDeformKernelData {
+	const SpaceTransform *transf;
+	void (*simpleDeform_callback)(const float factor, const int axis, const float dcut[3], float co[3]);
+	float smd_factor;
+	float smd_limit[2];
+	int deform_axis;
+	int lock_axis;
+	int limit_axis;
+	const uint *axis_map;
+} SimpleDeformKernelData;
+
+static void simpleDeform_kernel(void *__restrict userdata, ModDeformBlock *__restrict block)
+{
+	const SimpleDeformKernelData *data = userdata;
+	const float base_limit[2] = {0.0f, 0.0f};
+	const int lock_axis = data->lock_axis;
+	int i;
+
+	for (i = 0; i < block->len; i++) {
+		const float weight = block->weight[i];
+
+		if (weight != 0.0f) {
+			float co_orig[3], co[3], dcut[3] = {0.0f, 0.0f, 0.0f};
+
+			co_orig[0] = block->co[0][i];
+			co_orig[1] = block->co[1][i];
+			co_orig[2] = block->co[2][i];
+
+			if (data->transf) {
+				BLI_space_transform_apply(data->transf, co_orig);
+			}
+
+			copy_v3_v3(co, co_orig);
+
+			/* Apply axis limits, and axis mappings */
+			if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_X) {
+				axis_limit(0, base_limit, co, dcut);
+			}
+			if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Y) {
+				axis_limit(1, base_limit, co, dcut);
+			}
+			if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Z) {
+				axis_limit(2, base_limit, co, dcut);
+			}
+			axis_limit(data->limit_axis, data->smd_limit, co, dcut);
+
+			/* apply the deform to a mapped copy of the vertex, and then re-map it back. */
+			float co_remap[3];
+			float dcut_remap[3];
+			copy_v3_v3_map(co_remap, co, data->axis_map);
+			copy_v3_v3_map(dcut_remap, dcut, data->axis_map);
+			data->simpleDeform_callback(data->smd_factor, data->deform_axis, dcut_remap, co_remap);  /* apply deform */
+			copy_v3_v3_unmap(co, co_remap, data->axis_map);
+
+			interp_v3_v3v3(co, co_orig, co, weight);  /* Use vertex weight has coef of linear interpolation */
+
+			if (data->transf) {
+				BLI_space_transform_invert(data->transf, co);
+			}
+
+			block->co[0][i] = co[0];
+			block->co[1][i] = co[1];
+			block->co[2][i] = co[2];
+		}
+	}
+}
+
 /* simple deform modifier */
 static void SimpleDeformModifier_do(
         SimpleDeformModifierData *smd, const ModifierEvalContext *ctx,
         struct Object *ob, struct Mesh *mesh,
         float (*vertexCos)[3], int numVerts)
 {
-	const float base_limit[2] = {0.0f, 0.0f};
 	int i;
 	float smd_limit[2], smd_factor;
 	SpaceTransform *transf = NULL, tmp_transf;
@@ -291,51 +357,19 @@ static void SimpleDeformModifier_do(
 
 	MOD_get_vgroup(ob, mesh, smd->vgroup_name, &dvert, &vgroup);
 	const bool invert_vgroup = (smd->flag & MOD_SIMPLEDEFORM_FLAG_INVERT_VGROUP) != 0;
-	const uint *axis_map = axis_map_table[(smd->mode != MOD_SIMPLEDEFORM_MODE_BEND) ? deform_axis : 2];
-
-	for (i = 0; i < numVerts; i++) {
-		float weight = defvert_array_find_weight_safe(dvert, i, vgroup);
-
-		if (invert_vgroup) {
-			weight = 1.0f - weight;
-		}
-
-		if (weight != 0.0f) {
-			float co[3], dcut[3] = {0.0f, 0.0f, 0.0f};
-
-			if (transf) {
-				BLI_space_transform_apply(transf, vertexCos[i]);
-			}
 
-			copy_v3_v3(co, vertexCos[i]);
-
-			/* Apply axis limits, and axis mappings */
-			if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_X) {
-				axis_limit(0, base_limit, co, dcut);
-			}
-			if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Y) {
-				axis_limit(1, base_limit, co, dcut);
-			}
-			if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Z) {
-				axis_limit(2, base_limit, co, dcut);
-			}
-			axis_limit(limit_axis, smd_limit, co, dcut);
-
-			/* apply the deform to a mapped copy of the vertex, and then re-map it back. */
-			float co_remap[3];
-			float dcut_remap[3];
-			copy_v3_v3_map(co_remap, co, axis_map);
-			copy_v3_v3_map(dcut_remap, dcut, axis_map);
-			simpleDeform_callback(smd_factor, deform_axis, dcut_remap, co_remap);  /* apply deform */
-			copy_v3_v3_unmap(co, co_remap, axis_map);
-
-			interp_v3_v3v3(vertexCos[i], vertexCos[i], co, weight);  /* Use vertex weight has coef of linear interpolation */
-
-			if (transf) {
-				BLI_space_transform_invert(transf, vertexCos[i]);
-			}
-		}
-	}
+	SimpleDeformKernelData data = {
+		.transf = transf,
+		.simpleDeform_callback = simpleDeform_callback,
+		.smd_factor = smd_factor,
+		.smd_limit = {smd_limit[0], smd_limit[1]},
+		.deform_axis = deform_axis,
+		.lock_axis = lock_axis,
+		.limit_axis = limit_axis,
+		.axis_map = axis_map_table[(smd->mode != MOD_SIMPLEDEFORM_MODE_BEND) ? deform_axis : 2],
+	};
+
+	MOD_deform_verts_parallel(vertexCos, numVerts, dvert, vgroup, invert_vgroup, &data, simpleDeform_kernel);
 }
 
 
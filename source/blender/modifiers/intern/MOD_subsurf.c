@@ -77,6 +77,15 @@ static void copyData(const ModifierData *md, ModifierData *target, const int fla
 	tsmd->emCache = tsmd->mCache = NULL;
 }
 
+static void freeRuntimeData(SubsurfModifierData *smd)
+{
+	Subdiv *subdiv = (Subdiv *)smd->modifier.runtime;
+	if (subdiv != NULL) {
+		BKE_subdiv_free(subdiv);
+		smd->modifier.runtime = NULL;
+	}
+}
+
 static void freeData(ModifierData *md)
 {
 	SubsurfModifierData *smd = (SubsurfModifierData *) md;
@@ -89,6 +98,7 @@ static void freeData(ModifierData *md)
 		ccgSubSurf_free(smd->emCache);
 		smd->emCache = NULL;
 	}
+	freeRuntimeData(smd);
 }
 
 static bool isDisabled(const Scene *scene, ModifierData *md, bool useRenderParams)
@@ -176,6 +186,20 @@ static Mesh *subdiv_as_ccg(SubsurfModifierData *smd,
 	return result;
 }
 
+/* Cache subdivision descriptor in the modifier runtime, so topology refiner
+ * and evaluator are only re-created when topology or settings change. This
+ * way animated deformation only needs to refine the evaluator.
+ */
+static Subdiv *subdiv_descriptor_ensure(SubsurfModifierData *smd,
+                                        const SubdivSettings *subdiv_settings,
+                                        Mesh *mesh)
+{
+	Subdiv *subdiv = BKE_subdiv_update_from_mesh(
+	        (Subdiv *)smd->modifier.runtime, subdiv_settings, mesh);
+	smd->modifier.runtime = subdiv;
+	return subdiv;
+}
+
 /* Modifier itself. */
 
 static Mesh *applyModifier(ModifierData *md,
@@ -189,8 +213,7 @@ static Mesh *applyModifier(ModifierData *md,
 	if (subdiv_settings.level == 0) {
 		return result;
 	}
-	/* TODO(sergey): Try to re-use subdiv when possible. */
-	Subdiv *subdiv = BKE_subdiv_new_from_mesh(&subdiv_settings, mesh);
+	Subdiv *subdiv = subdiv_descriptor_ensure(smd, &subdiv_settings, mesh);
 	if (subdiv == NULL) {
 		/* Happens on bad topology, ut also on empty input mesh. */
 		return result;
@@ -204,9 +227,7 @@ static Mesh *applyModifier(ModifierData *md,
 	else {
 		result = subdiv_as_ccg(smd, ctx, mesh, subdiv);
 	}
-	/* TODO(sergey): Cache subdiv somehow. */
 	// BKE_subdiv_stats_print(&subdiv->stats);
-	BKE_subdiv_free(subdiv);
 	return result;
 }
 
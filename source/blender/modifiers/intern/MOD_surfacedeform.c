@@ -85,8 +85,29 @@ typedef struct SDefBindWeightData {
 	unsigned int numbinds;
 } SDefBindWeightData;
 
+/* Bind data flattened into contiguous arrays (CSR layout), built from the
+ * per-vertex #SDefVert data on first evaluation and kept in the modifier runtime. */
+typedef struct SDefBindCache {
+	/* Bind data the cache was built from. */
+	const SDefVert *verts;
+	unsigned int numverts;
+
+	/* Binds of vertex i are [bind_offsets[i], bind_offsets[i + 1]). */
+	unsigned int *bind_offsets;
+
+	/* Per bind, target vertices of bind j are [vert_offsets[j], vert_offsets[j + 1]). */
+	unsigned int *vert_offsets;
+	int *modes;
+	float *normal_dist;
+	float *influence;
+
+	/* Per bind target vertex. */
+	unsigned int *vert_inds;
+	float *vert_weights;
+} SDefBindCache;
+
 typedef struct SDefDeformData {
-	const SDefVert * const bind_verts;
+	const SDefBindCache * const cache;
 	float (* const targetCos)[3];
 	float (* const vertexCos)[3];
 } SDefDeformData;
@@ -117,10 +138,29 @@ static void initData(ModifierData *md)
 	smd->falloff = 4.0f;
 }
 
+static void freeBindCache(SurfaceDeformModifierData *smd)
+{
+	SDefBindCache *cache = smd->modifier.runtime;
+
+	if (cache != NULL) {
+		MEM_SAFE_FREE(cache->bind_offsets);
+		MEM_SAFE_FREE(cache->vert_offsets);
+		MEM_SAFE_FREE(cache->modes);
+		MEM_SAFE_FREE(cache->normal_dist);
+		MEM_SAFE_FREE(cache->influence);
+		MEM_SAFE_FREE(cache->vert_inds);
+		MEM_SAFE_FREE(cache->vert_weights);
+		MEM_freeN(cache);
+		smd->modifier.runtime = NULL;
+	}
+}
+
 static void freeData(ModifierData *md)
 {
 	SurfaceDeformModifierData *smd = (SurfaceDeformModifierData *)md;
 
+	freeBindCache(smd);
+
 	if (smd->verts) {
 		for (int i = 0; i < smd->numverts; i++) {
 			if (smd->verts[i].binds) {
@@ -1042,60 +1082,133 @@ static bool surfacedeformBind(
 	return data.success == 1;
 }
 
+static SDefBindCache *bindCacheEnsure(SurfaceDeformModifierData *smd)
+{
+	SDefBindCache *cache = smd->modifier.runtime;
+	unsigned int numbinds = 0, numbindverts = 0;
+
+	if (cache != NULL) {
+		if (cache->verts == smd->verts && cache->numverts == smd->numverts) {
+			return cache;
+		}
+		freeBindCache(smd);
+	}
+
+	for (unsigned int i = 0; i < smd->numverts; i++) {
+		const SDefBind *sdbind = smd->verts[i].binds;
+		for (unsigned int j = 0; j < smd->verts[i].numbinds; j++, sdbind++) {
+			numbindverts += sdbind->numverts;
+		}
+		numbinds += smd->verts[i].numbinds;
+	}
+
+	cache = MEM_callocN(sizeof(*cache), "SDefBindCache");
+	cache->verts = smd->verts;
+	cache->numverts = smd->numverts;
+	cache->bind_offsets = MEM_malloc_arrayN(smd->numverts + 1, sizeof(*cache->bind_offsets), "SDefBindOffsets");
+	cache->vert_offsets = MEM_malloc_arrayN(numbinds + 1, sizeof(*cache->vert_offsets), "SDefBindVertOffsets");
+	cache->modes = MEM_malloc_arrayN(numbinds, sizeof(*cache->modes), "SDefBindModes");
+	cache->normal_dist = MEM_malloc_arrayN(numbinds, sizeof(*cache->normal_dist), "SDefBindNormalDist");
+	cache->influence = MEM_malloc_arrayN(numbinds, sizeof(*cache->influence), "SDefBindInfluence");
+	cache->vert_inds = MEM_malloc_arrayN(numbindverts, sizeof(*cache->vert_inds), "SDefBindVertInds");
+	cache->vert_weights = MEM_malloc_arrayN(numbindverts, sizeof(*cache->vert_weights), "SDefBindVertWeights");
+
+	unsigned int bind_index = 0, vert_index = 0;
+	for (unsigned int i = 0; i < smd->numverts; i++) {
+		const SDefBind *sdbind = smd->verts[i].binds;
+
+		cache->bind_offsets[i] = bind_index;
+
+		for (unsigned int j = 0; j < smd->verts[i].numbinds; j++, sdbind++, bind_index++) {
+			cache->vert_offsets[bind_index] = vert_index;
+			cache->modes[bind_index] = sdbind->mode;
+			cache->normal_dist[bind_index] = sdbind->normal_dist;
+			cache->influence[bind_index] = sdbind->influence;
+
+			/* Centroid binds only store weights for two vertices and the centroid. */
+			memcpy(&cache->vert_inds[vert_index], sdbind->vert_inds, sizeof(*sdbind->vert_inds) * sdbind->numverts);
+			if (sdbind->mode == MOD_SDEF_MODE_NGON) {
+				memcpy(&cache->vert_weights[vert_index], sdbind->vert_weights, sizeof(float) * sdbind->numverts);
+			}
+			else {
+				memcpy(&cache->vert_weights[vert_index], sdbind->vert_weights, sizeof(float) * 3);
+			}
+			vert_index += sdbind->numverts;
+		}
+	}
+	cache->bind_offsets[smd->numverts] = bind_index;
+	cache->vert_offsets[bind_index] = vert_index;
+
+	smd->modifier.runtime = cache;
+	return cache;
+}
+
 static void deformVert(
         void *__restrict userdata,
         const int index,
         const ParallelRangeTLS *__restrict UNUSED(tls))
 {
 	const SDefDeformData * const data = (SDefDeformData *)userdata;
-	const SDefBind *sdbind = data->bind_verts[index].binds;
+	const SDefBindCache * const cache = data->cache;
+	const float (* const targetCos)[3] = (const float (*)[3])data->targetCos;
 	float * const vertexCos = data->vertexCos[index];
 	float norm[3], temp[3];
 
 	zero_v3(vertexCos);
 
-	for (int j = 0; j < data->bind_verts[index].numbinds; j++, sdbind++) {
-		/* Mode-generic operations (allocate poly coordinates) */
-		float (*coords)[3] = MEM_malloc_arrayN(sdbind->numverts, sizeof(*coords), "SDefDoPolyCoords");
+	for (unsigned int j = cache->bind_offsets[index]; j < cache->bind_offsets[index + 1]; j++) {
+		const unsigned int * const vert_inds = &cache->vert_inds[cache->vert_offsets[j]];
+		const float * const vert_weights = &cache->vert_weights[cache->vert_offsets[j]];
+		const unsigned int numverts = cache->vert_offsets[j + 1] - cache->vert_offsets[j];
 
-		for (int k = 0; k < sdbind->numverts; k++) {
-			copy_v3_v3(coords[k], data->targetCos[sdbind->vert_inds[k]]);
+		/* Mode-generic operations (poly normal, Newell's method) */
+		{
+			const float *v_prev = targetCos[vert_inds[numverts - 1]];
+
+			zero_v3(norm);
+			for (unsigned int k = 0; k < numverts; k++) {
+				const float *v_curr = targetCos[vert_inds[k]];
+				add_newell_cross_v3_v3v3(norm, v_prev, v_curr);
+				v_prev = v_curr;
+			}
+			normalize_v3(norm);
 		}
 
-		normal_poly_v3(norm, coords, sdbind->numverts);
 		zero_v3(temp);
 
 		/* ---------- looptri mode ---------- */
-		if (sdbind->mode == MOD_SDEF_MODE_LOOPTRI) {
-			madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[0]], sdbind->vert_weights[0]);
-			madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[1]], sdbind->vert_weights[1]);
-			madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[2]], sdbind->vert_weights[2]);
+		if (cache->modes[j] == MOD_SDEF_MODE_LOOPTRI) {
+			madd_v3_v3fl(temp, targetCos[vert_inds[0]], vert_weights[0]);
+			madd_v3_v3fl(temp, targetCos[vert_inds[1]], vert_weights[1]);
+			madd_v3_v3fl(temp, targetCos[vert_inds[2]], vert_weights[2]);
 		}
 		else {
 			/* ---------- ngon mode ---------- */
-			if (sdbind->mode == MOD_SDEF_MODE_NGON) {
-				for (int k = 0; k < sdbind->numverts; k++) {
-					madd_v3_v3fl(temp, coords[k], sdbind->vert_weights[k]);
+			if (cache->modes[j] == MOD_SDEF_MODE_NGON) {
+				for (unsigned int k = 0; k < numverts; k++) {
+					madd_v3_v3fl(temp, targetCos[vert_inds[k]], vert_weights[k]);
 				}
 			}
 
 			/* ---------- centroid mode ---------- */
-			else if (sdbind->mode == MOD_SDEF_MODE_CENTROID) {
-				float cent[3];
-				mid_v3_v3_array(cent, coords, sdbind->numverts);
+			else if (cache->modes[j] == MOD_SDEF_MODE_CENTROID) {
+				const float factor = 1.0f / (float)numverts;
+				float cent[3] = {0.0f, 0.0f, 0.0f};
+
+				for (unsigned int k = 0; k < numverts; k++) {
+					madd_v3_v3fl(cent, targetCos[vert_inds[k]], factor);
+				}
 
-				madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[0]], sdbind->vert_weights[0]);
-				madd_v3_v3fl(temp, data->targetCos[sdbind->vert_inds[1]], sdbind->vert_weights[1]);
-				madd_v3_v3fl(temp, cent, sdbind->vert_weights[2]);
+				madd_v3_v3fl(temp, targetCos[vert_inds[0]], vert_weights[0]);
+				madd_v3_v3fl(temp, targetCos[vert_inds[1]], vert_weights[1]);
+				madd_v3_v3fl(temp, cent, vert_weights[2]);
 			}
 		}
 
-		MEM_freeN(coords);
-
 		/* Apply normal offset (generic for all modes) */
-		madd_v3_v3fl(temp, norm, sdbind->normal_dist);
+		madd_v3_v3fl(temp, norm, cache->normal_dist[j]);
 
-		madd_v3_v3fl(vertexCos, temp, sdbind->influence);
+		madd_v3_v3fl(vertexCos, temp, cache->influence[j]);
 	}
 }
 
@@ -1176,7 +1289,7 @@ static void surfacedeformModifier_do(
 
 	/* Actual vertex location update starts here */
 	SDefDeformData data = {
-		.bind_verts = smd->verts,
+		.cache = bindCacheEnsure(smd),
 		.targetCos = MEM_malloc_arrayN(tnumverts, sizeof(float[3]), "SDefTargetVertArray"),
 		.vertexCos = vertexCos,
 	};
@@ -1190,7 +1303,7 @@ static void surfacedeformModifier_do(
 
 		ParallelRangeSettings settings;
 		BLI_parallel_range_settings_defaults(&settings);
-		settings.use_threading = (numverts > 10000);
+		settings.min_iter_per_thread = 16;
 		BLI_task_parallel_range(0, numverts,
 		                        &data,
 		                        deformVert,
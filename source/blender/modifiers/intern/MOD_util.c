@@ -43,6 +43,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_math_vector.h"
 #include "BLI_math_matrix.h"
+#include "BLI_task.h"
 
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
@@ -250,6 +251,93 @@ void MOD_get_vgroup(Object *ob, struct Mesh *mesh, const char *name, MDeformVert
 	}
 }
 
+typedef struct DeformVertsData {
+	float (*vertexCos)[3];
+	int numVerts;
+	const MDeformVert *dvert;
+	int defgrp_index;
+	bool invert_vgroup;
+	void *userdata;
+	ModDeformKernelFunc kernel;
+} DeformVertsData;
+
+static void deform_verts_block_task(
+        void *__restrict userdata,
+        const int iter,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const DeformVertsData *data = userdata;
+	float (*vertexCos)[3] = data->vertexCos;
+	ModDeformBlock block;
+	bool has_weight = false;
+	int i;
+
+	block.index_start = iter * MOD_DEFORM_BLOCK_SIZE;
+	block.len = min_ii(MOD_DEFORM_BLOCK_SIZE, data->numVerts - block.index_start);
+
+	for (i = 0; i < block.len; i++) {
+		float weight = defvert_array_find_weight_safe(data->dvert, block.index_start + i, data->defgrp_index);
+		if (data->invert_vgroup) {
+			weight = 1.0f - weight;
+		}
+		block.weight[i] = weight;
+		has_weight |= (weight != 0.0f);
+	}
+
+	/* Nothing to deform in this block. */
+	if (!has_weight) {
+		return;
+	}
+
+	for (i = 0; i < block.len; i++) {
+		const float *co = vertexCos[block.index_start + i];
+		block.co[0][i] = co[0];
+		block.co[1][i] = co[1];
+		block.co[2][i] = co[2];
+	}
+
+	data->kernel(data->userdata, &block);
+
+	for (i = 0; i < block.len; i++) {
+		float *co = vertexCos[block.index_start + i];
+		co[0] = block.co[0][i];
+		co[1] = block.co[1][i];
+		co[2] = block.co[2][i];
+	}
+}
+
+/**
+ * Run a deform kernel over all vertices, in blocks of #MOD_DEFORM_BLOCK_SIZE on multiple threads.
+ *
+ * Each block is copied into separate X, Y and Z arrays before calling \a kernel and written back
+ * afterwards. Vertex group weights are looked up by the driver (see #defvert_array_find_weight_safe),
+ * blocks without any weight are skipped. Kernels must leave vertices with zero weight unchanged.
+ */
+void MOD_deform_verts_parallel(
+        float (*vertexCos)[3], const int numVerts,
+        const MDeformVert *dvert, const int defgrp_index, const bool invert_vgroup,
+        void *userdata, ModDeformKernelFunc kernel)
+{
+	DeformVertsData data = {
+		.vertexCos = vertexCos,
+		.numVerts = numVerts,
+		.dvert = dvert,
+		.defgrp_index = defgrp_index,
+		.invert_vgroup = invert_vgroup,
+		.userdata = userdata,
+		.kernel = kernel,
+	};
+	const int num_blocks = (numVerts + MOD_DEFORM_BLOCK_SIZE - 1) / MOD_DEFORM_BLOCK_SIZE;
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (num_blocks > 1);
+	BLI_task_parallel_range(0, num_blocks,
+	                        &data,
+	                        deform_verts_block_task,
+	                        &settings);
+}
+
 
 /* only called by BKE_modifier.h/modifier.c */
 void modifier_type_init(ModifierTypeInfo *types[])
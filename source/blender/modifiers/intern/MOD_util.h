@@ -61,4 +61,25 @@ void MOD_get_vgroup(
         struct Object *ob, struct Mesh *mesh,
         const char *name, struct MDeformVert **dvert, int *defgrp_index);
 
+/* Deform kernels, see MOD_deform_verts_parallel(). */
+#define MOD_DEFORM_BLOCK_SIZE 256
+
+typedef struct ModDeformBlock {
+	/* Index of the first vertex in the block and the number of vertices. */
+	int index_start;
+	int len;
+	/* Positions stored per axis (X, Y and Z arrays), so kernels can be written as
+	 * straight loops over contiguous floats which the compiler can vectorize. */
+	float co[3][MOD_DEFORM_BLOCK_SIZE];
+	/* Vertex group weight, 1.0 when no group is used. */
+	float weight[MOD_DEFORM_BLOCK_SIZE];
+} ModDeformBlock;
+
+typedef void (*ModDeformKernelFunc)(void *__restrict userdata, ModDeformBlock *__restrict block);
+
+void MOD_deform_verts_parallel(
+        float (*vertexCos)[3], const int numVerts,
+        const struct MDeformVert *dvert, const int defgrp_index, const bool invert_vgroup,
+        void *userdata, ModDeformKernelFunc kernel);
+
 #endif /* __MOD_UTIL_H__ */
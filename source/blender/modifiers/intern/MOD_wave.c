@@ -45,6 +45,7 @@
 
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
+#include "BKE_image.h"
 #include "BKE_library.h"
 #include "BKE_library_query.h"
 #include "BKE_mesh.h"
@@ -155,6 +156,119 @@ static bool dependsOnNormals(ModifierData *md)
 	return (wmd->flag & MOD_WAVE_NORM) != 0;
 }
 
+typedef struct WaveKernelData {
+	const WaveModifierData *wmd;
+	const MVert *mvert;
+	float (*tex_co)[3];
+	struct Scene *scene;
+	struct Tex *tex_target;
+	struct ImagePool *pool;
+	int wmd_axis;
+	float ctime;
+	float minfac;
+	float lifefac;
+	float falloff;
+	float falloff_inv;
+} WaveKernelData;
+
+static void wave_kernel(void *__restrict userdata, ModDeformBlock *__restrict block)
+{
+	const WaveKernelData *data = userdata;
+	const WaveModifierData *wmd = data->wmd;
+	const MVert *mvert = data->mvert;
+	const float lifefac = data->lifefac;
+	const float falloff = data->falloff;
+	float *co_x = block->co[0], *co_y = block->co[1], *co_z = block->co[2];
+	int i;
+
+	for (i = 0; i < block->len; i++) {
+		const int index = block->index_start + i;
+		const float def_weight = block->weight[i];
+		float x = co_x[i] - wmd->startx;
+		float y = co_y[i] - wmd->starty;
+		float amplit = 0.0f;
+		float falloff_fac = 1.0f; /* when falloff == 0.0f this stays at 1.0f */
+
+		/* if this vert isn't in the vgroup, don't deform it */
+		if (def_weight == 0.0f) {
+			continue;
+		}
+
+		switch (data->wmd_axis) {
+			case MOD_WAVE_X | MOD_WAVE_Y:
+				amplit = sqrtf(x * x + y * y);
+				break;
+			case MOD_WAVE_X:
+				amplit = x;
+				break;
+			case MOD_WAVE_Y:
+				amplit = y;
+				break;
+		}
+
+		/* this way it makes nice circles */
+		amplit -= (data->ctime - wmd->timeoffs) * wmd->speed;
+
+		if (wmd->flag & MOD_WAVE_CYCL) {
+			amplit = (float)fmodf(amplit - wmd->width, 2.0f * wmd->width) +
+			         wmd->width;
+		}
+
+		if (falloff != 0.0f) {
+			float dist = 0.0f;
+
+			switch (data->wmd_axis) {
+				case MOD_WAVE_X | MOD_WAVE_Y:
+					dist = sqrtf(x * x + y * y);
+					break;
+				case MOD_WAVE_X:
+					dist = fabsf(x);
+					break;
+				case MOD_WAVE_Y:
+					dist = fabsf(y);
+					break;
+			}
+
+			falloff_fac = (1.0f - (dist * data->falloff_inv));
+			CLAMP(falloff_fac, 0.0f, 1.0f);
+		}
+
+		/* GAUSSIAN */
+		if ((falloff_fac != 0.0f) && (amplit > -wmd->width) && (amplit < wmd->width)) {
+			amplit = amplit * wmd->narrow;
+			amplit = (float)(1.0f / expf(amplit * amplit) - data->minfac);
+
+			/*apply texture*/
+			if (data->tex_target) {
+				TexResult texres;
+				texres.nor = NULL;
+				BKE_texture_get_value_ex(data->scene, data->tex_target, data->tex_co[index], &texres, data->pool, false);
+				amplit *= texres.tin;
+			}
+
+			/*apply weight & falloff */
+			amplit *= def_weight * falloff_fac;
+
+			if (mvert) {
+				/* move along normals */
+				if (wmd->flag & MOD_WAVE_NORM_X) {
+					co_x[i] += (lifefac * amplit) * mvert[index].no[0] / 32767.0f;
+				}
+				if (wmd->flag & MOD_WAVE_NORM_Y) {
+					co_y[i] += (lifefac * amplit) * mvert[index].no[1] / 32767.0f;
+				}
+				if (wmd->flag & MOD_WAVE_NORM_Z) {
+					co_z[i] += (lifefac * amplit) * mvert[index].no[2] / 32767.0f;
+				}
+			}
+			else {
+				/* move along local z axis */
+				co_z[i] += lifefac * amplit;
+			}
+		}
+	}
+}
+
 static void waveModifier_do(
         WaveModifierData *md,
         const ModifierEvalContext *ctx,
@@ -171,7 +285,6 @@ static void waveModifier_do(
 	float (*tex_co)[3] = NULL;
 	const int wmd_axis = wmd->flag & (MOD_WAVE_X | MOD_WAVE_Y);
 	const float falloff = wmd->falloff;
-	float falloff_fac = 1.0f; /* when falloff == 0.0f this stays at 1.0f */
 
 	if ((wmd->flag & MOD_WAVE_NORM) && (mesh != NULL)) {
 		mvert = mesh->mvert;
@@ -214,100 +327,33 @@ static void waveModifier_do(
 	}
 
 	if (lifefac != 0.0f) {
-		/* avoid divide by zero checks within the loop */
-		float falloff_inv = falloff != 0.0f ? 1.0f / falloff : 1.0f;
-		int i;
-
-		for (i = 0; i < numVerts; i++) {
-			float *co = vertexCos[i];
-			float x = co[0] - wmd->startx;
-			float y = co[1] - wmd->starty;
-			float amplit = 0.0f;
-			float def_weight = 1.0f;
-
-			/* get weights */
-			if (dvert) {
-				def_weight = defvert_find_weight(&dvert[i], defgrp_index);
-
-				/* if this vert isn't in the vgroup, don't deform it */
-				if (def_weight == 0.0f) {
-					continue;
-				}
-			}
-
-			switch (wmd_axis) {
-				case MOD_WAVE_X | MOD_WAVE_Y:
-					amplit = sqrtf(x * x + y * y);
-					break;
-				case MOD_WAVE_X:
-					amplit = x;
-					break;
-				case MOD_WAVE_Y:
-					amplit = y;
-					break;
-			}
-
-			/* this way it makes nice circles */
-			amplit -= (ctime - wmd->timeoffs) * wmd->speed;
-
-			if (wmd->flag & MOD_WAVE_CYCL) {
-				amplit = (float)fmodf(amplit - wmd->width, 2.0f * wmd->width) +
-				         wmd->width;
-			}
-
-			if (falloff != 0.0f) {
-				float dist = 0.0f;
-
-				switch (wmd_axis) {
-					case MOD_WAVE_X | MOD_WAVE_Y:
-						dist = sqrtf(x * x + y * y);
-						break;
-					case MOD_WAVE_X:
-						dist = fabsf(x);
-						break;
-					case MOD_WAVE_Y:
-						dist = fabsf(y);
-						break;
-				}
-
-				falloff_fac = (1.0f - (dist * falloff_inv));
-				CLAMP(falloff_fac, 0.0f, 1.0f);
-			}
+		WaveKernelData data = {
+			.wmd = wmd,
+			.mvert = mvert,
+			.tex_co = tex_co,
+			.scene = DEG_get_evaluated_scene(ctx->depsgraph),
+			.tex_target = tex_target,
+			.wmd_axis = wmd_axis,
+			.ctime = ctime,
+			.minfac = minfac,
+			.lifefac = lifefac,
+			.falloff = falloff,
+			/* avoid divide by zero checks within the loop */
+			.falloff_inv = falloff != 0.0f ? 1.0f / falloff : 1.0f,
+		};
+
+		if (tex_target != NULL) {
+			data.pool = BKE_image_pool_new();
+			BKE_texture_fetch_images_for_pool(tex_target, data.pool);
+		}
 
-			/* GAUSSIAN */
-			if ((falloff_fac != 0.0f) && (amplit > -wmd->width) && (amplit < wmd->width)) {
-				amplit = amplit * wmd->narrow;
-				amplit = (float)(1.0f / expf(amplit * amplit) - minfac);
-
-				/*apply texture*/
-				if (tex_target) {
-					Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
-					TexResult texres;
-					texres.nor = NULL;
-					BKE_texture_get_value(scene, tex_target, tex_co[i], &texres, false);
-					amplit *= texres.tin;
-				}
+		/* Vertices without a deform vertex are not weighted. */
+		MOD_deform_verts_parallel(
+		        vertexCos, numVerts, dvert, dvert ? defgrp_index : -1, false,
+		        &data, wave_kernel);
 
-				/*apply weight & falloff */
-				amplit *= def_weight * falloff_fac;
-
-				if (mvert) {
-					/* move along normals */
-					if (wmd->flag & MOD_WAVE_NORM_X) {
-						co[0] += (lifefac * amplit) * mvert[i].no[0] / 32767.0f;
-					}
-					if (wmd->flag & MOD_WAVE_NORM_Y) {
-						co[1] += (lifefac * amplit) * mvert[i].no[1] / 32767.0f;
-					}
-					if (wmd->flag & MOD_WAVE_NORM_Z) {
-						co[2] += (lifefac * amplit) * mvert[i].no[2] / 32767.0f;
-					}
-				}
-				else {
-					/* move along local z axis */
-					co[2] += lifefac * amplit;
-				}
-			}
+		if (data.pool != NULL) {
+			BKE_image_pool_free(data.pool);
 		}
 	}
 
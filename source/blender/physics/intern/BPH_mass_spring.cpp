@@ -884,7 +884,8 @@ static void cloth_calc_volume_force(ClothModifierData *clmd)
 }
 #endif
 
-static void cloth_solve_collisions(Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd, float step, float dt)
+static void cloth_solve_collisions(Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd, ClothCollisionCache *collision_cache,
+                                   float step, float dt)
 {
 	Cloth *cloth = clmd->clothObject;
 	Implicit_Data *id = cloth->implicit;
@@ -909,7 +910,7 @@ static void cloth_solve_collisions(Depsgraph *depsgraph, Object *ob, ClothModifi
 		zero_v3(verts[i].dcvel);
 	}
 
-	if (cloth_bvh_collision(depsgraph, ob, clmd, step / clmd->sim_parms->timescale, dt / clmd->sim_parms->timescale)) {
+	if (cloth_bvh_collision(depsgraph, ob, clmd, collision_cache, step / clmd->sim_parms->timescale, dt / clmd->sim_parms->timescale)) {
 		for (i = 0; i < mvert_num; i++) {
 			if ((clmd->sim_parms->vgroup_mass > 0) && (verts[i].flags & CLOTH_VERT_FLAG_PINNED))
 				continue;
@@ -979,6 +980,7 @@ int BPH_cloth_solve(Depsgraph *depsgraph, Object *ob, float frame, ClothModifier
 	Implicit_Data *id = cloth->implicit;
 	ColliderContacts *contacts = NULL;
 	int totcolliders = 0;
+	ClothCollisionCache *collision_cache = NULL;
 
 	BKE_sim_debug_data_clear_category("collision");
 
@@ -1000,6 +1002,11 @@ int BPH_cloth_solve(Depsgraph *depsgraph, Object *ob, float frame, ClothModifier
 		}
 	}
 
+	/* Colliders and contact buffers are shared by all substeps. */
+	if (!is_hair && (clmd->coll_parms->flags & (CLOTH_COLLSETTINGS_FLAG_ENABLED | CLOTH_COLLSETTINGS_FLAG_SELF))) {
+		collision_cache = cloth_collision_cache_create(depsgraph, ob, clmd);
+	}
+
 	while (step < tf) {
 		ImplicitSolverResult result;
 
@@ -1028,8 +1035,8 @@ int BPH_cloth_solve(Depsgraph *depsgraph, Object *ob, float frame, ClothModifier
 		cloth_record_result(clmd, &result, dt);
 
 		/* Calculate collision impulses. */
-		if (!is_hair) {
-			cloth_solve_collisions(depsgraph, ob, clmd, step, dt);
+		if (collision_cache) {
+			cloth_solve_collisions(depsgraph, ob, clmd, collision_cache, step, dt);
 		}
 
 		if (is_hair) {
@@ -1061,6 +1068,10 @@ int BPH_cloth_solve(Depsgraph *depsgraph, Object *ob, float frame, ClothModifier
 		step += dt;
 	}
 
+	if (collision_cache) {
+		cloth_collision_cache_free(collision_cache);
+	}
+
 	/* copy results back to cloth data */
 	for (i = 0; i < mvert_num; i++) {
 		BPH_mass_spring_get_motion_state(id, i, verts[i].x, verts[i].v);
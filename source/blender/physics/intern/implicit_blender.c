@@ -43,6 +43,7 @@
 
 #include "BLI_math.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -59,6 +60,16 @@
 #  define CLOTH_OPENMP_LIMIT 512
 #endif
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Solver loops run on multiple threads for at least this many vertices. */
+#define CLOTH_THREADED_MIN_VERTS 512
+/* Vertices are processed in chunks of fixed size, so that dot products are
+ * summed up in the same order for any number of threads. */
+#define CLOTH_CHUNK_VERTS 256
+
 //#define DEBUG_TIME
 
 #ifdef DEBUG_TIME
@@ -642,6 +653,197 @@ DO_INLINE void subadd_bfmatrixS_bfmatrixS(fmatrix3x3 *to, fmatrix3x3 *from, floa
 
 }
 
+///////////////////////////
+// BLOCK SPARSE ROW big matrix with 3x3 matrix entries
+///////////////////////////
+
+/* Copy of a SPARSE SYMMETRIC big matrix in which both triangles are stored row by row,
+ * so rows can be multiplied independently on multiple threads. Blocks are stored by columns,
+ * each padded to 4 floats for SIMD. */
+typedef struct bsrmatrix {
+	unsigned int vcount;
+	unsigned int *row_offsets;  /* first entry of each row, vcount + 1 items */
+	unsigned int *row_fill;     /* temporary, for building the structure */
+	unsigned int *cols;         /* column of each entry */
+	unsigned int *src;          /* big matrix block of each entry, BSR_TRANSPOSED for the upper triangle */
+	float (*blocks)[3][4];      /* block columns of each entry */
+} bsrmatrix;
+
+#define BSR_TRANSPOSED (1u << 31)
+
+DO_INLINE bsrmatrix *create_bsrmatrix(unsigned int verts, unsigned int springs)
+{
+	bsrmatrix *bsr = MEM_callocN(sizeof(bsrmatrix), "cloth_implicit_alloc_bsr");
+	const unsigned int max_entries = verts + 2 * springs;
+
+	bsr->vcount = verts;
+	bsr->row_offsets = MEM_callocN(sizeof(unsigned int) * (verts + 1), "cloth_implicit_bsr_rows");
+	bsr->row_fill = MEM_mallocN(sizeof(unsigned int) * verts, "cloth_implicit_bsr_fill");
+	bsr->cols = MEM_mallocN(sizeof(unsigned int) * max_entries, "cloth_implicit_bsr_cols");
+	bsr->src = MEM_mallocN(sizeof(unsigned int) * max_entries, "cloth_implicit_bsr_src");
+	bsr->blocks = MEM_mallocN_aligned(sizeof(*bsr->blocks) * max_entries, 16, "cloth_implicit_bsr_blocks");
+
+	return bsr;
+}
+
+DO_INLINE void del_bsrmatrix(bsrmatrix *bsr)
+{
+	if (bsr != NULL) {
+		MEM_freeN(bsr->row_offsets);
+		MEM_freeN(bsr->row_fill);
+		MEM_freeN(bsr->cols);
+		MEM_freeN(bsr->src);
+		MEM_freeN(bsr->blocks);
+		MEM_freeN(bsr);
+	}
+}
+
+/* Set up rows from the first num_blocks off-diagonal blocks of a big matrix,
+ * diagonal entry first, then the other entries in the order of the big matrix. */
+static void init_bsrmatrix_structure(bsrmatrix *bsr, fmatrix3x3 *from, unsigned int num_blocks)
+{
+	const unsigned int vcount = from[0].vcount;
+	unsigned int *offsets = bsr->row_offsets;
+	unsigned int i;
+
+	BLI_assert(bsr->vcount == vcount);
+	BLI_assert(num_blocks <= from[0].scount);
+
+	offsets[0] = 0;
+	for (i = 0; i < vcount; i++) {
+		offsets[i + 1] = 1;
+	}
+	for (i = vcount; i < vcount + num_blocks; i++) {
+		offsets[from[i].r + 1]++;
+		offsets[from[i].c + 1]++;
+	}
+	for (i = 0; i < vcount; i++) {
+		offsets[i + 1] += offsets[i];
+		bsr->row_fill[i] = offsets[i];
+	}
+
+	for (i = 0; i < vcount; i++) {
+		const unsigned int e = bsr->row_fill[i]++;
+		bsr->cols[e] = i;
+		bsr->src[e] = i;
+	}
+	for (i = vcount; i < vcount + num_blocks; i++) {
+		/* Lower triangle, multiplied with transposed blocks, see mul_bfmatrix_lfvector. */
+		unsigned int e = bsr->row_fill[from[i].c]++;
+		bsr->cols[e] = from[i].r;
+		bsr->src[e] = i | BSR_TRANSPOSED;
+
+		e = bsr->row_fill[from[i].r]++;
+		bsr->cols[e] = from[i].c;
+		bsr->src[e] = i;
+	}
+}
+
+static void fill_bsrmatrix_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	void **data = userdata;
+	bsrmatrix *bsr = data[0];
+	fmatrix3x3 *from = data[1];
+	const unsigned int row_start = chunk * CLOTH_CHUNK_VERTS;
+	const unsigned int row_end = min_ii(row_start + CLOTH_CHUNK_VERTS, bsr->vcount);
+
+	for (unsigned int e = bsr->row_offsets[row_start]; e < bsr->row_offsets[row_end]; e++) {
+		const unsigned int src = bsr->src[e];
+		float (*m)[3] = from[src & ~BSR_TRANSPOSED].m;
+		float (*blk)[4] = bsr->blocks[e];
+
+		if (src & BSR_TRANSPOSED) {
+			for (int j = 0; j < 3; j++) {
+				copy_v3_v3(blk[j], m[j]);
+				blk[j][3] = 0.0f;
+			}
+		}
+		else {
+			for (int j = 0; j < 3; j++) {
+				blk[j][0] = m[0][j];
+				blk[j][1] = m[1][j];
+				blk[j][2] = m[2][j];
+				blk[j][3] = 0.0f;
+			}
+		}
+	}
+}
+
+BLI_INLINE int chunks_for_verts(unsigned int verts)
+{
+	return (int)((verts + CLOTH_CHUNK_VERTS - 1) / CLOTH_CHUNK_VERTS);
+}
+
+static void parallel_chunks(unsigned int verts, void *userdata, TaskParallelRangeFunc func)
+{
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (verts >= CLOTH_THREADED_MIN_VERTS);
+	BLI_task_parallel_range(0, chunks_for_verts(verts), userdata, func, &settings);
+}
+
+/* Copy block values from a big matrix with the structure the BSR matrix was set up from. */
+static void fill_bsrmatrix(bsrmatrix *bsr, fmatrix3x3 *from)
+{
+	void *data[2] = {bsr, from};
+	parallel_chunks(bsr->vcount, data, fill_bsrmatrix_cb);
+}
+
+/* r = row of A * v */
+BLI_INLINE void mul_bsrmatrix_row(float r[3], const bsrmatrix *A, unsigned int row, lfVector *v)
+{
+	const unsigned int e_end = A->row_offsets[row + 1];
+#ifdef __SSE2__
+	__m128 sum = _mm_setzero_ps();
+	for (unsigned int e = A->row_offsets[row]; e < e_end; e++) {
+		const float *vec = v[A->cols[e]];
+		float (*blk)[4] = A->blocks[e];
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(blk[0]), _mm_set1_ps(vec[0])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(blk[1]), _mm_set1_ps(vec[1])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(blk[2]), _mm_set1_ps(vec[2])));
+	}
+	float tmp[4];
+	_mm_storeu_ps(tmp, sum);
+	copy_v3_v3(r, tmp);
+#else
+	zero_v3(r);
+	for (unsigned int e = A->row_offsets[row]; e < e_end; e++) {
+		const float *vec = v[A->cols[e]];
+		float (*blk)[4] = A->blocks[e];
+		for (int k = 0; k < 3; k++) {
+			r[k] += blk[0][k] * vec[0] + blk[1][k] * vec[1] + blk[2][k] * vec[2];
+		}
+	}
+#endif
+}
+
+static void mul_bsrmatrix_lfvector_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	void **data = userdata;
+	float (*to)[3] = data[0];
+	const bsrmatrix *A = data[1];
+	lfVector *v = data[2];
+	const unsigned int row_start = chunk * CLOTH_CHUNK_VERTS;
+	const unsigned int row_end = min_ii(row_start + CLOTH_CHUNK_VERTS, A->vcount);
+
+	for (unsigned int i = row_start; i < row_end; i++) {
+		mul_bsrmatrix_row(to[i], A, i, v);
+	}
+}
+
+/* to = A * v */
+static void mul_bsrmatrix_lfvector(float (*to)[3], const bsrmatrix *A, lfVector *v)
+{
+	void *data[3] = {to, (void *)A, v};
+	parallel_chunks(A->vcount, data, mul_bsrmatrix_lfvector_cb);
+}
+
 ///////////////////////////////////////////////////////////////////
 // simulator start
 ///////////////////////////////////////////////////////////////////
@@ -667,6 +869,7 @@ typedef struct Implicit_Data {
 	lfVector *z;                /* target velocity in constrained directions */
 	fmatrix3x3 *S;              /* filtering matrix for constraints */
 	fmatrix3x3 *P, *Pinv;       /* pre-conditioning matrix */
+	bsrmatrix *bsr;             /* row-wise copy of A or dFdX for multiplication */
 } Implicit_Data;
 
 Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
@@ -691,6 +894,7 @@ Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
 	id->B = create_lfvector(numverts);
 	id->dV = create_lfvector(numverts);
 	id->z = create_lfvector(numverts);
+	id->bsr = create_bsrmatrix(numverts, numsprings);
 
 	initdiag_bfmatrix(id->bigI, I);
 
@@ -717,6 +921,7 @@ void BPH_mass_spring_solver_free(Implicit_Data *id)
 	del_lfvector(id->B);
 	del_lfvector(id->dV);
 	del_lfvector(id->z);
+	del_bsrmatrix(id->bsr);
 
 	MEM_freeN(id);
 }
@@ -825,41 +1030,168 @@ static int  cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z
 }
 #endif
 
-static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z, fmatrix3x3 *S, ImplicitSolverResult *result)
+/* Shared state of the threaded conjugate gradient solver, vectors are processed in chunks
+ * of CLOTH_CHUNK_VERTS and each chunk writes its part of a dot product to its own slot. */
+typedef struct CGSolverData {
+	const bsrmatrix *A;
+	fmatrix3x3 *lA, *S, *Pinv;
+	lfVector *dV, *B, *fB, *r, *c, *q, *s;
+	float alpha, beta;
+	double *partial_a, *partial_b;
+} CGSolverData;
+
+BLI_INLINE void cg_chunk_range(const CGSolverData *data, const int chunk, unsigned int *r_start, unsigned int *r_end)
+{
+	*r_start = chunk * CLOTH_CHUNK_VERTS;
+	*r_end = min_ii(*r_start + CLOTH_CHUNK_VERTS, data->A->vcount);
+}
+
+/* Sum up chunk results in a fixed order, so the result does not depend on threading. */
+static double cg_sum_partial(const double *partial, int num_chunks)
+{
+	double sum = 0.0;
+	for (int i = 0; i < num_chunks; i++) {
+		sum += partial[i];
+	}
+	return sum;
+}
+
+static void cg_init_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	CGSolverData *data = userdata;
+	unsigned int start, end;
+	double bnorm2 = 0.0, delta = 0.0;
+	float AdV[3], tmp[3];
+
+	cg_chunk_range(data, chunk, &start, &end);
+
+	for (unsigned int i = start; i < end; i++) {
+		/* block Jacobi preconditioner, A is positive definite so diagonal blocks are invertible */
+		if (!invert_m3_m3(data->Pinv[i].m, data->lA[i].m)) {
+			unit_m3(data->Pinv[i].m);
+		}
+
+		/* d0 = filter(B)^T * P * filter(B) */
+		mul_v3_m3v3(data->fB[i], data->S[i].m, data->B[i]);
+		mul_v3_m3v3(tmp, data->Pinv[i].m, data->fB[i]);
+		bnorm2 += dot_v3v3(data->fB[i], tmp);
+
+		/* r = filter(B - A * dV) */
+		mul_bsrmatrix_row(AdV, data->A, i, data->dV);
+		sub_v3_v3v3(tmp, data->B[i], AdV);
+		mul_v3_m3v3(data->r[i], data->S[i].m, tmp);
+
+		/* c = filter(P^-1 * r) */
+		mul_v3_m3v3(tmp, data->Pinv[i].m, data->r[i]);
+		mul_v3_m3v3(data->c[i], data->S[i].m, tmp);
+
+		/* delta = r^T * c */
+		delta += dot_v3v3(data->r[i], data->c[i]);
+	}
+
+	data->partial_a[chunk] = bnorm2;
+	data->partial_b[chunk] = delta;
+}
+
+static void cg_mul_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	CGSolverData *data = userdata;
+	unsigned int start, end;
+	double cq = 0.0;
+	float Ac[3];
+
+	cg_chunk_range(data, chunk, &start, &end);
+
+	for (unsigned int i = start; i < end; i++) {
+		/* q = filter(A * c) */
+		mul_bsrmatrix_row(Ac, data->A, i, data->c);
+		mul_v3_m3v3(data->q[i], data->S[i].m, Ac);
+
+		cq += dot_v3v3(data->c[i], data->q[i]);
+	}
+
+	data->partial_a[chunk] = cq;
+}
+
+static void cg_step_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	CGSolverData *data = userdata;
+	const float alpha = data->alpha;
+	unsigned int start, end;
+	double delta = 0.0;
+
+	cg_chunk_range(data, chunk, &start, &end);
+
+	for (unsigned int i = start; i < end; i++) {
+		madd_v3_v3fl(data->dV[i], data->c[i], alpha);
+		madd_v3_v3fl(data->r[i], data->q[i], -alpha);
+
+		/* s = P^-1 * r */
+		mul_v3_m3v3(data->s[i], data->Pinv[i].m, data->r[i]);
+
+		delta += dot_v3v3(data->r[i], data->s[i]);
+	}
+
+	data->partial_b[chunk] = delta;
+}
+
+static void cg_direction_cb(
+        void *__restrict userdata,
+        const int chunk,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	CGSolverData *data = userdata;
+	const float beta = data->beta;
+	unsigned int start, end;
+	float tmp[3];
+
+	cg_chunk_range(data, chunk, &start, &end);
+
+	for (unsigned int i = start; i < end; i++) {
+		/* c = filter(s + beta * c) */
+		madd_v3_v3v3fl(tmp, data->s[i], data->c[i], beta);
+		mul_v3_m3v3(data->c[i], data->S[i].m, tmp);
+	}
+}
+
+/* Modified preconditioned conjugate gradient (Baraff & Witkin) with a block Jacobi preconditioner.
+ * The matrix is multiplied in its row-wise copy bsr, lA is only used for the diagonal blocks. */
+static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, const bsrmatrix *bsr, lfVector *lB, lfVector *z, fmatrix3x3 *S, fmatrix3x3 *Pinv, ImplicitSolverResult *result)
 {
 	// Solves for unknown X in equation AX=B
 	unsigned int conjgrad_loopcount = 0, conjgrad_looplimit = 100;
 	float conjgrad_epsilon = 0.01f;
 
 	unsigned int numverts = lA[0].vcount;
-	lfVector *fB = create_lfvector(numverts);
-	lfVector *AdV = create_lfvector(numverts);
-	lfVector *r = create_lfvector(numverts);
-	lfVector *c = create_lfvector(numverts);
-	lfVector *q = create_lfvector(numverts);
-	lfVector *s = create_lfvector(numverts);
-	float bnorm2, delta_new, delta_old, delta_target, alpha;
+	const int num_chunks = chunks_for_verts(numverts);
+	float bnorm2, delta_new, delta_old, delta_target;
+	CGSolverData data;
+
+	data.A = bsr;
+	data.lA = lA;
+	data.S = S;
+	data.Pinv = Pinv;
+	data.dV = ldV;
+	data.B = lB;
+	data.fB = create_lfvector(numverts);
+	data.r = create_lfvector(numverts);
+	data.c = create_lfvector(numverts);
+	data.q = create_lfvector(numverts);
+	data.s = create_lfvector(numverts);
+	data.partial_a = MEM_mallocN(sizeof(double) * num_chunks, "cloth_implicit_cg_partial_a");
+	data.partial_b = MEM_mallocN(sizeof(double) * num_chunks, "cloth_implicit_cg_partial_b");
 
 	cp_lfvector(ldV, z, numverts);
 
-	/* d0 = filter(B)^T * P * filter(B) */
-	cp_lfvector(fB, lB, numverts);
-	filter(fB, S);
-	bnorm2 = dot_lfvector(fB, fB, numverts);
-	delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
-
-	/* r = filter(B - A * dV) */
-	mul_bfmatrix_lfvector(AdV, lA, ldV);
-	sub_lfvector_lfvector(r, lB, AdV, numverts);
-	filter(r, S);
-
-	/* c = filter(P^-1 * r) */
-	cp_lfvector(c, r, numverts);
-	filter(c, S);
-
-	/* delta = r^T * c */
-	delta_new = dot_lfvector(r, c, numverts);
-
 #ifdef IMPLICIT_PRINT_SOLVER_INPUT_OUTPUT
 	printf("==== A ====\n");
 	print_bfmatrix(lA);
@@ -871,23 +1203,23 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	print_bfmatrix(S);
 #endif
 
-	while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-		mul_bfmatrix_lfvector(q, lA, c);
-		filter(q, S);
+	parallel_chunks(numverts, &data, cg_init_cb);
+	bnorm2 = (float)cg_sum_partial(data.partial_a, num_chunks);
+	delta_new = (float)cg_sum_partial(data.partial_b, num_chunks);
+	delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
-		alpha = delta_new / dot_lfvector(c, q, numverts);
+	while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
+		parallel_chunks(numverts, &data, cg_mul_cb);
 
-		add_lfvector_lfvectorS(ldV, ldV, c, alpha, numverts);
+		data.alpha = delta_new / (float)cg_sum_partial(data.partial_a, num_chunks);
 
-		add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
+		parallel_chunks(numverts, &data, cg_step_cb);
 
-		/* s = P^-1 * r */
-		cp_lfvector(s, r, numverts);
 		delta_old = delta_new;
-		delta_new = dot_lfvector(r, s, numverts);
+		delta_new = (float)cg_sum_partial(data.partial_b, num_chunks);
+		data.beta = delta_new / delta_old;
 
-		add_lfvector_lfvectorS(c, s, c, delta_new / delta_old, numverts);
-		filter(c, S);
+		parallel_chunks(numverts, &data, cg_direction_cb);
 
 		conjgrad_loopcount++;
 	}
@@ -898,12 +1230,13 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	printf("========\n");
 #endif
 
-	del_lfvector(fB);
-	del_lfvector(AdV);
-	del_lfvector(r);
-	del_lfvector(c);
-	del_lfvector(q);
-	del_lfvector(s);
+	del_lfvector(data.fB);
+	del_lfvector(data.r);
+	del_lfvector(data.c);
+	del_lfvector(data.q);
+	del_lfvector(data.s);
+	MEM_freeN(data.partial_a);
+	MEM_freeN(data.partial_b);
 	// printf("W/O conjgrad_loopcount: %d\n", conjgrad_loopcount);
 
 	result->status = conjgrad_loopcount < conjgrad_looplimit ? BPH_SOLVER_SUCCESS : BPH_SOLVER_NO_CONVERGENCE;
@@ -1122,7 +1455,11 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
 	subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-	mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+	/* A and dFdX share the block structure, multiply both in their row-wise copy */
+	init_bsrmatrix_structure(data->bsr, data->A, data->num_blocks);
+	fill_bsrmatrix(data->bsr, data->dFdX);
+	mul_bsrmatrix_lfvector(dFdXmV, data->bsr, data->V);
+	fill_bsrmatrix(data->bsr, data->A);
 
 	add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1130,7 +1467,7 @@ bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 	double start = PIL_check_seconds_timer();
 #endif
 
-	cg_filtered(data->dV, data->A, data->B, data->z, data->S, result); /* conjugate gradient algorithm to solve Ax=b */
+	cg_filtered(data->dV, data->A, data->bsr, data->B, data->z, data->S, data->Pinv, result); /* conjugate gradient algorithm to solve Ax=b */
 	// cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
 #ifdef DEBUG_TIME
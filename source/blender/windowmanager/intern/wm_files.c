@@ -115,6 +115,8 @@
 
 #include "GPU_draw.h"
 
+#include "COM_compositor.h"
+
 /* only to report a missing engine */
 #include "RE_engine.h"
 
@@ -488,6 +490,11 @@ static void wm_file_read_post(
 
 	CTX_wm_window_set(C, wm->windows.first);
 
+#ifdef WITH_COMPOSITOR
+	/* cached compositor results refer to data of the previous file */
+	COM_clearCaches();
+#endif
+
 	Main *bmain = CTX_data_main(C);
 	DEG_on_visible_update(bmain, true);
 	wm_event_do_depsgraph(C);
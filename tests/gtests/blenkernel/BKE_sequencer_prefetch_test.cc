@@ -0,0 +1,149 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "MEM_CacheLimiterC-Api.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_string.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_main.h"
+#include "BKE_scene.h"
+#include "BKE_sequencer.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Frames following the displayed one are rendered on prefetch threads. Text strips draw
+ * with the global render font, frames showing them have to be left to the playback thread. */
+
+#define COLOR_START 1
+#define TEXT_START 6
+#define STRIPS_END 30
+
+class SequencerPrefetchTest : public testing::Test
+{
+protected:
+	Main *bmain;
+	Scene *scene;
+	Sequence *seq_color;
+	Sequence *seq_text;
+	SeqRenderData context;
+	size_t cache_limit;
+	int prefetchframes;
+
+	static void SetUpTestCase()
+	{
+		IMB_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+	}
+
+	virtual void SetUp()
+	{
+		bmain = BKE_main_new();
+		scene = BKE_scene_add(bmain, "Scene");
+		scene->r.sfra = COLOR_START;
+		scene->r.efra = STRIPS_END;
+
+		Editing *ed = BKE_sequencer_editing_get(scene, true);
+		seq_color = effect_strip_add(ed, SEQ_TYPE_COLOR, 1, COLOR_START);
+		seq_text = effect_strip_add(ed, SEQ_TYPE_TEXT, 2, TEXT_START);
+
+		TextVars *text_data = (TextVars *)seq_text->effectdata;
+		BLI_strncpy(text_data->text, "Prefetch", sizeof(text_data->text));
+
+		BKE_sequencer_new_render_data(bmain, NULL, scene, 64, 48, SEQ_PROXY_RENDER_SIZE_FULL, false, &context);
+
+		/* the number of prefetched frames is limited by the cache size */
+		cache_limit = MEM_CacheLimiter_get_maximum();
+		MEM_CacheLimiter_set_maximum(256 * 1024 * 1024);
+		prefetchframes = U.prefetchframes;
+		U.prefetchframes = 10;
+	}
+
+	virtual void TearDown()
+	{
+		BKE_sequencer_prefetch_free();
+		BKE_sequencer_cache_cleanup();
+		U.prefetchframes = prefetchframes;
+		MEM_CacheLimiter_set_maximum(cache_limit);
+		BKE_main_free(bmain);
+	}
+
+	Sequence *effect_strip_add(Editing *ed, int type, int channel, int frame_start)
+	{
+		Sequence *seq = BKE_sequence_alloc(ed->seqbasep, frame_start, channel);
+		struct SeqEffectHandle sh;
+
+		seq->type = type;
+		seq->strip = (Strip *)MEM_callocN(sizeof(Strip), "strip");
+		seq->strip->us = 1;
+
+		sh = BKE_sequence_get_effect(seq);
+		sh.init(seq);
+
+		seq->len = 1;
+		BKE_sequence_tx_set_final_right(seq, STRIPS_END);
+		BKE_sequence_calc(scene, seq);
+		BKE_sequence_calc_disp(scene, seq);
+
+		return seq;
+	}
+
+	bool frame_is_cached(Sequence *seq, float cfra)
+	{
+		ImBuf *ibuf = BKE_sequencer_cache_get(&context, seq, cfra, SEQ_STRIPELEM_IBUF);
+
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+			return true;
+		}
+		return false;
+	}
+};
+
+TEST_F(SequencerPrefetchTest, StopsBeforeTextStrip)
+{
+	ImBuf *ibuf = BKE_sequencer_give_ibuf_threaded(&context, COLOR_START, 0);
+	ASSERT_TRUE(ibuf != NULL);
+	IMB_freeImBuf(ibuf);
+
+	BKE_sequencer_prefetch_wait();
+
+	for (int cfra = COLOR_START + 1; cfra < TEXT_START; cfra++) {
+		EXPECT_TRUE(frame_is_cached(seq_color, cfra)) << "frame " << cfra;
+	}
+	for (int cfra = TEXT_START; cfra <= COLOR_START + U.prefetchframes; cfra++) {
+		EXPECT_FALSE(frame_is_cached(seq_color, cfra)) << "frame " << cfra;
+		EXPECT_FALSE(frame_is_cached(seq_text, cfra)) << "frame " << cfra;
+	}
+}
+
+TEST_F(SequencerPrefetchTest, TextStripRenderedByCaller)
+{
+	for (int cfra = TEXT_START; cfra < TEXT_START + 5; cfra++) {
+		ImBuf *ibuf = BKE_sequencer_give_ibuf_threaded(&context, cfra, 0);
+		ASSERT_TRUE(ibuf != NULL);
+		EXPECT_EQ(64, ibuf->x);
+		EXPECT_EQ(48, ibuf->y);
+		IMB_freeImBuf(ibuf);
+
+		BKE_sequencer_prefetch_wait();
+
+		/* nothing ahead was rendered, only the displayed frame */
+		EXPECT_TRUE(frame_is_cached(seq_text, cfra));
+		EXPECT_FALSE(frame_is_cached(seq_text, cfra + 1));
+	}
+}
@@ -0,0 +1,150 @@
+#include "testing/testing.h"
+
+#include "BLI_utildefines.h"
+#include "bmesh.h"
+#include "bmesh_tools.h"
+#include "BLI_math.h"
+
+#include "MEM_guardedalloc.h"
+
+#define GRID_RES 64
+/* large enough to be split into regions which are decimated in parallel */
+#define GRID_RES_REGIONS 256
+#define GRID_SIZE 2.0f
+
+static float grid_height(const float x, const float y)
+{
+	return 0.25f * sinf(x * (float)M_PI) * cosf(y * (float)M_PI);
+}
+
+/* Triangulated height-field grid, large enough to use threaded cost calculation. */
+static BMesh *grid_mesh_create(const int res = GRID_RES)
+{
+	BMeshCreateParams bm_params = {0};
+	BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+	BMVert **verts = (BMVert **)MEM_mallocN(sizeof(*verts) * (res + 1) * (res + 1), __func__);
+#define GRID_VERT(i, j) verts[(i) * (res + 1) + (j)]
+
+	for (int i = 0; i <= res; i++) {
+		for (int j = 0; j <= res; j++) {
+			float co[3];
+			co[0] = ((float)i / res) * GRID_SIZE;
+			co[1] = ((float)j / res) * GRID_SIZE;
+			co[2] = grid_height(co[0], co[1]);
+			GRID_VERT(i, j) = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+		}
+	}
+
+	for (int i = 0; i < res; i++) {
+		for (int j = 0; j < res; j++) {
+			BMVert *tri_a[3] = {GRID_VERT(i, j), GRID_VERT(i + 1, j), GRID_VERT(i + 1, j + 1)};
+			BMVert *tri_b[3] = {GRID_VERT(i, j), GRID_VERT(i + 1, j + 1), GRID_VERT(i, j + 1)};
+			BM_face_create_verts(bm, tri_a, 3, NULL, BM_CREATE_NOP, true);
+			BM_face_create_verts(bm, tri_b, 3, NULL, BM_CREATE_NOP, true);
+		}
+	}
+
+#undef GRID_VERT
+	MEM_freeN(verts);
+
+	BM_mesh_normals_update(bm);
+	BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+	return bm;
+}
+
+static float grid_max_error(BMesh *bm)
+{
+	BMIter iter;
+	BMVert *v;
+	float error = 0.0f;
+
+	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+		error = max_ff(error, fabsf(v->co[2] - grid_height(v->co[0], v->co[1])));
+	}
+	return error;
+}
+
+TEST(bmesh_decimate, CollapseFaceCount)
+{
+	BMesh *bm = grid_mesh_create();
+	const int face_tot_orig = bm->totface;
+	const int face_tot_target = (int)(face_tot_orig * 0.25f);
+
+	BM_mesh_decimate_collapse(bm, 0.25f, NULL, 1.0f, false, -1, 0.0f);
+
+	/* each collapse removes two triangles from the grid interior */
+	EXPECT_LE(bm->totface, face_tot_target);
+	EXPECT_GE(bm->totface, face_tot_target - 2);
+	BM_mesh_free(bm);
+}
+
+TEST(bmesh_decimate, CollapseQuality)
+{
+	BMesh *bm = grid_mesh_create();
+
+	BM_mesh_decimate_collapse(bm, 0.1f, NULL, 1.0f, false, -1, 0.0f);
+
+	/* vertices stay close to the original surface */
+	EXPECT_LT(grid_max_error(bm), 0.02f);
+	BM_mesh_free(bm);
+}
+
+static void decimate_compare_threaded(const int res, const float ratio)
+{
+	BMesh *bm_threaded = grid_mesh_create(res);
+	BMesh *bm_single = grid_mesh_create(res);
+
+	BM_mesh_decimate_collapse_ex(bm_threaded, ratio, NULL, 1.0f, false, -1, 0.0f, true);
+	BM_mesh_decimate_collapse_ex(bm_single, ratio, NULL, 1.0f, false, -1, 0.0f, false);
+
+	ASSERT_EQ(bm_threaded->totvert, bm_single->totvert);
+	ASSERT_EQ(bm_threaded->totedge, bm_single->totedge);
+	ASSERT_EQ(bm_threaded->totface, bm_single->totface);
+
+	BMIter iter_a, iter_b;
+	BMVert *v_a = (BMVert *)BM_iter_new(&iter_a, bm_threaded, BM_VERTS_OF_MESH, NULL);
+	BMVert *v_b = (BMVert *)BM_iter_new(&iter_b, bm_single, BM_VERTS_OF_MESH, NULL);
+	for (; v_a && v_b; v_a = (BMVert *)BM_iter_step(&iter_a), v_b = (BMVert *)BM_iter_step(&iter_b)) {
+		EXPECT_V3_NEAR(v_a->co, v_b->co, 0.0f);
+	}
+
+	BM_mesh_free(bm_threaded);
+	BM_mesh_free(bm_single);
+}
+
+TEST(bmesh_decimate, CollapseMatchesSingleThreaded)
+{
+	/* Initial quadrics and costs are calculated on multiple threads,
+	 * the result must be the same as a single threaded run. */
+	decimate_compare_threaded(GRID_RES, 0.2f);
+}
+
+TEST(bmesh_decimate, RegionsFaceCount)
+{
+	BMesh *bm = grid_mesh_create(GRID_RES_REGIONS);
+	const int face_tot_target = (int)(bm->totface * 0.2f);
+
+	BM_mesh_decimate_collapse(bm, 0.2f, NULL, 1.0f, false, -1, 0.0f);
+
+	/* the serial pass over region borders reaches the exact target */
+	EXPECT_LE(bm->totface, face_tot_target);
+	EXPECT_GE(bm->totface, face_tot_target - 2);
+	BM_mesh_free(bm);
+}
+
+TEST(bmesh_decimate, RegionsQuality)
+{
+	BMesh *bm = grid_mesh_create(GRID_RES_REGIONS);
+
+	BM_mesh_decimate_collapse(bm, 0.05f, NULL, 1.0f, false, -1, 0.0f);
+
+	EXPECT_LT(grid_max_error(bm), 0.02f);
+	BM_mesh_free(bm);
+}
+
+TEST(bmesh_decimate, RegionsMatchSingleThreaded)
+{
+	/* Regions only depend on the mesh, collapsing them in parallel
+	 * must give the same result as collapsing them one after another. */
+	decimate_compare_threaded(GRID_RES_REGIONS, 0.2f);
+}
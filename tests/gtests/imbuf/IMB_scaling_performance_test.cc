@@ -0,0 +1,150 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Run the 8K cases too. */
+//#define SCALING_RUN_BIG
+
+class ImBufScalingPerformanceTest : public testing::Test
+{
+protected:
+	static void SetUpTestCase()
+	{
+		IMB_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+	}
+};
+
+static ImBuf *test_image_create(const int x, const int y, const bool use_float)
+{
+	ImBuf *ibuf = IMB_allocImBuf(x, y, 32, use_float ? IB_rectfloat : IB_rect);
+
+	for (size_t i = 0; i < (size_t)x * y; i++) {
+		const unsigned int value = (unsigned int)(i * 2654435761u);
+		if (use_float) {
+			for (int c = 0; c < 4; c++) {
+				ibuf->rect_float[i * 4 + c] = (float)((value >> (c * 8)) & 0xff) / 255.0f;
+			}
+		}
+		else {
+			ibuf->rect[i] = value;
+		}
+	}
+
+	return ibuf;
+}
+
+static void scaling_tests(const int x, const int y, const bool use_float)
+{
+	printf("\n========== STARTING %dx%d %s ==========\n", x, y, use_float ? "float" : "byte");
+
+	{
+		ImBuf *ibuf = test_image_create(x, y, use_float);
+		TIMEIT_START(scale_down);
+		IMB_scaleImBuf(ibuf, x / 3, y / 3);
+		TIMEIT_END(scale_down);
+		EXPECT_EQ(ibuf->x, x / 3);
+		EXPECT_EQ(ibuf->y, y / 3);
+		IMB_freeImBuf(ibuf);
+	}
+
+	{
+		ImBuf *ibuf = test_image_create(x, y, use_float);
+		TIMEIT_START(scale_up);
+		IMB_scaleImBuf(ibuf, x * 3 / 2, y * 3 / 2);
+		TIMEIT_END(scale_up);
+		EXPECT_EQ(ibuf->x, x * 3 / 2);
+		EXPECT_EQ(ibuf->y, y * 3 / 2);
+		IMB_freeImBuf(ibuf);
+	}
+
+	{
+		ImBuf *ibuf = test_image_create(x, y, use_float);
+		TIMEIT_START(scale_fast);
+		IMB_scalefastImBuf(ibuf, x / 3, y / 3);
+		TIMEIT_END(scale_fast);
+		EXPECT_EQ(ibuf->x, x / 3);
+		IMB_freeImBuf(ibuf);
+	}
+
+	{
+		ImBuf *ibuf = test_image_create(x, y, use_float);
+		TIMEIT_START(filter);
+		IMB_filter(ibuf);
+		TIMEIT_END(filter);
+		IMB_freeImBuf(ibuf);
+	}
+
+	{
+		ImBuf *ibuf = test_image_create(x, y, use_float);
+		TIMEIT_START(mipmap);
+		IMB_makemipmap(ibuf, false);
+		TIMEIT_END(mipmap);
+		EXPECT_GT(ibuf->miptot, 1);
+		IMB_freeImBuf(ibuf);
+	}
+
+	{
+		ImBuf *ibuf = test_image_create(x, y, use_float);
+		TIMEIT_START(mipmap_filtered);
+		IMB_makemipmap(ibuf, true);
+		TIMEIT_END(mipmap_filtered);
+		EXPECT_GT(ibuf->miptot, 1);
+		IMB_freeImBuf(ibuf);
+	}
+
+	printf("========== ENDED %dx%d %s ==========\n\n", x, y, use_float ? "float" : "byte");
+}
+
+TEST_F(ImBufScalingPerformanceTest, Byte256)
+{
+	scaling_tests(256, 256, false);
+}
+
+TEST_F(ImBufScalingPerformanceTest, Float256)
+{
+	scaling_tests(256, 256, true);
+}
+
+TEST_F(ImBufScalingPerformanceTest, Byte1080p)
+{
+	scaling_tests(1920, 1080, false);
+}
+
+TEST_F(ImBufScalingPerformanceTest, Float1080p)
+{
+	scaling_tests(1920, 1080, true);
+}
+
+TEST_F(ImBufScalingPerformanceTest, Byte4K)
+{
+	scaling_tests(4096, 2160, false);
+}
+
+TEST_F(ImBufScalingPerformanceTest, Float4K)
+{
+	scaling_tests(4096, 2160, true);
+}
+
+#ifdef SCALING_RUN_BIG
+TEST_F(ImBufScalingPerformanceTest, Byte8K)
+{
+	scaling_tests(7680, 4320, false);
+}
+
+TEST_F(ImBufScalingPerformanceTest, Float8K)
+{
+	scaling_tests(7680, 4320, true);
+}
+#endif
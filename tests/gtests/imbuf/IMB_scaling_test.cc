@@ -0,0 +1,170 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_threads.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Scaling and filtering are split over threads per line, the result has to be
+ * exactly the same as when running on a single thread.
+ * Sizes are not a power of two and above the threading threshold (256x256). */
+
+typedef void (*ImBufOperation)(ImBuf *ibuf);
+
+class ImBufScalingTest : public testing::Test
+{
+protected:
+	static void SetUpTestCase()
+	{
+		IMB_init();
+	}
+
+	static void TearDownTestCase()
+	{
+		BLI_system_num_threads_override_set(0);
+		IMB_exit();
+	}
+};
+
+static ImBuf *test_image_create(const int x, const int y, const bool use_float)
+{
+	ImBuf *ibuf = IMB_allocImBuf(x, y, 32, use_float ? IB_rectfloat : IB_rect);
+
+	for (size_t i = 0; i < (size_t)x * y; i++) {
+		const unsigned int value = (unsigned int)(i * 2654435761u);
+		if (use_float) {
+			for (int c = 0; c < 4; c++) {
+				ibuf->rect_float[i * 4 + c] = (float)((value >> (c * 8)) & 0xff) / 255.0f;
+			}
+		}
+		else {
+			ibuf->rect[i] = value;
+		}
+	}
+
+	return ibuf;
+}
+
+static void expect_imbuf_equal(const ImBuf *a, const ImBuf *b)
+{
+	ASSERT_EQ(a->x, b->x);
+	ASSERT_EQ(a->y, b->y);
+	ASSERT_EQ(a->rect != NULL, b->rect != NULL);
+	ASSERT_EQ(a->rect_float != NULL, b->rect_float != NULL);
+
+	const size_t tot_pixels = (size_t)a->x * a->y;
+	if (a->rect) {
+		EXPECT_EQ(0, memcmp(a->rect, b->rect, tot_pixels * sizeof(*a->rect)));
+	}
+	if (a->rect_float) {
+		EXPECT_EQ(0, memcmp(a->rect_float, b->rect_float, tot_pixels * sizeof(float[4])));
+	}
+}
+
+/* Run the operation once on a single thread and once threaded, then compare the results
+ * and all mipmap levels. A thread count above one is forced so the threaded code path is
+ * taken on single core machines too. */
+static void threaded_matches_single(const int x, const int y, const bool use_float, ImBufOperation operation)
+{
+	ImBuf *ibuf_single = test_image_create(x, y, use_float);
+	ImBuf *ibuf_threaded = test_image_create(x, y, use_float);
+
+	BLI_system_num_threads_override_set(1);
+	operation(ibuf_single);
+	BLI_system_num_threads_override_set(4);
+	operation(ibuf_threaded);
+	BLI_system_num_threads_override_set(0);
+
+	expect_imbuf_equal(ibuf_single, ibuf_threaded);
+
+	ASSERT_EQ(ibuf_single->miptot, ibuf_threaded->miptot);
+	for (int i = 0; i < ibuf_single->miptot - 1; i++) {
+		expect_imbuf_equal(ibuf_single->mipmap[i], ibuf_threaded->mipmap[i]);
+	}
+
+	IMB_freeImBuf(ibuf_single);
+	IMB_freeImBuf(ibuf_threaded);
+}
+
+static void scale_down(ImBuf *ibuf)
+{
+	IMB_scaleImBuf(ibuf, 211, 157);
+}
+
+static void scale_up(ImBuf *ibuf)
+{
+	IMB_scaleImBuf(ibuf, 1033, 777);
+}
+
+static void scale_mixed(ImBuf *ibuf)
+{
+	IMB_scaleImBuf(ibuf, 1033, 131);
+}
+
+static void scale_fast(ImBuf *ibuf)
+{
+	IMB_scalefastImBuf(ibuf, 701, 293);
+}
+
+static void filter(ImBuf *ibuf)
+{
+	IMB_filter(ibuf);
+}
+
+static void mipmap(ImBuf *ibuf)
+{
+	IMB_makemipmap(ibuf, false);
+}
+
+static void mipmap_filtered(ImBuf *ibuf)
+{
+	IMB_makemipmap(ibuf, true);
+}
+
+TEST_F(ImBufScalingTest, ScaleDown)
+{
+	threaded_matches_single(517, 389, false, scale_down);
+	threaded_matches_single(517, 389, true, scale_down);
+}
+
+TEST_F(ImBufScalingTest, ScaleUp)
+{
+	threaded_matches_single(517, 389, false, scale_up);
+	threaded_matches_single(517, 389, true, scale_up);
+}
+
+TEST_F(ImBufScalingTest, ScaleMixed)
+{
+	threaded_matches_single(517, 389, false, scale_mixed);
+	threaded_matches_single(517, 389, true, scale_mixed);
+}
+
+TEST_F(ImBufScalingTest, ScaleFast)
+{
+	threaded_matches_single(517, 389, false, scale_fast);
+	threaded_matches_single(517, 389, true, scale_fast);
+}
+
+TEST_F(ImBufScalingTest, Filter)
+{
+	threaded_matches_single(517, 389, false, filter);
+	threaded_matches_single(517, 389, true, filter);
+}
+
+TEST_F(ImBufScalingTest, Mipmap)
+{
+	threaded_matches_single(517, 389, false, mipmap);
+	threaded_matches_single(517, 389, true, mipmap);
+}
+
+TEST_F(ImBufScalingTest, MipmapFiltered)
+{
+	threaded_matches_single(517, 389, false, mipmap_filtered);
+	threaded_matches_single(517, 389, true, mipmap_filtered);
+}
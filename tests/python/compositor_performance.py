@@ -0,0 +1,113 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Time the compositor on a chain of simple per-pixel nodes.
+# This doesn't need any test files, the input is a generated image.
+#
+# Example usage:
+#
+#   blender --background --factory-startup --python tests/python/compositor_performance.py -- --runs 10
+
+import bpy
+
+import sys
+import time
+
+
+def build_tree(scene, size):
+    image = bpy.data.images.new("compositor_performance", size, size, float_buffer=True)
+    image.generated_type = 'COLOR_GRID'
+
+    scene.use_nodes = True
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    node_image = tree.nodes.new('CompositorNodeImage')
+    node_image.image = image
+
+    node_value = tree.nodes.new('CompositorNodeRGBToBW')
+    tree.links.new(node_image.outputs["Image"], node_value.inputs["Image"])
+
+    node_math = tree.nodes.new('CompositorNodeMath')
+    node_math.operation = 'MULTIPLY'
+    node_math.use_clamp = True
+    tree.links.new(node_value.outputs["Val"], node_math.inputs[0])
+    node_math.inputs[1].default_value = 0.75
+
+    node_mix_add = tree.nodes.new('CompositorNodeMixRGB')
+    node_mix_add.blend_type = 'ADD'
+    tree.links.new(node_math.outputs["Value"], node_mix_add.inputs["Fac"])
+    tree.links.new(node_image.outputs["Image"], node_mix_add.inputs[1])
+    node_mix_add.inputs[2].default_value = (0.1, 0.2, 0.3, 1.0)
+
+    node_mix_mul = tree.nodes.new('CompositorNodeMixRGB')
+    node_mix_mul.blend_type = 'MULTIPLY'
+    tree.links.new(node_mix_add.outputs["Image"], node_mix_mul.inputs[1])
+    tree.links.new(node_image.outputs["Image"], node_mix_mul.inputs[2])
+
+    node_gamma = tree.nodes.new('CompositorNodeGamma')
+    node_gamma.inputs["Gamma"].default_value = 2.2
+    tree.links.new(node_mix_mul.outputs["Image"], node_gamma.inputs["Image"])
+
+    node_composite = tree.nodes.new('CompositorNodeComposite')
+    tree.links.new(node_gamma.outputs["Image"], node_composite.inputs["Image"])
+
+
+def main():
+    import argparse
+
+    argv = sys.argv
+    argv = argv[argv.index("--") + 1:] if "--" in argv else []
+
+    parser = argparse.ArgumentParser(description="Compositor performance test")
+    parser.add_argument("--runs", type=int, default=5, help="number of timed compositor runs")
+    parser.add_argument("--size", type=int, default=2048, help="width and height of the input image")
+    args = parser.parse_args(argv)
+
+    scene = bpy.context.scene
+
+    # nothing to render, only the compositor is timed
+    for ob in list(scene.objects):
+        bpy.data.objects.remove(ob)
+
+    scene.render.resolution_x = args.size
+    scene.render.resolution_y = args.size
+    scene.render.resolution_percentage = 100
+    scene.render.use_compositing = True
+    scene.render.use_sequencer = False
+
+    build_tree(scene, args.size)
+
+    # first run includes setting up buffers and caches
+    bpy.ops.render.render()
+
+    timings = []
+    for _ in range(args.runs):
+        time_start = time.time()
+        bpy.ops.render.render()
+        timings.append(time.time() - time_start)
+
+    timings.sort()
+    print("Compositor %dx%d, %d runs: best %.4fs, median %.4fs" %
+          (args.size, args.size, args.runs, timings[0], timings[len(timings) // 2]))
+
+
+if __name__ == "__main__":
+    main()